@@ -23,7 +23,7 @@
 #include "etl/bit_stream.h"
 
 #include <stdint.h>
-#include <stdint.h>
+#include <math.h>
 
 AISPosition::AISPosition() {
     longitudeTenThousandthsMinute = LONGITUDE_UNKNOWN;
@@ -17,6 +17,10 @@
  */
 
 #include "DataModel.h"
+#include "DataModelTopicArena.h"
+#include "DataModelSubscriptionIndex.h"
+#include "DataModelLeaf.h"
+#include "DataModelWritableLeaf.h"
 
 #include "TaskObject.h"
 
@@ -27,12 +31,29 @@
 
 #include "Error.h"
 
+#include "etl/vector.h"
+#include "etl/algorithm.h"
+
+#include "esp_timer.h"
+
 #include <freertos/semphr.h>
 
+#include <string.h>
+
+static const char commandTopicPrefix[] = "command/";
+
+static bool writableLeafTopicBefore(DataModelWritableLeaf *leaf, const char *topic) {
+    return strcmp(leaf->topicName(), topic) < 0;
+}
+
 DataModel::DataModel(StatsManager &statsManager)
     : TaskObject("DataModel", LOGGER_LEVEL_DEBUG, stackSize),
       _rootNode(this),
-      subscriptionCount(0), retainedValues(0),
+      subscriptionLock(nullptr),
+      lockAcquisitions(0), lockContentions(0), lockWaitUs(0), lockMaxWaitUs(0),
+      leafCount(0), subscriptionCount(0), retainedValues(0),
+      commandLock(nullptr), commands(0), commandsRejected(0), relayed(0),
+      _commandNode("command", &_rootNode),
       _sysNode("$SYS", &_rootNode),
       _brokerNode("broker", &_sysNode),
       subscriptionsNode("subscriptions", &_brokerNode),
@@ -42,12 +63,39 @@ DataModel::DataModel(StatsManager &statsManager)
       retainedCountLeaf("count", &retainedNode),
       dataModelNode("dataModel", &_sysNode),
       updatesLeaf("updates", &dataModelNode),
-      updateRateLeaf("updateRate", &dataModelNode) {
+      updateRateLeaf("updateRate", &dataModelNode),
+      commandsLeaf("commands", &dataModelNode),
+      commandsRejectedLeaf("commandsRejected", &dataModelNode),
+      relayedLeaf("relayed", &dataModelNode),
+      leavesLeaf("leaves", &dataModelNode),
+      topicArenaNode("topicArena", &dataModelNode),
+      topicArenaSizeLeaf("size", &topicArenaNode),
+      topicArenaUsedLeaf("used", &topicArenaNode),
+      topicArenaTopicsLeaf("topics", &topicArenaNode),
+      topicArenaFailuresLeaf("failures", &topicArenaNode),
+      filterIndexNode("filterIndex", &dataModelNode),
+      filterIndexFiltersLeaf("filters", &filterIndexNode),
+      filterIndexNodesLeaf("nodes", &filterIndexNode),
+      subscriptionPoolNode("subscriptionPool", &dataModelNode),
+      subscriptionPoolSizeLeaf("size", &subscriptionPoolNode),
+      subscriptionPoolUsedLeaf("used", &subscriptionPoolNode),
+      subscriptionPoolBytesLeaf("bytes", &subscriptionPoolNode),
+      subscriptionPoolExhaustionsLeaf("exhaustions", &subscriptionPoolNode),
+      subscriptionLockNode("subscriptionLock", &dataModelNode),
+      lockAcquisitionsLeaf("acquisitions", &subscriptionLockNode),
+      lockContentionsLeaf("contentions", &subscriptionLockNode),
+      lockWaitUsLeaf("waitUs", &subscriptionLockNode),
+      lockMaxWaitUsLeaf("maxWaitUs", &subscriptionLockNode) {
     if ((subscriptionLock = xSemaphoreCreateMutex()) == nullptr) {
         logger << logErrorDataModel << "Failed to create subscriptionLock mutex" << eol;
         errorExit();
     }
 
+    if ((commandLock = xSemaphoreCreateMutex()) == nullptr) {
+        logger << logErrorDataModel << "Failed to create commandLock mutex" << eol;
+        errorExit();
+    }
+
     statsManager.addStatsHolder(*this);
 }
 
@@ -65,8 +113,24 @@ DataModelRoot &DataModel::rootNode() {
 
 bool DataModel::subscribe(const char *topicFilter, DataModelSubscriber &subscriber,
                           uint32_t cookie) {
+    // A filter that doesn't match anything in the data model yet is still accepted, as it can
+    // match elements added later and topics published by clients, both found through the index.
     takeSubscriptionLock();
-    bool result = _rootNode.subscribe(topicFilter, subscriber, cookie);
+    bool result = false;
+    if (!_rootNode.checkTopicFilterValidity(topicFilter)) {
+        taskLogger() << logWarnDataModel << "Illegal Topic Filter '" << topicFilter << "'" << eol;
+    } else {
+        const uint32_t poolExhaustionsBefore = DataModelLeaf::subscriptionPoolExhaustions();
+        const bool subscribed = subscribeElements(topicFilter, subscriber, cookie);
+        reportSubscriptionPoolExhaustion(poolExhaustionsBefore, topicFilter, subscriber);
+        const bool indexed = subscriptionIndex.add(topicFilter, subscriber, cookie);
+        if (!indexed) {
+            taskLogger() << logWarnDataModel << "Subscription index full, topic filter '"
+                         << topicFilter << "' from client '" << subscriber.name()
+                         << "' will not match elements added later or client topics" << eol;
+        }
+        result = subscribed || indexed;
+    }
     releaseSubscriptionLock();
 
     return result;
@@ -74,29 +138,171 @@ bool DataModel::subscribe(const char *topicFilter, DataModelSubscriber &subscrib
 
 void DataModel::unsubscribe(const char *topicFilter, DataModelSubscriber &subscriber) {
     takeSubscriptionLock();
-    _rootNode.unsubscribe(topicFilter, subscriber);
+    if (!_rootNode.checkTopicFilterValidity(topicFilter)) {
+        taskLogger() << logWarnDataModel << "Illegal Topic Filter '" << topicFilter
+                     << "' in unsubscribe from Client '" << subscriber.name() << "'" << eol;
+    } else {
+        unsubscribeElements(topicFilter, subscriber);
+        subscriptionIndex.remove(topicFilter, subscriber);
+    }
     releaseSubscriptionLock();
 }
 
+// A disconnecting client's subscriptions are swept from the whole tree rather than resolved from
+// its indexed filters, as a filter that didn't fit in the index still subscribed to the leaves
+// that existed when it was made.
 void DataModel::unsubscribeAll(DataModelSubscriber &subscriber) {
     taskLogger() << logDebugDataModel << "Unsubscribing client '"<< subscriber.name()
                  << "' from all topics." << eol;
     takeSubscriptionLock();
     _rootNode.unsubscribeAll(subscriber);
+    subscriptionIndex.removeAll(subscriber);
     releaseSubscriptionLock();
 }
 
-void DataModel::takeSubscriptionLock() {
-    if (xSemaphoreTake(subscriptionLock, pdMS_TO_TICKS(lockTimeoutMs)) != pdTRUE) {
-        taskLogger() << logErrorDataModel << "Failed to get subscription lock mutex" << eol;
+// Subscribes to the existing leaves matching a filter. The filter's leading literal levels are
+// resolved through the subscription index, leaving the tree to enumerate the children beneath
+// any wildcard levels. A filter starting with a wildcard has nothing to resolve and goes to the
+// root's children.
+bool DataModel::subscribeElements(const char *topicFilter, DataModelSubscriber &subscriber,
+                                  uint32_t cookie) {
+    const char *elementFilter;
+    DataModelElement *element = subscriptionIndex.resolveFilter(_rootNode, topicFilter,
+                                                                elementFilter);
+    if (element != nullptr) {
+        return element->subscribeIfMatching(elementFilter, subscriber, cookie);
+    } else if (startsWithWildcard(topicFilter)) {
+        return _rootNode.subscribe(topicFilter, subscriber, cookie);
+    } else {
+        return false;
+    }
+}
+
+void DataModel::unsubscribeElements(const char *topicFilter, DataModelSubscriber &subscriber) {
+    const char *elementFilter;
+    DataModelElement *element = subscriptionIndex.resolveFilter(_rootNode, topicFilter,
+                                                                elementFilter);
+    if (element != nullptr) {
+        element->unsubscribeIfMatching(elementFilter, subscriber);
+    } else if (startsWithWildcard(topicFilter)) {
+        _rootNode.unsubscribe(topicFilter, subscriber);
+    }
+}
+
+bool DataModel::startsWithWildcard(const char *topicFilter) {
+    return topicFilter[0] == dataModelSingleLevelWildcard ||
+           topicFilter[0] == dataModelMultiLevelWildcard;
+}
+
+// Passes a value that a client published to a topic outside of the data model on to the
+// subscribers with matching topic filters. They're found through the subscription index, the same
+// as for newly added leaves, and are handed the value directly, as with a leaf update. As with a
+// leaf, the value goes to at most maxDataModelSubscribers of them.
+void DataModel::publishTopic(const char *topic, const char *value) {
+    etl::vector<DataModelSubscriptionIndex::Match, maxDataModelSubscribers> matches;
+
+    takeSubscriptionLock();
+    subscriptionIndex.matchingSubscriptions(topic, matches);
+    relayed++;
+    releaseSubscriptionLock();
+
+    for (DataModelSubscriptionIndex::Match &match : matches) {
+        match.subscriber->publishTopic(topic, value, match.cookie);
+    }
+}
+
+bool DataModel::isCommandTopic(const char *topic) const {
+    return strncmp(topic, commandTopicPrefix, sizeof(commandTopicPrefix) - 1) == 0;
+}
+
+// Returns false if there's no writable leaf for the topic or its owner rejected the value.
+bool DataModel::writeCommand(const char *topic, const char *value) {
+    takeCommandLock();
+    commands++;
+    bool written = false;
+    DataModelWritableLeaf **leaf = findWritableLeaf(topic);
+    if (leaf == nullptr) {
+        taskLogger() << logWarnDataModel << "No writable element for command topic '" << topic
+                     << "'" << eol;
+    } else {
+        written = (*leaf)->write(value);
+    }
+    if (!written) {
+        commandsRejected++;
+    }
+    releaseCommandLock();
+
+    return written;
+}
+
+// Called with the command lock held.
+DataModelWritableLeaf **DataModel::findWritableLeaf(const char *topic) {
+    DataModelWritableLeaf **leaf = etl::lower_bound(writableLeaves.begin(),
+                                                    writableLeaves.end(), topic,
+                                                    writableLeafTopicBefore);
+    if (leaf == writableLeaves.end() || strcmp((*leaf)->topicName(), topic) != 0) {
+        return nullptr;
+    }
+
+    return leaf;
+}
+
+void DataModel::takeCommandLock() {
+    if (xSemaphoreTake(commandLock, pdMS_TO_TICKS(lockTimeoutMs)) != pdTRUE) {
+        taskLogger() << logErrorDataModel << "Failed to get command lock mutex" << eol;
         errorExit();
     }
 }
 
+void DataModel::releaseCommandLock() {
+    xSemaphoreGive(commandLock);
+}
+
+// The uncontended case is tried first so that we only pay for timing waits that actually happen.
+// The statistics are updated with the lock held.
+void DataModel::takeSubscriptionLock() {
+    if (xSemaphoreTake(subscriptionLock, 0) != pdTRUE) {
+        const int64_t waitStart = esp_timer_get_time();
+        if (xSemaphoreTake(subscriptionLock, pdMS_TO_TICKS(lockTimeoutMs)) != pdTRUE) {
+            taskLogger() << logErrorDataModel << "Failed to get subscription lock mutex" << eol;
+            errorExit();
+        }
+        const uint32_t waitUs = (uint32_t)(esp_timer_get_time() - waitStart);
+
+        lockContentions++;
+        lockWaitUs += waitUs;
+        if (waitUs > lockMaxWaitUs) {
+            lockMaxWaitUs = waitUs;
+        }
+    }
+
+    lockAcquisitions++;
+}
+
 void DataModel::releaseSubscriptionLock() {
     xSemaphoreGive(subscriptionLock);
 }
 
+// Called with the subscription lock held, after subscribing to the leaves matching a topic filter,
+// or a new leaf to an existing one. A subscription that ran out of pooled records is left in
+// place for the leaves it did reach.
+void DataModel::reportSubscriptionPoolExhaustion(uint32_t poolExhaustionsBefore,
+                                                 const char *topicFilter,
+                                                 DataModelSubscriber &subscriber) {
+    const uint32_t leavesMissed =
+        DataModelLeaf::subscriptionPoolExhaustions() - poolExhaustionsBefore;
+    if (leavesMissed != 0) {
+        taskLogger() << logWarnDataModel << "Subscription pool of "
+                     << DataModelLeaf::subscriptionPoolSize() << " exhausted, client '"
+                     << subscriber.name() << "' missed " << leavesMissed
+                     << " leaf subscriptions for '" << topicFilter << "'" << eol;
+    }
+}
+
+DataModelNode &DataModel::commandNode() {
+    return _commandNode;
+}
+
 DataModelNode &DataModel::sysNode() {
     return _sysNode;
 }
@@ -116,6 +322,61 @@ void DataModel::dump() {
     _rootNode.dump();
 }
 
+// Gives a newly created leaf the subscriptions it would have gotten had it existed when they were
+// made. Leaves created as part of constructing the data model itself are only indexed, as there
+// can't be any subscriptions yet, nor a lock to protect them.
+void DataModel::leafAdded(DataModelLeaf &leaf) {
+    if (subscriptionLock == nullptr) {
+        leafCount++;
+        subscriptionIndex.addElement(leaf);
+        return;
+    }
+
+    takeSubscriptionLock();
+    leafCount++;
+    subscriptionIndex.addElement(leaf);
+    if (!subscriptionIndex.isEmpty()) {
+        char topicBuffer[maxTopicNameLength + 1];
+        const char *topic = leaf.topicName();
+        if (topic == nullptr) {
+            leaf.buildTopicName(topicBuffer);
+            topic = topicBuffer;
+        }
+
+        etl::vector<DataModelSubscriptionIndex::Match, maxDataModelSubscribers> matches;
+        subscriptionIndex.matchingSubscriptions(topic, matches);
+        for (DataModelSubscriptionIndex::Match &match : matches) {
+            const uint32_t poolExhaustionsBefore = DataModelLeaf::subscriptionPoolExhaustions();
+            leaf.subscribeAll(*match.subscriber, match.cookie);
+            reportSubscriptionPoolExhaustion(poolExhaustionsBefore, topic, *match.subscriber);
+        }
+    }
+    releaseSubscriptionLock();
+}
+
+// Registered leaves are looked up by their interned topic name, so one that can't be interned
+// can't be written.
+void DataModel::writableLeafAdded(DataModelWritableLeaf &leaf) {
+    const char *topic = leaf.topicName();
+    if (topic == nullptr) {
+        taskLogger() << logWarnDataModel << "Topic arena exhausted, writable element '"
+                     << leaf.elementName() << "' not registered" << eol;
+        return;
+    }
+
+    takeCommandLock();
+    if (writableLeaves.full()) {
+        taskLogger() << logWarnDataModel << "Too many writable elements, '" << topic
+                     << "' not registered" << eol;
+    } else {
+        DataModelWritableLeaf **position = etl::lower_bound(writableLeaves.begin(),
+                                                            writableLeaves.end(), topic,
+                                                            writableLeafTopicBefore);
+        writableLeaves.insert(position, &leaf);
+    }
+    releaseCommandLock();
+}
+
 void DataModel::leafUpdated() {
     updates++;
 }
@@ -141,4 +402,22 @@ void DataModel::exportStats(uint32_t msElapsed) {
     subscriptionsCountLeaf = subscriptionCount;
     retainedCountLeaf = retainedValues;
     updates.update(updatesLeaf, updateRateLeaf, msElapsed);
+    commandsLeaf = commands;
+    commandsRejectedLeaf = commandsRejected;
+    relayedLeaf = relayed;
+    leavesLeaf = leafCount;
+    topicArenaSizeLeaf = dataModelTopicArena.size();
+    topicArenaUsedLeaf = dataModelTopicArena.bytesUsed();
+    topicArenaTopicsLeaf = dataModelTopicArena.topicCount();
+    topicArenaFailuresLeaf = dataModelTopicArena.internFailures();
+    filterIndexFiltersLeaf = subscriptionIndex.filterCount();
+    filterIndexNodesLeaf = subscriptionIndex.nodeCount();
+    subscriptionPoolSizeLeaf = DataModelLeaf::subscriptionPoolSize();
+    subscriptionPoolUsedLeaf = DataModelLeaf::subscriptionPoolUsed();
+    subscriptionPoolBytesLeaf = DataModelLeaf::subscriptionPoolBytes();
+    subscriptionPoolExhaustionsLeaf = DataModelLeaf::subscriptionPoolExhaustions();
+    lockAcquisitionsLeaf = lockAcquisitions;
+    lockContentionsLeaf = lockContentions;
+    lockWaitUsLeaf = lockWaitUs;
+    lockMaxWaitUsLeaf = lockMaxWaitUs;
 }
@@ -23,7 +23,6 @@
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/to_string.h"
 
 #include <stdint.h>
 
@@ -36,11 +35,7 @@ DataModelBoolLeaf & DataModelBoolLeaf::operator = (const bool value) {
     if (!hasValue() || this->value != value) {
         this->value = value;
         updated();
-        if (value) {
-            *this << (uint32_t)1;
-        } else {
-            *this << (uint32_t)0;
-        }
+        publishValue();
     }
 
     return *this;
@@ -50,16 +45,11 @@ DataModelBoolLeaf::operator bool() const {
     return value;
 }
 
-
-void DataModelBoolLeaf::sendRetainedValue(DataModelSubscriber &subscriber) {
-    if (hasValue()) {
-        etl::string<2> valueStr;
-        if (value) {
-            valueStr = "1";
-        } else {
-            valueStr = "0";
-        }
-        publishToSubscriber(subscriber, valueStr, true);
+void DataModelBoolLeaf::formatValue(etl::istring &valueStr) {
+    if (value) {
+        valueStr = "1";
+    } else {
+        valueStr = "0";
     }
 }
 
@@ -19,18 +19,35 @@
 #include "DataModelElement.h"
 #include "DataModelNode.h"
 #include "DataModel.h"
+#include "DataModelTopicArena.h"
 
 #include "Logger.h"
 
+#include <atomic>
+
 #include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+static constexpr uint32_t topicLocationValid = 0x80000000;
+static constexpr uint32_t topicLocationOffsetShift = 8;
+static constexpr uint32_t topicLocationLengthMask = 0x000000ff;
 
 DataModelElement::DataModelElement(const char *name, DataModelNode *parent)
-    : name(name), parent(parent) {
+    : name(name), topicLocation(0), nextIndexed(nullptr), parent(parent) {
     if (parent != nullptr) {
         parent->addChild(*this);
     }
 }
 
+// std::atomic isn't copyable, so the copy needed by leaves' postfix operators is spelled out. The
+// copy is never indexed, so it doesn't share the original's place in the subscription index.
+DataModelElement::DataModelElement(const DataModelElement &other)
+    : siblingLink(other), name(other.name),
+      topicLocation(other.topicLocation.load(std::memory_order_relaxed)), nextIndexed(nullptr),
+      parent(other.parent) {
+}
+
 bool DataModelElement::isMultiLevelWildcard(const char *topicFilter) {
     return (topicFilter[0] == dataModelMultiLevelWildcard) && (topicFilter[1] == 0);
 }
@@ -76,8 +93,8 @@ bool DataModelElement::topicFilterMatch(const char *topicFilter, unsigned &offse
     }
 }
 
+// Slow path, building the topic name from scratch. Used when the topic arena is exhausted.
 void DataModelElement::buildTopicName(char *topicNameBuffer) {
-    // TODO: Make this more efficent!
     if (parent) {
         parent->buildTopicName(topicNameBuffer);
         if (topicNameBuffer[0] != 0) {
@@ -93,12 +110,69 @@ void DataModelElement::buildTopicName(char *topicNameBuffer) {
     }
 }
 
+const char *DataModelElement::topicName() {
+    size_t length;
+    return topicName(length);
+}
+
+const char *DataModelElement::topicName(size_t &length) {
+    uint32_t location = topicLocation.load(std::memory_order_acquire);
+    if (location == 0) {
+        location = internTopicName();
+        if (location == 0) {
+            return nullptr;
+        }
+    }
+
+    length = location & topicLocationLengthMask;
+    const uint16_t offset = (location & ~topicLocationValid) >> topicLocationOffsetShift;
+    return dataModelTopicArena.topicAt(offset);
+}
+
+// The parent's topic is interned first so that each element's topic is its parent's plus a single
+// level. Two tasks racing to intern the same element will both append to the arena, but only the
+// first to record its location wins, so every caller sees the same string. The few wasted bytes
+// aren't worth a lock on the lookup path.
+uint32_t DataModelElement::internTopicName() {
+    const char *prefix = "";
+    size_t prefixLength = 0;
+    if (parent) {
+        prefix = parent->topicName(prefixLength);
+        if (prefix == nullptr) {
+            return 0;
+        }
+    }
+
+    const char *levelName = name ? name : "";
+    const size_t levelNameLength = strlen(levelName);
+    uint16_t offset;
+    if (!dataModelTopicArena.intern(prefix, prefixLength, levelName, levelNameLength, offset)) {
+        return 0;
+    }
+
+    const size_t length = prefixLength + (prefixLength ? 1 : 0) + levelNameLength;
+    uint32_t location = topicLocationValid | ((uint32_t)offset << topicLocationOffsetShift) |
+                        length;
+    uint32_t expected = 0;
+    if (!topicLocation.compare_exchange_strong(expected, location, std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+        return expected;
+    }
+
+    return location;
+}
+
 const char *DataModelElement::elementName() const {
     return name;
 }
 
 void DataModelElement::dump() {
-    char topic[maxTopicNameLength];
-    buildTopicName(topic);
-    taskLogger() << logDebugDataModel << topic << eol;
+    const char *topic = topicName();
+    if (topic) {
+        taskLogger() << logDebugDataModel << topic << eol;
+    } else {
+        char topicBuffer[maxTopicNameLength + 1];
+        buildTopicName(topicBuffer);
+        taskLogger() << logDebugDataModel << topicBuffer << eol;
+    }
 }
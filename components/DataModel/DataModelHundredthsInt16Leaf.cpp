@@ -25,12 +25,9 @@
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/string_stream.h"
 
 #include <stdint.h>
 
-constexpr size_t maxStringLength = 9;
-
 DataModelHundredthsInt16Leaf::DataModelHundredthsInt16Leaf(const char *name, DataModelNode *parent)
     : DataModelRetainedValueLeaf(name, parent) {
 }
@@ -42,20 +39,14 @@ DataModelHundredthsInt16Leaf & DataModelHundredthsInt16Leaf::operator =
 
         updated();
 
-        etl::string<maxStringLength> valueStr;
-        value.toString(valueStr);
-        *this << valueStr;
+        publishValue();
     }
 
     return *this;
 }
 
-void DataModelHundredthsInt16Leaf::sendRetainedValue(DataModelSubscriber &subscriber) {
-    if (hasValue()) {
-        etl::string<maxStringLength> valueStr;
-        value.toString(valueStr);
-        publishToSubscriber(subscriber, valueStr, true);
-    }
+void DataModelHundredthsInt16Leaf::formatValue(etl::istring &valueStr) {
+    value.toString(valueStr);
 }
 
 void DataModelHundredthsInt16Leaf::logValue(Logger &logger) {
@@ -25,13 +25,9 @@
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/string_stream.h"
-#include "etl/to_string.h"
 
 #include <stdint.h>
 
-constexpr size_t maxStringLength = 8;
-
 DataModelHundredthsUInt16Leaf::DataModelHundredthsUInt16Leaf(const char *name,
                                                              DataModelNode *parent)
     : DataModelRetainedValueLeaf(name, parent) {
@@ -44,9 +40,7 @@ DataModelHundredthsUInt16Leaf & DataModelHundredthsUInt16Leaf::operator =
 
         updated();
 
-        etl::string<maxStringLength> valueStr;
-        value.toString(valueStr);
-        *this << valueStr;
+        publishValue();
     }
 
     return *this;
@@ -58,20 +52,14 @@ DataModelHundredthsUInt16Leaf & DataModelHundredthsUInt16Leaf::operator = (uint1
 
         updated();
 
-        etl::string<maxStringLength> valueStr;
-        etl::to_string(value, valueStr);
-        *this << valueStr;
+        publishValue();
     }
 
     return *this;
 }
 
-void DataModelHundredthsUInt16Leaf::sendRetainedValue(DataModelSubscriber &subscriber) {
-    if (hasValue()) {
-        etl::string<maxStringLength> valueStr;
-        value.toString(valueStr);
-        publishToSubscriber(subscriber, valueStr, true);
-    }
+void DataModelHundredthsUInt16Leaf::formatValue(etl::istring &valueStr) {
+    value.toString(valueStr);
 }
 
 void DataModelHundredthsUInt16Leaf::logValue(Logger &logger) {
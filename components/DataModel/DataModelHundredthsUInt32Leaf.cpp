@@ -25,12 +25,9 @@
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/string_stream.h"
 
 #include <stdint.h>
 
-constexpr size_t maxStringLength = 14;
-
 DataModelHundredthsUInt32Leaf::DataModelHundredthsUInt32Leaf(const char *name,
                                                              DataModelNode *parent)
     : DataModelRetainedValueLeaf(name, parent) {
@@ -43,20 +40,14 @@ DataModelHundredthsUInt32Leaf & DataModelHundredthsUInt32Leaf::operator =
 
         updated();
 
-        etl::string<maxStringLength> valueStr;
-        value.toString(valueStr);
-        *this << valueStr;
+        publishValue();
     }
 
     return *this;
 }
 
-void DataModelHundredthsUInt32Leaf::sendRetainedValue(DataModelSubscriber &subscriber) {
-    if (hasValue()) {
-        etl::string<maxStringLength> valueStr;
-        value.toString(valueStr);
-        publishToSubscriber(subscriber, valueStr, true);
-    }
+void DataModelHundredthsUInt32Leaf::formatValue(etl::istring &valueStr) {
+    value.toString(valueStr);
 }
 
 void DataModelHundredthsUInt32Leaf::logValue(Logger &logger) {
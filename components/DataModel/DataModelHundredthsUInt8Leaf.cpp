@@ -25,13 +25,9 @@
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/string_stream.h"
-#include "etl/to_string.h"
 
 #include <stdint.h>
 
-constexpr size_t maxStringLength = 6;
-
 DataModelHundredthsUInt8Leaf::DataModelHundredthsUInt8Leaf(const char *name, DataModelNode *parent)
     : DataModelRetainedValueLeaf(name, parent) {
 }
@@ -43,9 +39,7 @@ DataModelHundredthsUInt8Leaf & DataModelHundredthsUInt8Leaf::operator =
 
         updated();
 
-        etl::string<maxStringLength> valueStr;
-        value.toString(valueStr);
-        *this << valueStr;
+        publishValue();
     }
 
     return *this;
@@ -57,20 +51,14 @@ DataModelHundredthsUInt8Leaf & DataModelHundredthsUInt8Leaf::operator = (uint8_t
 
         updated();
 
-        etl::string<maxStringLength> valueStr;
-        etl::to_string(value, valueStr);
-        *this << valueStr;
+        publishValue();
     }
 
     return *this;
 }
 
-void DataModelHundredthsUInt8Leaf::sendRetainedValue(DataModelSubscriber &subscriber) {
-    if (hasValue()) {
-        etl::string<maxStringLength> valueStr;
-        value.toString(valueStr);
-        publishToSubscriber(subscriber, valueStr, true);
-    }
+void DataModelHundredthsUInt8Leaf::formatValue(etl::istring &valueStr) {
+    value.toString(valueStr);
 }
 
 void DataModelHundredthsUInt8Leaf::logValue(Logger &logger) {
@@ -20,15 +20,13 @@
 #include "DataModelLeaf.h"
 #include "DataModelNode.h"
 
+#include "NumberFormat.h"
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/to_string.h"
 
 #include <stdint.h>
 
-constexpr size_t maxStringLength = 4;
-
 DataModelInt8Leaf::DataModelInt8Leaf(const char *name, DataModelNode *parent)
     : DataModelRetainedValueLeaf(name, parent),
       value(0) {
@@ -38,9 +36,7 @@ DataModelInt8Leaf & DataModelInt8Leaf::operator = (const int8_t value) {
     if (!hasValue() || this->value != value) {
         this->value = value;
         updated();
-        etl::string<maxStringLength> valueStr;
-        etl::to_string(value, valueStr);
-        *this << valueStr;
+        publishValue();
     }
 
     return *this;
@@ -49,18 +45,14 @@ DataModelInt8Leaf & DataModelInt8Leaf::operator = (const int8_t value) {
 DataModelInt8Leaf DataModelInt8Leaf::operator ++ (int) {
     value++;
     updated();
-    etl::string<maxStringLength> valueStr;
-    etl::to_string(value, valueStr);
-    *this << valueStr;
+    publishValue();
     return *this;
 }
 
 DataModelInt8Leaf DataModelInt8Leaf::operator -- (int) {
     value--;
     updated();
-    etl::string<maxStringLength> valueStr;
-    etl::to_string(value, valueStr);
-    *this << valueStr;
+    publishValue();
     return *this;
 }
 
@@ -68,12 +60,10 @@ DataModelInt8Leaf::operator int8_t() const {
     return value;
 }
 
-void DataModelInt8Leaf::sendRetainedValue(DataModelSubscriber &subscriber) {
-    if (hasValue()) {
-        etl::string<maxStringLength> valueStr;
-        etl::to_string(value, valueStr);
-        publishToSubscriber(subscriber, valueStr, true);
-    }
+void DataModelInt8Leaf::formatValue(etl::istring &valueStr) {
+    char buffer[maxInt32FormatLength];
+    const size_t length = formatInt32(buffer, value);
+    valueStr.assign(buffer, length);
 }
 
 void DataModelInt8Leaf::logValue(Logger &logger) {
@@ -21,55 +21,98 @@
 #include "DataModel.h"
 #include "DataModelSubscriber.h"
 
+#include "NumberFormat.h"
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/to_string.h"
+#include "etl/pool.h"
+#include "etl/vector.h"
+
+#include <new>
+
+#include <freertos/FreeRTOS.h>
 
 #include <stdint.h>
 #include <stddef.h>
 
+etl::pool<DataModelLeaf::Subscription, DataModelLeaf::maxSubscriptions>
+    DataModelLeaf::subscriptionPool;
+uint32_t DataModelLeaf::subscriptionPoolFailures = 0;
+
 DataModelLeaf::DataModelLeaf(const char *name, DataModelNode *parent)
-    : DataModelElement(name, parent) {
+    : DataModelElement(name, parent), subscriptions(nullptr) {
+    portMUX_INITIALIZE(&subscriptionsLock);
+    parent->leafAdded(*this);
 }
 
-bool DataModelLeaf::isSubscribed(DataModelSubscriber &subscriber) {
-    for (DataModelLeaf::Subscription &subscription : subscriptions) {
-        if (subscription.subscriber == &subscriber) {
-            return true;
+DataModelLeaf::Subscription *DataModelLeaf::findSubscription(DataModelSubscriber &subscriber) {
+    for (Subscription *subscription = subscriptions; subscription != nullptr;
+         subscription = subscription->next) {
+        if (subscription->subscriber == &subscriber) {
+            return subscription;
         }
     }
 
-    return false;
+    return nullptr;
+}
+
+bool DataModelLeaf::isSubscribed(DataModelSubscriber &subscriber) {
+    return findSubscription(subscriber) != nullptr;
 }
 
 bool DataModelLeaf::addSubscriber(DataModelSubscriber &subscriber, uint32_t cookie) {
-    if (!subscriptions.full()) {
-        subscriptions.push_back(Subscription(subscriber, cookie));
-        parent->leafSubscribedTo();
-        return true;
-    } else {
-        // This shouldn't happen if max sessions == max subscribers
+    size_t subscriberCount = 0;
+    for (Subscription *subscription = subscriptions; subscription != nullptr;
+         subscription = subscription->next) {
+        subscriberCount++;
+    }
+    if (subscriberCount >= maxDataModelSubscribers) {
+        logger() << logWarnDataModel << "Topic ending in '" << elementName() << "' already has "
+                 << maxDataModelSubscribers << " subscribers, client '" << subscriber.name()
+                 << "' not subscribed" << eol;
+        return false;
+    }
+
+    // Not logged here, as a wildcard subscription can run into this on every leaf it has yet to
+    // reach. The data model reports it once for the subscription.
+    if (subscriptionPool.full()) {
+        subscriptionPoolFailures++;
         return false;
     }
+
+    Subscription *subscription = new (subscriptionPool.allocate()) Subscription(subscriber, cookie);
+    taskENTER_CRITICAL(&subscriptionsLock);
+    subscription->next = subscriptions;
+    subscriptions = subscription;
+    taskEXIT_CRITICAL(&subscriptionsLock);
+    parent->leafSubscribedTo();
+
+    return true;
 }
 
 bool DataModelLeaf::updateSubscriber(DataModelSubscriber &subscriber, uint32_t cookie) {
-    for (DataModelLeaf::Subscription &subscription : subscriptions) {
-        if (subscription.subscriber == &subscriber) {
-            subscription.cookie = cookie;
-            return true;
-        }
+    Subscription *subscription = findSubscription(subscriber);
+    if (subscription != nullptr) {
+        taskENTER_CRITICAL(&subscriptionsLock);
+        subscription->cookie = cookie;
+        taskEXIT_CRITICAL(&subscriptionsLock);
+        return true;
     }
 
     // This shouldn't happen if the call was used as expected. Error?
     return false;
 }
 
+// Publishers only ever look at the list with subscriptionsLock held, copying out what they need, so
+// once unlinked a subscription can go straight back to the pool.
 void DataModelLeaf::unsubscribe(DataModelSubscriber &subscriber) {
-    for (auto subscriptionItr = subscriptions.begin(); subscriptionItr != subscriptions.end();) {
-        if (subscriptionItr->subscriber == &subscriber) {
-            subscriptions.erase(subscriptionItr);
+    for (Subscription **link = &subscriptions; *link != nullptr; link = &(*link)->next) {
+        Subscription *subscription = *link;
+        if (subscription->subscriber == &subscriber) {
+            taskENTER_CRITICAL(&subscriptionsLock);
+            *link = subscription->next;
+            taskEXIT_CRITICAL(&subscriptionsLock);
+            subscriptionPool.release(subscription);
 
             parent->leafUnsubscribedFrom();
 
@@ -79,8 +122,6 @@ void DataModelLeaf::unsubscribe(DataModelSubscriber &subscriber) {
             logger() << logDebugDataModel << "Client '" << subscriber.name()
                      << "' unsubcribed from topic ending in '" << elementName() << "'" << eol;
             return;
-        } else {
-            subscriptionItr++;
         }
     }
 
@@ -123,18 +164,27 @@ bool DataModelLeaf::subscribeAll(DataModelSubscriber &subscriber, uint32_t cooki
     return subscribe(subscriber, cookie);
 }
 
-DataModelLeaf & DataModelLeaf::operator << (const etl::istring &value) {
-    // For now we take the subscription lock when publishing, but later this should go away when
-    // updates become threaded.
-    parent->takeSubscriptionLock();
-
-    for (DataModelLeaf::Subscription subscription: subscriptions) {
-        // This could be made more efficent by building a topic name outside of this loop instead of
-        // down in the publish routine...
-        publishToSubscriber(*subscription.subscriber, value, false);
+// Publishing is done from a snapshot of the subscribers so that the leaf's lock is only held
+// for the copy, and updates never wait on a subscriber. A subscriber that unsubscribes while a
+// snapshot is being published may receive one last value. addSubscriber() holds a leaf to
+// maxDataModelSubscribers, so the snapshot can't be outgrown.
+void DataModelLeaf::snapshotSubscribers(SubscriberSnapshot &snapshot) {
+    taskENTER_CRITICAL(&subscriptionsLock);
+    for (Subscription *subscription = subscriptions;
+         subscription != nullptr && !snapshot.full();
+         subscription = subscription->next) {
+        snapshot.push_back(SnapshotEntry(subscription->subscriber, subscription->cookie));
     }
+    taskEXIT_CRITICAL(&subscriptionsLock);
+}
 
-    parent->releaseSubscriptionLock();
+DataModelLeaf & DataModelLeaf::operator << (const etl::istring &value) {
+    SubscriberSnapshot snapshot;
+    snapshotSubscribers(snapshot);
+
+    for (SnapshotEntry &entry : snapshot) {
+        publishToSubscriber(*entry.subscriber, value, false, entry.cookie);
+    }
 
     parent->leafUpdated();
 
@@ -142,18 +192,17 @@ DataModelLeaf & DataModelLeaf::operator << (const etl::istring &value) {
 }
 
 DataModelLeaf & DataModelLeaf::operator << (uint32_t value) {
-    etl::string<12> valueStr;
-    etl::to_string(value, valueStr);
+    char buffer[maxUInt32FormatLength];
+    const size_t length = formatUInt32(buffer, value);
+    etl::string<maxUInt32FormatLength> valueStr(buffer, length);
     *this << valueStr;
 
     return *this;
 }
 
 void DataModelLeaf::publishToSubscriber(DataModelSubscriber &subscriber, const etl::istring &value,
-                                        bool retainedValue) {
-    char topic[maxTopicNameLength];
-    buildTopicName(topic);
-    subscriber.publish(topic, value.c_str(), retainedValue);
+                                        bool retainedValue, uint32_t cookie) {
+    subscriber.publish(*this, value.c_str(), retainedValue, cookie);
 }
 
 void DataModelLeaf::unsubscribeIfMatching(const char *topicFilter,
@@ -176,6 +225,26 @@ void DataModelLeaf::unsubscribeAll(DataModelSubscriber &subscriber) {
     unsubscribe(subscriber);
 }
 
+size_t DataModelLeaf::subscriptionPoolSize() {
+    return maxSubscriptions;
+}
+
+size_t DataModelLeaf::subscriptionPoolUsed() {
+    return subscriptionPool.size();
+}
+
+size_t DataModelLeaf::subscriptionPoolBytes() {
+    return sizeof(subscriptionPool);
+}
+
+uint32_t DataModelLeaf::subscriptionPoolExhaustions() {
+    return subscriptionPoolFailures;
+}
+
 DataModelLeaf::Subscription::Subscription(DataModelSubscriber &subscriber, uint32_t cookie)
-    : subscriber(&subscriber), cookie(cookie) {
+    : next(nullptr), subscriber(&subscriber), cookie(cookie) {
+}
+
+DataModelLeaf::SnapshotEntry::SnapshotEntry(DataModelSubscriber *subscriber, uint32_t cookie)
+    : subscriber(subscriber), cookie(cookie) {
 }
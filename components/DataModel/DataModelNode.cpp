@@ -116,6 +116,14 @@ void DataModelNode::unsubscribeAll(DataModelSubscriber &subscriber) {
     }
 }
 
+void DataModelNode::leafAdded(DataModelLeaf &leaf) {
+    parent->leafAdded(leaf);
+}
+
+void DataModelNode::writableLeafAdded(DataModelWritableLeaf &leaf) {
+    parent->writableLeafAdded(leaf);
+}
+
 void DataModelNode::leafUpdated() {
     parent->leafUpdated();
 }
@@ -136,14 +144,6 @@ void DataModelNode::retainedValueCleared() {
     parent->retainedValueCleared();
 }
 
-void DataModelNode::takeSubscriptionLock() {
-    parent->takeSubscriptionLock();
-}
-
-void DataModelNode::releaseSubscriptionLock() {
-    parent->releaseSubscriptionLock();
-}
-
 void DataModelNode::dump() {
     DataModelElement::dump();
     for (DataModelElement &child : children) {
@@ -36,7 +36,7 @@ bool DataModelRetainedValueLeaf::subscribe(DataModelSubscriber &subscriber, uint
         return false;
     }
 
-    sendRetainedValue(subscriber);
+    sendRetainedValue(subscriber, cookie);
 
     return true;
 }
@@ -48,6 +48,32 @@ void DataModelRetainedValueLeaf::updated() {
     }
 }
 
+// Leaves keep their value in its native form and it's only formatted when there's someone to
+// send it to, once no matter how many subscribers there are.
+void DataModelRetainedValueLeaf::publishValue() {
+    SubscriberSnapshot snapshot;
+    snapshotSubscribers(snapshot);
+
+    if (!snapshot.empty()) {
+        etl::string<maxFormattedValueLength> valueStr;
+        formatValue(valueStr);
+        for (SnapshotEntry &entry : snapshot) {
+            publishToSubscriber(*entry.subscriber, valueStr, false, entry.cookie);
+        }
+    }
+
+    parent->leafUpdated();
+}
+
+void DataModelRetainedValueLeaf::sendRetainedValue(DataModelSubscriber &subscriber,
+                                                   uint32_t cookie) {
+    if (hasValue()) {
+        etl::string<maxFormattedValueLength> valueStr;
+        formatValue(valueStr);
+        publishToSubscriber(subscriber, valueStr, true, cookie);
+    }
+}
+
 void DataModelRetainedValueLeaf::removeValue() {
     if (hasBeenSet) {
         etl::string<1> emptyStr;
@@ -65,9 +91,14 @@ bool DataModelRetainedValueLeaf::hasValue() const {
 void DataModelRetainedValueLeaf::dump() {
     Logger &logger = taskLogger();
 
-    char topic[maxTopicNameLength];
-    buildTopicName(topic);
-    logger << logDebugDataModel << topic << ": ";
+    const char *topic = topicName();
+    if (topic) {
+        logger << logDebugDataModel << topic << ": ";
+    } else {
+        char topicBuffer[maxTopicNameLength + 1];
+        buildTopicName(topicBuffer);
+        logger << logDebugDataModel << topicBuffer << ": ";
+    }
     if (hasValue()) {
         logValue(logger);
     } else {
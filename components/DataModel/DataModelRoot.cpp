@@ -136,6 +136,14 @@ bool DataModelRoot::checkTopicFilterValidity(const char *topicFilter) {
     return true;
 }
 
+void DataModelRoot::leafAdded(DataModelLeaf &leaf) {
+    dataModel->leafAdded(leaf);
+}
+
+void DataModelRoot::writableLeafAdded(DataModelWritableLeaf &leaf) {
+    dataModel->writableLeafAdded(leaf);
+}
+
 void DataModelRoot::leafUpdated() {
     dataModel->leafUpdated();
 }
@@ -156,14 +164,6 @@ void DataModelRoot::retainedValueCleared() {
     dataModel->retainedValueCleared();
 }
 
-void DataModelRoot::takeSubscriptionLock() {
-    dataModel->takeSubscriptionLock();
-}
-
-void DataModelRoot::releaseSubscriptionLock() {
-    dataModel->releaseSubscriptionLock();
-}
-
 void DataModelRoot::dump() {
     for (DataModelElement &child : children) {
         child.dump();
@@ -74,12 +74,22 @@ int DataModelStringLeaf::compare(const etl::istring &otherString) const {
     return value.compare(otherString);
 }
 
-void DataModelStringLeaf::sendRetainedValue(DataModelSubscriber &subscriber) {
+void DataModelStringLeaf::sendRetainedValue(DataModelSubscriber &subscriber, uint32_t cookie) {
     if (hasValue()) {
-        publishToSubscriber(subscriber, value, true);
+        publishToSubscriber(subscriber, value, true, cookie);
     }
 }
 
+// String values are published as is, rather than through publishValue(), so this is only for
+// completeness.
+void DataModelStringLeaf::formatValue(etl::istring &valueStr) {
+    valueStr.assign(value);
+}
+
+size_t DataModelStringLeaf::maxLength() const {
+    return value.max_size();
+}
+
 bool DataModelStringLeaf::isEmptyStr() const {
     return hasValue() && value.empty();
 }
@@ -0,0 +1,415 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DataModelSubscriptionIndex.h"
+#include "DataModel.h"
+#include "DataModelElement.h"
+#include "DataModelSubscriber.h"
+
+#include "etl/pool.h"
+#include "etl/vector.h"
+
+#include <new>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+DataModelSubscriptionIndex::DataModelSubscriptionIndex()
+    : root("", 0), elementTable() {
+}
+
+bool DataModelSubscriptionIndex::add(const char *topicFilter, DataModelSubscriber &subscriber,
+                                     uint32_t cookie) {
+    Node *node = &root;
+    const char *level = topicFilter;
+    bool added;
+    while (true) {
+        const size_t length = topicLevelLength(level);
+        if (length == 1 && level[0] == dataModelMultiLevelWildcard) {
+            added = addFilter(node->multiLevelWildcardFilters, subscriber, cookie);
+            break;
+        }
+
+        if (length == 1 && level[0] == dataModelSingleLevelWildcard) {
+            node = findOrAddSingleLevelWildcardChild(*node);
+        } else {
+            node = findOrAddLiteralChild(*node, level, length);
+        }
+        if (node == nullptr) {
+            added = false;
+            break;
+        }
+
+        if (level[length] == 0) {
+            added = addFilter(node->filters, subscriber, cookie);
+            break;
+        }
+        level += length + 1;
+    }
+
+    if (!added) {
+        // Give back any nodes we created along the way.
+        pruneChildren(root);
+    }
+
+    return added;
+}
+
+void DataModelSubscriptionIndex::remove(const char *topicFilter,
+                                        DataModelSubscriber &subscriber) {
+    bool multiLevelWildcard;
+    Node *node = findNode(topicFilter, multiLevelWildcard);
+    if (node == nullptr) {
+        return;
+    }
+
+    if (multiLevelWildcard) {
+        removeFilter(node->multiLevelWildcardFilters, subscriber);
+    } else {
+        removeFilter(node->filters, subscriber);
+    }
+    pruneChildren(root);
+}
+
+void DataModelSubscriptionIndex::removeAll(DataModelSubscriber &subscriber) {
+    removeAllFromNode(root, subscriber);
+    pruneChildren(root);
+}
+
+void DataModelSubscriptionIndex::matchingSubscriptions(const char *topic,
+                                                       MatchList &matches) const {
+    addMatches(root, topic, true, matches);
+}
+
+bool DataModelSubscriptionIndex::isEmpty() const {
+    return filterPool.size() == 0;
+}
+
+size_t DataModelSubscriptionIndex::filterCount() const {
+    return filterPool.size();
+}
+
+size_t DataModelSubscriptionIndex::nodeCount() const {
+    return nodePool.size();
+}
+
+// Ancestors are indexed along with the leaf, as only elements with leaves beneath them can match
+// a filter. Once an ancestor that's already indexed is reached, so are all of its own ancestors.
+// The root isn't indexed, being the parent that a filter's first level is resolved against.
+void DataModelSubscriptionIndex::addElement(DataModelElement &leaf) {
+    for (DataModelElement *element = &leaf;
+         element->parent != nullptr && !isIndexed(*element);
+         element = element->parent) {
+        DataModelElement *&bucket =
+            elementTable[elementBucket(element->parent, element->name, strlen(element->name))];
+        element->nextIndexed = bucket;
+        bucket = element;
+    }
+}
+
+DataModelElement *DataModelSubscriptionIndex::resolveFilter(const DataModelElement &root,
+                                                            const char *topicFilter,
+                                                            const char *&elementFilter) const {
+    const DataModelElement *parent = &root;
+    DataModelElement *element = nullptr;
+    const char *level = topicFilter;
+    while (level[0] != dataModelSingleLevelWildcard && level[0] != dataModelMultiLevelWildcard) {
+        const size_t length = topicLevelLength(level);
+        element = findElement(parent, level, length);
+        if (element == nullptr) {
+            return nullptr;
+        }
+        elementFilter = level;
+
+        if (level[length] == 0) {
+            break;
+        }
+        parent = element;
+        level += length + 1;
+    }
+
+    return element;
+}
+
+DataModelSubscriptionIndex::Node *
+DataModelSubscriptionIndex::findOrAddLiteralChild(Node &node, const char *level,
+                                                  size_t levelLength) {
+    for (Node *child = node.firstChild; child != nullptr; child = child->nextSibling) {
+        if (child->levelMatches(level, levelLength)) {
+            return child;
+        }
+    }
+
+    if (levelLength > maxLevelLength || nodePool.full()) {
+        return nullptr;
+    }
+
+    Node *child = new (nodePool.allocate()) Node(level, levelLength);
+    child->nextSibling = node.firstChild;
+    node.firstChild = child;
+
+    return child;
+}
+
+DataModelSubscriptionIndex::Node *
+DataModelSubscriptionIndex::findOrAddSingleLevelWildcardChild(Node &node) {
+    if (node.singleLevelWildcardChild == nullptr) {
+        if (nodePool.full()) {
+            return nullptr;
+        }
+        node.singleLevelWildcardChild = new (nodePool.allocate()) Node("", 0);
+    }
+
+    return node.singleLevelWildcardChild;
+}
+
+// A subscriber resubscribing to a filter it already holds just gets its cookie updated.
+bool DataModelSubscriptionIndex::addFilter(Filter *&filters, DataModelSubscriber &subscriber,
+                                           uint32_t cookie) {
+    for (Filter *filter = filters; filter != nullptr; filter = filter->next) {
+        if (filter->subscriber == &subscriber) {
+            filter->cookie = cookie;
+            return true;
+        }
+    }
+
+    if (filterPool.full()) {
+        return false;
+    }
+
+    Filter *filter = new (filterPool.allocate()) Filter(subscriber, cookie);
+    filter->next = filters;
+    filters = filter;
+
+    return true;
+}
+
+bool DataModelSubscriptionIndex::removeFilter(Filter *&filters, DataModelSubscriber &subscriber) {
+    for (Filter **link = &filters; *link != nullptr; link = &(*link)->next) {
+        Filter *filter = *link;
+        if (filter->subscriber == &subscriber) {
+            *link = filter->next;
+            filterPool.release(filter);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+DataModelSubscriptionIndex::Node *DataModelSubscriptionIndex::findNode(const char *topicFilter,
+                                                                       bool &multiLevelWildcard) {
+    Node *node = &root;
+    const char *level = topicFilter;
+    while (true) {
+        const size_t length = topicLevelLength(level);
+        if (length == 1 && level[0] == dataModelMultiLevelWildcard) {
+            multiLevelWildcard = true;
+            return node;
+        }
+
+        if (length == 1 && level[0] == dataModelSingleLevelWildcard) {
+            node = node->singleLevelWildcardChild;
+        } else {
+            Node *child;
+            for (child = node->firstChild;
+                 child != nullptr && !child->levelMatches(level, length);
+                 child = child->nextSibling) {
+            }
+            node = child;
+        }
+        if (node == nullptr) {
+            return nullptr;
+        }
+
+        if (level[length] == 0) {
+            multiLevelWildcard = false;
+            return node;
+        }
+        level += length + 1;
+    }
+}
+
+void DataModelSubscriptionIndex::removeAllFromNode(Node &node, DataModelSubscriber &subscriber) {
+    removeFilter(node.filters, subscriber);
+    removeFilter(node.multiLevelWildcardFilters, subscriber);
+
+    for (Node *child = node.firstChild; child != nullptr; child = child->nextSibling) {
+        removeAllFromNode(*child, subscriber);
+    }
+    if (node.singleLevelWildcardChild) {
+        removeAllFromNode(*node.singleLevelWildcardChild, subscriber);
+    }
+}
+
+// Releases any descendant nodes that no longer lead to a filter.
+void DataModelSubscriptionIndex::pruneChildren(Node &node) {
+    for (Node **link = &node.firstChild; *link != nullptr;) {
+        Node *child = *link;
+        pruneChildren(*child);
+        if (child->isUnused()) {
+            *link = child->nextSibling;
+            nodePool.release(child);
+        } else {
+            link = &child->nextSibling;
+        }
+    }
+
+    Node *wildcardChild = node.singleLevelWildcardChild;
+    if (wildcardChild) {
+        pruneChildren(*wildcardChild);
+        if (wildcardChild->isUnused()) {
+            node.singleLevelWildcardChild = nullptr;
+            nodePool.release(wildcardChild);
+        }
+    }
+}
+
+// Node is the point in the index reached by the levels of the topic preceding level. A filter
+// ending in a multi-level wildcard also matches its parent level, so "a/#" matches "a".
+void DataModelSubscriptionIndex::addMatches(const Node &node, const char *level, bool topLevel,
+                                            MatchList &matches) const {
+    // Per the MQTT specification, wildcards at the top level must not match with topics beginning
+    // with a $
+    const bool wildcardsMatch = !(topLevel && level[0] == '$');
+    if (wildcardsMatch) {
+        addMatchingFilters(node.multiLevelWildcardFilters, matches);
+    }
+
+    const size_t length = topicLevelLength(level);
+    const bool lastLevel = level[length] == 0;
+    const char *nextLevel = level + length + 1;
+
+    for (const Node *child = node.firstChild; child != nullptr; child = child->nextSibling) {
+        if (child->levelMatches(level, length)) {
+            if (lastLevel) {
+                addMatchingFilters(child->filters, matches);
+                addMatchingFilters(child->multiLevelWildcardFilters, matches);
+            } else {
+                addMatches(*child, nextLevel, false, matches);
+            }
+            break;
+        }
+    }
+
+    const Node *wildcardChild = node.singleLevelWildcardChild;
+    if (wildcardChild && wildcardsMatch) {
+        if (lastLevel) {
+            addMatchingFilters(wildcardChild->filters, matches);
+            addMatchingFilters(wildcardChild->multiLevelWildcardFilters, matches);
+        } else {
+            addMatches(*wildcardChild, nextLevel, false, matches);
+        }
+    }
+}
+
+void DataModelSubscriptionIndex::addMatchingFilters(const Filter *filters, MatchList &matches) {
+    for (const Filter *filter = filters; filter != nullptr; filter = filter->next) {
+        bool alreadyMatched = false;
+        for (const Match &match : matches) {
+            if (match.subscriber == filter->subscriber) {
+                alreadyMatched = true;
+                break;
+            }
+        }
+
+        if (!alreadyMatched && !matches.full()) {
+            matches.push_back(Match(filter->subscriber, filter->cookie));
+        }
+    }
+}
+
+size_t DataModelSubscriptionIndex::topicLevelLength(const char *topic) {
+    size_t length;
+    for (length = 0;
+         topic[length] != 0 && topic[length] != dataModelLevelSeparator;
+         length++) {
+    }
+
+    return length;
+}
+
+DataModelSubscriptionIndex::Match::Match(DataModelSubscriber *subscriber, uint32_t cookie)
+    : subscriber(subscriber), cookie(cookie) {
+}
+
+DataModelSubscriptionIndex::Filter::Filter(DataModelSubscriber &subscriber, uint32_t cookie)
+    : next(nullptr), subscriber(&subscriber), cookie(cookie) {
+}
+
+DataModelSubscriptionIndex::Node::Node(const char *level, size_t levelLength)
+    : nextSibling(nullptr), firstChild(nullptr), singleLevelWildcardChild(nullptr),
+      filters(nullptr), multiLevelWildcardFilters(nullptr), levelLength(levelLength) {
+    memcpy(this->level, level, levelLength);
+}
+
+bool DataModelSubscriptionIndex::Node::levelMatches(const char *level, size_t levelLength) const {
+    return levelLength == this->levelLength && memcmp(this->level, level, levelLength) == 0;
+}
+
+bool DataModelSubscriptionIndex::Node::isUnused() const {
+    return firstChild == nullptr && singleLevelWildcardChild == nullptr && filters == nullptr &&
+           multiLevelWildcardFilters == nullptr;
+}
+
+// 32 bit FNV-1a over the name followed by the parent's address, so that the same name beneath
+// different parents, as with the fields of repeated nodes, lands in different buckets.
+size_t DataModelSubscriptionIndex::elementBucket(const DataModelElement *parent,
+                                                 const char *name, size_t nameLength) {
+    uint32_t hash = 2166136261u;
+    for (size_t pos = 0; pos < nameLength; pos++) {
+        hash = (hash ^ (uint8_t)name[pos]) * 16777619u;
+    }
+    uintptr_t parentAddress = (uintptr_t)parent;
+    for (size_t byte = 0; byte < sizeof(parentAddress); byte++) {
+        hash = (hash ^ (uint8_t)parentAddress) * 16777619u;
+        parentAddress >>= 8;
+    }
+
+    return hash & (elementBuckets - 1);
+}
+
+DataModelElement *DataModelSubscriptionIndex::findElement(const DataModelElement *parent,
+                                                          const char *name,
+                                                          size_t nameLength) const {
+    for (DataModelElement *element = elementTable[elementBucket(parent, name, nameLength)];
+         element != nullptr;
+         element = element->nextIndexed) {
+        if (element->parent == parent && strncmp(element->name, name, nameLength) == 0 &&
+            element->name[nameLength] == 0) {
+            return element;
+        }
+    }
+
+    return nullptr;
+}
+
+bool DataModelSubscriptionIndex::isIndexed(const DataModelElement &element) const {
+    const DataModelElement *parent = element.parent;
+    for (const DataModelElement *indexed =
+             elementTable[elementBucket(parent, element.name, strlen(element.name))];
+         indexed != nullptr;
+         indexed = indexed->nextIndexed) {
+        if (indexed == &element) {
+            return true;
+        }
+    }
+
+    return false;
+}
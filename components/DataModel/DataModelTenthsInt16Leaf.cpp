@@ -27,14 +27,10 @@
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/string_stream.h"
-#include "etl/to_string.h"
 
 #include <stdint.h>
 #include <stddef.h>
 
-constexpr size_t maxStringLength = 8;
-
 DataModelTenthsInt16Leaf::DataModelTenthsInt16Leaf(const char *name, DataModelNode *parent)
     : DataModelRetainedValueLeaf(name, parent) {
 }
@@ -45,9 +41,7 @@ DataModelTenthsInt16Leaf & DataModelTenthsInt16Leaf::operator = (const TenthsInt
 
         updated();
 
-        etl::string<maxStringLength> valueStr;
-        value.toString(valueStr);
-        *this << valueStr;
+        publishValue();
     }
 
     return *this;
@@ -59,9 +53,7 @@ DataModelTenthsInt16Leaf & DataModelTenthsInt16Leaf::operator = (const TenthsUIn
 
         updated();
 
-        etl::string<maxStringLength> valueStr;
-        value.toString(valueStr);
-        *this << valueStr;
+        publishValue();
     }
 
     return *this;
@@ -75,9 +67,7 @@ DataModelTenthsInt16Leaf & DataModelTenthsInt16Leaf::operator = (const Hundredth
 
         updated();
 
-        etl::string<maxStringLength> valueStr;
-        roundedValue.toString(valueStr);
-        *this << valueStr;
+        publishValue();
     }
 
     return *this;
@@ -89,20 +79,14 @@ DataModelTenthsInt16Leaf & DataModelTenthsInt16Leaf::operator = (const int16_t v
 
         updated();
 
-        etl::string<maxStringLength> valueStr;
-        etl::to_string(value, valueStr);
-        *this << valueStr;
+        publishValue();
     }
 
     return *this;
 }
 
-void DataModelTenthsInt16Leaf::sendRetainedValue(DataModelSubscriber &subscriber) {
-    if (hasValue()) {
-        etl::string<maxStringLength> valueStr;
-        value.toString(valueStr);
-        publishToSubscriber(subscriber, valueStr, true);
-    }
+void DataModelTenthsInt16Leaf::formatValue(etl::istring &valueStr) {
+    value.toString(valueStr);
 }
 
 void DataModelTenthsInt16Leaf::logValue(Logger &logger) {
@@ -25,13 +25,9 @@
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/string_stream.h"
-#include "etl/to_string.h"
 
 #include <stdint.h>
 
-constexpr size_t maxStringLength = 7;
-
 DataModelTenthsUInt16Leaf::DataModelTenthsUInt16Leaf(const char *name, DataModelNode *parent)
     : DataModelRetainedValueLeaf(name, parent) {
 }
@@ -42,9 +38,7 @@ DataModelTenthsUInt16Leaf & DataModelTenthsUInt16Leaf::operator = (const TenthsU
 
         updated();
 
-        etl::string<maxStringLength> valueStr;
-        value.toString(valueStr);
-        *this << valueStr;
+        publishValue();
     }
 
     return *this;
@@ -56,20 +50,14 @@ DataModelTenthsUInt16Leaf & DataModelTenthsUInt16Leaf::operator = (uint16_t valu
 
         updated();
 
-        etl::string<maxStringLength> valueStr;
-        etl::to_string(value, valueStr);
-        *this << valueStr;
+        publishValue();
     }
 
     return *this;
 }
 
-void DataModelTenthsUInt16Leaf::sendRetainedValue(DataModelSubscriber &subscriber) {
-    if (hasValue()) {
-        etl::string<maxStringLength> valueStr;
-        value.toString(valueStr);
-        publishToSubscriber(subscriber, valueStr, true);
-    }
+void DataModelTenthsUInt16Leaf::formatValue(etl::istring &valueStr) {
+    value.toString(valueStr);
 }
 
 void DataModelTenthsUInt16Leaf::logValue(Logger &logger) {
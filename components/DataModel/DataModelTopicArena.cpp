@@ -0,0 +1,86 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DataModelTopicArena.h"
+#include "DataModel.h"
+
+#include <freertos/FreeRTOS.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+DataModelTopicArena dataModelTopicArena;
+
+DataModelTopicArena::DataModelTopicArena() : used(0), topics(0), failures(0) {
+    portMUX_INITIALIZE(&lock);
+}
+
+// Copies prefix, a level separator if the prefix is non-empty, and name into the arena. Called
+// from whatever task first needs an element's topic, so the append is done with the arena locked.
+// The copy is bounded by maxTopicNameLength, keeping the critical section short.
+bool DataModelTopicArena::intern(const char *prefix, size_t prefixLength, const char *name,
+                                 size_t nameLength, uint16_t &offset) {
+    const size_t separatorLength = prefixLength ? 1 : 0;
+    const size_t topicLength = prefixLength + separatorLength + nameLength;
+    if (topicLength > maxTopicNameLength) {
+        return false;
+    }
+
+    taskENTER_CRITICAL(&lock);
+    if (used + topicLength + 1 > arenaSize) {
+        failures++;
+        taskEXIT_CRITICAL(&lock);
+        return false;
+    }
+
+    char *topic = arena + used;
+    memcpy(topic, prefix, prefixLength);
+    if (separatorLength) {
+        topic[prefixLength] = dataModelLevelSeparator;
+    }
+    memcpy(topic + prefixLength + separatorLength, name, nameLength);
+    topic[topicLength] = 0;
+
+    offset = used;
+    used += topicLength + 1;
+    topics++;
+    taskEXIT_CRITICAL(&lock);
+
+    return true;
+}
+
+const char *DataModelTopicArena::topicAt(uint16_t offset) const {
+    return arena + offset;
+}
+
+size_t DataModelTopicArena::size() const {
+    return arenaSize;
+}
+
+size_t DataModelTopicArena::bytesUsed() const {
+    return used;
+}
+
+uint16_t DataModelTopicArena::topicCount() const {
+    return topics;
+}
+
+uint16_t DataModelTopicArena::internFailures() const {
+    return failures;
+}
@@ -20,15 +20,13 @@
 #include "DataModelLeaf.h"
 #include "DataModelNode.h"
 
+#include "NumberFormat.h"
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/to_string.h"
 
 #include <stdint.h>
 
-constexpr size_t maxStringLength = 5;
-
 DataModelUInt16Leaf::DataModelUInt16Leaf(const char *name, DataModelNode *parent)
     : DataModelRetainedValueLeaf(name, parent),
       value(0) {
@@ -38,7 +36,7 @@ DataModelUInt16Leaf & DataModelUInt16Leaf::operator = (const uint16_t value) {
     if (!hasValue() || this->value != value) {
         this->value = value;
         updated();
-        *this << (uint32_t)value;
+        publishValue();
     }
 
     return *this;
@@ -47,14 +45,14 @@ DataModelUInt16Leaf & DataModelUInt16Leaf::operator = (const uint16_t value) {
 DataModelUInt16Leaf DataModelUInt16Leaf::operator ++ (int) {
     value++;
     updated();
-    *this << (uint32_t)value;
+    publishValue();
     return *this;
 }
 
 DataModelUInt16Leaf DataModelUInt16Leaf::operator -- (int) {
     value--;
     updated();
-    *this << (uint32_t)value;
+    publishValue();
     return *this;
 }
 
@@ -62,12 +60,10 @@ DataModelUInt16Leaf::operator uint16_t() const {
     return value;
 }
 
-void DataModelUInt16Leaf::sendRetainedValue(DataModelSubscriber &subscriber) {
-    if (hasValue()) {
-        etl::string<maxStringLength> valueStr;
-        etl::to_string(value, valueStr);
-        publishToSubscriber(subscriber, valueStr, true);
-    }
+void DataModelUInt16Leaf::formatValue(etl::istring &valueStr) {
+    char buffer[maxUInt32FormatLength];
+    const size_t length = formatUInt32(buffer, value);
+    valueStr.assign(buffer, length);
 }
 
 void DataModelUInt16Leaf::logValue(Logger &logger) {
@@ -20,10 +20,10 @@
 #include "DataModelLeaf.h"
 #include "DataModelNode.h"
 
+#include "NumberFormat.h"
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/to_string.h"
 
 #include <stdint.h>
 
@@ -36,7 +36,7 @@ DataModelUInt32Leaf & DataModelUInt32Leaf::operator = (const uint32_t value) {
     if (!hasValue() || this->value != value) {
         this->value = value;
         updated();
-        *this << value;
+        publishValue();
     }
 
     return *this;
@@ -45,14 +45,14 @@ DataModelUInt32Leaf & DataModelUInt32Leaf::operator = (const uint32_t value) {
 DataModelUInt32Leaf DataModelUInt32Leaf::operator ++ (int) {
     value++;
     updated();
-    *this << value;
+    publishValue();
     return *this;
 }
 
 DataModelUInt32Leaf DataModelUInt32Leaf::operator -- (int) {
     value--;
     updated();
-    *this << value;
+    publishValue();
     return *this;
 }
 
@@ -60,12 +60,10 @@ DataModelUInt32Leaf::operator uint32_t() const {
     return value;
 }
 
-void DataModelUInt32Leaf::sendRetainedValue(DataModelSubscriber &subscriber) {
-    if (hasValue()) {
-        etl::string<12> valueStr;
-        etl::to_string(value, valueStr);
-        publishToSubscriber(subscriber, valueStr, true);
-    }
+void DataModelUInt32Leaf::formatValue(etl::istring &valueStr) {
+    char buffer[maxUInt32FormatLength];
+    const size_t length = formatUInt32(buffer, value);
+    valueStr.assign(buffer, length);
 }
 
 void DataModelUInt32Leaf::logValue(Logger &logger) {
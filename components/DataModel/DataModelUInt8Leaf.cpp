@@ -20,10 +20,10 @@
 #include "DataModelLeaf.h"
 #include "DataModelNode.h"
 
+#include "NumberFormat.h"
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/to_string.h"
 
 #include <stdint.h>
 
@@ -36,7 +36,7 @@ DataModelUInt8Leaf & DataModelUInt8Leaf::operator = (const uint8_t value) {
     if (!hasValue() || this->value != value) {
         this->value = value;
         updated();
-        *this << (uint32_t)value;
+        publishValue();
     }
 
     return *this;
@@ -45,14 +45,14 @@ DataModelUInt8Leaf & DataModelUInt8Leaf::operator = (const uint8_t value) {
 DataModelUInt8Leaf DataModelUInt8Leaf::operator ++ (int) {
     value++;
     updated();
-    *this << (uint32_t)value;
+    publishValue();
     return *this;
 }
 
 DataModelUInt8Leaf DataModelUInt8Leaf::operator -- (int) {
     value--;
     updated();
-    *this << (uint32_t)value;
+    publishValue();
     return *this;
 }
 
@@ -60,13 +60,10 @@ DataModelUInt8Leaf::operator uint8_t() const {
     return value;
 }
 
-
-void DataModelUInt8Leaf::sendRetainedValue(DataModelSubscriber &subscriber) {
-    if (hasValue()) {
-        etl::string<3> valueStr;
-        etl::to_string(value, valueStr);
-        publishToSubscriber(subscriber, valueStr, true);
-    }
+void DataModelUInt8Leaf::formatValue(etl::istring &valueStr) {
+    char buffer[maxUInt32FormatLength];
+    const size_t length = formatUInt32(buffer, value);
+    valueStr.assign(buffer, length);
 }
 
 void DataModelUInt8Leaf::logValue(Logger &logger) {
@@ -0,0 +1,51 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "DataModelWritableLeaf.h"
+#include "DataModelStringLeaf.h"
+#include "DataModelNode.h"
+
+#include "Logger.h"
+
+#include "etl/string.h"
+
+#include <string.h>
+
+DataModelWritableLeaf::DataModelWritableLeaf(const char *name, DataModelNode *parent,
+                                             etl::istring &buffer,
+                                             DataModelWriteHandler &handler)
+    : DataModelStringLeaf(name, parent, buffer), handler(handler) {
+    parent->writableLeafAdded(*this);
+}
+
+bool DataModelWritableLeaf::write(const char *value) {
+    if (strlen(value) > maxLength()) {
+        taskLogger() << logWarnDataModel << "Value '" << value
+                     << "' too long for writable leaf '" << elementName() << "'" << eol;
+        return false;
+    }
+
+    if (!handler.leafWritten(*this, value)) {
+        return false;
+    }
+
+    DataModelStringLeaf::operator = (value);
+
+    return true;
+}
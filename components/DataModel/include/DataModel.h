@@ -20,6 +20,7 @@
 #define DATA_MODEL_H
 
 #include "DataModelRoot.h"
+#include "DataModelSubscriptionIndex.h"
 #include "DataModelSubscriber.h"
 #include "DataModelNode.h"
 #include "DataModelUInt16Leaf.h"
@@ -31,6 +32,8 @@
 
 #include "StatsHolder.h"
 
+#include "etl/vector.h"
+
 #include <freertos/semphr.h>
 
 #include <stddef.h>
@@ -43,17 +46,37 @@ const char dataModelSingleLevelWildcard = '+';
 const size_t maxTopicNameLength = 255;
 
 class StatsManager;
+class DataModelWritableLeaf;
 
 class DataModel : public TaskObject, public StatsHolder {
     private:
         static constexpr size_t stackSize = 3 * 1024;
         static constexpr uint32_t lockTimeoutMs = 60 * 1000;
+        static constexpr size_t maxWritableLeaves = 16;
 
         DataModelRoot _rootNode;
+        // Serializes changes to subscriptions. Leaf updates don't take it, instead reading a
+        // snapshot of each leaf's subscribers under that leaf's own lock.
         SemaphoreHandle_t subscriptionLock;
+        uint32_t lockAcquisitions;
+        uint32_t lockContentions;
+        uint32_t lockWaitUs;
+        uint32_t lockMaxWaitUs;
+        DataModelSubscriptionIndex subscriptionIndex;
+        uint16_t leafCount;
         uint16_t subscriptionCount;
         uint16_t retainedValues;
         StatCounter updates;
+        // Writable leaves, sorted by topic name so that the leaf for a command can be found with a
+        // binary search rather than a walk of the tree. Held under commandLock, which also keeps
+        // writes by different clients from overlapping.
+        etl::vector<DataModelWritableLeaf *, maxWritableLeaves> writableLeaves;
+        SemaphoreHandle_t commandLock;
+        uint32_t commands;
+        uint32_t commandsRejected;
+        uint32_t relayed;
+
+        DataModelNode _commandNode;
 
         DataModelNode _sysNode;
         DataModelNode _brokerNode;
@@ -65,11 +88,43 @@ class DataModel : public TaskObject, public StatsHolder {
         DataModelNode dataModelNode;
         DataModelUInt32Leaf updatesLeaf;
         DataModelUInt32Leaf updateRateLeaf;
+        DataModelUInt32Leaf commandsLeaf;
+        DataModelUInt32Leaf commandsRejectedLeaf;
+        DataModelUInt32Leaf relayedLeaf;
+        DataModelUInt16Leaf leavesLeaf;
+        DataModelNode topicArenaNode;
+        DataModelUInt32Leaf topicArenaSizeLeaf;
+        DataModelUInt32Leaf topicArenaUsedLeaf;
+        DataModelUInt16Leaf topicArenaTopicsLeaf;
+        DataModelUInt16Leaf topicArenaFailuresLeaf;
+        DataModelNode filterIndexNode;
+        DataModelUInt16Leaf filterIndexFiltersLeaf;
+        DataModelUInt16Leaf filterIndexNodesLeaf;
+        DataModelNode subscriptionPoolNode;
+        DataModelUInt16Leaf subscriptionPoolSizeLeaf;
+        DataModelUInt16Leaf subscriptionPoolUsedLeaf;
+        DataModelUInt32Leaf subscriptionPoolBytesLeaf;
+        DataModelUInt32Leaf subscriptionPoolExhaustionsLeaf;
+        DataModelNode subscriptionLockNode;
+        DataModelUInt32Leaf lockAcquisitionsLeaf;
+        DataModelUInt32Leaf lockContentionsLeaf;
+        DataModelUInt32Leaf lockWaitUsLeaf;
+        DataModelUInt32Leaf lockMaxWaitUsLeaf;
 
         virtual void task() override;
         virtual void exportStats(uint32_t msElapsed) override;
         void takeSubscriptionLock();
         void releaseSubscriptionLock();
+        bool subscribeElements(const char *topicFilter, DataModelSubscriber &subscriber,
+                               uint32_t cookie);
+        void unsubscribeElements(const char *topicFilter, DataModelSubscriber &subscriber);
+        static bool startsWithWildcard(const char *topicFilter);
+        void reportSubscriptionPoolExhaustion(uint32_t poolExhaustionsBefore,
+                                              const char *topicFilter,
+                                              DataModelSubscriber &subscriber);
+        void takeCommandLock();
+        void releaseCommandLock();
+        DataModelWritableLeaf **findWritableLeaf(const char *topic);
 
     public:
         DataModel(StatsManager &statsManager);
@@ -77,20 +132,23 @@ class DataModel : public TaskObject, public StatsHolder {
         bool subscribe(const char *topicFilter, DataModelSubscriber &subscriber, uint32_t cookie);
         void unsubscribe(const char *topicFilter, DataModelSubscriber &subscriber);
         void unsubscribeAll(DataModelSubscriber &subscriber);
+        void publishTopic(const char *topic, const char *value);
+        bool isCommandTopic(const char *topic) const;
+        bool writeCommand(const char *topic, const char *value);
+        DataModelNode &commandNode();
         DataModelNode &sysNode();
         DataModelNode &brokerNode();
         DataModelNode &messagesNode();
         void dump();
 
         // The below method should probably be a friend method or something
+        void leafAdded(DataModelLeaf &leaf);
+        void writableLeafAdded(DataModelWritableLeaf &leaf);
         void leafUpdated();
         void leafSubscribedTo();
         void leafUnsubscribedFrom();
         void valueRetained();
         void retainedValueCleared();
-
-        // Used for taking locks, but should go away later
-        friend class DataModelRoot;
 };
 
 #endif // DATA_MODEL_H
@@ -21,6 +21,8 @@
 
 #include "DataModelRetainedValueLeaf.h"
 
+#include "etl/string.h"
+
 #include <stdint.h>
 
 class DataModelNode;
@@ -30,13 +32,13 @@ class DataModelBoolLeaf : public DataModelRetainedValueLeaf {
    private:
         bool value;
 
+        virtual void formatValue(etl::istring &valueStr) override;
         virtual void logValue(Logger &logger) override;
 
     public:
         DataModelBoolLeaf(const char *name, DataModelNode *parent);
         DataModelBoolLeaf & operator = (const bool value);
         operator bool() const;
-        virtual void sendRetainedValue(DataModelSubscriber &subscriber) override;
 };
 
 #endif // DATA_MODEL_BOOL_LEAF_H
@@ -21,13 +21,21 @@
 
 #include "etl/intrusive_links.h"
 
+#include <freertos/FreeRTOS.h>
+
+#include <atomic>
+
 #include <stdint.h>
 #include <stddef.h>
 
 class DataModelNode;
 class DataModelSubscriber;
+class DataModelSubscriptionIndex;
 
-const unsigned maxDataModelSubscribers = 5;
+// Subscribers are MQTT sessions, each with at most one subscription to a given leaf. This bounds
+// the subscribers of a single leaf, which are copied onto the updating task's stack, rather than
+// following the number of MQTT clients.
+const unsigned maxDataModelSubscribers = CONFIG_LUNAMON_DATA_MODEL_MAX_LEAF_SUBSCRIBERS;
 
 constexpr size_t siblingLinkId = 0;
 typedef etl::forward_link<siblingLinkId> siblingLink;
@@ -35,16 +43,31 @@ typedef etl::forward_link<siblingLinkId> siblingLink;
 class DataModelElement : public siblingLink {
     private:
         const char *name;
+        // Where the element's full topic name lives in the topic arena, or 0 if it has yet to be
+        // interned.
+        std::atomic<uint32_t> topicLocation;
+        // Chains the elements sharing a bucket of the subscription index's element table.
+        DataModelElement *nextIndexed;
+
+        uint32_t internTopicName();
+
+        friend class DataModelSubscriptionIndex;
 
     protected:
         DataModelNode *parent;
         bool isMultiLevelWildcard(const char *topicFilter);
         bool topicFilterMatch(const char *topicFilter, unsigned &offsetToNextLevel,
                               bool &lastLevel);
-        void buildTopicName(char *topicNameBuffer);
 
     public:
         DataModelElement(const char *name, DataModelNode *parent);
+        DataModelElement(const DataModelElement &other);
+        void buildTopicName(char *topicNameBuffer);
+        // Returns the element's full topic name, interning it on first use. Returns nullptr if
+        // the topic arena is exhausted, in which case callers should fall back to
+        // buildTopicName().
+        const char *topicName();
+        const char *topicName(size_t &length);
         const char *elementName() const;
         // Returns true if one or more subscriptions were made
         virtual bool subscribeIfMatching(const char *topicFilter, DataModelSubscriber &subscriber,
@@ -21,6 +21,8 @@
 
 #include "DataModelRetainedValueLeaf.h"
 
+#include "etl/string.h"
+
 #include "HundredthsInt16.h"
 
 #include <stdint.h>
@@ -32,12 +34,12 @@ class DataModelHundredthsInt16Leaf : public DataModelRetainedValueLeaf {
    private:
         HundredthsInt16 value;
 
+        virtual void formatValue(etl::istring &valueStr) override;
         virtual void logValue(Logger &logger) override;
 
     public:
         DataModelHundredthsInt16Leaf(const char *name, DataModelNode *parent);
         DataModelHundredthsInt16Leaf & operator = (const HundredthsInt16 &value);
-        virtual void sendRetainedValue(DataModelSubscriber &subscriber) override;
 };
 
 #endif // DATA_MODEL_HUNDREDTHS_INT16_LEAF_H
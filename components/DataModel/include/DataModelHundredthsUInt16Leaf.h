@@ -21,6 +21,8 @@
 
 #include "DataModelRetainedValueLeaf.h"
 
+#include "etl/string.h"
+
 #include "HundredthsUInt16.h"
 
 #include <stdint.h>
@@ -32,13 +34,13 @@ class DataModelHundredthsUInt16Leaf : public DataModelRetainedValueLeaf {
    private:
         HundredthsUInt16 value;
 
+        virtual void formatValue(etl::istring &valueStr) override;
         virtual void logValue(Logger &logger) override;
 
     public:
         DataModelHundredthsUInt16Leaf(const char *name, DataModelNode *parent);
         DataModelHundredthsUInt16Leaf & operator = (const HundredthsUInt16 &value);
         DataModelHundredthsUInt16Leaf & operator = (uint16_t value);
-        virtual void sendRetainedValue(DataModelSubscriber &subscriber) override;
 };
 
 #endif
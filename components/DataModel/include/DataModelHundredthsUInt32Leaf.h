@@ -21,6 +21,8 @@
 
 #include "DataModelRetainedValueLeaf.h"
 
+#include "etl/string.h"
+
 #include "HundredthsUInt32.h"
 
 #include <stdint.h>
@@ -32,12 +34,12 @@ class DataModelHundredthsUInt32Leaf : public DataModelRetainedValueLeaf {
    private:
         HundredthsUInt32 value;
 
+        virtual void formatValue(etl::istring &valueStr) override;
         virtual void logValue(Logger &logger) override;
 
     public:
         DataModelHundredthsUInt32Leaf(const char *name, DataModelNode *parent);
         DataModelHundredthsUInt32Leaf & operator = (const HundredthsUInt32 &value);
-        virtual void sendRetainedValue(DataModelSubscriber &subscriber) override;
 };
 
 #endif // DATA_MODEL_HUNDREDTHS_UINT32_LEAF_H
@@ -21,6 +21,8 @@
 
 #include "DataModelRetainedValueLeaf.h"
 
+#include "etl/string.h"
+
 #include "HundredthsUInt8.h"
 
 #include <stdint.h>
@@ -33,13 +35,13 @@ class DataModelHundredthsUInt8Leaf : public DataModelRetainedValueLeaf {
    private:
         HundredthsUInt8 value;
 
+        virtual void formatValue(etl::istring &valueStr) override;
         virtual void logValue(Logger &logger) override;
 
     public:
         DataModelHundredthsUInt8Leaf(const char *name, DataModelNode *parent);
         DataModelHundredthsUInt8Leaf & operator = (const HundredthsUInt8 &value);
         DataModelHundredthsUInt8Leaf & operator = (uint8_t value);
-        virtual void sendRetainedValue(DataModelSubscriber &subscriber) override;
 };
 
 #endif
@@ -21,6 +21,8 @@
 
 #include "DataModelRetainedValueLeaf.h"
 
+#include "etl/string.h"
+
 #include <stdint.h>
 
 class DataModelNode;
@@ -30,6 +32,7 @@ class DataModelInt8Leaf : public DataModelRetainedValueLeaf {
    private:
         int8_t value;
 
+        virtual void formatValue(etl::istring &valueStr) override;
         virtual void logValue(Logger &logger) override;
 
     public:
@@ -38,7 +41,6 @@ class DataModelInt8Leaf : public DataModelRetainedValueLeaf {
         DataModelInt8Leaf operator ++ (int);
         DataModelInt8Leaf operator -- (int);
         operator int8_t() const;
-        virtual void sendRetainedValue(DataModelSubscriber &subscriber) override;
 };
 
 #endif
@@ -24,8 +24,11 @@ class DataModelSubscriber;
 #include "DataModelElement.h"
 
 #include "etl/string.h"
+#include "etl/pool.h"
 #include "etl/vector.h"
 
+#include <freertos/FreeRTOS.h>
+
 #include <stdint.h>
 
 class DataModelNode;
@@ -34,14 +37,29 @@ class DataModelLeaf : public DataModelElement {
     private:
         class Subscription {
             public:
+                Subscription *next;
                 DataModelSubscriber *subscriber;
                 uint32_t cookie;
 
                 Subscription(DataModelSubscriber &subscriber, uint32_t cookie);
         };
 
-        etl::vector<Subscription, maxDataModelSubscribers> subscriptions;
+        static constexpr size_t maxSubscriptions =
+            CONFIG_LUNAMON_DATA_MODEL_SUBSCRIPTIONS_PER_CLIENT * CONFIG_LUNAMON_MAX_MQTT_CLIENTS;
+
+        // Most leaves are never subscribed to, so rather than each leaf carrying room for its
+        // subscribers, subscriptions for all leaves come from a shared pool. Allocations and
+        // releases are made with the data model's subscription lock held.
+        static etl::pool<Subscription, maxSubscriptions> subscriptionPool;
+        static uint32_t subscriptionPoolFailures;
+
+        // Changes to the subscriptions are made with the data model's subscription lock held,
+        // serializing them, and are made under subscriptionsLock so that updating tasks can take
+        // a consistent snapshot without waiting on subscribes and unsubscribes in progress.
+        Subscription *subscriptions;
+        portMUX_TYPE subscriptionsLock;
 
+        Subscription *findSubscription(DataModelSubscriber &subscriber);
         bool addSubscriber(DataModelSubscriber &subscriber, uint32_t cookie);
 
     protected:
@@ -49,8 +67,18 @@ class DataModelLeaf : public DataModelElement {
         bool updateSubscriber(DataModelSubscriber &subscriber, uint32_t cookie);
         virtual bool subscribe(DataModelSubscriber &subscriber, uint32_t cookie);
         void unsubscribe(DataModelSubscriber &subscriber);
+        class SnapshotEntry {
+            public:
+                DataModelSubscriber *subscriber;
+                uint32_t cookie;
+
+                SnapshotEntry(DataModelSubscriber *subscriber, uint32_t cookie);
+        };
+        typedef etl::vector<SnapshotEntry, maxDataModelSubscribers> SubscriberSnapshot;
+
+        void snapshotSubscribers(SubscriberSnapshot &snapshot);
         void publishToSubscriber(DataModelSubscriber &subscriber, const etl::istring &value,
-                                 bool retainedValue);
+                                 bool retainedValue, uint32_t cookie);
 
     public:
         DataModelLeaf(const char *name, DataModelNode *parent);
@@ -62,6 +90,10 @@ class DataModelLeaf : public DataModelElement {
         virtual void unsubscribeAll(DataModelSubscriber &subscriber) override;
         DataModelLeaf & operator << (const etl::istring &value);
         DataModelLeaf & operator << (uint32_t value);
+        static size_t subscriptionPoolSize();
+        static size_t subscriptionPoolUsed();
+        static size_t subscriptionPoolBytes();
+        static uint32_t subscriptionPoolExhaustions();
 };
 
 #endif
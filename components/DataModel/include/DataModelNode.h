@@ -20,6 +20,8 @@
 #define DATA_MODEL_NODE_H
 
 class DataModelSubscriber;
+class DataModelLeaf;
+class DataModelWritableLeaf;
 
 #include "DataModelElement.h"
 
@@ -45,13 +47,13 @@ class DataModelNode : public DataModelElement {
                                            DataModelSubscriber &subscriber) override;
         virtual bool subscribeAll(DataModelSubscriber &subscriber, uint32_t cookie) override;
         virtual void unsubscribeAll(DataModelSubscriber &subscriber) override;
+        virtual void leafAdded(DataModelLeaf &leaf);
+        virtual void writableLeafAdded(DataModelWritableLeaf &leaf);
         virtual void leafUpdated();
         virtual void leafSubscribedTo();
         virtual void leafUnsubscribedFrom();
         virtual void valueRetained();
         virtual void retainedValueCleared();
-        virtual void takeSubscriptionLock();
-        virtual void releaseSubscriptionLock();
         virtual void dump() override;
 };
 
@@ -21,6 +21,9 @@
 
 #include "DataModelLeaf.h"
 
+#include "etl/string.h"
+
+#include <stddef.h>
 #include <stdint.h>
 
 class DataModelNode;
@@ -31,11 +34,16 @@ class DataModelRetainedValueLeaf : public DataModelLeaf {
         bool hasBeenSet;
 
     protected:
+        // Enough for any of the numeric leaves, which are all that use formatValue().
+        static constexpr size_t maxFormattedValueLength = 14;
+
         DataModelRetainedValueLeaf(const char *name, DataModelNode *parent);
         virtual bool subscribe(DataModelSubscriber &subscriber, uint32_t cookie) override;
         void updated();
+        void publishValue();
         bool hasValue() const;
-        virtual void sendRetainedValue(DataModelSubscriber &subscriber) = 0;
+        virtual void sendRetainedValue(DataModelSubscriber &subscriber, uint32_t cookie);
+        virtual void formatValue(etl::istring &valueStr) = 0;
         virtual void logValue(Logger &logger) = 0;
 
     public:
@@ -30,23 +30,23 @@ class DataModelRoot : public DataModelNode {
     private:
         DataModel *dataModel;
 
-        bool checkTopicFilterValidity(const char *topicFilter);
         bool subscribeChildrenIfMatching(const char *topicFilter, DataModelSubscriber &subscriber,
                                          uint32_t cookie);
 
     public:
         DataModelRoot(DataModel *dataModel);
         void setDataModel(DataModel *dataModel);
+        bool checkTopicFilterValidity(const char *topicFilter);
         bool subscribe(const char *topicFilter, DataModelSubscriber &subscriber, uint32_t cookie);
         void unsubscribe(const char *topicFilter, DataModelSubscriber &subscriber);
         virtual bool subscribeAll(DataModelSubscriber &subscriber, uint32_t cookie) override;
+        virtual void leafAdded(DataModelLeaf &leaf) override;
+        virtual void writableLeafAdded(DataModelWritableLeaf &leaf) override;
         virtual void leafUpdated() override;
         virtual void leafSubscribedTo() override;
         virtual void leafUnsubscribedFrom() override;
         virtual void valueRetained() override;
         virtual void retainedValueCleared() override;
-        virtual void takeSubscriptionLock() override;
-        virtual void releaseSubscriptionLock() override;
         virtual void dump() override;
 };
 
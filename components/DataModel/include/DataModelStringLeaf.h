@@ -32,6 +32,7 @@ class DataModelStringLeaf : public DataModelRetainedValueLeaf {
     private:
         etl::istring &value;
 
+        virtual void formatValue(etl::istring &valueStr) override;
         virtual void logValue(Logger &logger) override;
 
     public:
@@ -42,7 +43,7 @@ class DataModelStringLeaf : public DataModelRetainedValueLeaf {
         void append(const etl::istring &string);
         operator const char * () const;
         int compare(const etl::istring &otherString) const;
-        virtual void sendRetainedValue(DataModelSubscriber &subscriber) override;
+        virtual void sendRetainedValue(DataModelSubscriber &subscriber, uint32_t cookie) override;
         bool isEmptyStr() const;
         size_t maxLength() const;
 };
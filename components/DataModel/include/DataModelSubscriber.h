@@ -21,9 +21,20 @@
 
 #include "etl/string.h"
 
+#include <stdint.h>
+
+class DataModelLeaf;
+
 class DataModelSubscriber {
     public:
-        virtual void publish(const char *topic, const char *value, bool retainedValue) = 0;
+        // Called by updating tasks, possibly several at once and without the data model's
+        // subscription lock. Retained values sent on a new subscription are published with the
+        // subscription lock held. The cookie is the one given when subscribing.
+        virtual void publish(DataModelLeaf &leaf, const char *value, bool retainedValue,
+                             uint32_t cookie) = 0;
+        // Called by the task of a client that published to a topic outside of the data model,
+        // without the subscription lock. The cookie is that of a subscription matching the topic.
+        virtual void publishTopic(const char *topic, const char *value, uint32_t cookie) = 0;
         virtual const etl::istring &name() const = 0;
 };
 
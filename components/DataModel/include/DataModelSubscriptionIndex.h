@@ -0,0 +1,133 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_MODEL_SUBSCRIPTION_INDEX_H
+#define DATA_MODEL_SUBSCRIPTION_INDEX_H
+
+#include "etl/pool.h"
+#include "etl/vector.h"
+
+#include <freertos/FreeRTOS.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+class DataModelElement;
+class DataModelSubscriber;
+
+// A trie of the topic filters that subscribers hold, keyed on topic level, with explicit branches
+// for single (+) and multi-level (#) wildcards. Used to find the subscriptions matching a topic
+// in O(depth) so that data model leaves created after a subscription was made pick it up.
+//
+// The data model's elements are also hashed here, on their parent and name, so that the literal
+// levels of a filter being subscribed or unsubscribed resolve to an element with a lookup each
+// rather than a search of every level's children. Elements are chained through their own link,
+// so the table can't fill. All access is done with the data model's subscription lock held,
+// other than the adding of the leaves that make up the data model itself, before there's a lock.
+class DataModelSubscriptionIndex {
+    public:
+        class Match {
+            public:
+                DataModelSubscriber *subscriber;
+                uint32_t cookie;
+
+                Match(DataModelSubscriber *subscriber, uint32_t cookie);
+        };
+        typedef etl::ivector<Match> MatchList;
+
+    private:
+        static constexpr size_t maxNodes = CONFIG_LUNAMON_DATA_MODEL_FILTER_INDEX_NODES;
+        static constexpr size_t maxFilters = CONFIG_LUNAMON_DATA_MODEL_FILTER_INDEX_FILTERS;
+        static constexpr size_t maxLevelLength = CONFIG_LUNAMON_DATA_MODEL_FILTER_INDEX_LEVEL_LENGTH;
+        static constexpr size_t elementBuckets = 128;
+        static_assert((elementBuckets & (elementBuckets - 1)) == 0,
+                      "The element table's size must be a power of two");
+
+        class Filter {
+            public:
+                Filter *next;
+                DataModelSubscriber *subscriber;
+                uint32_t cookie;
+
+                Filter(DataModelSubscriber &subscriber, uint32_t cookie);
+        };
+
+        class Node {
+            public:
+                Node *nextSibling;
+                Node *firstChild;
+                Node *singleLevelWildcardChild;
+                // Filters that end at this level
+                Filter *filters;
+                // Filters that end with a multi-level wildcard following this level
+                Filter *multiLevelWildcardFilters;
+                uint8_t levelLength;
+                char level[maxLevelLength];
+
+                Node(const char *level, size_t levelLength);
+                bool levelMatches(const char *level, size_t levelLength) const;
+                bool isUnused() const;
+        };
+
+        Node root;
+        etl::pool<Node, maxNodes> nodePool;
+        etl::pool<Filter, maxFilters> filterPool;
+        DataModelElement *elementTable[elementBuckets];
+
+        Node *findOrAddLiteralChild(Node &node, const char *level, size_t levelLength);
+        Node *findOrAddSingleLevelWildcardChild(Node &node);
+        bool addFilter(Filter *&filters, DataModelSubscriber &subscriber, uint32_t cookie);
+        bool removeFilter(Filter *&filters, DataModelSubscriber &subscriber);
+        Node *findNode(const char *topicFilter, bool &multiLevelWildcard);
+        void removeAllFromNode(Node &node, DataModelSubscriber &subscriber);
+        void pruneChildren(Node &node);
+        void addMatches(const Node &node, const char *topic, bool topLevel,
+                        MatchList &matches) const;
+        static void addMatchingFilters(const Filter *filters, MatchList &matches);
+        static size_t topicLevelLength(const char *topic);
+        static size_t elementBucket(const DataModelElement *parent, const char *name,
+                                    size_t nameLength);
+        DataModelElement *findElement(const DataModelElement *parent, const char *name,
+                                      size_t nameLength) const;
+        bool isIndexed(const DataModelElement &element) const;
+
+    public:
+        DataModelSubscriptionIndex();
+        // Returns false if the filter couldn't be indexed due to lack of space. The filter must
+        // already have been checked for validity.
+        bool add(const char *topicFilter, DataModelSubscriber &subscriber, uint32_t cookie);
+        void remove(const char *topicFilter, DataModelSubscriber &subscriber);
+        void removeAll(DataModelSubscriber &subscriber);
+        // Adds a match for each subscriber with one or more filters matching the topic. A
+        // subscriber with multiple matching filters is only listed once.
+        void matchingSubscriptions(const char *topic, MatchList &matches) const;
+        bool isEmpty() const;
+        size_t filterCount() const;
+        size_t nodeCount() const;
+        // Indexes a newly created leaf, along with any of its ancestors not yet indexed.
+        void addElement(DataModelElement &leaf);
+        // Resolves the literal levels at the start of a valid topic filter to the element that
+        // they name, stopping short of the first wildcard level. elementFilter is set to the part
+        // of the filter starting with the element's own level, to be handed to its
+        // subscribeIfMatching() or unsubscribeIfMatching(). Returns nullptr if there's no such
+        // element, or if the filter starts with a wildcard.
+        DataModelElement *resolveFilter(const DataModelElement &root, const char *topicFilter,
+                                        const char *&elementFilter) const;
+};
+
+#endif // DATA_MODEL_SUBSCRIPTION_INDEX_H
@@ -21,6 +21,8 @@
 
 #include "DataModelRetainedValueLeaf.h"
 
+#include "etl/string.h"
+
 #include "TenthsInt16.h"
 
 #include <stdint.h>
@@ -34,6 +36,7 @@ class DataModelTenthsInt16Leaf : public DataModelRetainedValueLeaf {
     private:
         TenthsInt16 value;
 
+        virtual void formatValue(etl::istring &valueStr) override;
         virtual void logValue(Logger &logger) override;
 
     public:
@@ -42,7 +45,6 @@ class DataModelTenthsInt16Leaf : public DataModelRetainedValueLeaf {
         DataModelTenthsInt16Leaf & operator = (const TenthsUInt16 &value);
         DataModelTenthsInt16Leaf & operator = (const HundredthsUInt16 &value);
         DataModelTenthsInt16Leaf & operator = (const int16_t value);
-        virtual void sendRetainedValue(DataModelSubscriber &subscriber) override;
 };
 
 #endif
@@ -21,6 +21,8 @@
 
 #include "DataModelRetainedValueLeaf.h"
 
+#include "etl/string.h"
+
 #include "TenthsUInt16.h"
 
 #include <stdint.h>
@@ -32,13 +34,13 @@ class DataModelTenthsUInt16Leaf : public DataModelRetainedValueLeaf {
    private:
         TenthsUInt16 value;
 
+        virtual void formatValue(etl::istring &valueStr) override;
         virtual void logValue(Logger &logger) override;
 
     public:
         DataModelTenthsUInt16Leaf(const char *name, DataModelNode *parent);
         DataModelTenthsUInt16Leaf & operator = (const TenthsUInt16 &value);
         DataModelTenthsUInt16Leaf & operator = (uint16_t value);
-        virtual void sendRetainedValue(DataModelSubscriber &subscriber) override;
 };
 
 #endif
@@ -21,6 +21,8 @@
 
 #include "DataModelRetainedValueLeaf.h"
 
+#include "etl/string.h"
+
 #include "TenthsUInt32.h"
 
 #include <stdint.h>
@@ -32,13 +34,13 @@ class DataModelTenthsUInt32Leaf : public DataModelRetainedValueLeaf {
    private:
         TenthsUInt32 value;
 
+        virtual void formatValue(etl::istring &valueStr) override;
         virtual void logValue(Logger &logger) override;
 
     public:
         DataModelTenthsUInt32Leaf(const char *name, DataModelNode *parent);
         DataModelTenthsUInt32Leaf & operator = (const TenthsUInt32 &value);
         DataModelTenthsUInt32Leaf & operator = (uint32_t value);
-        virtual void sendRetainedValue(DataModelSubscriber &subscriber) override;
 };
 
 #endif // DATA_MODEL_TENTHS_UINT32_LEAF_H
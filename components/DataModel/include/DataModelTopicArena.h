@@ -0,0 +1,55 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_MODEL_TOPIC_ARENA_H
+#define DATA_MODEL_TOPIC_ARENA_H
+
+#include <freertos/FreeRTOS.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Append-only store for the full topic names of data model elements. Each element's topic is
+// built once, the first time it's needed, and is afterwards referenced by offset and length.
+// Strings are stored NUL terminated so they can be handed out as C strings. Nothing is ever
+// removed, as data model elements live for the life of the program.
+class DataModelTopicArena {
+    private:
+        static constexpr size_t arenaSize = CONFIG_LUNAMON_DATA_MODEL_TOPIC_ARENA_SIZE;
+
+        char arena[arenaSize];
+        size_t used;
+        uint16_t topics;
+        uint16_t failures;
+        portMUX_TYPE lock;
+
+    public:
+        DataModelTopicArena();
+        // Returns false if the arena doesn't have room for the topic.
+        bool intern(const char *prefix, size_t prefixLength, const char *name, size_t nameLength,
+                    uint16_t &offset);
+        const char *topicAt(uint16_t offset) const;
+        size_t size() const;
+        size_t bytesUsed() const;
+        uint16_t topicCount() const;
+        uint16_t internFailures() const;
+};
+
+extern DataModelTopicArena dataModelTopicArena;
+
+#endif // DATA_MODEL_TOPIC_ARENA_H
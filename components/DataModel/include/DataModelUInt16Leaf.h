@@ -21,6 +21,8 @@
 
 #include "DataModelRetainedValueLeaf.h"
 
+#include "etl/string.h"
+
 #include <stdint.h>
 
 class DataModelNode;
@@ -30,6 +32,7 @@ class DataModelUInt16Leaf : public DataModelRetainedValueLeaf {
    private:
         uint16_t value;
 
+        virtual void formatValue(etl::istring &valueStr) override;
         virtual void logValue(Logger &logger) override;
 
     public:
@@ -38,7 +41,6 @@ class DataModelUInt16Leaf : public DataModelRetainedValueLeaf {
         DataModelUInt16Leaf operator ++ (int);
         DataModelUInt16Leaf operator -- (int);
         operator uint16_t() const;
-        virtual void sendRetainedValue(DataModelSubscriber &subscriber) override;
 };
 
 #endif
@@ -0,0 +1,52 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DATA_MODEL_WRITABLE_LEAF_H
+#define DATA_MODEL_WRITABLE_LEAF_H
+
+#include "DataModelStringLeaf.h"
+
+#include "etl/string.h"
+
+class DataModelNode;
+class DataModelWritableLeaf;
+
+// Implemented by the owner of a writable leaf to act on the values clients write to it.
+class DataModelWriteHandler {
+    public:
+        // Called on the task of the client doing the write, with the data model's command lock
+        // held. Returns false if the value isn't acceptable, in which case the leaf keeps its
+        // old value.
+        virtual bool leafWritten(DataModelWritableLeaf &leaf, const char *value) = 0;
+};
+
+// A string leaf that MQTT clients can set by publishing to its topic. Writable leaves belong
+// under the data model's command node and are registered with the data model as they're
+// created. An accepted value becomes the leaf's value, so subscribers see the last command given.
+class DataModelWritableLeaf : public DataModelStringLeaf {
+    private:
+        DataModelWriteHandler &handler;
+
+    public:
+        DataModelWritableLeaf(const char *name, DataModelNode *parent, etl::istring &buffer,
+                              DataModelWriteHandler &handler);
+        bool write(const char *value);
+};
+
+#endif // DATA_MODEL_WRITABLE_LEAF_H
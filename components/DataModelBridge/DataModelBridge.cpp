@@ -37,6 +37,7 @@
 #include "NMEAVHWMessage.h"
 #include "NMEAVTGMessage.h"
 #include "NMEATXTMessage.h"
+#include "NMEALazyMessage.h"
 
 #include "StatCounter.h"
 
@@ -54,73 +55,90 @@ DataModelBridge::DataModelBridge(InstrumentData &instrumentData)
       windBridge(instrumentData) {
 }
 
-void DataModelBridge::processMessage(const NMEAMessage *message) {
-    const NMEAMsgType msgType = message->type();
-    switch (msgType) {
-        case NMEAMsgType::DBK:
-            waterBridge.bridgeNMEADBKMessage((NMEADBKMessage *)message);
-            break;
-
-        case NMEAMsgType::DBS:
-            waterBridge.bridgeNMEADBSMessage((NMEADBSMessage *)message);
-            break;
-
-        case NMEAMsgType::DBT:
-            waterBridge.bridgeNMEADBTMessage((NMEADBTMessage *)message);
-            break;
-
-        case NMEAMsgType::DPT:
-            waterBridge.bridgeNMEADPTMessage((NMEADPTMessage *)message);
-            break;
-
-        case NMEAMsgType::GGA:
-            gpsBridge.bridgeNMEAGGAMessage((NMEAGGAMessage *)message);
-            break;
-
-        case NMEAMsgType::GLL:
-            gpsBridge.bridgeNMEAGLLMessage((NMEAGLLMessage *)message);
-            break;
-
-        case NMEAMsgType::GSA:
-            gpsBridge.bridgeNMEAGSAMessage((NMEAGSAMessage *)message);
-            break;
-
-        case NMEAMsgType::GST:
-            gpsBridge.bridgeNMEAGSTMessage((NMEAGSTMessage *)message);
-            break;
-
-        case NMEAMsgType::HDG:
-            autoPilotBridge.bridgeNMEAHDGMessage((NMEAHDGMessage *)message);
-            break;
-
-        case NMEAMsgType::MTW:
-            waterBridge.bridgeNMEAMTWMessage((NMEAMTWMessage *)message);
-            break;
-
-        case NMEAMsgType::MWV:
-            windBridge.bridgeNMEAMWVMessage((NMEAMWVMessage *)message);
-            break;
-
-        case NMEAMsgType::RMC:
-            gpsBridge.bridgeNMEARMCMessage((NMEARMCMessage *)message);
-            break;
+// The message types bridged, and how. This is the one list of them, giving both what the bridge
+// asks its NMEA interfaces to decode and where each decoded message goes. Types whose messages
+// are only partly bridged are taken lazily, decoding just the fields used.
+const DataModelBridge::BridgedMsgType DataModelBridge::bridgedMsgTypes[] = {
+    { NMEAMsgType::DBK, [](DataModelBridge &bridge, const NMEAMessage *message) {
+        bridge.waterBridge.bridgeNMEADBKMessage((NMEADBKMessage *)message);
+    } },
+    { NMEAMsgType::DBS, [](DataModelBridge &bridge, const NMEAMessage *message) {
+        bridge.waterBridge.bridgeNMEADBSMessage((NMEADBSMessage *)message);
+    } },
+    { NMEAMsgType::DBT, [](DataModelBridge &bridge, const NMEAMessage *message) {
+        bridge.waterBridge.bridgeNMEADBTMessage((NMEADBTMessage *)message);
+    } },
+    { NMEAMsgType::DPT, nullptr, [](DataModelBridge &bridge, NMEALazyMessage &message) {
+        bridge.waterBridge.bridgeNMEADPTMessage(message);
+    } },
+    { NMEAMsgType::GGA, [](DataModelBridge &bridge, const NMEAMessage *message) {
+        bridge.gpsBridge.bridgeNMEAGGAMessage((NMEAGGAMessage *)message);
+    } },
+    { NMEAMsgType::GLL, [](DataModelBridge &bridge, const NMEAMessage *message) {
+        bridge.gpsBridge.bridgeNMEAGLLMessage((NMEAGLLMessage *)message);
+    } },
+    { NMEAMsgType::GSA, [](DataModelBridge &bridge, const NMEAMessage *message) {
+        bridge.gpsBridge.bridgeNMEAGSAMessage((NMEAGSAMessage *)message);
+    } },
+    { NMEAMsgType::GST, [](DataModelBridge &bridge, const NMEAMessage *message) {
+        bridge.gpsBridge.bridgeNMEAGSTMessage((NMEAGSTMessage *)message);
+    } },
+    { NMEAMsgType::HDG, [](DataModelBridge &bridge, const NMEAMessage *message) {
+        bridge.autoPilotBridge.bridgeNMEAHDGMessage((NMEAHDGMessage *)message);
+    } },
+    { NMEAMsgType::MTW, [](DataModelBridge &bridge, const NMEAMessage *message) {
+        bridge.waterBridge.bridgeNMEAMTWMessage((NMEAMTWMessage *)message);
+    } },
+    { NMEAMsgType::MWV, [](DataModelBridge &bridge, const NMEAMessage *message) {
+        bridge.windBridge.bridgeNMEAMWVMessage((NMEAMWVMessage *)message);
+    } },
+    { NMEAMsgType::RMC, [](DataModelBridge &bridge, const NMEAMessage *message) {
+        bridge.gpsBridge.bridgeNMEARMCMessage((NMEARMCMessage *)message);
+    } },
+    { NMEAMsgType::RSA, [](DataModelBridge &bridge, const NMEAMessage *message) {
+        bridge.autoPilotBridge.bridgeNMEARSAMessage((NMEARSAMessage *)message);
+    } },
+    { NMEAMsgType::VHW, [](DataModelBridge &bridge, const NMEAMessage *message) {
+        bridge.waterBridge.bridgeNMEAVHWMessage((NMEAVHWMessage *)message);
+    } },
+    { NMEAMsgType::VTG, [](DataModelBridge &bridge, const NMEAMessage *message) {
+        bridge.gpsBridge.bridgeNMEAVTGMessage((NMEAVTGMessage *)message);
+    } },
+    { NMEAMsgType::TXT, [](DataModelBridge &bridge, const NMEAMessage *message) {
+        bridge.logTXTMessage((NMEATXTMessage *)message);
+    } }
+};
+
+const DataModelBridge::BridgedMsgType *DataModelBridge::findBridgedMsgType(
+        NMEAMsgType::Value msgType) {
+    for (const BridgedMsgType &bridgedMsgType : bridgedMsgTypes) {
+        if (bridgedMsgType.msgType == msgType) {
+            return &bridgedMsgType;
+        }
+    }
 
-        case NMEAMsgType::RSA:
-            autoPilotBridge.bridgeNMEARSAMessage((NMEARSAMessage *)message);
-            break;
+    return nullptr;
+}
 
-        case NMEAMsgType::VHW:
-            waterBridge.bridgeNMEAVHWMessage((NMEAVHWMessage *)message);
-            break;
+bool DataModelBridge::decodesMsgType(NMEAMsgType::Value msgType) const {
+    const BridgedMsgType *bridgedMsgType = findBridgedMsgType(msgType);
+    return bridgedMsgType != nullptr && bridgedMsgType->bridge != nullptr;
+}
 
-        case NMEAMsgType::VTG:
-            gpsBridge.bridgeNMEAVTGMessage((NMEAVTGMessage *)message);
-            break;
+bool DataModelBridge::decodesMsgTypeLazily(NMEAMsgType::Value msgType) const {
+    const BridgedMsgType *bridgedMsgType = findBridgedMsgType(msgType);
+    return bridgedMsgType != nullptr && bridgedMsgType->bridgeLazily != nullptr;
+}
 
-        case NMEAMsgType::TXT:
-            logTXTMessage((NMEATXTMessage *)message);
-            break;
+void DataModelBridge::processMessage(const NMEAMessage *message) {
+    const NMEAMsgType msgType = message->type();
+    const BridgedMsgType *bridgedMsgType = findBridgedMsgType(msgType);
+    if (bridgedMsgType != nullptr && bridgedMsgType->bridge != nullptr) {
+        bridgedMsgType->bridge(*this, message);
+        return;
+    }
 
+    switch (msgType) {
         case NMEAMsgType::GSV:
         case NMEAMsgType::VDM:
         case NMEAMsgType::VDO:
@@ -135,6 +153,13 @@ void DataModelBridge::processMessage(const NMEAMessage *message) {
     }
 }
 
+void DataModelBridge::processLazyMessage(NMEALazyMessage &message) {
+    const BridgedMsgType *bridgedMsgType = findBridgedMsgType(message.type());
+    if (bridgedMsgType != nullptr && bridgedMsgType->bridgeLazily != nullptr) {
+        bridgedMsgType->bridgeLazily(*this, message);
+    }
+}
+
 void DataModelBridge::logTXTMessage(NMEATXTMessage *message) {
     // While we don't have a way of making TXT messages available in the DataModel, we output them
     // as info log messages here to aid in debugging. Later we could trade some memory for a way to
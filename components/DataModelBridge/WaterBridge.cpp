@@ -23,11 +23,12 @@
 #include "NMEADBKMessage.h"
 #include "NMEADBSMessage.h"
 #include "NMEADBTMessage.h"
-#include "NMEADPTMessage.h"
 #include "NMEAMTWMessage.h"
 #include "NMEAVHWMessage.h"
+#include "NMEALazyMessage.h"
 #include "NMEATemperatureUnits.h"
 #include "NMEATenthsInt16.h"
+#include "NMEATenthsUInt16.h"
 
 #include "DataModelNode.h"
 #include "DataModelTenthsInt16Leaf.h"
@@ -63,15 +64,23 @@ void WaterBridge::bridgeNMEADBTMessage(const NMEADBTMessage *message) {
     waterData.endUpdates();
 }
 
-void WaterBridge::bridgeNMEADPTMessage(const NMEADPTMessage *message) {
+// DPT is taken lazily, as the max range scale that ends newer messages isn't bridged.
+void WaterBridge::bridgeNMEADPTMessage(NMEALazyMessage &message) {
+    NMEATenthsUInt16 depthBelowTransducer;
+    NMEATenthsInt16 transducerOffset;
+    if (!message.decodeField(0, depthBelowTransducer, "DPT", "Depth") ||
+        !message.decodeField(1, transducerOffset, "DPT", "Transducer Offset")) {
+        return;
+    }
+
     waterData.beginUpdates();
-    message->depthBelowTransducerMeters.publish(waterData.depthBelowTransducerMetersLeaf);
+    depthBelowTransducer.publish(waterData.depthBelowTransducerMetersLeaf);
 
     // The transducer offset field in this message is a little wonky as it can indicate either
     // a distance from the transducer to the keel or a distance from the transducer to the water
     // line, indicated by the sign.
-    TenthsUInt16 depthBelowTransducerMeters = message->depthBelowTransducerMeters;
-    TenthsInt16 transducerOffsetMeters = message->transducerOffsetMeters;
+    TenthsUInt16 depthBelowTransducerMeters = depthBelowTransducer;
+    TenthsInt16 transducerOffsetMeters = transducerOffset;
     if (transducerOffsetMeters < 0) {
         TenthsInt16 depthBelowKeelMeters;
         depthBelowKeelMeters = depthBelowTransducerMeters - transducerOffsetMeters.abs();
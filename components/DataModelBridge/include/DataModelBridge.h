@@ -20,6 +20,7 @@
 #define DATA_MODEL_BRIDGE_H
 
 #include "NMEAMessageHandler.h"
+#include "NMEAMsgType.h"
 
 #include "AutoPilotBridge.h"
 #include "GPSBridge.h"
@@ -29,19 +30,33 @@
 class InstrumentData;
 class NMEAMessage;
 class NMEATXTMessage;
+class NMEALazyMessage;
 
 class DataModelBridge : public NMEAMessageHandler {
     private:
+        struct BridgedMsgType {
+            NMEAMsgType::Value msgType;
+            // Only one of these is set, bridgeLazily for types taken lazily.
+            void (*bridge)(DataModelBridge &bridge, const NMEAMessage *message);
+            void (*bridgeLazily)(DataModelBridge &bridge, NMEALazyMessage &message);
+        };
+
+        static const BridgedMsgType bridgedMsgTypes[];
+
         AutoPilotBridge autoPilotBridge;
         GPSBridge gpsBridge;
         WaterBridge waterBridge;
         WindBridge windBridge;
 
+        static const BridgedMsgType *findBridgedMsgType(NMEAMsgType::Value msgType);
         void logTXTMessage(NMEATXTMessage *message);
 
     public:
         DataModelBridge(InstrumentData &instrumentData);
+        virtual bool decodesMsgType(NMEAMsgType::Value msgType) const override;
         virtual void processMessage(const NMEAMessage *message) override;
+        virtual bool decodesMsgTypeLazily(NMEAMsgType::Value msgType) const override;
+        virtual void processLazyMessage(NMEALazyMessage &message) override;
 };
 
 #endif // DATA_MODEL_BRIDGE_H
@@ -24,9 +24,9 @@ class WaterData;
 class NMEADBKMessage;
 class NMEADBSMessage;
 class NMEADBTMessage;
-class NMEADPTMessage;
 class NMEAMTWMessage;
 class NMEAVHWMessage;
+class NMEALazyMessage;
 
 class WaterBridge {
     private:
@@ -37,7 +37,7 @@ class WaterBridge {
         void bridgeNMEADBKMessage(const NMEADBKMessage *message);
         void bridgeNMEADBSMessage(const NMEADBSMessage *message);
         void bridgeNMEADBTMessage(const NMEADBTMessage *message);
-        void bridgeNMEADPTMessage(const NMEADPTMessage *message);
+        void bridgeNMEADPTMessage(NMEALazyMessage &message);
         void bridgeNMEAMTWMessage(const NMEAMTWMessage *message);
         void bridgeNMEAVHWMessage(const NMEAVHWMessage *message);
 };
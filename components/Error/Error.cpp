@@ -22,6 +22,8 @@
 
 #include "esp_log.h"
 
+#include <stdlib.h>
+
 void fatalError(const char *errorMsg) {
     ESP_LOGE("Util", "%s", errorMsg);
     errorExit();
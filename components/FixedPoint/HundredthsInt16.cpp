@@ -18,10 +18,10 @@
 
 #include "HundredthsInt16.h"
 
+#include "NumberFormat.h"
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/string_stream.h"
 
 HundredthsInt16::HundredthsInt16() : _integer(0), _hundredths(0) {
 }
@@ -67,9 +67,9 @@ HundredthsInt16 HundredthsInt16::operator/(uint32_t divider) {
 }
 
 void HundredthsInt16::toString(etl::istring &string) const {
-    etl::string_stream stringStream(string);
-
-    stringStream << _integer << "." << etl::setfill(0) << etl::setw(2) << _hundredths;
+    char buffer[maxFixedPointFormatLength];
+    const size_t length = formatFixedPoint(buffer, (int32_t)_integer, _hundredths, 2);
+    string.append(buffer, length);
 }
 
 // Doesn't honor base changes, but do they really makes sense for this type?
@@ -18,10 +18,10 @@
 
 #include "HundredthsUInt32.h"
 
+#include "NumberFormat.h"
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/string_stream.h"
 
 HundredthsUInt32::HundredthsUInt32() : _wholeNumber(0), _hundredths(0) {
 }
@@ -62,9 +62,9 @@ HundredthsUInt32 HundredthsUInt32::operator/ (uint32_t divider) {
 }
 
 void HundredthsUInt32::toString(etl::istring &string) const {
-    etl::string_stream stringStream(string);
-
-    stringStream << _wholeNumber << "." << etl::setfill(0) << etl::setw(2) << _hundredths;
+    char buffer[maxFixedPointFormatLength];
+    const size_t length = formatFixedPoint(buffer, (uint32_t)_wholeNumber, _hundredths, 2);
+    string.append(buffer, length);
 }
 
 // Doesn't honor base changes, but do they really makes sense for this type?
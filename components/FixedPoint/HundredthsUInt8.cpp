@@ -18,10 +18,10 @@
 
 #include "HundredthsUInt8.h"
 
+#include "NumberFormat.h"
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/string_stream.h"
 
 HundredthsUInt8::HundredthsUInt8() : _wholeNumber(0), _hundredths(0) {
 }
@@ -60,9 +60,9 @@ void HundredthsUInt8::setFromQ22Dot10(uint32_t q22Dot10) {
 }
 
 void HundredthsUInt8::toString(etl::istring &string) const {
-    etl::string_stream stringStream(string);
-
-    stringStream << _wholeNumber << "." << etl::setfill(0) << etl::setw(2) << _hundredths;
+    char buffer[maxFixedPointFormatLength];
+    const size_t length = formatFixedPoint(buffer, (uint32_t)_wholeNumber, _hundredths, 2);
+    string.append(buffer, length);
 }
 
 // Doesn't honor base changes, but do they really makes sense for this type?
@@ -19,12 +19,13 @@
 #include "TenthsInt16.h"
 #include "TenthsUInt16.h"
 
+#include "NumberFormat.h"
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/string_stream.h"
 
 #include <stdint.h>
+#include <stddef.h>
 
 TenthsInt16::TenthsInt16() : _integer(0), _tenths(0) {
 }
@@ -116,9 +117,9 @@ bool TenthsInt16::operator <(int16_t value) {
 
 
 void TenthsInt16::toString(etl::istring &string) const {
-    etl::string_stream stringStream(string);
-
-    stringStream << _integer << "." << _tenths;
+    char buffer[maxFixedPointFormatLength];
+    const size_t length = formatFixedPoint(buffer, (int32_t)_integer, _tenths, 1);
+    string.append(buffer, length);
 }
 
 // Doesn't honor base changes, but do they really makes sense for this type?
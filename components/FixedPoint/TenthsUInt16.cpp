@@ -21,12 +21,13 @@
 #include "TenthsUInt32.h"
 #include "HundredthsUInt16.h"
 
+#include "NumberFormat.h"
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/string_stream.h"
 
 #include <stdint.h>
+#include <stddef.h>
 
 TenthsUInt16::TenthsUInt16() : _wholeNumber(0), _tenths(0) {
 }
@@ -123,9 +124,9 @@ TenthsUInt16 TenthsUInt16::operator/(uint32_t divider) const {
 }
 
 void TenthsUInt16::toString(etl::istring &string) const {
-    etl::string_stream stringStream(string);
-
-    stringStream << _wholeNumber << "." << _tenths;
+    char buffer[maxFixedPointFormatLength];
+    const size_t length = formatFixedPoint(buffer, (uint32_t)_wholeNumber, _tenths, 1);
+    string.append(buffer, length);
 }
 
 // Doesn't honor base changes, but do they really makes sense for this type?
@@ -19,12 +19,13 @@
 #include "TenthsUInt32.h"
 #include "TenthsUInt16.h"
 
+#include "NumberFormat.h"
 #include "Logger.h"
 
 #include "etl/string.h"
-#include "etl/string_stream.h"
 
 #include <stdint.h>
+#include <stddef.h>
 
 TenthsUInt32::TenthsUInt32() : _wholeNumber(0), _tenths(0) {
 }
@@ -99,9 +100,9 @@ TenthsUInt32 TenthsUInt32::operator/(uint32_t divider) const {
 }
 
 void TenthsUInt32::toString(etl::istring &string) const {
-    etl::string_stream stringStream(string);
-
-    stringStream << _wholeNumber << "." << _tenths;
+    char buffer[maxFixedPointFormatLength];
+    const size_t length = formatFixedPoint(buffer, (uint32_t)_wholeNumber, _tenths, 1);
+    string.append(buffer, length);
 }
 
 // Doesn't honor base changes, but do they really makes sense for this type?
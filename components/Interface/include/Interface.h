@@ -59,9 +59,8 @@ class Interface : public TaskObject, StatsHolder {
         DataModelUInt32Leaf outputByteRateLeaf;
         SemaphoreHandle_t writeLock;
 
-        virtual void exportStats(uint32_t msElapsed) override;
-
     protected:
+        virtual void exportStats(uint32_t msElapsed) override;
         void takeWriteLock();
         void releaseWriteLock();
 
@@ -17,6 +17,7 @@
  */
 
 #include "Logger.h"
+#include "NumberFormat.h"
 #include "LoggableItem.h"
 
 #include "Error.h"
@@ -171,8 +172,8 @@ Logger & Logger::operator << (uint8_t value) {
     if (outputCurrentLine) {
         switch (base) {
             case Dec:
-                char decimalStr[4];
-                snprintf(decimalStr, 4, "%u", value);
+                char decimalStr[maxUInt32FormatLength + 1];
+                decimalStr[formatUInt32(decimalStr, value)] = 0;
                 logString(decimalStr);
                 break;
 
@@ -194,8 +195,8 @@ Logger & Logger::operator << (uint16_t value) {
     if (outputCurrentLine) {
         switch (base) {
             case Dec:
-                char decimalStr[6];
-                snprintf(decimalStr, 6, "%u", value);
+                char decimalStr[maxUInt32FormatLength + 1];
+                decimalStr[formatUInt32(decimalStr, value)] = 0;
                 logString(decimalStr);
                 break;
 
@@ -213,12 +214,12 @@ Logger & Logger::operator << (uint16_t value) {
     return *this;
 }
 
-Logger & Logger::operator << (uint32_t value) {
+Logger & Logger::operator << (unsigned long value) {
     if (outputCurrentLine) {
         switch (base) {
             case Dec:
-                char decimalStr[11];
-                snprintf(decimalStr, 11, "%lu", value);
+                char decimalStr[maxUInt32FormatLength + 1];
+                decimalStr[formatUInt32(decimalStr, value)] = 0;
                 logString(decimalStr);
                 break;
 
@@ -240,8 +241,8 @@ Logger & Logger::operator << (unsigned value) {
     if (outputCurrentLine) {
         switch (base) {
             case Dec:
-                char decimalStr[11];
-                snprintf(decimalStr, 11, "%u", value);
+                char decimalStr[maxUInt32FormatLength + 1];
+                decimalStr[formatUInt32(decimalStr, value)] = 0;
                 logString(decimalStr);
                 break;
 
@@ -263,8 +264,8 @@ Logger & Logger::operator << (int16_t value) {
     if (outputCurrentLine) {
         switch (base) {
             case Dec:
-                char decimalStr[12];
-                snprintf(decimalStr, 12, "%d", value);
+                char decimalStr[maxInt32FormatLength + 1];
+                decimalStr[formatInt32(decimalStr, value)] = 0;
                 logString(decimalStr);
                 break;
 
@@ -282,12 +283,12 @@ Logger & Logger::operator << (int16_t value) {
     return *this;
 }
 
-Logger & Logger::operator << (int32_t value) {
+Logger & Logger::operator << (long value) {
     if (outputCurrentLine) {
         switch (base) {
             case Dec:
-                char decimalStr[16];
-                snprintf(decimalStr, 16, "%ld", value);
+                char decimalStr[maxInt32FormatLength + 1];
+                decimalStr[formatInt32(decimalStr, value)] = 0;
                 logString(decimalStr);
                 break;
 
@@ -309,8 +310,8 @@ Logger & Logger::operator << (int value) {
     if (outputCurrentLine) {
         switch (base) {
             case Dec:
-                char decimalStr[12];
-                snprintf(decimalStr, 12, "%d", value);
+                char decimalStr[maxInt32FormatLength + 1];
+                decimalStr[formatInt32(decimalStr, value)] = 0;
                 logString(decimalStr);
                 break;
 
@@ -258,10 +258,13 @@ class Logger {
         Logger & operator << (const etl::string_view &stringView);
         Logger & operator << (uint8_t value);
         Logger & operator << (uint16_t value);
-        Logger & operator << (uint32_t value);
+        // uint32_t and int32_t are unsigned long and long on the ESP32 but unsigned and int on a
+        // 64 bit host, so the 32 bit overloads are spelled out to stay distinct from unsigned and
+        // int on both.
+        Logger & operator << (unsigned long value);
         Logger & operator << (unsigned value);
         Logger & operator << (int16_t value);
-        Logger & operator << (int32_t value);
+        Logger & operator << (long value);
         Logger & operator << (int value);
         Logger & operator << (bool value);
         Logger & operator << (float value);
@@ -32,26 +32,49 @@
 #include "etl/intrusive_links.h"
 #include "etl/intrusive_list.h"
 
+#include "etl/algorithm.h"
+
 #include <lwip/sockets.h>
+#include <sys/select.h>
 
 #include <freertos/semphr.h>
 
 #include <stdint.h>
+#include <errno.h>
+#include <string.h>
 
 MQTTBroker::MQTTBroker(WiFiManager &wifiManager, DataModel &dataModel, StatsManager &statsManager)
     : TaskObject("MQTTBroker", LOGGER_LEVEL_DEBUG, stackSize),
       WiFiManagerClient(wifiManager),
+      wakeupSocket(-1),
+      wakeupPending(false),
       clientsNode("clients", &dataModel.brokerNode()),
       connectedClientsLeaf("connected", &clientsNode),
       disconnectedClientsLeaf("disconnected", &clientsNode),
       maximumClientsLeaf("maximum", &clientsNode),
       totalClientsLeaf("total", &clientsNode),
+      keepAliveExpirationsLeaf("keepAliveExpirations", &clientsNode),
       messagesReceivedLeaf("received", &dataModel.messagesNode()),
       messagesSentLeaf("sent", &dataModel.messagesNode()),
+      receivesLeaf("receives", &dataModel.messagesNode()),
       publishNode("publish", &dataModel.messagesNode()),
       publishReceivedLeaf("received", &publishNode),
       publishSentLeaf("sent", &publishNode),
       publishDroppedLeaf("dropped", &publishNode),
+      publishCoalescedLeaf("coalesced", &publishNode),
+      publishInFlightLeaf("inFlight", &publishNode),
+      publishRetransmitsLeaf("retransmits", &publishNode),
+      publishLockNode("lock", &publishNode),
+      publishLockAcquisitionsLeaf("acquisitions", &publishLockNode),
+      publishLockContentionsLeaf("contentions", &publishLockNode),
+      publishLockWaitUsLeaf("waitUs", &publishLockNode),
+      publishLockMaxWaitUsLeaf("maxWaitUs", &publishLockNode),
+      flushesNode("flushes", &dataModel.messagesNode()),
+      flushesCountLeaf("count", &flushesNode),
+      flushesRateLeaf("rate", &flushesNode),
+      bytesPerFlushLeaf("bytesPerFlush", &flushesNode),
+      lastFlushTotal(0),
+      lastBytesFlushedTotal(0),
       connectionsNode("connections", &dataModel.brokerNode()),
       connection1IDLeaf("1", &connectionsNode, connection1IDBuffer),
       connection2IDLeaf("2", &connectionsNode, connection2IDBuffer),
@@ -79,8 +102,8 @@ MQTTBroker::MQTTBroker(WiFiManager &wifiManager, DataModel &dataModel, StatsMana
     }
 
     // We preallocate the maximum number connections to avoid allocating and freeing them as clients
-    // come and go. Each connection has a task, which we fire up now, putting it in a wait state for
-    // when we later assign a socket to it.
+    // come and go. With the threaded engine each connection has a task, which we fire up now,
+    // putting it in a wait state for when we later assign a socket to it.
     takeConnectionLock();
     for (unsigned connectionId = 1; connectionId <= maxMQTTConnections; connectionId++) {
         MQTTConnection *connection = new MQTTConnection(*this, connectionId);
@@ -91,13 +114,14 @@ MQTTBroker::MQTTBroker(WiFiManager &wifiManager, DataModel &dataModel, StatsMana
 
         connectionIndex[connectionId] = connection;
         idleConnections.push_back(*connection);
-        connection->start();
+        if (mqttBrokerEngine == MQTT_BROKER_THREADED) {
+            connection->start();
+        }
     }
     releaseConnectionLock();
 
-    // We preallocate the maximum number connections to avoid allocating and freeing them as clients
-    // come and go. Each connection has a task, which we fire up now, putting it in a wait state for
-    // when we later assign a connection to it.
+    // Sessions are preallocated in the same way, and with the threaded engine also each have a
+    // task waiting for when we later assign a connection to it.
     takeSessionLock();
     for (unsigned sessionId = 1; sessionId <= maxMQTTSessions; sessionId++) {
         MQTTSession *session = new MQTTSession(*this, dataModel, sessionId);
@@ -105,8 +129,11 @@ MQTTBroker::MQTTBroker(WiFiManager &wifiManager, DataModel &dataModel, StatsMana
             logger << logErrorMQTT << "Failed to allocation session " << sessionId << eol;
             errorExit();
         }
+        sessionIndex[sessionId] = session;
         freeSessions.push_back(*session);
-        session->start();
+        if (mqttBrokerEngine == MQTT_BROKER_THREADED) {
+            session->start();
+        }
     }
     releaseSessionLock();
 
@@ -131,18 +158,167 @@ void MQTTBroker::task() {
     logger << logNotifyMQTT << "MQTT Broker listening for connections on port " << serverPort
            << eol;
 
+    if (mqttBrokerEngine == MQTT_BROKER_EVENT_LOOP) {
+        createWakeupSocket();
+        runEventLoop();
+    } else {
+        acceptConnections();
+    }
+}
+
+void MQTTBroker::acceptConnections() {
     while (1) {
-        struct sockaddr_in sourceAddr;
-        socklen_t sourceAddrLength = sizeof(sourceAddr);
-        int connectionSocket = accept(serverSocket, (struct sockaddr *)&sourceAddr,
-                                      &sourceAddrLength);
-        if (connectionSocket < 0) {
-            logger << logWarnMQTT << "Unable to accept MQTT connection: " << strerror(errno) << eol;
-            continue;
+        acceptConnection();
+        _keepAliveWheel.advance();
+    }
+}
+
+void MQTTBroker::acceptConnection() {
+    struct sockaddr_in sourceAddr;
+    socklen_t sourceAddrLength = sizeof(sourceAddr);
+    int connectionSocket = accept(serverSocket, (struct sockaddr *)&sourceAddr,
+                                  &sourceAddrLength);
+    if (connectionSocket < 0) {
+        // With the threaded engine accepts time out so that the keep-alive wheel gets advanced.
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            logger << logWarnMQTT << "Unable to accept MQTT connection: " << strerror(errno)
+                   << eol;
+        }
+        return;
+    }
+
+    newConnection(connectionSocket, sourceAddr, sourceAddrLength);
+}
+
+// The event loop engine. The broker's task owns the listening socket and every client socket,
+// doing the work that the threaded engine spreads across connection and session tasks. Only this
+// task adds connections to or removes them from the active list, so it can walk the list without
+// the connection lock.
+void MQTTBroker::runEventLoop() {
+    while (true) {
+        fd_set readSockets;
+        fd_set writeSockets;
+        const int maxSocket = addEventLoopSockets(readSockets, writeSockets);
+
+        struct timeval timeout;
+        timeout.tv_sec = eventLoopTickMs / 1000;
+        timeout.tv_usec = (eventLoopTickMs % 1000) * 1000;
+        const int readySockets = select(maxSocket + 1, &readSockets, &writeSockets, nullptr,
+                                        &timeout);
+        if (readySockets < 0 && errno != EINTR) {
+            logger << logWarnMQTT << "MQTT Broker select failed: " << strerror(errno) << eol;
+        }
+
+        if (readySockets > 0) {
+            if (FD_ISSET(wakeupSocket, &readSockets)) {
+                drainWakeupSocket();
+            }
+
+            if (FD_ISSET(serverSocket, &readSockets)) {
+                acceptConnection();
+            }
+
+            // Connections are gone through by id rather than by list as a connection can go idle
+            // while receiving.
+            for (unsigned connectionId = 1; connectionId <= maxMQTTConnections; connectionId++) {
+                MQTTConnection *connection = connectionIndex[connectionId];
+                if (connection->isOpen() && FD_ISSET(connection->socket(), &readSockets)) {
+                    connection->receive();
+                }
+            }
+        }
+
+        _keepAliveWheel.advance();
+
+        // Sessions pick up publishes queued by other tasks, flush their outgoing buffers when
+        // they're due or when their sockets have become writable, and act on connections being
+        // lost. Connections then act on any disconnects the sessions asked for.
+        for (unsigned sessionId = 1; sessionId <= maxMQTTSessions; sessionId++) {
+            sessionIndex[sessionId]->service();
         }
+        for (unsigned connectionId = 1; connectionId <= maxMQTTConnections; connectionId++) {
+            connectionIndex[connectionId]->service();
+        }
+    }
+}
+
+// lwIP has no pipes, so the wakeup socket is a UDP socket on the loopback interface, bound to an
+// ephemeral port and then connected to that same port.
+void MQTTBroker::createWakeupSocket() {
+    if ((wakeupSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) < 0) {
+        logger << logErrorMQTT << "Failed to create MQTT wakeup socket: " << strerror(errno) << eol;
+        errorExit();
+    }
 
-        newConnection(connectionSocket, sourceAddr, sourceAddrLength);
+    struct sockaddr_in wakeupAddr;
+    memset(&wakeupAddr, 0, sizeof(wakeupAddr));
+    wakeupAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    wakeupAddr.sin_family = AF_INET;
+    wakeupAddr.sin_port = 0;
+    socklen_t wakeupAddrLength = sizeof(wakeupAddr);
+
+    if (bind(wakeupSocket, (struct sockaddr *)&wakeupAddr, sizeof(wakeupAddr)) != 0 ||
+        getsockname(wakeupSocket, (struct sockaddr *)&wakeupAddr, &wakeupAddrLength) != 0 ||
+        connect(wakeupSocket, (struct sockaddr *)&wakeupAddr, wakeupAddrLength) != 0) {
+        logger << logErrorMQTT << "Failed to set up MQTT wakeup socket: " << strerror(errno)
+               << eol;
+        errorExit();
     }
+
+    logger << logDebugMQTT << "MQTT wakeup socket bound to port " << ntohs(wakeupAddr.sin_port)
+           << eol;
+}
+
+// The pending flag is cleared before the socket is drained, so a wakeup sent while draining
+// leaves a datagram behind for the next select() rather than being lost. Either way, the
+// notification that went with it is picked up by this pass's servicing of the sessions.
+void MQTTBroker::drainWakeupSocket() {
+    wakeupPending.store(false);
+
+    uint8_t wakeups[16];
+    while (recv(wakeupSocket, wakeups, sizeof(wakeups), MSG_DONTWAIT) > 0) {
+    }
+}
+
+// Called by sessions with the event loop engine after they've been notified, from whichever task
+// did the notifying.
+void MQTTBroker::wakeEventLoop() {
+    if (wakeupSocket < 0 || wakeupPending.exchange(true)) {
+        return;
+    }
+
+    const uint8_t wakeup = 0;
+    if (send(wakeupSocket, &wakeup, sizeof(wakeup), MSG_DONTWAIT) < 0) {
+        // The loop still gets to the notification on its next tick.
+        wakeupPending.store(false);
+    }
+}
+
+// Returns the highest numbered socket added.
+int MQTTBroker::addEventLoopSockets(fd_set &readSockets, fd_set &writeSockets) {
+    FD_ZERO(&readSockets);
+    FD_ZERO(&writeSockets);
+
+    FD_SET(serverSocket, &readSockets);
+    FD_SET(wakeupSocket, &readSockets);
+    int maxSocket = etl::max(serverSocket, wakeupSocket);
+
+    for (MQTTConnection &connection : activeConnections) {
+        if (connection.isOpen()) {
+            FD_SET(connection.socket(), &readSockets);
+            maxSocket = etl::max(maxSocket, connection.socket());
+        }
+    }
+
+    // Sessions whose clients weren't keeping up are woken as soon as there's room to send more.
+    for (MQTTSession &session : activeSessions) {
+        if (session.isOutgoingBacklogged()) {
+            FD_SET(session.socket(), &writeSockets);
+            maxSocket = etl::max(maxSocket, session.socket());
+        }
+    }
+
+    return maxSocket;
 }
 
 void MQTTBroker::createServerSocket() {
@@ -172,6 +348,13 @@ void MQTTBroker::createServerSocket() {
         logger << logErrorMQTT << "Listen failed on MQTT server socket: " << strerror(errno) << eol;
         errorExit();
     }
+
+    if (mqttBrokerEngine == MQTT_BROKER_THREADED) {
+        struct timeval acceptTimeout;
+        acceptTimeout.tv_sec = acceptTimeoutMs / 1000;
+        acceptTimeout.tv_usec = (acceptTimeoutMs % 1000) * 1000;
+        setsockopt(serverSocket, SOL_SOCKET, SO_RCVTIMEO, &acceptTimeout, sizeof(acceptTimeout));
+    }
 }
 
 void MQTTBroker::newConnection(int connectionSocket, struct sockaddr_in &sourceAddr,
@@ -333,6 +516,10 @@ void MQTTBroker::sessionLostConnection(MQTTSession &session) {
     releaseSessionLock();
 }
 
+MQTTKeepAliveWheel &MQTTBroker::keepAliveWheel() {
+    return _keepAliveWheel;
+}
+
 void MQTTBroker::closeConnectionSocket(int connectionSocket) {
     shutdown(connectionSocket, SHUT_RDWR);
     close(connectionSocket);
@@ -343,20 +530,31 @@ void MQTTBroker::initClientStats() {
     disconnectedClientsLeaf = 0;
     maximumClientsLeaf = 0;
     totalClientsLeaf = 0;
+    keepAliveExpirationsLeaf = 0;
 }
 
 void MQTTBroker::exportStats(uint32_t msElapsed) {
-    exportMessageStats();
+    exportMessageStats(msElapsed);
     exportConnectionInfo();
     exportSessionInfo();
 }
 
-void MQTTBroker::exportMessageStats() {
+void MQTTBroker::exportMessageStats(uint32_t msElapsed) {
     uint32_t received = 0;
     uint32_t sent = 0;
+    uint32_t receives = 0;
     uint32_t publishReceived = 0;
     uint32_t publishSent = 0;
     uint32_t publishDropped = 0;
+    uint32_t publishCoalesced = 0;
+    uint32_t publishInFlight = 0;
+    uint32_t publishRetransmits = 0;
+    uint32_t publishLockAcquisitions = 0;
+    uint32_t publishLockContentions = 0;
+    uint32_t publishLockWaitUs = 0;
+    uint32_t publishLockMaxWaitUs = 0;
+    uint32_t flushTotal = 0;
+    uint32_t bytesFlushedTotal = 0;
 
     // We loop through both active and inactive connections and sessions when we gather sent message
     // counts sine what we want is the accumulation since broker startup and not stats about active
@@ -364,9 +562,11 @@ void MQTTBroker::exportMessageStats() {
     takeConnectionLock();
     for (MQTTConnection &activeConnection : activeConnections) {
         sent += activeConnection.messagesSent();
+        receives += activeConnection.receives();
     }
     for (MQTTConnection &idleConnection : idleConnections) {
         sent += idleConnection.messagesSent();
+        receives += idleConnection.receives();
     }
     releaseConnectionLock();
 
@@ -377,6 +577,15 @@ void MQTTBroker::exportMessageStats() {
         publishReceived += activeSession.publishMessagesReceived();
         publishSent += activeSession.publishMessagesSent();
         publishDropped += activeSession.publishMessagesDropped();
+        publishCoalesced += activeSession.publishMessagesCoalesced();
+        publishInFlight += activeSession.inFlightPublishes();
+        publishRetransmits += activeSession.retransmits();
+        publishLockAcquisitions += activeSession.publishLockAcquisitions();
+        publishLockContentions += activeSession.publishLockContentions();
+        publishLockWaitUs += activeSession.publishLockWaitUs();
+        publishLockMaxWaitUs = etl::max(publishLockMaxWaitUs, activeSession.publishLockMaxWaitUs());
+        flushTotal += activeSession.flushes();
+        bytesFlushedTotal += activeSession.bytesFlushed();
     }
     for (MQTTSession &disconnectedSession : disconnectedSessions) {
         received += disconnectedSession.messagesReceived();
@@ -384,6 +593,16 @@ void MQTTBroker::exportMessageStats() {
         publishReceived += disconnectedSession.publishMessagesReceived();
         publishSent += disconnectedSession.publishMessagesSent();
         publishDropped += disconnectedSession.publishMessagesDropped();
+        publishCoalesced += disconnectedSession.publishMessagesCoalesced();
+        publishInFlight += disconnectedSession.inFlightPublishes();
+        publishRetransmits += disconnectedSession.retransmits();
+        publishLockAcquisitions += disconnectedSession.publishLockAcquisitions();
+        publishLockContentions += disconnectedSession.publishLockContentions();
+        publishLockWaitUs += disconnectedSession.publishLockWaitUs();
+        publishLockMaxWaitUs = etl::max(publishLockMaxWaitUs,
+                                        disconnectedSession.publishLockMaxWaitUs());
+        flushTotal += disconnectedSession.flushes();
+        bytesFlushedTotal += disconnectedSession.bytesFlushed();
     }
     for (MQTTSession &freeSession : freeSessions) {
         received += freeSession.messagesReceived();
@@ -391,14 +610,45 @@ void MQTTBroker::exportMessageStats() {
         publishReceived += freeSession.publishMessagesReceived();
         publishSent += freeSession.publishMessagesSent();
         publishDropped += freeSession.publishMessagesDropped();
+        publishCoalesced += freeSession.publishMessagesCoalesced();
+        publishInFlight += freeSession.inFlightPublishes();
+        publishRetransmits += freeSession.retransmits();
+        publishLockAcquisitions += freeSession.publishLockAcquisitions();
+        publishLockContentions += freeSession.publishLockContentions();
+        publishLockWaitUs += freeSession.publishLockWaitUs();
+        publishLockMaxWaitUs = etl::max(publishLockMaxWaitUs, freeSession.publishLockMaxWaitUs());
+        flushTotal += freeSession.flushes();
+        bytesFlushedTotal += freeSession.bytesFlushed();
     }
     releaseSessionLock();
 
     messagesReceivedLeaf = received;
     messagesSentLeaf = sent;
+    receivesLeaf = receives;
     publishReceivedLeaf = publishReceived;
     publishSentLeaf = publishSent;
     publishDroppedLeaf = publishDropped;
+    publishCoalescedLeaf = publishCoalesced;
+    publishInFlightLeaf = publishInFlight;
+    publishRetransmitsLeaf = publishRetransmits;
+    publishLockAcquisitionsLeaf = publishLockAcquisitions;
+    publishLockContentionsLeaf = publishLockContentions;
+    publishLockWaitUsLeaf = publishLockWaitUs;
+    publishLockMaxWaitUsLeaf = publishLockMaxWaitUs;
+
+    // Bytes per flush is reported for the last stats interval so that it reflects how well
+    // batching is doing now rather than since startup.
+    const uint32_t intervalFlushes = flushTotal - lastFlushTotal;
+    const uint32_t intervalBytesFlushed = bytesFlushedTotal - lastBytesFlushedTotal;
+    if (intervalFlushes) {
+        bytesPerFlushLeaf = intervalBytesFlushed / intervalFlushes;
+    } else {
+        bytesPerFlushLeaf = 0;
+    }
+    flushes.incrementBy(intervalFlushes);
+    flushes.update(flushesCountLeaf, flushesRateLeaf, msElapsed);
+    lastFlushTotal = flushTotal;
+    lastBytesFlushedTotal = bytesFlushedTotal;
 }
 
 void MQTTBroker::exportConnectionInfo() {
@@ -406,10 +656,13 @@ void MQTTBroker::exportConnectionInfo() {
 
     unsigned connectionPos = 0;
     for (MQTTConnection &connection : activeConnections) {
+        if (connectionPos == maxMQTTReportedClients) {
+            break;
+        }
         *connectionLeaves[connectionPos++] = connection.clientID();
     }
 
-    for (; connectionPos < maxMQTTConnections; connectionPos++) {
+    for (; connectionPos < maxMQTTReportedClients; connectionPos++) {
         *connectionLeaves[connectionPos] = "";
     }
 
@@ -425,17 +678,21 @@ void MQTTBroker::exportSessionInfo() {
     unsigned sessionPos = 0;
     for (MQTTSession &activeSession : activeSessions) {
         connectedClients++;
-        *sessionLeaves[sessionPos++] = activeSession.getClientID();
+        if (sessionPos < maxMQTTReportedClients) {
+            *sessionLeaves[sessionPos++] = activeSession.getClientID();
+        }
     }
 
     for (MQTTSession &disconnectedSession : disconnectedSessions) {
         disconnectedClients++;
-        *sessionLeaves[sessionPos++] = disconnectedSession.getClientID();
+        if (sessionPos < maxMQTTReportedClients) {
+            *sessionLeaves[sessionPos++] = disconnectedSession.getClientID();
+        }
     }
 
     releaseSessionLock();
 
-    for (; sessionPos < maxMQTTSessions; sessionPos++) {
+    for (; sessionPos < maxMQTTReportedClients; sessionPos++) {
         *sessionLeaves[sessionPos] = "";
     }
 
@@ -446,6 +703,7 @@ void MQTTBroker::exportSessionInfo() {
     if (totalClientsCount > maximumClientsLeaf) {
         maximumClientsLeaf = totalClientsCount;
     }
+    keepAliveExpirationsLeaf = _keepAliveWheel.expirations();
 }
 
 void MQTTBroker::takeConnectionLock() {
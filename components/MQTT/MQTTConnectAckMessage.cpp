@@ -1,6 +1,6 @@
 /*
  * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
- * Copyright (C) 2021-2023 Lisa Rowell
+ * Copyright (C) 2021-2024 Lisa Rowell
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,35 +19,17 @@
 #include "MQTTConnectAckMessage.h"
 
 #include "MQTTMessage.h"
-#include "MQTTUtil.h"
+#include "MQTTPacketBuilder.h"
 
 #include <stdint.h>
-#include <sys/socket.h>
 
 bool sendMQTTConnectAckMessage(int connectionSocket, bool sessionPresent, uint8_t returnCode) {
-    MQTTFixedHeader fixedHeader;
-    MQTTConnectAckVariableHeader variableHeader;
+    uint8_t packetBuffer[mqttConnectAckPacketSize];
+    MQTTPacketBuilder packetBuilder(packetBuffer, sizeof(packetBuffer));
 
-    fixedHeader.typeAndFlags = MQTT_MSG_CONNACK << MQTT_MSG_TYPE_SHIFT;
-    if (send(connectionSocket, &fixedHeader, sizeof(fixedHeader), 0) < 0) {
+    if (!packetBuilder.buildConnectAck(sessionPresent, returnCode)) {
         return false;
     }
-    const uint8_t remainingLength = sizeof(MQTTConnectAckVariableHeader);
-    if (!mqttWriteRemainingLength(connectionSocket, remainingLength)) {
-        return false;
-    }
-
-    variableHeader.flags = 0;
-    if (sessionPresent) {
-        variableHeader.flags |= MQTT_CONNACK_SESSION_PRESENT_MASK;
-    }
-    variableHeader.returnCode = returnCode;
-
-    if (send(connectionSocket, &variableHeader, sizeof(variableHeader), 0) < 0) {
-        return false;
-    }
-
-//    messagesSent++;
 
-    return true;
+    return packetBuilder.send(connectionSocket);
 }
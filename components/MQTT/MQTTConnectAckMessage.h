@@ -20,6 +20,7 @@
 #define MQTT_CONNECT_ACK_MESSAGE_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 #define MQTT_CONNACK_ACCEPTED                     0x00
 #define MQTT_CONNACK_REFUSED_PROTOCOL_VERSION     0x01
@@ -35,6 +36,9 @@ struct MQTTConnectAckVariableHeader {
 
 #define MQTT_CONNACK_SESSION_PRESENT_MASK 0x01
 
+// A CONNACK is always the one byte of type, a one byte remaining length, and the variable header.
+constexpr size_t mqttConnectAckPacketSize = 2 + sizeof(MQTTConnectAckVariableHeader);
+
 bool sendMQTTConnectAckMessage(int connectionSocket, bool sessionPresent, uint8_t returnCode);
 
 #endif
@@ -18,7 +18,9 @@
 
 #include "MQTTConnection.h"
 #include "MQTTBroker.h"
+#include "MQTTSession.h"
 #include "MQTTMessage.h"
+#include "MQTTReceiveRing.h"
 #include "MQTTConnectMessage.h"
 #include "MQTTConnectAckMessage.h"
 #include "MQTTString.h"
@@ -33,22 +35,17 @@
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
-#include <freertos/message_buffer.h>
 
+#include <errno.h>
+#include <string.h>
 #include <strings.h>
 #include <arpa/inet.h>
 
 MQTTConnection::MQTTConnection(MQTTBroker &broker, uint8_t id)
     : TaskObject("MQTTConnection", LOGGER_LEVEL_DEBUG, stackSize),
-      _id(id), broker(broker), connectionSocket(0), _messagesSent(0) {
+      _id(id), broker(broker), connectionSocket(0), session(nullptr), socketOpen(false),
+      waitingForSession(false), disconnectRequested(false), _messagesSent(0), _receives(0) {
     bzero(&sourceAddr, sizeof(sourceAddr));
-
-    sessionMessages = xMessageBufferCreate(sessionMessageBufferSize);
-    if (sessionMessages == nullptr) {
-        logger << logErrorMQTT << "Failed to allocation session message buffer for session #" << id
-               << eol;
-        errorExit();
-    }
 }
 
 // This method is invoked by the Broker task and uses FreeRTOS's direct to task notification
@@ -63,6 +60,11 @@ void MQTTConnection::assignSocket(int connectionSocket, struct sockaddr_in &sour
 
     this->sourceAddr = sourceAddr;
 
+    if (mqttBrokerEngine == MQTT_BROKER_EVENT_LOOP) {
+        attachSocket(connectionSocket);
+        return;
+    }
+
     if (xTaskNotifyIndexed(taskHandle(), notifyIndex, (uint32_t)connectionSocket,
                            eSetValueWithOverwrite) != pdPASS) {
         logger << logErrorMQTT << "Failed to assign socket to Connection #" << _id << eol;
@@ -72,9 +74,21 @@ void MQTTConnection::assignSocket(int connectionSocket, struct sockaddr_in &sour
 
 // This method is invoked by either a session that has received a disconnect or a connection which
 // is taking over a session that's still paired with a now obsolete connection. Use the task's
-// notification as a mailbox. After the next read or timeout, the task will pick it up and close.
+// notification as a mailbox. After the next read, the task will pick it up and close.
 void MQTTConnection::markForDisconnection() {
-     if (xTaskNotifyIndexed(taskHandle(), notifyIndex, notifyDisconnect, eSetBits) != pdPASS) {
+    // With the event loop engine this is always called on the broker's task, which acts on it
+    // when it next services the connection.
+    if (mqttBrokerEngine == MQTT_BROKER_EVENT_LOOP) {
+        disconnectRequested = true;
+        return;
+    }
+
+    // A client that has gone quiet would otherwise leave the task waiting on it forever. This has
+    // to come before the notification: the task doesn't close the socket until it has been
+    // notified, but once it has, the descriptor may already belong to a new connection.
+    shutdown(connectionSocket, SHUT_RD);
+
+    if (xTaskNotifyIndexed(taskHandle(), notifyIndex, notifyDisconnect, eSetBits) != pdPASS) {
         taskLogger() << logErrorMQTT << "Failed to send disconnect notification to Connection #"
                      << _id << eol;
         errorExit();
@@ -87,7 +101,7 @@ void MQTTConnection::waitForSocketAssignment() {
     BaseType_t socketReceived;
     uint32_t socketNotification;
     do {
-        socketReceived = xTaskNotifyWaitIndexed(notifyIndex, 0, ULONG_MAX, &socketNotification,
+        socketReceived = xTaskNotifyWaitIndexed(notifyIndex, 0, UINT32_MAX, &socketNotification,
                                                 portMAX_DELAY);
     } while (!socketReceived);
 
@@ -106,6 +120,17 @@ void MQTTConnection::waitForSocketAssignment() {
     }
 }
 
+// The event loop engine's equivalent of waitForSocketAssignment() and the setup that follows it.
+void MQTTConnection::attachSocket(int connectionSocket) {
+    this->connectionSocket = connectionSocket;
+    setSocketOptions();
+
+    session = nullptr;
+    socketOpen = true;
+    waitingForSession = false;
+    disconnectRequested = false;
+}
+
 uint8_t MQTTConnection::id() const {
     return _id;
 }
@@ -118,8 +143,8 @@ int MQTTConnection::socket() const {
     return connectionSocket;
 }
 
-MessageBufferHandle_t MQTTConnection::sessionMessageBuffer() {
-    return sessionMessages;
+MQTTReceiveRing &MQTTConnection::receiveRing() {
+    return _receiveRing;
 }
 
 void MQTTConnection::task() {
@@ -131,45 +156,88 @@ void MQTTConnection::task() {
         // CONNECT message. For now, mark as not having a session.
         session = nullptr;
 
-        for (bool connectionOpen = true; connectionOpen; ) {
-            MQTTMessage message;
-            connectionOpen = readMessage(message);
-            if (connectionOpen) {
-                processMessage(message);
-            }
+        while (receiveMessages()) {
         }
 
+        // The socket is only closed once the session is done with it, so that its number can't be
+        // reused for another client while the session might still be using it.
         shutdownConnection();
         if (session != nullptr) {
             session->notifyConnectionLost();
             waitForSessionDisconnect();
         }
+        close(connectionSocket);
         goIdle();
     }
 }
 
-bool MQTTConnection::readMessage(MQTTMessage &message) {
-    // MQTT has a leading header, called the Fixed Header, which has a variable length encoding of
-    // the number of bytes coming after the fixed header. This can be used to calculate the overall
-    // message length. Since this fixed header isn't actually of fixed length, and instead has a
-    // funky, variable length, remaining bytes field, we need to read in the minimum header size,
-    // see if it's enough to determine the length, if not, keep reading, byte, by byte, until we
-    // know the length.
-
-    // First read in the minimum header size. This may or may not be enough to determine the
-    // message size.
-    bytesInBuffer = 0;
-    if (!readToBuffer(minMQTTFixedHeaderSize)) {
+// Reads as much as the socket has, and the receive ring has room for, in one go and processes
+// every complete message received, leaving any partial message pending in the ring for the next
+// time. MQTT messages are typically small, so a client sending a burst of them gets them handled
+// at well under one read per message. Returns false if the connection should be closed.
+bool MQTTConnection::receiveMessages() {
+    size_t spaceLength;
+    uint8_t *space = _receiveRing.receiveSpace(spaceLength);
+    if (space == nullptr) {
+        // The session still holds a ring's worth of messages. With the event loop engine it
+        // handles them as they're queued, so it's not going to catch up.
+        if (mqttBrokerEngine == MQTT_BROKER_EVENT_LOOP) {
+            logger << logErrorMQTT << "Receive ring for connection #" << _id << " (" << sourceAddr
+                   << ") stuck full. Aborting connection." << eol;
+            return false;
+        }
+        vTaskDelay(1);
+        return true;
+    }
+
+    // The event loop engine only calls us when select() says there's something to read, but
+    // mustn't block should that turn out not to be so.
+    const int flags = mqttBrokerEngine == MQTT_BROKER_EVENT_LOOP ? MSG_DONTWAIT : 0;
+    const ssize_t bytesRead = recv(connectionSocket, space, spaceLength, flags);
+    _receives++;
+    if (bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return true;
+    }
+    if (bytesRead <= 0) {
         return false;
     }
+    _receiveRing.received(bytesRead);
 
-    MQTTFixedHeader *fixedHeader = (MQTTFixedHeader *)buffer;
-    size_t fixedHeaderLength = minMQTTFixedHeaderSize;
+    MQTTMessage message;
+    bool malformed = false;
+    while (!disconnectRequested && pendingMessage(message, malformed)) {
+        if (!processMessage(message)) {
+            return false;
+        }
+    }
+
+    return !malformed;
+}
+
+// Called by the event loop engine's broker task when the socket has data.
+void MQTTConnection::receive() {
+    if (!receiveMessages()) {
+        closeSocket();
+    }
+}
 
-    // If the minimum header didn't have the full length field, we repeatedly read in bytes until
-    // we get a length byte with the end of length bit set.
+// Looks for a complete message at the start of the receive ring's pending bytes. Returns false if
+// there isn't one yet, setting malformed if what's there can never become one.
+//
+// MQTT has a leading header, called the Fixed Header, which has a variable length encoding of the
+// number of bytes coming after the fixed header. Since this fixed header isn't actually of fixed
+// length, and instead has a funky, variable length, remaining bytes field, we need to look at as
+// much of it as has arrived to see if we can determine the message length yet.
+bool MQTTConnection::pendingMessage(MQTTMessage &message, bool &malformed) {
+    const size_t bytesPending = _receiveRing.pendingLength();
+    if (bytesPending < minMQTTFixedHeaderSize) {
+        return false;
+    }
+
+    MQTTFixedHeader *fixedHeader = (MQTTFixedHeader *)_receiveRing.pending();
+    size_t fixedHeaderLength = minMQTTFixedHeaderSize;
     while (!messageRemainingLengthIsComplete(fixedHeader, fixedHeaderLength)) {
-        if (!readToBuffer(1)) {
+        if (fixedHeaderLength == bytesPending) {
             return false;
         }
         fixedHeaderLength++;
@@ -178,18 +246,20 @@ bool MQTTConnection::readMessage(MQTTMessage &message) {
     size_t remainingLength;
     if (!determineRemainingLength(remainingLength, fixedHeader, fixedHeaderLength)) {
         logIllegalRemainingLength(fixedHeader, fixedHeaderLength);
+        malformed = true;
         return false;
     }
 
     // While the MQTT protocol supports messages of 256 Mb, it's just not practical to support that
-    // on an ESP32. We have a fixed length receive buffer; if a client tries to send a message
-    // longer than that, thank and excuse the client.
+    // on an ESP32. If a client tries to send a message longer than the receive ring can hold,
+    // thank and excuse the client.
     if (fixedHeaderLength + remainingLength > maxIncomingMessageSize) {
         logMessageSizeTooLarge(fixedHeaderLength + remainingLength);
+        malformed = true;
         return false;
     }
 
-    if (!readToBuffer(remainingLength)) {
+    if (fixedHeaderLength + remainingLength > bytesPending) {
         return false;
     }
 
@@ -197,6 +267,47 @@ bool MQTTConnection::readMessage(MQTTMessage &message) {
     return true;
 }
 
+// Event loop engine: closes the socket after it failed or the client closed it. If a session was
+// using the connection, the connection stays out of the idle list until the session is done with
+// it.
+void MQTTConnection::closeSocket() {
+    shutdownConnection();
+    close(connectionSocket);
+    socketOpen = false;
+
+    if (session != nullptr) {
+        waitingForSession = true;
+        session->notifyConnectionLost();
+    } else {
+        goIdle();
+    }
+}
+
+// Called by the event loop engine's broker task on each pass to act on a disconnect request.
+void MQTTConnection::service() {
+    if (!disconnectRequested) {
+        return;
+    }
+    disconnectRequested = false;
+
+    if (socketOpen) {
+        shutdownConnection();
+        close(connectionSocket);
+        socketOpen = false;
+    } else if (!waitingForSession) {
+        // A late request for a connection that has already gone idle.
+        return;
+    }
+
+    waitingForSession = false;
+    session = nullptr;
+    goIdle();
+}
+
+bool MQTTConnection::isOpen() const {
+    return socketOpen;
+}
+
 bool MQTTConnection::processMessage(const MQTTMessage &message) {
     logger << logDebugMQTT << message.messageTypeStr() << " message received on connection #"
            << _id << " (" << sourceAddr << ")" << eol;
@@ -204,21 +315,28 @@ bool MQTTConnection::processMessage(const MQTTMessage &message) {
     // We process messages at the connection level until we successfully associate the connection
     // with either a pre-existing session or a new one. After that, we let the session handle the
     // message.
-    if (!session) {
-        switch (message.messageType()) {
-            case MQTT_MSG_CONNECT:
-                return processConnectMessage(message);
-
-            default:
-                logger << logWarnMQTT << "Unimplemented message type " << message.messageTypeStr()
-                       << " message received from connection #" << _id << " (" << sourceAddr << ")"
-                       << eol;
-                return true;
-        }
-    } else {
+    if (session) {
         queueMessageForSession(message);
         return true;
     }
+
+    bool keepOpen = true;
+    switch (message.messageType()) {
+        case MQTT_MSG_CONNECT:
+            keepOpen = processConnectMessage(message);
+            break;
+
+        default:
+            logger << logWarnMQTT << "Unimplemented message type " << message.messageTypeStr()
+                   << " message received from connection #" << _id << " (" << sourceAddr << ")"
+                   << eol;
+    }
+
+    // Unless a CONNECT paired us with a session, which now has the message, we're done with it.
+    if (!session) {
+        _receiveRing.consume(message.totalLength());
+    }
+    return keepOpen;
 }
 
 // Returns true if the message was processed without a terminating condition
@@ -333,11 +451,9 @@ bool MQTTConnection::processConnectMessage(const MQTTMessage &message) {
     } else {
         // We failed to pair with either an existing session or a free one. This could happen if
         // we were full up with either active sessions or ones waiting for a reconnection and we
-        // got some new connection for a completely new client. In this case we want to make sure
-        // and clear out the session message queue.
+        // got some new connection for a completely new client.
         logger << logWarnMQTT << "Failed to get a session for connection #" << _id << " ("
                << sourceAddr << ")" << eol;
-        clearSessionMessages();
         if (sendMQTTConnectAckMessage(connectionSocket, false,
                                       MQTT_CONNACK_REFUSED_SERVER_UNAVAILABLE)) {
             _messagesSent++;
@@ -373,7 +489,7 @@ bool MQTTConnection::determineRemainingLength(size_t &remainingLength, MQTTFixed
     for (lengthByte = 0, multiplier = 1, remainingLength = 0;
          lengthByte < remainingLengthBytes;
          lengthByte++, multiplier = multiplier * 128) {
-        remainingLength += fixedHeader->remainingLength[lengthByte] & 0x7f * multiplier;
+        remainingLength += (fixedHeader->remainingLength[lengthByte] & 0x7f) * multiplier;
     }
 
     if (fixedHeader->remainingLength[remainingLengthBytes - 1] & 0x80) {
@@ -399,29 +515,12 @@ void MQTTConnection::setSocketOptions() {
     setsockopt(connectionSocket, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(int));
 }
 
-bool MQTTConnection::readToBuffer(size_t readAmount) {
-    // Since lwip's recv does not currently implement the MSG_WAITALL flag, we loop until we receive
-    // all required bytes or encounter an error or connection closure.
-    while (readAmount) {
-        ssize_t bytesRead = recv(connectionSocket, buffer + bytesInBuffer, readAmount, 0);
-        if (bytesRead < 0) {
-            return false;
-        }
-
-        bytesInBuffer += bytesRead;
-        readAmount -= bytesRead;
-    }
-
-    return true;
-}
-
 void MQTTConnection::shutdownConnection() {
     logger << "Shutting down Connection #" << _id << " (" << sourceAddr << ")" << eol;
 
     // Properly shutdown the socket
     shutdown(connectionSocket, SHUT_WR);
     shutdown(connectionSocket, SHUT_RD);
-    close(connectionSocket);
 }
 
 void MQTTConnection::waitForSessionDisconnect() {
@@ -430,7 +529,7 @@ void MQTTConnection::waitForSessionDisconnect() {
     BaseType_t notificationReceived;
     uint32_t notification;
     do {
-        notificationReceived = xTaskNotifyWaitIndexed(notifyIndex, 0, ULONG_MAX, &notification,
+        notificationReceived = xTaskNotifyWaitIndexed(notifyIndex, 0, UINT32_MAX, &notification,
                                                       portMAX_DELAY);
     } while (!notificationReceived);
 
@@ -449,29 +548,38 @@ void MQTTConnection::waitForSessionDisconnect() {
 void MQTTConnection::goIdle() {
     logger << logDebugMQTT << "MQTT Connection #" << _id << " going idle." << eol;
 
+    // Anything the session didn't get to is of no use to the next client.
+    _receiveRing.reset();
+
     // Move ourselves to the idle list
     broker.connectionGoingIdle(*this);
 }
 
+// Hands the message, which is at the start of the receive ring's pending bytes, to the session in
+// place. The session releases it back to the ring once it's been handled.
 void MQTTConnection::queueMessageForSession(const MQTTMessage &message) {
-    if (xMessageBufferSend(sessionMessages, message.messageStart(), message.totalLength(),
-                           sessionMessageBufferTimeout) == 0) {
-        logger << logErrorMQTT << "Failed to enqueue MQTT " << message.messageTypeStr()
-               << " message from connection #" << _id << " (" << sourceAddr << ") to session"
-               << eol;
-        errorExit();
+    // The event loop engine's task is also the session's, so it can't wait for room, but then
+    // again it never needs to as the session handles each message as it's queued.
+    TickType_t waited = 0;
+    while (!_receiveRing.queueMessage(message.totalLength())) {
+        if (mqttBrokerEngine == MQTT_BROKER_EVENT_LOOP || waited >= sessionMessageTimeout) {
+            logger << logErrorMQTT << "Failed to enqueue MQTT " << message.messageTypeStr()
+                   << " message from connection #" << _id << " (" << sourceAddr << ") to session"
+                   << eol;
+            errorExit();
+        }
+        vTaskDelay(1);
+        waited++;
     }
 
     // Since sessions wait both on a queue and on notifications, send the session a notification
     // that has a message waiting for it.
     session->notifyMessageReady();
-}
 
-void MQTTConnection::clearSessionMessages() {
-    if (xMessageBufferReset(sessionMessages) != pdPASS) {
-        logger << logErrorMQTT << "Failed to reset session message buffer for connection #" << _id
-               << eol;
-        errorExit();
+    // With the event loop engine the session handles the message right away, so that the ring
+    // never holds more than the one.
+    if (mqttBrokerEngine == MQTT_BROKER_EVENT_LOOP) {
+        session->service();
     }
 }
 
@@ -496,3 +604,7 @@ void MQTTConnection::logMessageSizeTooLarge(size_t messageSize) {
 uint32_t MQTTConnection::messagesSent() {
     return _messagesSent;
 }
+
+uint32_t MQTTConnection::receives() {
+    return _receives;
+}
@@ -0,0 +1,146 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MQTTInFlightWindow.h"
+#include "MQTTPublishQueue.h"
+
+#include <freertos/FreeRTOS.h>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+MQTTInFlightWindow::MQTTInFlightWindow() : _occupancy(0), lastPacketId(0) {
+    for (MQTTInFlightPublish &publish : publishes) {
+        publish.leaf = nullptr;
+    }
+}
+
+// Packet ids are handed out in turn, skipping 0, which isn't a legal id, and any still in use.
+uint16_t MQTTInFlightWindow::allocatePacketId() {
+    do {
+        lastPacketId++;
+    } while (lastPacketId == 0 || packetIdInUse(lastPacketId));
+
+    return lastPacketId;
+}
+
+bool MQTTInFlightWindow::packetIdInUse(uint16_t packetId) const {
+    for (const MQTTInFlightPublish &publish : publishes) {
+        if (publish.leaf != nullptr && publish.packetId == packetId) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void MQTTInFlightWindow::setValue(MQTTInFlightPublish &publish, const MQTTPublishRecord &record) {
+    publish.retainedValue = record.retainedValue;
+    publish.valueLength = record.valueLength;
+    memcpy(publish.value, record.value, record.valueLength + 1);
+}
+
+MQTTInFlightPublish *MQTTInFlightWindow::find(const DataModelLeaf &leaf) {
+    for (MQTTInFlightPublish &publish : publishes) {
+        if (publish.leaf == &leaf) {
+            return &publish;
+        }
+    }
+
+    return nullptr;
+}
+
+// Returns the new in-flight publish, with its packet id assigned, or nullptr if the window is
+// full. The caller sends it and sets sentAt.
+MQTTInFlightPublish *MQTTInFlightWindow::add(const MQTTPublishRecord &record) {
+    if (isFull()) {
+        return nullptr;
+    }
+
+    for (MQTTInFlightPublish &publish : publishes) {
+        if (publish.leaf == nullptr) {
+            publish.packetId = allocatePacketId();
+            publish.leaf = record.leaf;
+            setValue(publish, record);
+            _occupancy++;
+            return &publish;
+        }
+    }
+
+    return nullptr;
+}
+
+// Swaps in a newer value for the publish's leaf. It goes out as a new message, so it gets a new
+// packet id, and a late acknowledgement of the old one is simply not recognized.
+void MQTTInFlightWindow::replace(MQTTInFlightPublish &publish, const MQTTPublishRecord &record) {
+    publish.packetId = allocatePacketId();
+    setValue(publish, record);
+}
+
+// Returns false if no publish was waiting on the packet id.
+bool MQTTInFlightWindow::acknowledge(uint16_t packetId) {
+    for (MQTTInFlightPublish &publish : publishes) {
+        if (publish.leaf != nullptr && publish.packetId == packetId) {
+            publish.leaf = nullptr;
+            _occupancy--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// The publish that has waited longest since it was last sent, which is the next one due to be
+// sent again. Returns nullptr if the window is empty.
+MQTTInFlightPublish *MQTTInFlightWindow::oldest() {
+    MQTTInFlightPublish *oldestPublish = nullptr;
+    for (MQTTInFlightPublish &publish : publishes) {
+        if (publish.leaf != nullptr &&
+            (oldestPublish == nullptr || (int32_t)(publish.sentAt - oldestPublish->sentAt) < 0)) {
+            oldestPublish = &publish;
+        }
+    }
+
+    return oldestPublish;
+}
+
+// For going through every publish in the window, returns nullptr for free slots.
+MQTTInFlightPublish *MQTTInFlightWindow::publish(size_t index) {
+    MQTTInFlightPublish &publish = publishes[index];
+    return publish.leaf != nullptr ? &publish : nullptr;
+}
+
+void MQTTInFlightWindow::clear() {
+    for (MQTTInFlightPublish &publish : publishes) {
+        publish.leaf = nullptr;
+    }
+    _occupancy = 0;
+}
+
+bool MQTTInFlightWindow::isEmpty() const {
+    return _occupancy == 0;
+}
+
+bool MQTTInFlightWindow::isFull() const {
+    return _occupancy == capacity;
+}
+
+size_t MQTTInFlightWindow::occupancy() const {
+    return _occupancy;
+}
@@ -0,0 +1,123 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MQTTKeepAliveWheel.h"
+#include "MQTTSession.h"
+
+#include "Logger.h"
+#include "Error.h"
+
+#include "etl/intrusive_links.h"
+#include "etl/intrusive_list.h"
+#include "etl/algorithm.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <esp_timer.h>
+
+#include <stdint.h>
+#include <stddef.h>
+
+MQTTKeepAliveWheel::MQTTKeepAliveWheel() : lastAdvance(now()), _expirations(0) {
+    if ((lock = xSemaphoreCreateMutex()) == nullptr) {
+        taskLogger() << logErrorMQTT << "Failed to create keep-alive wheel mutex" << eol;
+        errorExit();
+    }
+}
+
+// The wheel's clock, in seconds.
+uint32_t MQTTKeepAliveWheel::now() {
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+// Files the session under its current keep-alive deadline, refiling it if it already was.
+void MQTTKeepAliveWheel::start(MQTTSession &session) {
+    takeLock();
+
+    if (session.KeepAliveLink::is_linked()) {
+        etl::unlink<KeepAliveLink>(session);
+    }
+    slots[session.keepAliveDeadline() & slotMask].push_back(session);
+
+    releaseLock();
+}
+
+void MQTTKeepAliveWheel::stop(MQTTSession &session) {
+    takeLock();
+
+    if (session.KeepAliveLink::is_linked()) {
+        etl::unlink<KeepAliveLink>(session);
+    }
+
+    releaseLock();
+}
+
+// Called by the broker task at least once a second. Catches up on every slot passed since the
+// last call, though never goes around more than once, as every session would have been looked at.
+void MQTTKeepAliveWheel::advance() {
+    const uint32_t currentSecond = now();
+    if (currentSecond == lastAdvance) {
+        return;
+    }
+
+    takeLock();
+
+    const uint32_t slotsPassed = etl::min(currentSecond - lastAdvance, (uint32_t)wheelSlots);
+    for (uint32_t slot = currentSecond - slotsPassed + 1; slot != currentSecond + 1; slot++) {
+        expireSlot(slot & slotMask, currentSecond);
+    }
+    lastAdvance = currentSecond;
+
+    releaseLock();
+}
+
+void MQTTKeepAliveWheel::expireSlot(uint32_t slot, uint32_t currentSecond) {
+    etl::intrusive_list<MQTTSession, KeepAliveLink> &sessions = slots[slot];
+
+    auto sessionIterator = sessions.begin();
+    while (sessionIterator != sessions.end()) {
+        MQTTSession &session = *sessionIterator;
+        ++sessionIterator;
+
+        const uint32_t deadline = session.keepAliveDeadline();
+        if ((int32_t)(currentSecond - deadline) >= 0) {
+            etl::unlink<KeepAliveLink>(session);
+            _expirations++;
+            session.notifyKeepAliveExpired();
+        } else if ((deadline & slotMask) != slot) {
+            // The client has been heard from since the session was filed here.
+            etl::unlink<KeepAliveLink>(session);
+            slots[deadline & slotMask].push_back(session);
+        }
+    }
+}
+
+uint32_t MQTTKeepAliveWheel::expirations() const {
+    return _expirations;
+}
+
+void MQTTKeepAliveWheel::takeLock() {
+    if (xSemaphoreTake(lock, pdMS_TO_TICKS(lockTimeoutMs)) != pdTRUE) {
+        taskLogger() << logErrorMQTT << "Failed to take keep-alive wheel lock" << eol;
+        errorExit();
+    }
+}
+
+void MQTTKeepAliveWheel::releaseLock() {
+    xSemaphoreGive(lock);
+}
@@ -0,0 +1,198 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MQTTPacketBuilder.h"
+
+#include "MQTTMessage.h"
+#include "MQTTConnectAckMessage.h"
+#include "MQTTPublishMessage.h"
+#include "MQTTPublishAckMessage.h"
+#include "MQTTSubscribeAckMessage.h"
+#include "MQTTUnsubscribeAckMessage.h"
+#include "MQTTUtil.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+MQTTPacketBuilder::MQTTPacketBuilder(uint8_t *buffer, size_t bufferSize)
+    : buffer(buffer), bufferSize(bufferSize), length(0) {
+}
+
+bool MQTTPacketBuilder::buildConnectAck(bool sessionPresent, uint8_t returnCode) {
+    const uint32_t remainingLength = sizeof(MQTTConnectAckVariableHeader);
+    if (!startPacket(MQTT_MSG_CONNACK << MQTT_MSG_TYPE_SHIFT, remainingLength)) {
+        return false;
+    }
+
+    MQTTConnectAckVariableHeader variableHeader;
+    variableHeader.flags = 0;
+    if (sessionPresent) {
+        variableHeader.flags |= MQTT_CONNACK_SESSION_PRESENT_MASK;
+    }
+    variableHeader.returnCode = returnCode;
+    appendBytes(&variableHeader, sizeof(variableHeader));
+
+    return true;
+}
+
+bool MQTTPacketBuilder::buildPublish(const char *topic, const char *value, bool dup,
+                                     uint8_t qosLevel, bool retain, uint16_t packetId) {
+    uint8_t typeAndFlags = MQTT_MSG_PUBLISH << MQTT_MSG_TYPE_SHIFT;
+    if (dup) {
+        typeAndFlags |= MQTT_PUBLISH_FLAGS_DUP_MASK;
+    }
+    typeAndFlags |= (qosLevel << MQTT_PUBLISH_FLAGS_QOS_SHIFT) & MQTT_PUBLISH_FLAGS_QOS_MASK;
+    if (retain) {
+        typeAndFlags |= MQTT_PUBLISH_FLAGS_RETAIN_MASK;
+    }
+
+    const size_t topicLength = strlen(topic);
+    const size_t valueLength = strlen(value);
+    uint32_t remainingLength = sizeof(uint16_t) + topicLength + valueLength;
+    if (qosLevel > 0) {
+        remainingLength += sizeof(uint16_t);
+    }
+
+    if (!startPacket(typeAndFlags, remainingLength)) {
+        return false;
+    }
+
+    appendUInt16(topicLength);
+    appendBytes(topic, topicLength);
+    if (qosLevel > 0) {
+        appendUInt16(packetId);
+    }
+    appendBytes(value, valueLength);
+
+    return true;
+}
+
+bool MQTTPacketBuilder::buildSubscribeAck(uint16_t packetId, uint8_t numberResults,
+                                          const uint8_t *results) {
+    const uint32_t remainingLength = sizeof(MQTTSubscribeAckVariableHeader) + numberResults;
+    if (!startPacket(MQTT_MSG_SUBACK << MQTT_MSG_TYPE_SHIFT, remainingLength)) {
+        return false;
+    }
+
+    appendUInt16(packetId);
+    appendBytes(results, numberResults * sizeof(uint8_t));
+
+    return true;
+}
+
+bool MQTTPacketBuilder::buildUnsubscribeAck(uint16_t packetId) {
+    const uint32_t remainingLength = sizeof(MQTTUnsubscribeAckVariableHeader);
+    if (!startPacket(MQTT_MSG_UNSUBACK << MQTT_MSG_TYPE_SHIFT, remainingLength)) {
+        return false;
+    }
+
+    appendUInt16(packetId);
+
+    return true;
+}
+
+bool MQTTPacketBuilder::buildPublishAck(uint16_t packetId) {
+    const uint32_t remainingLength = sizeof(MQTTPublishAckVariableHeader);
+    if (!startPacket(MQTT_MSG_PUBACK << MQTT_MSG_TYPE_SHIFT, remainingLength)) {
+        return false;
+    }
+
+    appendUInt16(packetId);
+
+    return true;
+}
+
+bool MQTTPacketBuilder::buildPingResponse() {
+    return startPacket(MQTT_MSG_PINGRESP << MQTT_MSG_TYPE_SHIFT, 0);
+}
+
+// Sends everything that has been built in one go and empties the buffer, successful or not.
+bool MQTTPacketBuilder::send(int connectionSocket) {
+    const bool success = mqttSendAll(connectionSocket, buffer, length);
+    length = 0;
+
+    return success;
+}
+
+// Sends what the socket will take without blocking and moves anything left to the front of the
+// buffer, where later packets are appended after it.
+bool MQTTPacketBuilder::sendAvailable(int connectionSocket, size_t &bytesSent) {
+    if (!mqttSendAvailable(connectionSocket, buffer, length, bytesSent)) {
+        length = 0;
+        return false;
+    }
+
+    length -= bytesSent;
+    memmove(buffer, buffer + bytesSent, length);
+
+    return true;
+}
+
+void MQTTPacketBuilder::reset() {
+    length = 0;
+}
+
+bool MQTTPacketBuilder::isEmpty() const {
+    return length == 0;
+}
+
+size_t MQTTPacketBuilder::size() const {
+    return length;
+}
+
+size_t MQTTPacketBuilder::capacity() const {
+    return bufferSize;
+}
+
+const uint8_t *MQTTPacketBuilder::data() const {
+    return buffer;
+}
+
+// Writes the fixed header after first making sure that the whole packet will fit so that the
+// rest of a build can append without further checks.
+bool MQTTPacketBuilder::startPacket(uint8_t typeAndFlags, uint32_t remainingLength) {
+    if (remainingLength > mqttMaxRemainingLength) {
+        return false;
+    }
+
+    const size_t packetLength =
+        sizeof(MQTTFixedHeader) + mqttRemainingLengthSize(remainingLength) + remainingLength;
+    if (packetLength > bufferSize - length) {
+        return false;
+    }
+
+    appendByte(typeAndFlags);
+    length += mqttEncodeRemainingLength(buffer + length, remainingLength);
+
+    return true;
+}
+
+void MQTTPacketBuilder::appendByte(uint8_t value) {
+    buffer[length++] = value;
+}
+
+void MQTTPacketBuilder::appendUInt16(uint16_t value) {
+    mqttEncodeUInt16(buffer + length, value);
+    length += sizeof(uint16_t);
+}
+
+void MQTTPacketBuilder::appendBytes(const void *bytes, size_t count) {
+    memcpy(buffer + length, bytes, count);
+    length += count;
+}
@@ -0,0 +1,49 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MQTTPublishAckMessage.h"
+#include "MQTTMessage.h"
+
+#include "Logger.h"
+
+#include <stdint.h>
+
+MQTTPublishAckMessage::MQTTPublishAckMessage(MQTTMessage const &message) : MQTTMessage(message) {
+}
+
+bool MQTTPublishAckMessage::parse() {
+    if (fixedHeaderFlags() != 0x0) {
+        taskLogger() << logWarnMQTT
+                     << "Received MQTT PUBACK message with invalid Fixed Header Flags" << eol;
+        return false;
+    }
+
+    if (remainingLength != sizeof(MQTTPublishAckVariableHeader)) {
+        taskLogger() << logWarnMQTT << "Received MQTT PUBACK message with a bad Remaining Length"
+                     << eol;
+        return false;
+    }
+
+    variableHeader = (MQTTPublishAckVariableHeader *)variableHeaderStart;
+
+    return true;
+}
+
+uint16_t MQTTPublishAckMessage::packetId() const {
+    return variableHeader->packetIdMSB * 256 + variableHeader->packetIdLSB;
+}
@@ -0,0 +1,41 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MQTT_PUBLISH_ACK_MESSAGE_H
+#define MQTT_PUBLISH_ACK_MESSAGE_H
+
+#include "MQTTMessage.h"
+
+#include <stdint.h>
+
+struct MQTTPublishAckVariableHeader {
+    uint8_t packetIdMSB;
+    uint8_t packetIdLSB;
+};
+
+class MQTTPublishAckMessage : MQTTMessage {
+    private:
+        MQTTPublishAckVariableHeader *variableHeader;
+
+    public:
+        MQTTPublishAckMessage(MQTTMessage const &message);
+        bool parse();
+        uint16_t packetId() const;
+};
+
+#endif // MQTT_PUBLISH_ACK_MESSAGE_H
@@ -0,0 +1,115 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "MQTTPublishMessage.h"
+#include "MQTTMessage.h"
+#include "MQTTString.h"
+
+#include "Logger.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+MQTTPublishMessage::MQTTPublishMessage(MQTTMessage const &message)
+    : MQTTMessage(message), topicStr(nullptr), packetIdField(nullptr), payloadStart(nullptr),
+      payloadLength(0) {
+}
+
+bool MQTTPublishMessage::parse() {
+    if (qosLevel() > 2) {
+        taskLogger() << logWarnMQTT << "Received MQTT PUBLISH message with illegal QoS" << eol;
+        return false;
+    }
+
+    uint8_t *messagePos = (uint8_t *)variableHeaderStart;
+    uint32_t bytesRemaining = remainingLength;
+    if (!parseString(topicStr, messagePos, bytesRemaining)) {
+        taskLogger() << logWarnMQTT
+                     << "Received MQTT PUBLISH message with a size too small for its Topic Name"
+                     << eol;
+        return false;
+    }
+
+    if (topicStr->length() == 0) {
+        taskLogger() << logWarnMQTT << "Received MQTT PUBLISH message with zero length Topic Name"
+                     << eol;
+        return false;
+    }
+
+    if (qosLevel() > 0) {
+        if (bytesRemaining < sizeof(MQTTPublishPacketId)) {
+            taskLogger() << logWarnMQTT
+                         << "Received MQTT PUBLISH message with a size too small for its Packet "
+                            "Identifier" << eol;
+            return false;
+        }
+
+        packetIdField = (MQTTPublishPacketId *)messagePos;
+        messagePos += sizeof(MQTTPublishPacketId);
+        bytesRemaining -= sizeof(MQTTPublishPacketId);
+
+        if (packetId() == 0) {
+            taskLogger() << logWarnMQTT
+                         << "Received MQTT PUBLISH message with zero Packet Indentifier." << eol;
+            return false;
+        }
+    }
+
+    payloadStart = messagePos;
+    payloadLength = bytesRemaining;
+
+    return true;
+}
+
+bool MQTTPublishMessage::dup() const {
+    return fixedHeaderFlags() & MQTT_PUBLISH_FLAGS_DUP_MASK;
+}
+
+uint8_t MQTTPublishMessage::qosLevel() const {
+    return (fixedHeaderFlags() & MQTT_PUBLISH_FLAGS_QOS_MASK) >> MQTT_PUBLISH_FLAGS_QOS_SHIFT;
+}
+
+bool MQTTPublishMessage::retain() const {
+    return fixedHeaderFlags() & MQTT_PUBLISH_FLAGS_RETAIN_MASK;
+}
+
+const MQTTString &MQTTPublishMessage::topic() const {
+    return *topicStr;
+}
+
+uint16_t MQTTPublishMessage::packetId() const {
+    if (packetIdField == nullptr) {
+        return 0;
+    }
+
+    return packetIdField->packetIdMSB * 256 + packetIdField->packetIdLSB;
+}
+
+// Returns false if too long to copy. maxLength does not include the nil.
+bool MQTTPublishMessage::copyPayloadTo(char *cString, size_t maxLength) const {
+    if (payloadLength > maxLength) {
+        return false;
+    }
+
+    memcpy(cString, payloadStart, payloadLength);
+    cString[payloadLength] = 0;
+
+    return true;
+}
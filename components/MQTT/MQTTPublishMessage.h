@@ -24,4 +24,36 @@
 #define MQTT_PUBLISH_FLAGS_QOS_SHIFT 1
 #define MQTT_PUBLISH_FLAGS_RETAIN_MASK 0x01
 
+#include "MQTTMessage.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+class MQTTString;
+
+struct MQTTPublishPacketId {
+    uint8_t packetIdMSB;
+    uint8_t packetIdLSB;
+};
+
+class MQTTPublishMessage : MQTTMessage {
+    private:
+        MQTTString *topicStr;
+        // Only present with QoS 1 and 2.
+        MQTTPublishPacketId *packetIdField;
+        uint8_t *payloadStart;
+        uint32_t payloadLength;
+
+    public:
+        MQTTPublishMessage(MQTTMessage const &message);
+        bool parse();
+        bool dup() const;
+        uint8_t qosLevel() const;
+        bool retain() const;
+        const MQTTString &topic() const;
+        uint16_t packetId() const;
+        // Returns false if too long to copy. maxLength does not include the nil.
+        bool copyPayloadTo(char *cString, size_t maxLength) const;
+};
+
 #endif // MQTT_PUBLISH_MESSAGE_H
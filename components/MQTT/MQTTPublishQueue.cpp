@@ -0,0 +1,137 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MQTTPublishQueue.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <atomic>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+MQTTPublishQueue::MQTTPublishQueue() : head(0), tail(0) {
+    for (Slot &slot : slots) {
+        slot.sequence = 0;
+        slot.record.leaf = nullptr;
+    }
+}
+
+// Returns false if the queue is full. consumerCaughtUp is set if the consumer had already taken
+// everything ahead of this record, in which case it needs a wake up to come and get it.
+bool MQTTPublishQueue::push(DataModelLeaf &leaf, const char *value, size_t valueLength,
+                            bool retainedValue, uint8_t qosLevel, bool &consumerCaughtUp) {
+    const uint32_t headIndex = head.load(std::memory_order_relaxed);
+    if (headIndex - tail.load(std::memory_order_acquire) >= capacity) {
+        return false;
+    }
+
+    writeSlot(slots[headIndex & capacityMask], leaf, value, valueLength, retainedValue, qosLevel);
+    head.store(headIndex + 1, std::memory_order_seq_cst);
+
+    consumerCaughtUp = tail.load(std::memory_order_seq_cst) == headIndex;
+
+    return true;
+}
+
+// Discards the oldest queued record to make room for a new one. Returns false if the consumer got
+// to it first, which also means that there's now room.
+bool MQTTPublishQueue::dropOldest() {
+    uint32_t tailIndex = tail.load(std::memory_order_acquire);
+    if (tailIndex == head.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    return tail.compare_exchange_strong(tailIndex, tailIndex + 1);
+}
+
+// Replaces the value in the newest queued record for the leaf. Returns true only if the consumer is
+// certain to see the new value; if it claimed the record while we were rewriting it we can't know
+// which version it got, so the caller needs to queue the value normally.
+bool MQTTPublishQueue::coalesce(DataModelLeaf &leaf, const char *value, size_t valueLength,
+                                bool retainedValue, uint8_t qosLevel) {
+    const uint32_t headIndex = head.load(std::memory_order_relaxed);
+    const uint32_t tailIndex = tail.load(std::memory_order_acquire);
+
+    for (uint32_t index = headIndex; index != tailIndex; ) {
+        index--;
+        Slot &slot = slots[index & capacityMask];
+        // Only the producer writes records, so reading the leaf here is safe.
+        if (slot.record.leaf == &leaf) {
+            writeSlot(slot, leaf, value, valueLength, retainedValue, qosLevel);
+            return (int32_t)(index - tail.load(std::memory_order_seq_cst)) >= 0;
+        }
+    }
+
+    return false;
+}
+
+bool MQTTPublishQueue::pop(MQTTPublishRecord &record) {
+    while (true) {
+        uint32_t tailIndex = tail.load(std::memory_order_acquire);
+        if (tailIndex == head.load(std::memory_order_seq_cst)) {
+            return false;
+        }
+
+        Slot &slot = slots[tailIndex & capacityMask];
+        const uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence & 1) {
+            // The producer is in the middle of coalescing into this record. Give it a chance to
+            // finish.
+            taskYIELD();
+            continue;
+        }
+
+        record = slot.record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+            continue;
+        }
+
+        // If this fails the producer dropped the record out from under us.
+        if (tail.compare_exchange_strong(tailIndex, tailIndex + 1)) {
+            return true;
+        }
+    }
+}
+
+bool MQTTPublishQueue::isEmpty() const {
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+}
+
+bool MQTTPublishQueue::isFull() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire) >=
+           capacity;
+}
+
+void MQTTPublishQueue::writeSlot(Slot &slot, DataModelLeaf &leaf, const char *value,
+                                 size_t valueLength, bool retainedValue, uint8_t qosLevel) {
+    slot.sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.record.leaf = &leaf;
+    slot.record.retainedValue = retainedValue;
+    slot.record.qosLevel = qosLevel;
+    slot.record.valueLength = valueLength;
+    memcpy(slot.record.value, value, valueLength);
+    slot.record.value[valueLength] = 0;
+
+    slot.sequence.fetch_add(1, std::memory_order_release);
+}
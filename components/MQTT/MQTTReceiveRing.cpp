@@ -0,0 +1,144 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MQTTReceiveRing.h"
+#include "MQTTMessage.h"
+
+#include "etl/algorithm.h"
+
+#include <atomic>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+MQTTReceiveRing::MQTTReceiveRing()
+    : pendingStart(0), pendingEnd(0), queueHead(0), queueTail(0) {
+}
+
+// Throws away everything in the ring, queued messages included. Only for use once the session is
+// done with the connection.
+void MQTTReceiveRing::reset() {
+    pendingStart = pendingEnd;
+    queueTail.store(queueHead.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+// The oldest position in the ring that is still in use.
+size_t MQTTReceiveRing::tail() const {
+    const uint32_t tailIndex = queueTail.load(std::memory_order_acquire);
+    if (tailIndex != queueHead.load(std::memory_order_relaxed)) {
+        return queuedMessages[tailIndex % maxQueuedMessages].position;
+    } else {
+        return pendingStart;
+    }
+}
+
+// Moves receiving to the start of the ring, copying the partial message along so that it stays
+// contiguous. Returns false if messages the session has yet to release are in the way.
+bool MQTTReceiveRing::moveToStart() {
+    const size_t length = pendingLength();
+    const size_t nextLap = (pendingStart & ~ringMask) + ringSize;
+    const uint32_t tailIndex = queueTail.load(std::memory_order_acquire);
+    const size_t newTail = tailIndex != queueHead.load(std::memory_order_relaxed)
+        ? queuedMessages[tailIndex % maxQueuedMessages].position : nextLap;
+
+    if (nextLap + length + minReceiveSpace - newTail > ringSize) {
+        return false;
+    }
+
+    memmove(buffer, pending(), length);
+    pendingStart = nextLap;
+    pendingEnd = nextLap + length;
+    return true;
+}
+
+// Returns where the next read should go, and in length how much may be read there, or nullptr if
+// the session has to release messages before there's room.
+uint8_t *MQTTReceiveRing::receiveSpace(size_t &length) {
+    // Where the next read would go, measured from the start of the ring the pending bytes begin
+    // in. It may be at the very end, but the pending bytes are never split.
+    size_t offset = (pendingStart & ringMask) + pendingLength();
+    const bool nothingInUse = tail() == pendingEnd;
+    if (ringSize - offset < minReceiveSpace || (offset != 0 && nothingInUse)) {
+        // Either we're about to run out of room at the end of the ring, or nothing is in use, in
+        // which case starting over gives the most room for the next read.
+        if (moveToStart()) {
+            offset = pendingLength();
+        } else if (offset == ringSize) {
+            return nullptr;
+        }
+    }
+
+    const size_t inUse = pendingEnd - tail();
+    length = etl::min(ringSize - offset, ringSize - inUse);
+    if (length == 0) {
+        return nullptr;
+    }
+    return buffer + offset;
+}
+
+void MQTTReceiveRing::received(size_t length) {
+    pendingEnd += length;
+}
+
+uint8_t *MQTTReceiveRing::pending() {
+    return buffer + (pendingStart & ringMask);
+}
+
+size_t MQTTReceiveRing::pendingLength() const {
+    return pendingEnd - pendingStart;
+}
+
+// Done with the first length bytes of pending, a message the connection handled itself.
+void MQTTReceiveRing::consume(size_t length) {
+    pendingStart += length;
+}
+
+// Hands the message making up the first length bytes of pending to the session. Returns false if
+// the session already has as many messages queued as we can track.
+bool MQTTReceiveRing::queueMessage(size_t length) {
+    const uint32_t headIndex = queueHead.load(std::memory_order_relaxed);
+    if (headIndex - queueTail.load(std::memory_order_acquire) >= maxQueuedMessages) {
+        return false;
+    }
+
+    QueuedMessage &queuedMessage = queuedMessages[headIndex % maxQueuedMessages];
+    queuedMessage.position = pendingStart;
+    queuedMessage.length = length;
+    queueHead.store(headIndex + 1, std::memory_order_release);
+
+    pendingStart += length;
+    return true;
+}
+
+// Points message at the oldest queued message, which stays in place until released. Returns false
+// if there isn't one.
+bool MQTTReceiveRing::nextMessage(MQTTMessage &message) {
+    const uint32_t tailIndex = queueTail.load(std::memory_order_relaxed);
+    if (tailIndex == queueHead.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    const QueuedMessage &queuedMessage = queuedMessages[tailIndex % maxQueuedMessages];
+    message = MQTTMessage(buffer + (queuedMessage.position & ringMask), queuedMessage.length);
+    return true;
+}
+
+void MQTTReceiveRing::releaseMessage() {
+    queueTail.fetch_add(1, std::memory_order_release);
+}
@@ -0,0 +1,60 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "MQTTRelayQueue.h"
+
+#include <atomic>
+
+#include <stdint.h>
+#include <string.h>
+
+MQTTRelayQueue::MQTTRelayQueue() : head(0), tail(0) {
+}
+
+// Returns false if the queue is full. The topic and value must already be known to fit.
+bool MQTTRelayQueue::push(const char *topic, const char *value, bool &consumerCaughtUp) {
+    const uint32_t currentHead = head.load(std::memory_order_relaxed);
+    const uint32_t currentTail = tail.load(std::memory_order_acquire);
+    if (currentHead - currentTail == capacity) {
+        return false;
+    }
+
+    MQTTRelayRecord &record = records[currentHead % capacity];
+    strcpy(record.topic, topic);
+    strcpy(record.value, value);
+
+    consumerCaughtUp = currentHead == currentTail;
+    head.store(currentHead + 1, std::memory_order_release);
+
+    return true;
+}
+
+// Returns nullptr if the queue is empty.
+const MQTTRelayRecord *MQTTRelayQueue::front() const {
+    const uint32_t currentTail = tail.load(std::memory_order_relaxed);
+    if (currentTail == head.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    return &records[currentTail % capacity];
+}
+
+void MQTTRelayQueue::pop() {
+    tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
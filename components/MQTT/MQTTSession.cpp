@@ -26,21 +26,28 @@
 #include "MQTTUnsubscribeMessage.h"
 #include "MQTTUnsubscribeAckMessage.h"
 #include "MQTTPingRequestMessage.h"
+#include "MQTTPublishAckMessage.h"
 #include "MQTTPublishMessage.h"
 #include "MQTTDisconnectMessage.h"
-#include "MQTTUtil.h"
+#include "MQTTPacketBuilder.h"
 #include "MQTTString.h"
+#include "MQTTReceiveRing.h"
+#include "MQTTKeepAliveWheel.h"
 
 #include "DataModel.h"
+#include "DataModelLeaf.h"
 
 #include "Logger.h"
 #include "Error.h"
 
 #include "etl/string.h"
+#include "etl/algorithm.h"
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
+#include <esp_timer.h>
+
 #include <stdint.h>
 #include <errno.h>
 #include <string.h>
@@ -48,41 +55,98 @@
 MQTTSession::MQTTSession(MQTTBroker &broker, DataModel &dataModel, uint8_t id)
     : TaskObject("MQTTSession", LOGGER_LEVEL_DEBUG, stackSize),
       id(id), broker(broker), dataModel(dataModel), _connection(nullptr), freshSession(true),
+      connectionSocket(0), keepAliveTimeout(0), _keepAliveDeadline(0), pendingNotifications(0),
+      generation(0), _publishLockAcquisitions(0), _publishLockContentions(0),
+      _publishLockWaitUs(0), _publishLockMaxWaitUs(0),
+      packetBuilder(outgoingBuffer, maxOutgoingMessageSize), outgoingPackets(0),
+      outgoingPublishes(0), outgoingPendingSince(0), outgoingBacklogged(false),
       _messagesReceived(0), _messagesSent(0), _publishMessagesReceived(0), _publishMessagesSent(0),
-      _publishMessagesDropped(0) {
+      _publishMessagesDropped(0), _publishMessagesQueueDropped(0), _publishMessagesCoalesced(0),
+      _flushes(0), _bytesFlushed(0), publishHeld(false), _inFlightCoalesced(0), _retransmits(0) {
+    if ((publishLock = xSemaphoreCreateMutex()) == nullptr) {
+        logger << logErrorMQTT << "Failed to create publishLock mutex" << eol;
+        errorExit();
+    }
 }
 
+static_assert(maxMQTTConnections <= 0xff, "MQTT connection ids must fit in a notification");
+
 void MQTTSession::task() {
     while (true != false) {
-        uint32_t notifications;
-        (void)xTaskNotifyWaitIndexed(notifyIndex, 0, ULONG_MAX, &notifications, portMAX_DELAY);
+        uint32_t notifications = 0;
+        (void)xTaskNotifyWaitIndexed(notifyIndex, 0, UINT32_MAX, &notifications,
+                                     etl::min(outgoingFlushWait(), retransmitWait()));
 
-        if (notifications & notifyShutdownMask) {
-            shutdown();
-        }
+        handleNotifications(notifications);
+        retransmitIfDue();
 
-        if (notifications & notifyConnectionLostMask) {
-            // It's possible that we detected the connection closing while doing a write and
-            // signaled the connection to shutdown, but the connection shutdown before getting the
-            // signal and also signalled us to shut down. Hey Mo!
-            // We ignore the signal if we're not connected, but this needs to be considered more
-            // closely as there could be a race condition here. Would it be better to not signal the
-            // session if it's not connected to the connection in question?
-            if (_connection != nullptr) {
-                connectionLost();
-            }
-        }
+        // Publishes go out either when enough of them have built up to be worth a TCP segment or
+        // when the oldest of them has waited out the flush delay.
+        flushOutgoingIfDue();
+    }
+}
 
-        if (notifications & notifyNewConnectionIdMask) {
-            const unsigned newConnectionId =
-                (notifications & notifyNewConnectionIdMask) >> notifyNewConnectionIdShift;
-            newConnection(newConnectionId);
-        }
+// Called by the event loop engine's broker task on each pass in place of the session's own task.
+void MQTTSession::service() {
+    handleNotifications(pendingNotifications.exchange(0));
+    retransmitIfDue();
+    flushOutgoingIfDue();
+}
+
+void MQTTSession::handleNotifications(uint32_t notifications) {
+    if (notifications & notifyShutdownMask) {
+        shutdown();
+    }
 
-        if (notifications & notifyMessageReadyMask) {
-            readMessages();
+    if (notifications & notifyConnectionLostMask) {
+        // It's possible that we detected the connection closing while doing a write and
+        // signaled the connection to shutdown, but the connection shutdown before getting the
+        // signal and also signalled us to shut down. Hey Mo!
+        // We ignore the signal if we're not connected, but this needs to be considered more
+        // closely as there could be a race condition here. Would it be better to not signal the
+        // session if it's not connected to the connection in question?
+        if (_connection != nullptr) {
+            connectionLost();
         }
     }
+
+    if (notifications & notifyKeepAliveExpiredMask) {
+        keepAliveExpired();
+    }
+
+    if (notifications & notifyNewConnectionIdMask) {
+        const unsigned newConnectionId =
+            (notifications & notifyNewConnectionIdMask) >> notifyNewConnectionIdShift;
+        newConnection(newConnectionId);
+    }
+
+    if (notifications & notifyMessageReadyMask) {
+        readMessages();
+    }
+
+    if (notifications & notifyPublishReadyMask) {
+        drainPublishQueue();
+        drainRelayQueue();
+    }
+}
+
+bool MQTTSession::notify(uint32_t notification) {
+    if (mqttBrokerEngine == MQTT_BROKER_EVENT_LOOP) {
+        pendingNotifications.fetch_or(notification);
+        broker.wakeEventLoop();
+        return true;
+    }
+
+    return xTaskNotifyIndexed(taskHandle(), notifyIndex, notification, eSetBits) == pdPASS;
+}
+
+// True if running on the task that does this session's work.
+bool MQTTSession::onSessionTask() {
+    if (mqttBrokerEngine == MQTT_BROKER_EVENT_LOOP) {
+        return xTaskGetCurrentTaskHandle() == broker.taskHandle();
+    } else {
+        return xTaskGetCurrentTaskHandle() == taskHandle();
+    }
 }
 
 // This method is called from the from a MQTTConnection thread with the session lock taken.
@@ -92,8 +156,7 @@ void MQTTSession::assignConnection(unsigned connectionId) {
     // return value.
     cancelPendingConnectionAssignment();
 
-     if (xTaskNotifyIndexed(taskHandle(), notifyIndex, connectionId << notifyNewConnectionIdShift,
-                            eSetBits) != pdPASS) {
+    if (!notify(connectionId << notifyNewConnectionIdShift)) {
         logger << logErrorMQTT << "Failed to send new connection notification to session #" << id
                << eol;
         errorExit();
@@ -106,7 +169,7 @@ void MQTTSession::initiateShutdown() {
     // new client notification and if there was one, mark the Connection for disconnection.
     cancelPendingConnectionAssignment();
 
-     if (xTaskNotifyIndexed(taskHandle(), notifyIndex, notifyShutdownMask, eSetBits) != pdPASS) {
+    if (!notify(notifyShutdownMask)) {
         taskLogger() << logErrorMQTT << "Failed to send shutdown notification to session #" << id
                      << eol;
         errorExit();
@@ -114,8 +177,13 @@ void MQTTSession::initiateShutdown() {
 }
 
 void MQTTSession::cancelPendingConnectionAssignment() {
-    const uint32_t oldNotifications = ulTaskNotifyValueClear(taskHandle(),
-                                                             notifyNewConnectionIdMask);
+    uint32_t oldNotifications;
+    if (mqttBrokerEngine == MQTT_BROKER_EVENT_LOOP) {
+        oldNotifications = pendingNotifications.fetch_and(~notifyNewConnectionIdMask);
+    } else {
+        oldNotifications = ulTaskNotifyValueClearIndexed(taskHandle(), notifyIndex,
+                                                         notifyNewConnectionIdMask);
+    }
     const unsigned skippedConnectionId =
         (oldNotifications & notifyNewConnectionIdMask) >> notifyNewConnectionIdShift;
     if (skippedConnectionId) {
@@ -133,13 +201,17 @@ void MQTTSession::connectionLost() {
     // session.
     _connection->markForDisconnection();
     _connection = nullptr;
+    setConnectionSocket(0);
+    stopKeepAliveTimer();
 
     if (cleanSession) {
         logger << logDebugMQTT << "Session #" << id << " lost connection to " << clientID
                << ". Going idle." << eol;
 
         dataModel.unsubscribeAll(*this);
+        discardInFlight();
         clientID.clear();
+        endGeneration();
         broker.sessionGoingIdle(*this);
     } else {
         logger << logDebugMQTT << "Session #" << id << " lost connection to " << clientID
@@ -169,9 +241,8 @@ void MQTTSession::newConnection(unsigned connectionId) {
     }
 
     _connection = broker.connectionForId(connectionId);
-    connectionSocket = _connection->socket();
+    setConnectionSocket(_connection->socket());
     clientID = _connection->clientID();
-    connectionMessageBuffer = _connection->sessionMessageBuffer();
 
     if (freshSession) {
         // Until we suck in a CONNECT message from the connection, we mark the session as being a
@@ -187,16 +258,20 @@ void MQTTSession::newConnection(unsigned connectionId) {
     }
 }
 
+// Messages are handled where they sit in the connection's receive ring and released back to it
+// once done with.
 void MQTTSession::readMessages() {
-    size_t messageSize;
-    uint8_t messageBuffer[maxIncomingMessageSize];
-
-    while (_connection &&
-           (messageSize = xMessageBufferReceive(connectionMessageBuffer, messageBuffer,
-                                                maxIncomingMessageSize, 0)) > 0) {
-        MQTTMessage message = MQTTMessage(messageBuffer, messageSize);
+    MQTTConnection *connection = _connection;
+    if (connection == nullptr) {
+        return;
+    }
+    MQTTReceiveRing &receiveRing = connection->receiveRing();
 
+    MQTTMessage message;
+    while (_connection == connection && receiveRing.nextMessage(message)) {
         _messagesReceived++;
+        // Any message from the client will do to show that it's still there.
+        resetKeepAliveTimer();
 
         MQTTMessageType msgType = message.messageType();
         switch (msgType) {
@@ -238,13 +313,26 @@ void MQTTSession::readMessages() {
                        << message.messageTypeStr() << " from client " << clientID << eol;
                 break;
 
+            case MQTT_MSG_PUBLISH:
+                publishMessageReceived(message);
+                break;
+
             case MQTT_MSG_PUBACK:
+                publishAckMessageReceived(message);
+                break;
+
             case MQTT_MSG_PUBREL:
             case MQTT_MSG_PUBCOMP:
             default:
                 logger << logWarnMQTT << "Received unimplemented message type "
                        << message.messageTypeStr() << " from client " << clientID << eol;
         }
+
+        // Should handling the message have parted us from the connection, the connection throws
+        // away what's left in its ring when it goes idle.
+        if (_connection == connection) {
+            receiveRing.releaseMessage();
+        }
     }
 }
 
@@ -258,16 +346,22 @@ void MQTTSession::connectMessageReceived(MQTTMessage &message) {
         errorExit();
     }
     cleanSession = connectMessage.cleanSession();
+    startKeepAliveTimer(connectMessage.keepAliveSec());
+    if (cleanSession) {
+        discardInFlight();
+    }
 
     logger << "Session #" << id << " sending a CONNACK Accepted to " << clientID << eol;
 
-    if (sendMQTTConnectAckMessage(connectionSocket, !freshSession, MQTT_CONNACK_ACCEPTED)) {
-        _messagesSent++;
-    } else {
+    if (!sendConnectAckMessage(!freshSession, MQTT_CONNACK_ACCEPTED)) {
         logger << logWarnMQTT << "Failed to send CONNACK message to client " << clientID
                << ". Closing connection." << eol;
         handleConnectionSendFailure();
+        return;
     }
+
+    // A client resuming a session gets the QoS 1 publishes it never acknowledged sent again.
+    resendInFlight();
 }
 
 void MQTTSession::subscribeMessageReceived(MQTTMessage &message) {
@@ -279,8 +373,6 @@ void MQTTSession::subscribeMessageReceived(MQTTMessage &message) {
         return;
     }
 
-    resetKeepAliveTimer();
-
     // Loop through the topics, trying to subscribe to each and adding the result to the SUBACK
     // message.
     unsigned topicFilterCount = subscribeMessage.numTopicFilters();
@@ -312,10 +404,13 @@ void MQTTSession::subscribeMessageReceived(MQTTMessage &message) {
                    << *topicFilterStr << "'" << eol;
             subscribeResults[topicFilterIndex] = subscribeResult(false, 0);
         } else {
-            if (dataModel.subscribe(topicFilter, *this, (uint32_t)maxQoS)) {
+            // The granted QoS rides along with the subscription as its cookie, coming back to us
+            // with each publish.
+            const uint8_t grantedQoS = etl::min(maxQoS, maxGrantedQoS);
+            if (dataModel.subscribe(topicFilter, *this, subscriptionCookie(grantedQoS))) {
                 logger << logDebugMQTT << "Topic Filter '" << topicFilter << "' subscribed to by '"
-                       << clientID << "'" << eol;
-                subscribeResults[topicFilterIndex] = subscribeResult(true, 0);
+                       << clientID << "' at QoS " << grantedQoS << eol;
+                subscribeResults[topicFilterIndex] = subscribeResult(true, grantedQoS);
             } else {
                 logger << logWarnMQTT << "Client '" << clientID
                        << "' failed to subscribe to Topic Filter '" << topicFilter << "'" << eol;
@@ -342,8 +437,6 @@ void MQTTSession::unsubscribeMessageReceived(MQTTMessage &message) {
         return;
     }
 
-    resetKeepAliveTimer();
-
     unsigned topicFilterCount = unsubscribeMessage.numTopicFilters();
     unsigned topicFilterIndex;
     for (topicFilterIndex = 0; topicFilterIndex < topicFilterCount; topicFilterIndex++) {
@@ -391,8 +484,6 @@ void MQTTSession::pingRequestMessageReceived(MQTTMessage &message) {
         return;
     }
 
-    resetKeepAliveTimer();
-
     logger << logDebugMQTT << "Sending MQTT PINGRESP message to client '" << clientID << eol;
 
     if (!sendPingResponseMessage()) {
@@ -417,6 +508,96 @@ void MQTTSession::disconnectMessageReceived(MQTTMessage &message) {
     shutdown();
 }
 
+// Values published by the client are handled right here on the session's task: a write to a
+// command topic goes to the writable leaf for it and anything else goes straight onto the queues
+// of the sessions subscribed to it. QoS 2 isn't supported.
+void MQTTSession::publishMessageReceived(MQTTMessage &message) {
+    _publishMessagesReceived++;
+
+    MQTTPublishMessage publishMessage(message);
+    if (!publishMessage.parse()) {
+        logger << logWarnMQTT << "Bad MQTT PUBLISH message from client " << clientID
+               << ". Terminating connection." << eol;
+        shutdown();
+        return;
+    }
+
+    const uint8_t qosLevel = publishMessage.qosLevel();
+    if (qosLevel > maxGrantedQoS) {
+        logger << logWarnMQTT << "Unsupported QoS " << qosLevel << " PUBLISH from client "
+               << clientID << ". Terminating connection." << eol;
+        shutdown();
+        return;
+    }
+
+    char topic[maxTopicNameLength + 1];
+    if (!publishMessage.topic().copyTo(topic, maxTopicNameLength)) {
+        logger << logWarnMQTT << "MQTT PUBLISH message from client " << clientID
+               << " with too long of a Topic Name '" << publishMessage.topic() << "'" << eol;
+    } else if (strpbrk(topic, "+#") != nullptr) {
+        logger << logWarnMQTT << "MQTT PUBLISH message from client " << clientID
+               << " with a wildcard in its Topic Name '" << topic
+               << "'. Terminating connection." << eol;
+        shutdown();
+        return;
+    } else if (topic[0] == '$') {
+        logger << logWarnMQTT << "Client " << clientID << " published to reserved topic '"
+               << topic << "'" << eol;
+    } else {
+        char value[maxMQTTPublishValueLength + 1];
+        if (!publishMessage.copyPayloadTo(value, maxMQTTPublishValueLength)) {
+            logger << logWarnMQTT << "MQTT PUBLISH message from client " << clientID
+                   << " to topic '" << topic << "' with too large of a value" << eol;
+        } else {
+            logger << logDebugMQTT << "Client '" << clientID << "' published '" << value
+                   << "' to topic '" << topic << "' with QoS " << qosLevel << eol;
+            routePublish(topic, value);
+        }
+    }
+
+    // A value we couldn't use is still acknowledged, as sending it again wouldn't help.
+    if (qosLevel == 1 && !sendPublishAckMessage(publishMessage.packetId())) {
+        logger << logWarnMQTT << "Failed to send PUBACK message to client " << clientID
+               << ". Closing connection." << eol;
+        handleConnectionSendFailure();
+    }
+}
+
+// The retain flag isn't acted on here. Command values are retained by their leaves, while values
+// for other topics are only passed on to current subscribers.
+void MQTTSession::routePublish(const char *topic, const char *value) {
+    if (dataModel.isCommandTopic(topic)) {
+        if (!dataModel.writeCommand(topic, value)) {
+            logger << logWarnMQTT << "Command '" << value << "' to topic '" << topic
+                   << "' from client " << clientID << " rejected" << eol;
+        }
+    } else {
+        dataModel.publishTopic(topic, value);
+    }
+}
+
+void MQTTSession::publishAckMessageReceived(MQTTMessage &message) {
+    MQTTPublishAckMessage publishAckMessage(message);
+    if (!publishAckMessage.parse()) {
+        logger << logWarnMQTT << "Bad MQTT PUBACK message from client " << clientID
+               << ". Terminating connection." << eol;
+        shutdown();
+        return;
+    }
+
+    const uint16_t packetId = publishAckMessage.packetId();
+    if (!inFlight.acknowledge(packetId)) {
+        // Most likely an acknowledgement for a publish since replaced by a newer value.
+        logger << logDebugMQTT << "PUBACK from client " << clientID << " for packet id "
+               << packetId << " not in flight" << eol;
+        return;
+    }
+
+    if (publishHeld) {
+        drainPublishQueue();
+    }
+}
+
 void MQTTSession::serverOnlyMsgReceivedError(MQTTMessage &message) {
     logger << logErrorMQTT << "Received server->client only message " << message.messageTypeStr()
            << " from client " << clientID << ". Terminating connection." << eol;
@@ -429,162 +610,506 @@ void MQTTSession::reservedMsgReceivedError(MQTTMessage &message) {
     shutdown();
 }
 
-void MQTTSession::publish(const char *topic, const char *value, bool retainedValue) {
-    if (_connection != nullptr && connectionSocket != 0) {
-        logger << logDebugMQTT << "Publishing Topic '" << topic << "' to Client '" << clientID
-               << "' with value '" << value << "' and retain " << retainedValue << eol;
+// Called from the task that updated a subscribed to leaf, with the data model's subscription lock
+// held. We don't do anything here that might block on the network; the update is put on the
+// session's publish queue for the session task to pick up.
+void MQTTSession::publish(DataModelLeaf &leaf, const char *value, bool retainedValue,
+                          uint32_t cookie) {
+    if (_connection == nullptr) {
+        return;
+    }
 
-        sendPublishMessage(topic, value, false, 0, retainedValue, 0);
-    } else {
-        logger << logDebugMQTT << "Skipping Publishing Topic '" << topic << "' to Client '"
-               << clientID << ": no connection." << eol;
+    const size_t valueLength = strlen(value);
+    if (valueLength > maxMQTTPublishValueLength) {
+        _publishMessagesQueueDropped++;
+        return;
     }
-}
 
-uint8_t MQTTSession::subscribeResult(bool success, uint8_t maxQoS) {
-    if (!success) {
-        return MQTT_SUBACK_FAILURE_FLAG;
-    } else {
-        return maxQoS;
+    bool consumerCaughtUp = false;
+    takePublishLock();
+    if (cookieIsCurrent(cookie)) {
+        queuePublish(leaf, value, valueLength, retainedValue, (uint8_t)cookie, consumerCaughtUp);
+    }
+    releasePublishLock();
+
+    if (consumerCaughtUp) {
+        if (!notify(notifyPublishReadyMask)) {
+            taskLogger() << logErrorMQTT << "Failed to send publish ready notification to session #"
+                         << id << eol;
+            errorExit();
+        }
     }
 }
 
-bool MQTTSession::sendSubscribeAckMessage(uint16_t packetId, uint8_t numberResults,
-                                              uint8_t *results) {
-    MQTTFixedHeader fixedHeader;
-    MQTTSubscribeAckVariableHeader variableHeader;
+// Called with the publish lock held.
+void MQTTSession::queuePublish(DataModelLeaf &leaf, const char *value, size_t valueLength,
+                               bool retainedValue, uint8_t qosLevel, bool &consumerCaughtUp) {
+    if (publishQueue.push(leaf, value, valueLength, retainedValue, qosLevel, consumerCaughtUp)) {
+        return;
+    }
 
-    fixedHeader.typeAndFlags = MQTT_MSG_SUBACK << MQTT_MSG_TYPE_SHIFT;
-    if (send(connectionSocket, &fixedHeader, sizeof(fixedHeader), 0) < 0) {
-        return false;
+    switch (publishQueueOverflowPolicy) {
+        case MQTT_PUBLISH_QUEUE_DROP_OLDEST:
+            if (publishQueue.dropOldest()) {
+                _publishMessagesQueueDropped++;
+            }
+            break;
+
+        case MQTT_PUBLISH_QUEUE_COALESCE:
+            if (publishQueue.coalesce(leaf, value, valueLength, retainedValue, qosLevel)) {
+                _publishMessagesCoalesced++;
+                return;
+            }
+            break;
+
+        case MQTT_PUBLISH_QUEUE_BLOCK:
+            waitForPublishQueueSpace();
+            break;
     }
-    const uint8_t remainingLength = sizeof(MQTTSubscribeAckVariableHeader) + numberResults;
-    if (!mqttWriteRemainingLength(connectionSocket, remainingLength)) {
-        return false;
+
+    if (!publishQueue.push(leaf, value, valueLength, retainedValue, qosLevel,
+                           consumerCaughtUp)) {
+        _publishMessagesQueueDropped++;
     }
+}
 
-    variableHeader.packetIdMSB = packetId >> 8;
-    variableHeader.packetIdLSB = packetId & 0xff;
+// Called from the task of the client that published the value. Relayed values go out at QoS 0
+// whatever the subscription's granted QoS, as the in-flight window only holds leaf updates. There's
+// no overflow policy; when the relay queue is full the value is dropped.
+void MQTTSession::publishTopic(const char *topic, const char *value, uint32_t cookie) {
+    if (_connection == nullptr) {
+        return;
+    }
 
-    if (send(connectionSocket, &variableHeader, sizeof(variableHeader), 0) < 0) {
-        return false;
+    bool consumerCaughtUp = false;
+    takePublishLock();
+    if (cookieIsCurrent(cookie) && !relayQueue.push(topic, value, consumerCaughtUp)) {
+        _publishMessagesQueueDropped++;
     }
+    releasePublishLock();
 
-    if (send(connectionSocket, results, numberResults * sizeof(uint8_t), 0) < 0) {
-        return false;
+    if (consumerCaughtUp) {
+        if (!notify(notifyPublishReadyMask)) {
+            taskLogger() << logErrorMQTT << "Failed to send publish ready notification to session #"
+                         << id << eol;
+            errorExit();
+        }
     }
+}
 
-    _messagesSent++;
+// Used with the block overflow policy. The producer holds the publish lock, which the session task
+// needs when sending retained values for a new subscription, so we only block for a bounded time.
+// If it's the session task itself that's publishing it can make room by draining the queue.
+void MQTTSession::waitForPublishQueueSpace() {
+    if (onSessionTask()) {
+        drainPublishQueue();
+        return;
+    }
 
-    return true;
+    for (TickType_t waited = 0; publishQueue.isFull() && waited < publishQueueBlockTimeout;
+         waited++) {
+        vTaskDelay(1);
+    }
 }
 
-bool MQTTSession::sendUnsubscribeAckMessage(uint16_t packetId) {
-    MQTTFixedHeader fixedHeader;
-    MQTTUnsubscribeAckVariableHeader variableHeader;
+// As with the data model's subscription lock, the wait is only timed if the lock is contended.
+void MQTTSession::takePublishLock() {
+    if (xSemaphoreTake(publishLock, 0) != pdTRUE) {
+        const int64_t waitStart = esp_timer_get_time();
+        if (xSemaphoreTake(publishLock, pdMS_TO_TICKS(lockTimeoutMs)) != pdTRUE) {
+            taskLogger() << logErrorMQTT << "Failed to get publish lock mutex" << eol;
+            errorExit();
+        }
+        const uint32_t waitUs = (uint32_t)(esp_timer_get_time() - waitStart);
 
-    fixedHeader.typeAndFlags = MQTT_MSG_UNSUBACK << MQTT_MSG_TYPE_SHIFT;
-    if (send(connectionSocket, &fixedHeader, sizeof(fixedHeader), 0) < 0) {
-        return false;
-    }
-    const uint8_t remainingLength = sizeof(MQTTUnsubscribeAckVariableHeader);
-    if (!mqttWriteRemainingLength(connectionSocket, remainingLength)) {
-        return false;
+        _publishLockContentions++;
+        _publishLockWaitUs += waitUs;
+        if (waitUs > _publishLockMaxWaitUs) {
+            _publishLockMaxWaitUs = waitUs;
+        }
     }
 
-    variableHeader.packetIdMSB = packetId >> 8;
-    variableHeader.packetIdLSB = packetId & 0xff;
+    _publishLockAcquisitions++;
+}
 
-    if (send(connectionSocket, &variableHeader, sizeof(variableHeader), 0) < 0) {
-        return false;
+void MQTTSession::releasePublishLock() {
+    xSemaphoreGive(publishLock);
+}
+
+// A QoS 1 record that can't get into a full in-flight window is held back, and with it the rest
+// of the queue, until a PUBACK makes room. While held, the queue backs up and its overflow policy
+// decides what gives.
+void MQTTSession::drainPublishQueue() {
+    if (publishHeld) {
+        if (connectionSocket == 0) {
+            _publishMessagesDropped++;
+        } else if (!publishRecord(heldPublish)) {
+            return;
+        }
+        publishHeld = false;
     }
 
-    _messagesSent++;
+    MQTTPublishRecord record;
+    while (publishQueue.pop(record)) {
+        if (connectionSocket == 0) {
+            _publishMessagesDropped++;
+            continue;
+        }
 
-    return true;
+        if (!publishRecord(record)) {
+            heldPublish = record;
+            publishHeld = true;
+            return;
+        }
+    }
 }
 
-bool MQTTSession::sendPublishMessage(const char *topic, const char *value, bool dup,
-                                     uint8_t qosLevel, bool retain, uint16_t packetId) {
-    MQTTFixedHeader fixedHeader;
+// Returns false if the record is QoS 1 and must wait for room in the in-flight window.
+bool MQTTSession::publishRecord(const MQTTPublishRecord &record) {
+    if (record.qosLevel == 0) {
+        char topicBuffer[maxTopicNameLength + 1];
+        const char *topic = topicName(*record.leaf, topicBuffer);
 
-    fixedHeader.typeAndFlags = MQTT_MSG_PUBLISH << MQTT_MSG_TYPE_SHIFT;
-    if (dup) {
-        fixedHeader.typeAndFlags |= MQTT_PUBLISH_FLAGS_DUP_MASK;
+        logger << logDebugMQTT << "Publishing Topic '" << topic << "' to Client '" << clientID
+               << "' with value '" << record.value << "' and retain " << record.retainedValue
+               << eol;
+
+        queuePublishMessage(topic, record.value, false, 0, record.retainedValue, 0);
+        return true;
     }
-    fixedHeader.typeAndFlags |= qosLevel << MQTT_PUBLISH_FLAGS_QOS_SHIFT;
-    if (retain) {
-        fixedHeader.typeAndFlags |= MQTT_PUBLISH_FLAGS_RETAIN_MASK;
+
+    MQTTInFlightPublish *publish = inFlight.find(*record.leaf);
+    if (publish != nullptr) {
+        inFlight.replace(*publish, record);
+        _inFlightCoalesced++;
+    } else {
+        publish = inFlight.add(record);
+        if (publish == nullptr) {
+            return false;
+        }
     }
-    if (send(connectionSocket, &fixedHeader, sizeof(fixedHeader), 0) < 0) {
-        _publishMessagesDropped++;
-        return false;
+
+    sendInFlight(*publish, false);
+    return true;
+}
+
+const char *MQTTSession::topicName(DataModelLeaf &leaf, char *topicBuffer) {
+    const char *topic = leaf.topicName();
+    if (topic == nullptr) {
+        leaf.buildTopicName(topicBuffer);
+        topic = topicBuffer;
     }
 
-    const size_t valueLength = strlen(value);
-    uint32_t remainingLength;
-    remainingLength = strlen(topic) + 2 + valueLength;
-    if (qosLevel > 0) {
-        remainingLength += 2;
+    return topic;
+}
+
+void MQTTSession::sendInFlight(MQTTInFlightPublish &publish, bool dup) {
+    char topicBuffer[maxTopicNameLength + 1];
+    const char *topic = topicName(*publish.leaf, topicBuffer);
+
+    logger << logDebugMQTT << "Publishing Topic '" << topic << "' to Client '" << clientID
+           << "' with value '" << publish.value << "', packet id " << publish.packetId
+           << " and dup " << dup << eol;
+
+    publish.sentAt = xTaskGetTickCount();
+    queuePublishMessage(topic, publish.value, dup, 1, publish.retainedValue, publish.packetId);
+}
+
+void MQTTSession::resendInFlight() {
+    for (size_t index = 0; index < MQTTInFlightWindow::capacity; index++) {
+        MQTTInFlightPublish *publish = inFlight.publish(index);
+        if (publish != nullptr) {
+            _retransmits++;
+            sendInFlight(*publish, true);
+        }
     }
-    if (!mqttWriteRemainingLength(connectionSocket, remainingLength)) {
-        _publishMessagesDropped++;
-        return false;
+}
+
+// Sending a publish again moves it to the back of the window, so we keep going until the oldest
+// one isn't yet due.
+void MQTTSession::retransmitIfDue() {
+    MQTTInFlightPublish *publish;
+    while (connectionSocket != 0 && (publish = inFlight.oldest()) != nullptr &&
+           xTaskGetTickCount() - publish->sentAt >= retransmitInterval) {
+        _retransmits++;
+        sendInFlight(*publish, true);
     }
+}
 
-    if (!mqttWriteMQTTString(connectionSocket, topic)) {
-        _publishMessagesDropped++;
-        return false;
+TickType_t MQTTSession::retransmitWait() {
+    const MQTTInFlightPublish *publish = inFlight.oldest();
+    if (publish == nullptr) {
+        return portMAX_DELAY;
+    }
+
+    const TickType_t waited = xTaskGetTickCount() - publish->sentAt;
+    if (waited >= retransmitInterval) {
+        return 0;
     }
 
-    if (qosLevel > 0) {
-        if (!mqttWriteUInt16(connectionSocket, packetId)) {
+    return retransmitInterval - waited;
+}
+
+void MQTTSession::drainRelayQueue() {
+    const MQTTRelayRecord *record;
+    while ((record = relayQueue.front()) != nullptr) {
+        if (connectionSocket == 0) {
             _publishMessagesDropped++;
-            return false;
+        } else {
+            logger << logDebugMQTT << "Relaying Topic '" << record->topic << "' to Client '"
+                   << clientID << "' with value '" << record->value << "'" << eol;
+
+            queuePublishMessage(record->topic, record->value, false, 0, false, 0);
         }
+        relayQueue.pop();
     }
+}
 
-    if (send(connectionSocket, value, valueLength, 0) < 0) {
-        _publishMessagesDropped++;
-        return false;
+void MQTTSession::discardInFlight() {
+    inFlight.clear();
+    publishHeld = false;
+}
+
+uint32_t MQTTSession::subscriptionCookie(uint8_t grantedQoS) const {
+    return (generation << cookieGenerationShift) | grantedQoS;
+}
+
+// Called with the publish lock held.
+bool MQTTSession::cookieIsCurrent(uint32_t cookie) const {
+    return (cookie >> cookieGenerationShift) == generation;
+}
+
+// Called once the session has unsubscribed from everything, before it's handed back to the
+// broker for reuse. Producers check the generation with the publish lock held, so once this
+// returns none of them can queue a publish meant for the session's previous client.
+void MQTTSession::endGeneration() {
+    takePublishLock();
+    generation = (generation + 1) & generationMask;
+    releasePublishLock();
+}
+
+uint8_t MQTTSession::subscribeResult(bool success, uint8_t maxQoS) {
+    if (!success) {
+        return MQTT_SUBACK_FAILURE_FLAG;
+    } else {
+        return maxQoS;
     }
+}
 
-    _messagesSent++;
-    _publishMessagesSent++;
+bool MQTTSession::sendConnectAckMessage(bool sessionPresent, uint8_t returnCode) {
+    bool built = packetBuilder.buildConnectAck(sessionPresent, returnCode);
+    if (!built && flushOutgoing()) {
+        built = packetBuilder.buildConnectAck(sessionPresent, returnCode);
+    }
 
-    return true;
+    return built && sendOutgoing();
+}
+
+bool MQTTSession::sendSubscribeAckMessage(uint16_t packetId, uint8_t numberResults,
+                                          uint8_t *results) {
+    bool built = packetBuilder.buildSubscribeAck(packetId, numberResults, results);
+    if (!built && flushOutgoing()) {
+        built = packetBuilder.buildSubscribeAck(packetId, numberResults, results);
+    }
+
+    return built && sendOutgoing();
+}
+
+bool MQTTSession::sendUnsubscribeAckMessage(uint16_t packetId) {
+    bool built = packetBuilder.buildUnsubscribeAck(packetId);
+    if (!built && flushOutgoing()) {
+        built = packetBuilder.buildUnsubscribeAck(packetId);
+    }
+
+    return built && sendOutgoing();
+}
+
+bool MQTTSession::sendPublishAckMessage(uint16_t packetId) {
+    bool built = packetBuilder.buildPublishAck(packetId);
+    if (!built && flushOutgoing()) {
+        built = packetBuilder.buildPublishAck(packetId);
+    }
+
+    return built && sendOutgoing();
 }
 
 bool MQTTSession::sendPingResponseMessage() {
-    MQTTFixedHeader fixedHeader;
+    bool built = packetBuilder.buildPingResponse();
+    if (!built && flushOutgoing()) {
+        built = packetBuilder.buildPingResponse();
+    }
+
+    return built && sendOutgoing();
+}
 
-    fixedHeader.typeAndFlags = MQTT_MSG_PINGRESP << MQTT_MSG_TYPE_SHIFT;
-    if (send(connectionSocket, &fixedHeader, sizeof(fixedHeader), 0) < 0) {
+// Rather than putting a PUBLISH on the wire right away, we add it to the outgoing buffer so that
+// the burst of updates that typically come from a single NMEA sentence goes out together. The
+// buffer is flushed once it passes the threshold or the oldest PUBLISH in it has waited out the
+// flush delay.
+bool MQTTSession::queuePublishMessage(const char *topic, const char *value, bool dup,
+                                      uint8_t qosLevel, bool retain, uint16_t packetId) {
+    bool startsBatch = packetBuilder.isEmpty();
+    bool built = packetBuilder.buildPublish(topic, value, dup, qosLevel, retain, packetId);
+    if (!built && !startsBatch) {
+        flushOutgoing();
+        // With the event loop engine, a client that isn't keeping up can leave the buffer
+        // partly full.
+        startsBatch = packetBuilder.isEmpty();
+        built = packetBuilder.buildPublish(topic, value, dup, qosLevel, retain, packetId);
+    }
+    if (!built) {
+        if (startsBatch) {
+            logger << logWarnMQTT << "PUBLISH of topic '" << topic << "' to client " << clientID
+                   << " too large for the outgoing buffer" << eol;
+        }
+        _publishMessagesDropped++;
         return false;
     }
 
-    if (!mqttWriteRemainingLength(connectionSocket, 0)) {
-        return false;
+    outgoingPackets++;
+    outgoingPublishes++;
+
+    if (startsBatch) {
+        outgoingPendingSince = xTaskGetTickCount();
     }
 
-    _messagesSent++;
+    if (packetBuilder.size() >= outgoingFlushThreshold) {
+        return flushOutgoing();
+    }
 
     return true;
 }
 
+// Adds whatever was last built to the outgoing buffer's accounting and sends everything.
+bool MQTTSession::sendOutgoing() {
+    outgoingPackets++;
+    return flushOutgoing();
+}
+
+// Sends everything in the outgoing buffer in one go.
+bool MQTTSession::flushOutgoing() {
+    if (packetBuilder.isEmpty()) {
+        return true;
+    }
+
+    size_t bytes = packetBuilder.size();
+    bool success;
+    if (mqttBrokerEngine == MQTT_BROKER_EVENT_LOOP) {
+        // The event loop can't wait on one client's socket. What doesn't go out now is left in the
+        // buffer for the broker to send once the socket is writable.
+        success = packetBuilder.sendAvailable(connectionSocket, bytes);
+        outgoingBacklogged = success && !packetBuilder.isEmpty();
+    } else {
+        success = packetBuilder.send(connectionSocket);
+    }
+    if (success) {
+        _messagesSent += outgoingPackets;
+        _publishMessagesSent += outgoingPublishes;
+        _flushes++;
+        _bytesFlushed += bytes;
+    } else {
+        _publishMessagesDropped += outgoingPublishes;
+    }
+    outgoingPackets = 0;
+    outgoingPublishes = 0;
+
+    return success;
+}
+
+// Throws away anything that didn't make it out before the connection went away.
+void MQTTSession::discardOutgoing() {
+    _publishMessagesDropped += outgoingPublishes;
+    packetBuilder.reset();
+    outgoingPackets = 0;
+    outgoingPublishes = 0;
+    outgoingBacklogged = false;
+}
+
+void MQTTSession::flushOutgoingIfDue() {
+    if (!packetBuilder.isEmpty()) {
+        const TickType_t pendingTime = xTaskGetTickCount() - outgoingPendingSince;
+        if (pendingTime >= outgoingFlushDelay) {
+            if (!flushOutgoing()) {
+                logger << logWarnMQTT << "Failed to flush outgoing messages to client " << clientID
+                       << eol;
+            }
+        }
+    }
+}
+
+// Returns how long the session task can sleep before the oldest queued PUBLISH is due to go out.
+TickType_t MQTTSession::outgoingFlushWait() {
+    if (packetBuilder.isEmpty()) {
+        return portMAX_DELAY;
+    }
+
+    const TickType_t pendingTime = xTaskGetTickCount() - outgoingPendingSince;
+    if (pendingTime >= outgoingFlushDelay) {
+        return 0;
+    } else {
+        return outgoingFlushDelay - pendingTime;
+    }
+}
+
+void MQTTSession::setConnectionSocket(int connectionSocket) {
+    discardOutgoing();
+    this->connectionSocket = connectionSocket;
+
+    // With no connection, draining the publish queue drops whatever was waiting on the old one.
+    if (connectionSocket == 0) {
+        drainPublishQueue();
+    }
+}
+
 const etl::istring &MQTTSession::name() const {
     return clientID;
 }
 
+// Per the MQTT spec, a client that we haven't heard from in one and a half times its keep-alive
+// interval is to be disconnected. A keep-alive of 0 turns this off.
+void MQTTSession::startKeepAliveTimer(uint16_t keepAliveSec) {
+    keepAliveTimeout = ((uint32_t)keepAliveSec * 3 + 1) / 2;
+    if (keepAliveTimeout == 0) {
+        stopKeepAliveTimer();
+        return;
+    }
+
+    resetKeepAliveTimer();
+    broker.keepAliveWheel().start(*this);
+}
+
 void MQTTSession::resetKeepAliveTimer() {
-    // *** Implement! ***
+    if (keepAliveTimeout) {
+        _keepAliveDeadline.store(MQTTKeepAliveWheel::now() + keepAliveTimeout,
+                                 std::memory_order_relaxed);
+    }
+}
+
+void MQTTSession::stopKeepAliveTimer() {
+    keepAliveTimeout = 0;
+    broker.keepAliveWheel().stop(*this);
+}
+
+// The keep-alive wheel has taken us off of it and let us know that the client went quiet. Hang up
+// on it and, since a client that's gone missing isn't likely to come back for its session, free
+// the session up for another.
+void MQTTSession::keepAliveExpired() {
+    // The connection may have gone on its own while the notification was on its way.
+    if (_connection == nullptr || keepAliveTimeout == 0) {
+        return;
+    }
+
+    logger << logWarnMQTT << "Client " << clientID << " on session #" << id
+           << " missed its keep-alive. Closing connection." << eol;
+    shutdown();
 }
 
 void MQTTSession::handleConnectionSendFailure() {
     // Signal the Connection that we got hung up on and make sure we stop using it
     _connection->markForDisconnection();
     _connection = nullptr;
-    connectionSocket = 0;
+    setConnectionSocket(0);
+    stopKeepAliveTimer();
 
     // MQTT's clean session flag on a connect indicates that the session should stay open after the
     // loss of a tcp connection. If the flag was off when the connection was made, we should stick
@@ -594,7 +1119,9 @@ void MQTTSession::handleConnectionSendFailure() {
         broker.sessionLostConnection(*this);
     } else {
         dataModel.unsubscribeAll(*this);
+        discardInFlight();
         clientID.clear();
+        endGeneration();
         broker.sessionGoingIdle(*this);
     }
 }
@@ -604,22 +1131,25 @@ void MQTTSession::shutdown() {
            << eol;
 
     dataModel.unsubscribeAll(*this);
+    stopKeepAliveTimer();
+    discardInFlight();
 
     // If we have a connection currently, make sure we signal it to close and for sanity, clear our
     // references as well.
     if (_connection) {
         _connection->markForDisconnection();
         _connection = nullptr;
-        connectionSocket = 0;
+        setConnectionSocket(0);
         clientID.clear();
     }
 
+    endGeneration();
     broker.sessionGoingIdle(*this);
 }
 
 // Called from a Connection thread
 void MQTTSession::notifyMessageReady() {
-    if (xTaskNotifyIndexed(taskHandle(), notifyIndex, notifyMessageReadyMask, eSetBits) != pdPASS) {
+    if (!notify(notifyMessageReadyMask)) {
         taskLogger() << logErrorMQTT << "Failed to send message ready notification to session #"
                      << id << eol;
         errorExit();
@@ -628,14 +1158,34 @@ void MQTTSession::notifyMessageReady() {
 
 // Called from a Connection thread
 void MQTTSession::notifyConnectionLost() {
-    if (xTaskNotifyIndexed(taskHandle(), notifyIndex, notifyConnectionLostMask,
-                           eSetBits) != pdPASS) {
+    if (!notify(notifyConnectionLostMask)) {
         taskLogger() << logErrorMQTT << "Failed to send connection lost notification to session #"
                      << id << eol;
         errorExit();
     }
 }
 
+// Called by the broker task when it advances the keep-alive wheel.
+void MQTTSession::notifyKeepAliveExpired() {
+    if (!notify(notifyKeepAliveExpiredMask)) {
+        taskLogger() << logErrorMQTT
+                     << "Failed to send keep-alive expired notification to session #" << id << eol;
+        errorExit();
+    }
+}
+
+uint32_t MQTTSession::keepAliveDeadline() const {
+    return _keepAliveDeadline.load(std::memory_order_relaxed);
+}
+
+bool MQTTSession::isOutgoingBacklogged() const {
+    return outgoingBacklogged;
+}
+
+int MQTTSession::socket() const {
+    return connectionSocket;
+}
+
 uint32_t MQTTSession::messagesReceived() const {
     return _messagesReceived;
 }
@@ -653,5 +1203,41 @@ uint32_t MQTTSession::publishMessagesSent() const {
 }
 
 uint32_t MQTTSession::publishMessagesDropped() const {
-    return _publishMessagesDropped;
+    return _publishMessagesDropped + _publishMessagesQueueDropped;
+}
+
+uint32_t MQTTSession::publishMessagesCoalesced() const {
+    return _publishMessagesCoalesced + _inFlightCoalesced;
+}
+
+uint32_t MQTTSession::flushes() const {
+    return _flushes;
+}
+
+uint32_t MQTTSession::bytesFlushed() const {
+    return _bytesFlushed;
+}
+
+uint32_t MQTTSession::inFlightPublishes() const {
+    return inFlight.occupancy();
+}
+
+uint32_t MQTTSession::retransmits() const {
+    return _retransmits;
+}
+
+uint32_t MQTTSession::publishLockAcquisitions() const {
+    return _publishLockAcquisitions;
+}
+
+uint32_t MQTTSession::publishLockContentions() const {
+    return _publishLockContentions;
+}
+
+uint32_t MQTTSession::publishLockWaitUs() const {
+    return _publishLockWaitUs;
+}
+
+uint32_t MQTTSession::publishLockMaxWaitUs() const {
+    return _publishLockMaxWaitUs;
 }
@@ -1,6 +1,6 @@
 /*
  * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
- * Copyright (C) 2021-2023 Lisa Rowell
+ * Copyright (C) 2021-2024 Lisa Rowell
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,9 +19,26 @@
 #include "MQTTUtil.h"
 
 #include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
 #include <sys/socket.h>
 
-bool mqttWriteRemainingLength(int connectionSocket, uint32_t remainingLength) {
+size_t mqttRemainingLengthSize(uint32_t remainingLength) {
+    if (remainingLength < 0x80) {
+        return 1;
+    } else if (remainingLength < 0x4000) {
+        return 2;
+    } else if (remainingLength < 0x200000) {
+        return 3;
+    } else {
+        return 4;
+    }
+}
+
+// Encodes the MQTT variable length Remaining Length field into the destination, returning the
+// number of bytes used. The destination must have room for mqttMaxRemainingLengthSize bytes.
+size_t mqttEncodeRemainingLength(uint8_t *destination, uint32_t remainingLength) {
+    size_t pos = 0;
     do {
         uint8_t encodedByte;
         encodedByte = remainingLength % 0x80;
@@ -29,34 +46,46 @@ bool mqttWriteRemainingLength(int connectionSocket, uint32_t remainingLength) {
         if (remainingLength) {
             encodedByte |= 0x80;
         }
-        if (send(connectionSocket, &encodedByte, sizeof(uint8_t), 0) < 0) {
-            return false;
-        }
+        destination[pos++] = encodedByte;
     } while (remainingLength);
 
-    return true;
+    return pos;
 }
 
-bool mqttWriteUInt16(int connectionSocket, uint16_t value) {
-    uint8_t valueBytes[2];
-    valueBytes[0] = value >> 8;
-    valueBytes[1] = value & 0xff;
+void mqttEncodeUInt16(uint8_t *destination, uint16_t value) {
+    destination[0] = value >> 8;
+    destination[1] = value & 0xff;
+}
+
+// Since a blocking lwip send can still return having written only part of the data, we loop until
+// everything has gone out or we encounter an error.
+bool mqttSendAll(int connectionSocket, const uint8_t *data, size_t length) {
+    while (length) {
+        const ssize_t bytesSent = send(connectionSocket, data, length, 0);
+        if (bytesSent < 0) {
+            return false;
+        }
 
-    if (send(connectionSocket, valueBytes, 2, 0) < 0) {
-        return false;
+        data += bytesSent;
+        length -= bytesSent;
     }
 
     return true;
 }
 
-bool mqttWriteMQTTString(int connectionSocket, const char *string) {
-    const uint16_t length = strlen(string);
-    if (!mqttWriteUInt16(connectionSocket, length)) {
-        return false;
-    }
+// Sends as much of the data as the socket will take without blocking. Returns false if the socket
+// failed, otherwise bytesSent says how much went out.
+bool mqttSendAvailable(int connectionSocket, const uint8_t *data, size_t length,
+                       size_t &bytesSent) {
+    bytesSent = 0;
+    while (bytesSent < length) {
+        const ssize_t sent = send(connectionSocket, data + bytesSent, length - bytesSent,
+                                  MSG_DONTWAIT);
+        if (sent < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
 
-    if (send(connectionSocket, string, length, 0) < 0) {
-        return false;
+        bytesSent += sent;
     }
 
     return true;
@@ -1,6 +1,6 @@
 /*
  * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
- * Copyright (C) 2021-2023 Lisa Rowell
+ * Copyright (C) 2021-2024 Lisa Rowell
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,12 +19,18 @@
 #ifndef MQTT_UTIL_H
 #define MQTT_UTIL_H
 
-#include "MQTTConnection.h"
-
 #include <stdint.h>
+#include <stddef.h>
+
+// The largest remaining length that can be encoded in the four bytes allowed by the spec.
+constexpr uint32_t mqttMaxRemainingLength = 268435455;
+constexpr size_t mqttMaxRemainingLengthSize = 4;
 
-bool mqttWriteRemainingLength(int connectionSocket, uint32_t remainingLength);
-bool mqttWriteUInt16(int connectionSocket, uint16_t value);
-bool mqttWriteMQTTString(int connectionSocket, const char *string);
+size_t mqttRemainingLengthSize(uint32_t remainingLength);
+size_t mqttEncodeRemainingLength(uint8_t *destination, uint32_t remainingLength);
+void mqttEncodeUInt16(uint8_t *destination, uint16_t value);
+bool mqttSendAll(int connectionSocket, const uint8_t *data, size_t length);
+bool mqttSendAvailable(int connectionSocket, const uint8_t *data, size_t length,
+                       size_t &bytesSent);
 
 #endif
@@ -19,8 +19,19 @@
 #ifndef MQTT_H
 #define MQTT_H
 
+#include "sdkconfig.h"
+
 #include <stddef.h>
 
 constexpr size_t maxMQTTClientIDLength = 23;
 
+enum MQTTBrokerEngine {
+    MQTT_BROKER_THREADED = 0,
+    MQTT_BROKER_EVENT_LOOP = 1
+};
+
+// With the threaded engine each connection and session has a task of its own. With the event loop
+// engine they have none and the broker's task does all of their work.
+constexpr MQTTBrokerEngine mqttBrokerEngine = (MQTTBrokerEngine)CONFIG_LUNAMON_MQTT_BROKER_ENGINE;
+
 #endif // MQTT_H
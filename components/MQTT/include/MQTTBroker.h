@@ -22,12 +22,14 @@
 #include "MQTTConnection.h"
 #include "MQTTSession.h"
 #include "MQTTMessage.h"
+#include "MQTTKeepAliveWheel.h"
 
 #include "DataModelNode.h"
 #include "DataModelUInt8Leaf.h"
 #include "DataModelUInt32Leaf.h"
 #include "DataModelStringLeaf.h"
 
+#include "StatCounter.h"
 #include "StatsHolder.h"
 #include "TaskObject.h"
 #include "WiFiManagerClient.h"
@@ -36,10 +38,13 @@
 #include "etl/string.h"
 
 #include <lwip/sockets.h>
+#include <sys/select.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 
+#include <atomic>
+
 #include <stdint.h>
 
 class DataModel;
@@ -47,14 +52,29 @@ class StatsManager;
 
 static constexpr size_t maxMQTTConnections = CONFIG_LUNAMON_MAX_MQTT_CLIENTS;
 static constexpr size_t maxMQTTSessions = CONFIG_LUNAMON_MAX_MQTT_CLIENTS;
+// For now the data model has a fixed number of slots for connection and session client IDs.
+static constexpr size_t maxMQTTReportedClients = 5;
 
 class MQTTBroker : public TaskObject, WiFiManagerClient, StatsHolder {
     private:
         static constexpr size_t stackSize = 6 * 1024;
         static constexpr uint16_t serverPort = 1883;
         static constexpr uint32_t lockTimeoutMs = 60 * 1000;
+        // With the threaded engine, how long the broker task waits for a connection before it
+        // goes and advances the keep-alive wheel.
+        static constexpr uint32_t acceptTimeoutMs = 1000;
+        // The event loop engine's longest wait for socket activity, which paces the flush delay,
+        // retransmits and the keep-alive wheel. Publishes queued by other tasks don't wait for it,
+        // as they wake the loop through its wakeup socket.
+        static constexpr uint32_t eventLoopTickMs =
+            CONFIG_LUNAMON_MQTT_FLUSH_DELAY_MS > 0 ? CONFIG_LUNAMON_MQTT_FLUSH_DELAY_MS : 1;
 
         int serverSocket;
+        // A loopback UDP socket connected to itself that the event loop engine selects on along
+        // with its client sockets, so that sessions notified from other tasks can wake it. A
+        // wakeup already pending isn't sent again.
+        int wakeupSocket;
+        std::atomic<bool> wakeupPending;
         SemaphoreHandle_t connectionLock;
         etl::intrusive_list<MQTTConnection, ConnectionLink> idleConnections;
         etl::intrusive_list<MQTTConnection, ConnectionLink> activeConnections;
@@ -63,18 +83,39 @@ class MQTTBroker : public TaskObject, WiFiManagerClient, StatsHolder {
         etl::intrusive_list<MQTTSession, SessionLink> freeSessions;
         etl::intrusive_list<MQTTSession, SessionLink> activeSessions;
         etl::intrusive_list<MQTTSession, SessionLink> disconnectedSessions;
+        MQTTSession *sessionIndex[maxMQTTSessions + 1];
+        MQTTKeepAliveWheel _keepAliveWheel;
 
         DataModelNode clientsNode;
         DataModelUInt8Leaf connectedClientsLeaf;
         DataModelUInt8Leaf disconnectedClientsLeaf;
         DataModelUInt8Leaf maximumClientsLeaf;
         DataModelUInt8Leaf totalClientsLeaf;
+        DataModelUInt32Leaf keepAliveExpirationsLeaf;
         DataModelUInt32Leaf messagesReceivedLeaf;
         DataModelUInt32Leaf messagesSentLeaf;
+        // Socket reads on client connections, to be compared with messages received.
+        DataModelUInt32Leaf receivesLeaf;
         DataModelNode publishNode;
         DataModelUInt32Leaf publishReceivedLeaf;
         DataModelUInt32Leaf publishSentLeaf;
         DataModelUInt32Leaf publishDroppedLeaf;
+        DataModelUInt32Leaf publishCoalescedLeaf;
+        DataModelUInt32Leaf publishInFlightLeaf;
+        DataModelUInt32Leaf publishRetransmitsLeaf;
+        // Summed over the sessions' publish locks, other than the longest wait.
+        DataModelNode publishLockNode;
+        DataModelUInt32Leaf publishLockAcquisitionsLeaf;
+        DataModelUInt32Leaf publishLockContentionsLeaf;
+        DataModelUInt32Leaf publishLockWaitUsLeaf;
+        DataModelUInt32Leaf publishLockMaxWaitUsLeaf;
+        DataModelNode flushesNode;
+        DataModelUInt32Leaf flushesCountLeaf;
+        DataModelUInt32Leaf flushesRateLeaf;
+        DataModelUInt32Leaf bytesPerFlushLeaf;
+        StatCounter flushes;
+        uint32_t lastFlushTotal;
+        uint32_t lastBytesFlushedTotal;
         DataModelNode connectionsNode;
         etl::string<maxMQTTClientIDLength> connection1IDBuffer;
         DataModelStringLeaf connection1IDLeaf;
@@ -86,7 +127,7 @@ class MQTTBroker : public TaskObject, WiFiManagerClient, StatsHolder {
         DataModelStringLeaf connection4IDLeaf;
         etl::string<maxMQTTClientIDLength> connection5IDBuffer;
         DataModelStringLeaf connection5IDLeaf;
-        DataModelStringLeaf *connectionLeaves[maxMQTTConnections];
+        DataModelStringLeaf *connectionLeaves[maxMQTTReportedClients];
         DataModelNode sessionsNode;
         etl::string<maxMQTTClientIDLength> session1IDBuffer;
         DataModelStringLeaf session1IDLeaf;
@@ -98,10 +139,16 @@ class MQTTBroker : public TaskObject, WiFiManagerClient, StatsHolder {
         DataModelStringLeaf session4IDLeaf;
         etl::string<maxMQTTClientIDLength> session5IDBuffer;
         DataModelStringLeaf session5IDLeaf;
-        DataModelStringLeaf *sessionLeaves[maxMQTTSessions];
+        DataModelStringLeaf *sessionLeaves[maxMQTTReportedClients];
 
         virtual void task() override;
         void createServerSocket();
+        void acceptConnections();
+        void runEventLoop();
+        void createWakeupSocket();
+        void drainWakeupSocket();
+        int addEventLoopSockets(fd_set &readSockets, fd_set &writeSockets);
+        void acceptConnection();
         void newConnection(int connectionSocket, struct sockaddr_in &sourceAddr,
                            socklen_t sourceAddrLength);
         void closeConnectionSocket(int connectionSocket);
@@ -117,7 +164,7 @@ class MQTTBroker : public TaskObject, WiFiManagerClient, StatsHolder {
 
         void initClientStats();
         virtual void exportStats(uint32_t msElapsed) override;
-        void exportMessageStats();
+        void exportMessageStats(uint32_t msElapsed);
         void exportConnectionInfo();
         void exportSessionInfo();
 
@@ -128,6 +175,8 @@ class MQTTBroker : public TaskObject, WiFiManagerClient, StatsHolder {
         MQTTSession *pairConnectionWithSession(MQTTConnection *connection, bool cleanSession);
         void sessionGoingIdle(MQTTSession &session);
         void sessionLostConnection(MQTTSession &session);
+        MQTTKeepAliveWheel &keepAliveWheel();
+        void wakeEventLoop();
 };
 
 #endif //MQTT_BROKER_H
@@ -23,12 +23,12 @@
 
 #include "MQTT.h"
 #include "MQTTMessage.h"
+#include "MQTTReceiveRing.h"
 
 #include "etl/string.h"
 #include "etl/intrusive_links.h"
 
 #include <freertos/FreeRTOS.h>
-#include <freertos/message_buffer.h>
 
 #include <lwip/sockets.h>
 
@@ -46,15 +46,14 @@ class MQTTConnection : public TaskObject, public ConnectionLink {
 
         static constexpr size_t minMQTTFixedHeaderSize = 2;
         static constexpr size_t maxMQTTFixedHeaderSize = (minMQTTFixedHeaderSize + 3);
-        static constexpr uint32_t maxIncomingMessageSize = 1024;
+        static constexpr uint32_t maxIncomingMessageSize = MQTTReceiveRing::maxMessageSize;
 
-        // Since we use freeRtos message buffers, we can't safely use the OG notification index of
-        // 0. Use our own index instead.
+        // Leave the OG notification index of 0 to FreeRTOS and use our own index instead.
         static constexpr UBaseType_t notifyIndex = 1;
 
         // Used as a notification when a session (or another connection) wants to force
         // disconnection of the client.
-        static constexpr int notifyDisconnect = -1;
+        static constexpr uint32_t notifyDisconnect = UINT32_MAX;
 
         uint8_t _id;
         MQTTBroker &broker;
@@ -63,38 +62,38 @@ class MQTTConnection : public TaskObject, public ConnectionLink {
         etl::string<maxMQTTClientIDLength> _clientID;
 
         MQTTSession *session;
-        uint8_t buffer[maxIncomingMessageSize];
-        size_t bytesInBuffer;
-
-        // Currently we queue incoming messages in a FreeRTOS message buffer for an attached
-        // MQTTSession to pull out and deal with. This has the annoying characteristic of an extra
-        // copy from the incoming buffer to the outgoing, but it simplifies logic.
-        // An alternative approach would be for the session to read messages after the connect
-        // message itself.
-        static constexpr size_t sessionMessageBufferSize = 2 * 1024;
-        static constexpr TickType_t sessionMessageBufferTimeout = pdMS_TO_TICKS(10000);
-        MessageBufferHandle_t sessionMessages;
+        MQTTReceiveRing _receiveRing;
+        // Connection state for the event loop engine, where there is no task to hold it.
+        bool socketOpen;
+        bool waitingForSession;
+        bool disconnectRequested;
+
+        // How long we'll wait for the session to make room for another message before deciding
+        // that it's wedged.
+        static constexpr TickType_t sessionMessageTimeout = pdMS_TO_TICKS(10000);
 
         uint16_t keepAliveTime;
         bool cleanSession;
         uint32_t _messagesSent;
+        uint32_t _receives;
 
         virtual void task() override;
         void waitForSocketAssignment();
+        void attachSocket(int connectionSocket);
         void setSocketOptions();
-        bool readMessage(MQTTMessage &message);
+        bool receiveMessages();
+        bool pendingMessage(MQTTMessage &message, bool &malformed);
+        void closeSocket();
         bool processMessage(const MQTTMessage &message);
         bool processConnectMessage(const MQTTMessage &message);
         bool messageRemainingLengthIsComplete(MQTTFixedHeader *fixedHeader,
                                               size_t fixedHeaderLength);
         bool determineRemainingLength(size_t &remainingLength, MQTTFixedHeader *fixedHeader,
                                       size_t fixedHeaderLength);
-        bool readToBuffer(size_t readAmount);
         void shutdownConnection();
         void waitForSessionDisconnect();
         void goIdle();
         void queueMessageForSession(const MQTTMessage &message);
-        void clearSessionMessages();
         void logIllegalRemainingLength(MQTTFixedHeader *fixedHeader, size_t fixedHeaderLength);
         void logMessageSizeTooLarge(size_t messageSize);
 
@@ -102,11 +101,15 @@ class MQTTConnection : public TaskObject, public ConnectionLink {
         MQTTConnection(MQTTBroker &broker, uint8_t id);
         void assignSocket(int connectionSocket, struct sockaddr_in &sourceAddr);
         void markForDisconnection();
+        void receive();
+        void service();
+        bool isOpen() const;
         uint8_t id() const;
         const etl::istring &clientID() const;
         int socket() const;
-        MessageBufferHandle_t sessionMessageBuffer();
+        MQTTReceiveRing &receiveRing();
         uint32_t messagesSent();
+        uint32_t receives();
 };
 
 #endif // MQTT_CONNECTION_H
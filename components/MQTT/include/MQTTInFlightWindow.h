@@ -0,0 +1,75 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MQTT_IN_FLIGHT_WINDOW_H
+#define MQTT_IN_FLIGHT_WINDOW_H
+
+#include "MQTTPublishQueue.h"
+
+#include "sdkconfig.h"
+
+#include <freertos/FreeRTOS.h>
+
+#include <stdint.h>
+#include <stddef.h>
+
+class DataModelLeaf;
+
+struct MQTTInFlightPublish {
+    // nullptr while the slot is free.
+    DataModelLeaf *leaf;
+    uint16_t packetId;
+    bool retainedValue;
+    uint8_t valueLength;
+    TickType_t sentAt;
+    char value[maxMQTTPublishValueLength + 1];
+};
+
+// The QoS 1 PUBLISH messages sent to a client that it has yet to acknowledge, each kept until its
+// PUBACK comes in so that it can be sent again. There's at most one per leaf: a newer value for a
+// leaf replaces the unacknowledged one, under a new packet id, rather than waiting behind it.
+//
+// Only used from the task doing the session's work, so there's no locking.
+class MQTTInFlightWindow {
+    public:
+        static constexpr size_t capacity = CONFIG_LUNAMON_MQTT_QOS1_WINDOW;
+
+    private:
+        MQTTInFlightPublish publishes[capacity];
+        size_t _occupancy;
+        uint16_t lastPacketId;
+
+        uint16_t allocatePacketId();
+        bool packetIdInUse(uint16_t packetId) const;
+        void setValue(MQTTInFlightPublish &publish, const MQTTPublishRecord &record);
+
+    public:
+        MQTTInFlightWindow();
+        MQTTInFlightPublish *find(const DataModelLeaf &leaf);
+        MQTTInFlightPublish *add(const MQTTPublishRecord &record);
+        void replace(MQTTInFlightPublish &publish, const MQTTPublishRecord &record);
+        bool acknowledge(uint16_t packetId);
+        MQTTInFlightPublish *oldest();
+        MQTTInFlightPublish *publish(size_t index);
+        void clear();
+        bool isEmpty() const;
+        bool isFull() const;
+        size_t occupancy() const;
+};
+
+#endif // MQTT_IN_FLIGHT_WINDOW_H
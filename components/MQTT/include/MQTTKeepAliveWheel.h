@@ -0,0 +1,68 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MQTT_KEEP_ALIVE_WHEEL_H
+#define MQTT_KEEP_ALIVE_WHEEL_H
+
+#include "MQTTSession.h"
+
+#include "etl/intrusive_list.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Keep-alive timers for all of the broker's sessions, kept as a hashed timer wheel with a slot per
+// second. A session is filed in the slot for its deadline and checked each time the wheel comes
+// around to it, so that deadlines further out than a turn of the wheel simply wait a few turns.
+//
+// Every message from a client pushes out its session's deadline, so rather than refiling the
+// session then, which would need the wheel's lock on every message, the session just updates its
+// deadline and the wheel refiles it when it comes across it in the old slot.
+//
+// Sessions are started and stopped from their own tasks, while the wheel is advanced by the broker
+// task, which notifies sessions whose deadlines have passed.
+class MQTTKeepAliveWheel {
+    private:
+        static constexpr size_t wheelSlots = 64;
+        static constexpr uint32_t slotMask = wheelSlots - 1;
+        static constexpr uint32_t lockTimeoutMs = 60 * 1000;
+
+        static_assert((wheelSlots & slotMask) == 0, "Wheel slots must be a power of two");
+
+        etl::intrusive_list<MQTTSession, KeepAliveLink> slots[wheelSlots];
+        SemaphoreHandle_t lock;
+        uint32_t lastAdvance;
+        uint32_t _expirations;
+
+        void expireSlot(uint32_t slot, uint32_t currentSecond);
+        void takeLock();
+        void releaseLock();
+
+    public:
+        MQTTKeepAliveWheel();
+        static uint32_t now();
+        void start(MQTTSession &session);
+        void stop(MQTTSession &session);
+        void advance();
+        uint32_t expirations() const;
+};
+
+#endif // MQTT_KEEP_ALIVE_WHEEL_H
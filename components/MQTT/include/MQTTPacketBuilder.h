@@ -0,0 +1,58 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MQTT_PACKET_BUILDER_H
+#define MQTT_PACKET_BUILDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Serializes outbound MQTT control packets into a caller supplied contiguous buffer so that they
+// can be handed to the TCP stack in a single send instead of a send per field. Packets are
+// appended to whatever is already in the buffer, which allows several packets to be sent at once.
+// A build that won't fit leaves the buffer as it was and returns false.
+class MQTTPacketBuilder {
+    private:
+        uint8_t *buffer;
+        size_t bufferSize;
+        size_t length;
+
+        bool startPacket(uint8_t typeAndFlags, uint32_t remainingLength);
+        void appendByte(uint8_t value);
+        void appendUInt16(uint16_t value);
+        void appendBytes(const void *bytes, size_t count);
+
+    public:
+        MQTTPacketBuilder(uint8_t *buffer, size_t bufferSize);
+        bool buildConnectAck(bool sessionPresent, uint8_t returnCode);
+        bool buildPublish(const char *topic, const char *value, bool dup, uint8_t qosLevel,
+                          bool retain, uint16_t packetId);
+        bool buildSubscribeAck(uint16_t packetId, uint8_t numberResults, const uint8_t *results);
+        bool buildUnsubscribeAck(uint16_t packetId);
+        bool buildPublishAck(uint16_t packetId);
+        bool buildPingResponse();
+        bool send(int connectionSocket);
+        bool sendAvailable(int connectionSocket, size_t &bytesSent);
+        void reset();
+        bool isEmpty() const;
+        size_t size() const;
+        size_t capacity() const;
+        const uint8_t *data() const;
+};
+
+#endif // MQTT_PACKET_BUILDER_H
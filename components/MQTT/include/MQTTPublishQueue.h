@@ -0,0 +1,95 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MQTT_PUBLISH_QUEUE_H
+#define MQTT_PUBLISH_QUEUE_H
+
+#include <freertos/FreeRTOS.h>
+
+#include <atomic>
+
+#include <stdint.h>
+#include <stddef.h>
+
+class DataModelLeaf;
+
+// Long enough for the largest string leaf values, such as log entries.
+constexpr size_t maxMQTTPublishValueLength = 128;
+
+enum MQTTPublishQueueOverflowPolicy : uint8_t {
+    MQTT_PUBLISH_QUEUE_DROP_OLDEST = 0,
+    MQTT_PUBLISH_QUEUE_COALESCE = 1,
+    MQTT_PUBLISH_QUEUE_BLOCK = 2
+};
+
+struct MQTTPublishRecord {
+    DataModelLeaf *leaf;
+    bool retainedValue;
+    uint8_t qosLevel;
+    uint8_t valueLength;
+    char value[maxMQTTPublishValueLength + 1];
+};
+
+// A lock free, single producer, single consumer queue of leaf updates waiting to be published to
+// an MQTT session. Leaves may be updated from many tasks at once, so the session serializes them
+// with its publish lock, making them a single producer. The consumer is the session task.
+//
+// To support dropping the oldest record and coalescing updates into a queued record for the same
+// leaf, the producer is allowed to advance the tail and to rewrite queued records. Each slot has a
+// sequence number, odd while being written, that lets the consumer detect that a record changed
+// under it and retry, and the consumer claims a record with a compare and swap on the tail.
+class MQTTPublishQueue {
+    private:
+        static constexpr uint32_t capacity = CONFIG_LUNAMON_MQTT_PUBLISH_QUEUE_DEPTH;
+        static constexpr uint32_t capacityMask = capacity - 1;
+        static_assert((capacity & capacityMask) == 0,
+                      "MQTT publish queue depth must be a power of two");
+
+        struct Slot {
+            std::atomic<uint32_t> sequence;
+            MQTTPublishRecord record;
+        };
+
+        Slot slots[capacity];
+        // Index of the next record to be written, only changed by the producer.
+        std::atomic<uint32_t> head;
+        // Index of the next record to be read. Advanced by the consumer, or by the producer when
+        // dropping the oldest record.
+        std::atomic<uint32_t> tail;
+
+        void writeSlot(Slot &slot, DataModelLeaf &leaf, const char *value, size_t valueLength,
+                       bool retainedValue, uint8_t qosLevel);
+
+    public:
+        MQTTPublishQueue();
+
+        // Producer side
+        bool push(DataModelLeaf &leaf, const char *value, size_t valueLength, bool retainedValue,
+                  uint8_t qosLevel, bool &consumerCaughtUp);
+        bool dropOldest();
+        bool coalesce(DataModelLeaf &leaf, const char *value, size_t valueLength,
+                      bool retainedValue, uint8_t qosLevel);
+
+        // Consumer side
+        bool pop(MQTTPublishRecord &record);
+
+        bool isEmpty() const;
+        bool isFull() const;
+};
+
+#endif // MQTT_PUBLISH_QUEUE_H
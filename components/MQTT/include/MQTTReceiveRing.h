@@ -0,0 +1,96 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MQTT_RECEIVE_RING_H
+#define MQTT_RECEIVE_RING_H
+
+#include "sdkconfig.h"
+
+#include <atomic>
+
+#include <stdint.h>
+#include <stddef.h>
+
+class MQTTMessage;
+
+// The receive buffer of an MQTTConnection. The connection reads as much as the socket has straight
+// into the ring, frames the messages where they land, and hands them to its session in place,
+// without copying. A message is always contiguous in the ring.
+//
+// The connection is the single producer, reading, framing, and queuing messages, and the session
+// the single consumer, taking queued messages oldest first and releasing each when it's done with
+// it. Messages the connection handles itself, before it has a session, are consumed straight away.
+// Space is reclaimed as messages are released, so should the session fall behind by a ring's
+// worth, receiveSpace() comes up empty until it catches up.
+//
+// Positions are counted in bytes received, modulo the ring size, which must be a power of two for
+// this to survive the counts wrapping.
+class MQTTReceiveRing {
+    public:
+        // While MQTT allows messages of up to 256 MB, we can't hold anything like that.
+        static constexpr size_t maxMessageSize = 1024;
+
+    private:
+        static constexpr size_t ringSize = CONFIG_LUNAMON_MQTT_RECEIVE_RING_SIZE;
+        static constexpr size_t ringMask = ringSize - 1;
+        static constexpr size_t maxQueuedMessages = 16;
+        // When there's less than this left at the end of the ring, receiving moves to its start,
+        // taking the message in progress with it.
+        static constexpr size_t minReceiveSpace = 256;
+
+        static_assert((ringSize & ringMask) == 0, "MQTTReceiveRing size must be a power of two");
+        static_assert(ringSize >= maxMessageSize + minReceiveSpace,
+                      "MQTTReceiveRing must hold the largest message and room to receive more");
+
+        struct QueuedMessage {
+            size_t position;
+            size_t length;
+        };
+
+        uint8_t buffer[ringSize];
+        // Received bytes that haven't been framed into messages yet run from pendingStart to
+        // pendingEnd.
+        size_t pendingStart;
+        size_t pendingEnd;
+        QueuedMessage queuedMessages[maxQueuedMessages];
+        // Index of the next message to be queued, only changed by the connection.
+        std::atomic<uint32_t> queueHead;
+        // Index of the oldest message not yet released, only changed by the session.
+        std::atomic<uint32_t> queueTail;
+
+        size_t tail() const;
+        bool moveToStart();
+
+    public:
+        MQTTReceiveRing();
+
+        // Connection side
+        void reset();
+        uint8_t *receiveSpace(size_t &length);
+        void received(size_t length);
+        uint8_t *pending();
+        size_t pendingLength() const;
+        void consume(size_t length);
+        bool queueMessage(size_t length);
+
+        // Session side
+        bool nextMessage(MQTTMessage &message);
+        void releaseMessage();
+};
+
+#endif // MQTT_RECEIVE_RING_H
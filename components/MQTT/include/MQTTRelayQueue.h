@@ -0,0 +1,62 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MQTT_RELAY_QUEUE_H
+#define MQTT_RELAY_QUEUE_H
+
+#include "MQTTPublishQueue.h"
+
+#include "DataModel.h"
+
+#include <atomic>
+
+#include <stdint.h>
+
+struct MQTTRelayRecord {
+    char topic[maxTopicNameLength + 1];
+    char value[maxMQTTPublishValueLength + 1];
+};
+
+// Values published by clients to topics outside of the data model, waiting to be passed on to an
+// MQTT session subscribed to them. As with the publish queue, the producers are serialized by the
+// session's publish lock and the session task is the only consumer. Producers never touch the
+// record at the front of a non-empty queue, so the consumer sends it from where it sits and only
+// then pops it.
+class MQTTRelayQueue {
+    private:
+        static constexpr uint32_t capacity = CONFIG_LUNAMON_MQTT_RELAY_QUEUE_DEPTH;
+
+        MQTTRelayRecord records[capacity];
+        // Only changed by the producer.
+        std::atomic<uint32_t> head;
+        // Only changed by the consumer.
+        std::atomic<uint32_t> tail;
+
+    public:
+        MQTTRelayQueue();
+
+        // Producer side
+        bool push(const char *topic, const char *value, bool &consumerCaughtUp);
+
+        // Consumer side
+        const MQTTRelayRecord *front() const;
+        void pop();
+};
+
+#endif // MQTT_RELAY_QUEUE_H
@@ -24,12 +24,18 @@
 #include "TaskObject.h"
 
 #include "MQTT.h"
+#include "MQTTPacketBuilder.h"
+#include "MQTTPublishQueue.h"
+#include "MQTTRelayQueue.h"
+#include "MQTTInFlightWindow.h"
 
 #include "etl/intrusive_links.h"
 #include "etl/string.h"
 
 #include <freertos/FreeRTOS.h>
-#include <freertos/message_buffer.h>
+#include <freertos/semphr.h>
+
+#include <atomic>
 
 #include <stdint.h>
 
@@ -37,26 +43,48 @@ class MQTTBroker;
 class MQTTConnection;
 class MQTTMessage;
 class DataModel;
+class DataModelLeaf;
 
 constexpr size_t sessionLinkId = 0;
 typedef etl::bidirectional_link<sessionLinkId> SessionLink;
+constexpr size_t keepAliveLinkId = 1;
+typedef etl::bidirectional_link<keepAliveLinkId> KeepAliveLink;
 
-class MQTTSession : public DataModelSubscriber, public TaskObject, public SessionLink {
+class MQTTSession : public DataModelSubscriber, public TaskObject, public SessionLink,
+                    public KeepAliveLink {
     private:
-        static constexpr size_t stackSize = 4 * 1024;
+        static constexpr size_t stackSize = 5 * 1024;
+        static constexpr uint32_t lockTimeoutMs = 60 * 1000;
 
         // Since we use freeRtos message buffers, we can't safely use the OG notification index of
         // 0. Use our own index instead.
         static constexpr UBaseType_t notifyIndex = 1;
 
-        static constexpr uint32_t notifyNewConnectionIdMask  = 0xf0000000;
-        static constexpr unsigned notifyNewConnectionIdShift = 28;
+        static constexpr uint32_t notifyNewConnectionIdMask  = 0x000000ff;
+        static constexpr unsigned notifyNewConnectionIdShift = 0;
         static constexpr uint32_t notifyShutdownMask         = 0x08000000;
         static constexpr uint32_t notifyMessageReadyMask     = 0x04000000;
         static constexpr uint32_t notifyConnectionLostMask   = 0x02000000;
-
-        static constexpr uint32_t maxIncomingMessageSize = 1024;
+        static constexpr uint32_t notifyPublishReadyMask     = 0x01000000;
+        static constexpr uint32_t notifyKeepAliveExpiredMask = 0x00800000;
+
+        static constexpr size_t maxOutgoingMessageSize = CONFIG_LUNAMON_MQTT_OUTGOING_BUFFER_SIZE;
+        static constexpr size_t outgoingFlushThreshold = CONFIG_LUNAMON_MQTT_FLUSH_THRESHOLD;
+        static constexpr TickType_t outgoingFlushDelay =
+            pdMS_TO_TICKS(CONFIG_LUNAMON_MQTT_FLUSH_DELAY_MS);
+        static constexpr MQTTPublishQueueOverflowPolicy publishQueueOverflowPolicy =
+            (MQTTPublishQueueOverflowPolicy)CONFIG_LUNAMON_MQTT_PUBLISH_QUEUE_OVERFLOW_POLICY;
+        static constexpr TickType_t publishQueueBlockTimeout =
+            pdMS_TO_TICKS(CONFIG_LUNAMON_MQTT_PUBLISH_QUEUE_BLOCK_TIMEOUT_MS);
         static constexpr uint32_t maxTopicsPerSubscribeMessage = 100;
+        // QoS 2 isn't supported, subscriptions asking for it are granted QoS 1.
+        static constexpr uint8_t maxGrantedQoS = 1;
+        static constexpr TickType_t retransmitInterval =
+            pdMS_TO_TICKS(CONFIG_LUNAMON_MQTT_QOS1_RETRANSMIT_MS);
+        // Subscription cookies carry the granted QoS in their low byte and the session's
+        // generation above it.
+        static constexpr unsigned cookieGenerationShift = 8;
+        static constexpr uint32_t generationMask = UINT32_MAX >> cookieGenerationShift;
 
         uint8_t id;
         MQTTBroker &broker;
@@ -66,14 +94,58 @@ class MQTTSession : public DataModelSubscriber, public TaskObject, public Sessio
         bool cleanSession;
         bool freshSession;
         int connectionSocket;
-        MessageBufferHandle_t connectionMessageBuffer;
+        // One and a half times the client's keep-alive interval, in seconds, or 0 if it doesn't
+        // use keep-alives.
+        uint32_t keepAliveTimeout;
+        // When, by the keep-alive wheel's clock, we give up on hearing from the client.
+        std::atomic<uint32_t> _keepAliveDeadline;
+        // Used in place of the task's notification value with the event loop engine.
+        std::atomic<uint32_t> pendingNotifications;
+        MQTTPublishQueue publishQueue;
+        MQTTRelayQueue relayQueue;
+        // Advanced, with the publish lock held, each time the session goes idle. Updating tasks
+        // publish from a snapshot of a leaf's subscribers and may still hold the cookie of a
+        // subscription this session had before it was freed and reused; publishes whose cookie
+        // is from an earlier generation are dropped.
+        uint32_t generation;
+        // Serializes the tasks updating leaves this session is subscribed to, the producers for
+        // the publish queue.
+        SemaphoreHandle_t publishLock;
+        // Updated with the publish lock held. Waits are only timed when the lock was contended.
+        uint32_t _publishLockAcquisitions;
+        uint32_t _publishLockContentions;
+        uint32_t _publishLockWaitUs;
+        uint32_t _publishLockMaxWaitUs;
+        uint8_t outgoingBuffer[maxOutgoingMessageSize];
+        MQTTPacketBuilder packetBuilder;
+        uint32_t outgoingPackets;
+        uint32_t outgoingPublishes;
+        TickType_t outgoingPendingSince;
+        // Set when the event loop engine couldn't send all of the outgoing buffer without
+        // blocking.
+        bool outgoingBacklogged;
         uint32_t _messagesReceived;
         uint32_t _messagesSent;
         uint32_t _publishMessagesReceived;
         uint32_t _publishMessagesSent;
         uint32_t _publishMessagesDropped;
+        // Updated by producer tasks with the publish lock held.
+        uint32_t _publishMessagesQueueDropped;
+        uint32_t _publishMessagesCoalesced;
+        uint32_t _flushes;
+        uint32_t _bytesFlushed;
+        // QoS 1 publishes awaiting acknowledgement. When the window is full, the next QoS 1
+        // publish needing a place in it is held back, along with everything queued behind it.
+        MQTTInFlightWindow inFlight;
+        MQTTPublishRecord heldPublish;
+        bool publishHeld;
+        uint32_t _inFlightCoalesced;
+        uint32_t _retransmits;
 
         virtual void task() override;
+        void handleNotifications(uint32_t notifications);
+        bool notify(uint32_t notification);
+        bool onSessionTask();
         void newConnection(unsigned connectionId);
         void cancelPendingConnectionAssignment();
         void readMessages();
@@ -82,17 +154,50 @@ class MQTTSession : public DataModelSubscriber, public TaskObject, public Sessio
         void unsubscribeMessageReceived(MQTTMessage &message);
         void pingRequestMessageReceived(MQTTMessage &message);
         void disconnectMessageReceived(MQTTMessage &message);
+        void publishMessageReceived(MQTTMessage &message);
+        void routePublish(const char *topic, const char *value);
+        void publishAckMessageReceived(MQTTMessage &message);
         void serverOnlyMsgReceivedError(MQTTMessage &message);
         void reservedMsgReceivedError(MQTTMessage &message);
-        virtual void publish(const char *topic, const char *value, bool retainedValue) override;
+        virtual void publish(DataModelLeaf &leaf, const char *value, bool retainedValue,
+                             uint32_t cookie) override;
+        void queuePublish(DataModelLeaf &leaf, const char *value, size_t valueLength,
+                          bool retainedValue, uint8_t qosLevel, bool &consumerCaughtUp);
+        virtual void publishTopic(const char *topic, const char *value, uint32_t cookie) override;
+        void waitForPublishQueueSpace();
+        void takePublishLock();
+        void releasePublishLock();
+        void drainPublishQueue();
+        bool publishRecord(const MQTTPublishRecord &record);
+        const char *topicName(DataModelLeaf &leaf, char *topicBuffer);
+        void sendInFlight(MQTTInFlightPublish &publish, bool dup);
+        void resendInFlight();
+        void retransmitIfDue();
+        TickType_t retransmitWait();
+        void discardInFlight();
+        uint32_t subscriptionCookie(uint8_t grantedQoS) const;
+        bool cookieIsCurrent(uint32_t cookie) const;
+        void endGeneration();
+        void drainRelayQueue();
         uint8_t subscribeResult(bool success, uint8_t maxQoS);
+        bool sendConnectAckMessage(bool sessionPresent, uint8_t returnCode);
         bool sendSubscribeAckMessage(uint16_t packetId, uint8_t numberResults, uint8_t *results);
         bool sendUnsubscribeAckMessage(uint16_t packetId);
-        bool sendPublishMessage(const char *topic, const char *value, bool dup, uint8_t qosLevel,
-                                bool retain, uint16_t packetId);
+        bool sendPublishAckMessage(uint16_t packetId);
+        bool queuePublishMessage(const char *topic, const char *value, bool dup, uint8_t qosLevel,
+                                 bool retain, uint16_t packetId);
         bool sendPingResponseMessage();
+        bool sendOutgoing();
+        bool flushOutgoing();
+        void discardOutgoing();
+        void flushOutgoingIfDue();
+        TickType_t outgoingFlushWait();
+        void setConnectionSocket(int connectionSocket);
         virtual const etl::istring &name() const override;
+        void startKeepAliveTimer(uint16_t keepAliveSec);
         void resetKeepAliveTimer();
+        void stopKeepAliveTimer();
+        void keepAliveExpired();
         void handleConnectionSendFailure();
         void shutdown();
         void connectionLost();
@@ -106,11 +211,25 @@ class MQTTSession : public DataModelSubscriber, public TaskObject, public Sessio
         MQTTConnection *connection() const;
         void notifyMessageReady();
         void notifyConnectionLost();
+        void notifyKeepAliveExpired();
+        uint32_t keepAliveDeadline() const;
+        void service();
+        bool isOutgoingBacklogged() const;
+        int socket() const;
         uint32_t messagesReceived() const;
         uint32_t messagesSent() const;
         uint32_t publishMessagesReceived() const;
         uint32_t publishMessagesSent() const;
         uint32_t publishMessagesDropped() const;
+        uint32_t publishMessagesCoalesced() const;
+        uint32_t flushes() const;
+        uint32_t bytesFlushed() const;
+        uint32_t inFlightPublishes() const;
+        uint32_t retransmits() const;
+        uint32_t publishLockAcquisitions() const;
+        uint32_t publishLockContentions() const;
+        uint32_t publishLockWaitUs() const;
+        uint32_t publishLockMaxWaitUs() const;
 };
 
 #endif //MQTT_SESSION_H
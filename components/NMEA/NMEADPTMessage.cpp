@@ -38,9 +38,9 @@ bool NMEADPTMessage::parse(NMEALineWalker &lineWalker) {
         return false;
     }
 
-    // NMEA 3.0 added a max range scale field, early messages only had two fields. Untested...
+    // NMEA 3.0 added a max range scale field, early messages only had two fields.
     if (!lineWalker.atEndOfLine()) {
-        if (!maxRangeScaleMeters.extract(lineWalker, talker, "DPT", "Max Range Scale"), true) {
+        if (!maxRangeScaleMeters.extract(lineWalker, talker, "DPT", "Max Range Scale", true)) {
             return false;
         }
     }
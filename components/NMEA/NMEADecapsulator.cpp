@@ -15,124 +15,149 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-
 #include "NMEADecapsulator.h"
+#include "NMEAReassembly.h"
 #include "NMEATalker.h"
 #include "NMEAMsgType.h"
+#include "NMEARadioChannelCode.h"
 
 #include "Logger.h"
 
 #include "etl/string_view.h"
-#include "etl/array.h"
-#include "etl/bit_stream.h"
-#include "etl/endianness.h"
 
 #include <stdint.h>
+#include <stddef.h>
 
-NMEADecapsulator::NMEADecapsulator() : messageBitStream(messageDataArray.data(),
-                                                        messageDataArray.size(),
-                                                        etl::endian::big) {
-    reset();
+NMEADecapsulator::NMEADecapsulator()
+    : nextStartSequence(0), _evictedMessages(0), _incompleteMessages(0) {
 }
 
-void NMEADecapsulator::addFragment(const NMEATalker &talker, const NMEAMsgType &msgType,
-                                   uint8_t fragmentCount, uint8_t fragmentIndex,
-                                   uint32_t messageIdOrZero, etl::string_view &payloadView,
-                                   uint8_t fillBits) {
-    if (decapsulationInProgress &&
-        !fragmentIsNext(talker, msgType, fragmentCount, fragmentIndex, messageIdOrZero)) {
-        // We're working with a fragment that does not match an decapsulation that's in progress.
-        // Ditch the old message, but fall through and work on the fragment we've been given as it
-        // might be the start of a different message.
-        logger() << logWarnNMEA << "Incomplete encapsulated NMEA "<< messageMsgType
-                 << " message from " << messageTalker << eol;
-        decapsulationInProgress = false;
+const NMEAReassembly *NMEADecapsulator::addFragment(const NMEATalker &talker,
+                                                    const NMEAMsgType &msgType,
+                                                    const NMEARadioChannelCode &radioChannelCode,
+                                                    uint8_t fragmentCount, uint8_t fragmentIndex,
+                                                    uint32_t messageIdOrZero,
+                                                    const etl::string_view &payloadView,
+                                                    uint8_t fillBits) {
+    if (fragmentCount == 1) {
+        if (fragmentIndex != 1) {
+            logger() << logWarnNMEA << "Encapsulated NMEA " << msgType << " message from "
+                     << talker << " with a fragment index beyond its fragment count" << eol;
+            return nullptr;
+        }
+        singleFragmentReassembly.start(talker, msgType, radioChannelCode, fragmentCount,
+                                       messageIdOrZero, 0);
+        return addToReassembly(singleFragmentReassembly, fragmentIndex, payloadView, fillBits);
+    }
+
+    expireReassemblies();
+
+    NMEAReassembly *reassembly = findReassembly(talker, msgType, radioChannelCode, fragmentCount,
+                                                messageIdOrZero);
+    if (reassembly != nullptr && reassembly->lastFragmentIndex + 1 != fragmentIndex) {
+        // A fragment was lost, or repeated, leaving a message that can't be completed. Give up on
+        // it, but go on to work with the fragment we've been given as it might be the start of a
+        // new message that reuses the sequential message id.
+        abandonReassembly(*reassembly);
+        reassembly = nullptr;
     }
 
-    if (!decapsulationInProgress) {
+    if (reassembly == nullptr) {
         if (fragmentIndex != 1) {
             // We came into the middle of a message's fragment stream so we should discard this
             // fragment as it's useless without the preceeding ones.
             logger() << logWarnNMEA << "Discarding encapsulated NMEA " << msgType
                      << " message fragment from " << talker
                      << " that is missing preceeding fragments" << eol;
-            return;
+            return nullptr;
         }
 
-        messageTalker = talker;
-        messageMsgType = msgType;
-        messageFragmentCount = fragmentCount;
-        messageID = messageIdOrZero;
-        decapsulationInProgress = true;
+        reassembly = &allocateReassembly();
+        reassembly->start(talker, msgType, radioChannelCode, fragmentCount, messageIdOrZero,
+                          nextStartSequence++);
     }
 
-    lastFragmentIndex = fragmentIndex;
+    // A reassembly is given up on when it goes this long without a fragment, however long the
+    // message is.
+    reassembly->timeout.setMilliSeconds(reassemblyTimeoutMs);
 
-    if (!addFragmentPayload(payloadView, fillBits)) {
-        reset();
-    }
+    return addToReassembly(*reassembly, fragmentIndex, payloadView, fillBits);
 }
 
-bool NMEADecapsulator::fragmentIsNext(const NMEATalker &talker, const NMEAMsgType &msgType,
-                                      uint8_t fragmentCount, uint8_t fragmentIndex,
-                                      uint32_t messageIdOrZero) {
-    return messageTalker == talker &&
-           messageMsgType == msgType &&
-           messageFragmentCount == fragmentCount &&
-           lastFragmentIndex + 1 == fragmentIndex &&
-           messageID == messageIdOrZero;
+void NMEADecapsulator::expireReassemblies() {
+    for (NMEAReassembly &reassembly : reassemblies) {
+        if (reassembly.inUse && reassembly.timeout.expired()) {
+            abandonReassembly(reassembly);
+        }
+    }
 }
 
-bool NMEADecapsulator::isComplete() const {
-    return lastFragmentIndex == messageFragmentCount;
-}
+NMEAReassembly *NMEADecapsulator::findReassembly(const NMEATalker &talker,
+                                                 const NMEAMsgType &msgType,
+                                                 const NMEARadioChannelCode &radioChannelCode,
+                                                 uint8_t fragmentCount, uint32_t messageIdOrZero) {
+    for (NMEAReassembly &reassembly : reassemblies) {
+        if (reassembly.matches(talker, msgType, radioChannelCode, fragmentCount,
+                               messageIdOrZero)) {
+            return &reassembly;
+        }
+    }
 
-const etl::array<uint8_t, maxNMEAEncapsulatedMessageSize> &NMEADecapsulator::messageData() const {
-    return messageDataArray;
+    return nullptr;
 }
 
-size_t NMEADecapsulator::messageBitLength() const {
-    return messageBitStream.size_bits();
-}
+NMEAReassembly &NMEADecapsulator::allocateReassembly() {
+    NMEAReassembly *oldestReassembly = &reassemblies[0];
+    for (NMEAReassembly &reassembly : reassemblies) {
+        if (!reassembly.inUse) {
+            return reassembly;
+        }
+        // Start sequences wrap, so they're compared by their distance from the next one.
+        if (nextStartSequence - reassembly.startSequence >
+            nextStartSequence - oldestReassembly->startSequence) {
+            oldestReassembly = &reassembly;
+        }
+    }
+
+    logger() << logWarnNMEA << "Evicting encapsulated NMEA " << oldestReassembly->msgType
+             << " message from " << oldestReassembly->talker << " to make room for another"
+             << eol;
+    oldestReassembly->inUse = false;
+    _evictedMessages++;
 
-size_t NMEADecapsulator::messageByteLength() const {
-    return messageBitStream.size_bytes();
+    return *oldestReassembly;
 }
 
-void NMEADecapsulator::reset() {
-    decapsulationInProgress = false;
-    messageBitStream.restart();
+void NMEADecapsulator::abandonReassembly(NMEAReassembly &reassembly) {
+    logger() << logWarnNMEA << "Incomplete encapsulated NMEA " << reassembly.msgType
+             << " message from " << reassembly.talker << eol;
+    reassembly.inUse = false;
+    _incompleteMessages++;
 }
 
-bool NMEADecapsulator::addFragmentPayload(etl::string_view &payloadView, uint8_t fillBits) {
-    for (auto payloadItr = payloadView.begin(); payloadItr < payloadView.end(); payloadItr++) {
-        uint8_t payloadValue = payloadCharValue(*payloadItr);
-
-        // The last byte of payload can have lower order bits that are padding and shouldn't be
-        // added to the stream.
-        uint8_t validBits; 
-        if (payloadItr + 1 == payloadView.end()) {
-            validBits = 6 - fillBits;
-            payloadValue = payloadValue >> fillBits;
-        } else {
-            validBits = 6;
-        }
+NMEAReassembly *NMEADecapsulator::addToReassembly(NMEAReassembly &reassembly,
+                                                  uint8_t fragmentIndex,
+                                                  const etl::string_view &payloadView,
+                                                  uint8_t fillBits) {
+    if (!reassembly.addFragmentPayload(fragmentIndex, payloadView, fillBits)) {
+        reassembly.inUse = false;
+        _incompleteMessages++;
+        return nullptr;
+    }
 
-        if (!messageBitStream.write(payloadValue, validBits)) {
-            logger() << logWarnNMEA << "Failed to add encapsulated fragment payload to message"
-                     << eol;
-            return false;
-        }
+    if (reassembly.isComplete()) {
+        // The slot is free for reuse, but its data stays put until then.
+        reassembly.inUse = false;
+        return &reassembly;
     }
 
-    return true;
+    return nullptr;
 }
 
-uint8_t NMEADecapsulator::payloadCharValue(char payloadChar) {
-    // From https://gpsd.gitlab.io/gpsd/AIVDM.html "AIVDM/AIVDO Payload Armoring"
-    uint8_t value = payloadChar - 48;
-    if (value > 40) {
-        value -= 8;
-    }
-    return value;
+uint32_t NMEADecapsulator::evictedMessages() const {
+    return _evictedMessages;
+}
+
+uint32_t NMEADecapsulator::incompleteMessages() const {
+    return _incompleteMessages;
 }
@@ -18,20 +18,32 @@
 
 #include "NMEAInterface.h"
 #include "NMEAMessageHandler.h"
+#include "NMEALazyMessage.h"
 #include "NMEALineSource.h"
+#include "NMEAMsgType.h"
 
 #include "DataModelNode.h"
 #include "DataModelUInt32Leaf.h"
 
 #include "StatsManager.h"
 
+#include "Logger.h"
 #include "Error.h"
 
+#include <stdint.h>
+
 NMEAInterface::NMEAInterface(DataModelNode &interfaceNode, const char *filteredTalkersList,
                              AISContacts &aisContacts, StatsManager &statsManager)
     : NMEALineSource(interfaceNode, filteredTalkersList, statsManager),
       parser(aisContacts),
-      messageHandlers() {
+      messageHandlers(),
+      decodedMsgTypes(0),
+      lazyMsgTypes(0),
+      encapsulatedNode("encapsulated", &nmeaInputNode()),
+      evictedEncapsulatedLeaf("evicted", &encapsulatedNode),
+      incompleteEncapsulatedLeaf("incomplete", &encapsulatedNode) {
+    static_assert(NMEAMsgType::PROPRIETARY < 32, "NMEA message types don't fit the decoded mask");
+
     addLineHandler(*this);
 }
 
@@ -41,21 +53,77 @@ void NMEAInterface::addMessageHandler(NMEAMessageHandler &messageHandler) {
     }
 
     messageHandlers.push_back(&messageHandler);
+
+    for (uint8_t msgType = NMEAMsgType::UNKNOWN; msgType <= NMEAMsgType::PROPRIETARY; msgType++) {
+        if (messageHandler.decodesMsgTypeLazily((NMEAMsgType::Value)msgType)) {
+            lazyMsgTypes |= 1 << msgType;
+        } else if (messageHandler.decodesMsgType((NMEAMsgType::Value)msgType)) {
+            decodedMsgTypes |= 1 << msgType;
+        }
+    }
+}
+
+bool NMEAInterface::needsParsing(const NMEAMsgType &msgType) {
+    switch (msgType) {
+        case NMEAMsgType::VDM:
+        case NMEAMsgType::VDO:
+            // The parser itself consumes AIS messages, feeding the AIS contacts.
+            return true;
+
+        default:
+            if (decodedMsgTypes & (1 << msgType)) {
+                return true;
+            }
+            // Logging of messages needs them fully decoded as well.
+            return logger().debugEnabled(LOGGER_MODULE_NMEA);
+    }
 }
 
 void NMEAInterface::handleLine(const NMEALine &inputLine, const NMEATalker &talker,
                                const NMEAMsgType &msgType) {
-    NMEAMessage *nmeaMessage = parser.parseLine(inputLine, talker, msgType);
-    if (nmeaMessage != nullptr) {
-        nmeaMessage->log();
+    const bool takenLazily = lazyMsgTypes & (1 << msgType);
+    const bool parsedFully = needsParsing(msgType);
+    if (!takenLazily && !parsedFully) {
+        // Still counted, as the message count is of all the lines received, not just those that
+        // are decoded.
+        messagesCounter++;
+        return;
+    }
 
+    // The line is only split into fields, or parsed, once a handler asks for them, and then only
+    // once for all of the handlers.
+    NMEALazyMessage lazyMessage(parser, inputLine, talker, msgType);
+    if (takenLazily) {
         for (NMEAMessageHandler *messageHandler : messageHandlers) {
-            messageHandler->processMessage(nmeaMessage);
+            if (messageHandler->decodesMsgTypeLazily(msgType)) {
+                messageHandler->processLazyMessage(lazyMessage);
+            }
         }
+    }
 
-        messagesCounter++;
+    if (parsedFully) {
+        NMEAMessage *nmeaMessage = lazyMessage.message();
+        if (nmeaMessage == nullptr) {
+            return;
+        }
+
+        nmeaMessage->log();
+
+        for (NMEAMessageHandler *messageHandler : messageHandlers) {
+            if (!takenLazily || !messageHandler->decodesMsgTypeLazily(msgType)) {
+                messageHandler->processMessage(nmeaMessage);
+            }
+        }
 
         // While we're done with the nmeaMessage, we don't do a free here
         // since it was allocated with a static buffer and placement new.
     }
+
+    messagesCounter++;
+}
+
+void NMEAInterface::exportStats(uint32_t msElapsed) {
+    NMEALineSource::exportStats(msElapsed);
+    evictedEncapsulatedLeaf = parser.evictedEncapsulatedMessages();
+    incompleteEncapsulatedLeaf = parser.incompleteEncapsulatedMessages();
 }
@@ -0,0 +1,106 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NMEALazyMessage.h"
+#include "NMEAParser.h"
+#include "NMEAMessage.h"
+#include "NMEALine.h"
+#include "NMEALineWalker.h"
+#include "NMEATalker.h"
+#include "NMEAMsgType.h"
+
+#include "etl/string_view.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+NMEALazyMessage::NMEALazyMessage(NMEAParser &parser, const NMEALine &nmeaLine,
+                                 const NMEATalker &talker, const NMEAMsgType &msgType)
+    : parser(parser),
+      nmeaLine(nmeaLine),
+      talker(talker),
+      msgType(msgType),
+      _fieldCount(0),
+      tokenized(false),
+      parsed(false),
+      parsedMessage(nullptr) {
+}
+
+const NMEATalker &NMEALazyMessage::source() const {
+    return talker;
+}
+
+NMEAMsgType::Value NMEALazyMessage::type() const {
+    return msgType;
+}
+
+// Records where each field starts, relative to the line without its start character and
+// checksum, the way an NMEALineWalker stripping them sees it.
+void NMEALazyMessage::tokenize() {
+    etl::string_view words = nmeaLine.contents();
+    words.remove_prefix(1);
+    words.remove_suffix(3);
+
+    // The first word is the talker and message type.
+    size_t commaPos = words.find(',');
+    while (commaPos != words.npos && _fieldCount < maxNMEALineLength) {
+        fieldOffsets[_fieldCount++] = commaPos + 1;
+        commaPos = words.find(',', commaPos + 1);
+    }
+
+    tokenized = true;
+}
+
+bool NMEALazyMessage::seekField(size_t fieldIndex, NMEALineWalker &walker) {
+    if (!tokenized) {
+        tokenize();
+    }
+    if (fieldIndex >= _fieldCount) {
+        return false;
+    }
+
+    walker.skipChars(fieldOffsets[fieldIndex]);
+
+    return true;
+}
+
+size_t NMEALazyMessage::fieldCount() {
+    if (!tokenized) {
+        tokenize();
+    }
+
+    return _fieldCount;
+}
+
+bool NMEALazyMessage::getField(size_t fieldIndex, etl::string_view &word) {
+    NMEALineWalker walker(nmeaLine, true);
+    if (!seekField(fieldIndex, walker)) {
+        return false;
+    }
+
+    return walker.getWord(word);
+}
+
+NMEAMessage *NMEALazyMessage::message() {
+    if (!parsed) {
+        parsedMessage = parser.parseLine(nmeaLine, talker, msgType);
+        parsed = true;
+    }
+
+    return parsedMessage;
+}
@@ -46,6 +46,8 @@
 #include "NMEAUInt8.h"
 #include "NMEAUInt32.h"
 #include "NMEAMessageBuffer.h"
+#include "NMEADecapsulator.h"
+#include "NMEAReassembly.h"
 
 #include "AISContacts.h"
 
@@ -149,31 +151,26 @@ NMEAMessage *NMEAParser::parseEncapsulatedLine(const NMEATalker &talker, const N
                                                NMEALineWalker &walker) {
     NMEAUInt8 fragmentCount;
     if (!fragmentCount.extract(walker, talker, msgType.name(), "Fragment Count")) {
-        decapsulator.reset();
         return nullptr;
     }
     if (fragmentCount == 0) {
         logger() << logWarnNMEA << "Encapsulated NMEA " << msgType << " message from " << talker
                  << " with 0 fragment count" << eol;
-        decapsulator.reset();
         return nullptr;
     }
 
     NMEAUInt8 fragmentIndex;
     if (!fragmentIndex.extract(walker, talker, msgType.name(), "Fragment Index")) {
-        decapsulator.reset();
         return nullptr;
     }
     if (fragmentIndex == 0) {
         logger() << logWarnNMEA << "Encapsulated NMEA " << msgType << " message from " << talker
                  << " with 0 fragment index" << eol;
-        decapsulator.reset();
         return nullptr;
     }
 
     NMEAUInt32 messageID;
     if (!messageID.extract(walker, talker, msgType.name(), "Message ID", true)) {
-        decapsulator.reset();
         return nullptr;
     }
     // We assume that all messages that are fragmented will contain a message id. This may need to
@@ -181,14 +178,12 @@ NMEAMessage *NMEAParser::parseEncapsulatedLine(const NMEATalker &talker, const N
     if (fragmentCount > 1 && !messageID.hasValue()) {
         logger() << logWarnNMEA << "Encapsulated multi-fragment NMEA " << msgType
                  << " message from " << talker << " without a message id" << eol;
-        decapsulator.reset();
         return nullptr;
     }
     const uint32_t messageIdOrZero = messageID.hasValue() ? messageID : 0;
 
     NMEARadioChannelCode radioChannelCode;
     if (!radioChannelCode.extract(walker, talker, msgType)) {
-        decapsulator.reset();
         return nullptr;
     }
 
@@ -196,33 +191,30 @@ NMEAMessage *NMEAParser::parseEncapsulatedLine(const NMEATalker &talker, const N
     if (!walker.getWord(payloadView)) {
         logger() << logWarnNMEA << "NMEA " << msgType << " message from " << talker
                  << " missing payload" << eol;
-        decapsulator.reset();
         return nullptr;
     }
 
     NMEAUInt8 fillBits;
     if (!fillBits.extract(walker, talker, msgType.name(), "Fill Bits", false, 5)) {
-        decapsulator.reset();
         return nullptr;
     }
 
-    decapsulator.addFragment(talker, msgType, fragmentCount, fragmentIndex, messageIdOrZero,
-                             payloadView, fillBits);
-
-    if (decapsulator.isComplete()) {
-        NMEAMessage *message = parseEncapsulatedMessage(talker, msgType);
-        decapsulator.reset();
-        return message;
+    const NMEAReassembly *reassembly =
+        decapsulator.addFragment(talker, msgType, radioChannelCode, fragmentCount, fragmentIndex,
+                                 messageIdOrZero, payloadView, fillBits);
+    if (reassembly != nullptr) {
+        return parseEncapsulatedMessage(talker, msgType, *reassembly);
     } else {
         return nullptr;
     }
 }
 
 NMEAMessage *NMEAParser::parseEncapsulatedMessage(const NMEATalker &talker,
-                                                  const NMEAMsgType &msgType) {
-    etl::bit_stream_reader streamReader((void *)decapsulator.messageData().data(),
-                                        decapsulator.messageByteLength(), etl::endian::big);
-    const size_t messageSizeInBits = decapsulator.messageBitLength();
+                                                  const NMEAMsgType &msgType,
+                                                  const NMEAReassembly &reassembly) {
+    etl::bit_stream_reader streamReader((void *)reassembly.messageData().data(),
+                                        reassembly.messageByteLength(), etl::endian::big);
+    const size_t messageSizeInBits = reassembly.messageBitLength();
 
     switch (msgType) {
         case NMEAMsgType::VDM:
@@ -239,3 +231,11 @@ NMEAMessage *NMEAParser::parseEncapsulatedMessage(const NMEATalker &talker,
             return nullptr;
     }
 }
+
+uint32_t NMEAParser::evictedEncapsulatedMessages() const {
+    return decapsulator.evictedMessages();
+}
+
+uint32_t NMEAParser::incompleteEncapsulatedMessages() const {
+    return decapsulator.incompleteMessages();
+}
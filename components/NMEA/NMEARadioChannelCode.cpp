@@ -74,6 +74,10 @@ void NMEARadioChannelCode::publish(DataModelStringLeaf &leaf) const {
     }
 }
 
+bool NMEARadioChannelCode::operator == (const NMEARadioChannelCode &other) const {
+    return radioChannelCode == other.radioChannelCode;
+}
+
 void NMEARadioChannelCode::log(Logger &logger) const {
     switch (radioChannelCode) {
         case RADIO_CHANNEL_87B:
@@ -0,0 +1,182 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "NMEAReassembly.h"
+#include "NMEATalker.h"
+#include "NMEAMsgType.h"
+#include "NMEARadioChannelCode.h"
+
+#include "PassiveTimer.h"
+
+#include "Logger.h"
+
+#include "etl/string_view.h"
+#include "etl/array.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Payload characters are de-armored with a table, from https://gpsd.gitlab.io/gpsd/AIVDM.html
+// "AIVDM/AIVDO Payload Armoring". Characters outside of the armoring alphabet map to
+// invalidSixBitValue, which has bits set above the six bit value so that a group of characters can
+// be checked for validity with a single test.
+static constexpr uint8_t invalidSixBitValue = 0xff;
+static constexpr uint8_t sixBitValueMask = 0x3f;
+
+static constexpr etl::array<uint8_t, 256> buildSixBitValueTable() {
+    etl::array<uint8_t, 256> table{};
+    for (size_t character = 0; character < 256; character++) {
+        if (character >= '0' && character <= 'W') {
+            table[character] = character - '0';
+        } else if (character >= '`' && character <= 'w') {
+            table[character] = character - '0' - 8;
+        } else {
+            table[character] = invalidSixBitValue;
+        }
+    }
+    return table;
+}
+
+static constexpr etl::array<uint8_t, 256> sixBitValueTable = buildSixBitValueTable();
+
+NMEAReassembly::NMEAReassembly()
+    : inUse(false),
+      _messageBitLength(0) {
+}
+
+void NMEAReassembly::start(const NMEATalker &talker, const NMEAMsgType &msgType,
+                           const NMEARadioChannelCode &radioChannelCode, uint8_t fragmentCount,
+                           uint32_t messageIdOrZero, uint32_t startSequence) {
+    inUse = true;
+    this->talker = talker;
+    this->msgType = msgType;
+    this->radioChannelCode = radioChannelCode;
+    this->fragmentCount = fragmentCount;
+    lastFragmentIndex = 0;
+    messageID = messageIdOrZero;
+    this->startSequence = startSequence;
+    _messageBitLength = 0;
+}
+
+bool NMEAReassembly::matches(const NMEATalker &talker, const NMEAMsgType &msgType,
+                             const NMEARadioChannelCode &radioChannelCode, uint8_t fragmentCount,
+                             uint32_t messageIdOrZero) const {
+    return inUse &&
+           this->talker == talker &&
+           this->msgType == msgType &&
+           this->radioChannelCode == radioChannelCode &&
+           this->fragmentCount == fragmentCount &&
+           messageID == messageIdOrZero;
+}
+
+bool NMEAReassembly::addFragmentPayload(uint8_t fragmentIndex, const etl::string_view &payloadView,
+                                        uint8_t fillBits) {
+    lastFragmentIndex = fragmentIndex;
+
+    if (payloadView.empty()) {
+        return true;
+    }
+
+    // The bulk of the payload is de-armored four characters, and so three bytes, at a time. The
+    // last character is left for the end as it can have lower order bits that are padding and
+    // shouldn't be added to the message.
+    const uint8_t *payload = (const uint8_t *)payloadView.data();
+    const uint8_t *lastCharacter = payload + payloadView.size() - 1;
+    while (lastCharacter - payload >= 4) {
+        const uint8_t value0 = sixBitValueTable[payload[0]];
+        const uint8_t value1 = sixBitValueTable[payload[1]];
+        const uint8_t value2 = sixBitValueTable[payload[2]];
+        const uint8_t value3 = sixBitValueTable[payload[3]];
+        if ((value0 | value1 | value2 | value3) & ~sixBitValueMask) {
+            logger() << logWarnNMEA << "Bad character in encapsulated fragment payload" << eol;
+            return false;
+        }
+        if (!appendBits((uint32_t)value0 << 18 | (uint32_t)value1 << 12 | (uint32_t)value2 << 6 |
+                        value3, 24)) {
+            return false;
+        }
+        payload += 4;
+    }
+
+    for (; payload <= lastCharacter; payload++) {
+        uint8_t value = sixBitValueTable[*payload];
+        if (value & ~sixBitValueMask) {
+            logger() << logWarnNMEA << "Bad character in encapsulated fragment payload" << eol;
+            return false;
+        }
+
+        uint8_t validBits;
+        if (payload == lastCharacter) {
+            validBits = 6 - fillBits;
+            value = value >> fillBits;
+        } else {
+            validBits = 6;
+        }
+        if (!appendBits(value, validBits)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Adds up to 24 bits to the end of the message, most significant bit first.
+bool NMEAReassembly::appendBits(uint32_t bits, uint8_t bitCount) {
+    if (_messageBitLength + bitCount > messageDataArray.size() * 8) {
+        logger() << logWarnNMEA << "Failed to add encapsulated fragment payload to message"
+                 << eol;
+        return false;
+    }
+
+    // Any bits already in a partially filled last byte are taken back out and written along with
+    // the new ones.
+    size_t byteIndex = _messageBitLength / 8;
+    const uint8_t partialBits = _messageBitLength % 8;
+    uint8_t pendingBitCount = partialBits + bitCount;
+    uint32_t pendingBits = bits;
+    if (partialBits) {
+        pendingBits |= (uint32_t)(messageDataArray[byteIndex] >> (8 - partialBits)) << bitCount;
+    }
+
+    while (pendingBitCount >= 8) {
+        pendingBitCount -= 8;
+        messageDataArray[byteIndex++] = pendingBits >> pendingBitCount;
+    }
+    if (pendingBitCount) {
+        messageDataArray[byteIndex] = pendingBits << (8 - pendingBitCount);
+    }
+
+    _messageBitLength += bitCount;
+
+    return true;
+}
+
+bool NMEAReassembly::isComplete() const {
+    return lastFragmentIndex == fragmentCount;
+}
+
+const etl::array<uint8_t, maxNMEAEncapsulatedMessageSize> &NMEAReassembly::messageData() const {
+    return messageDataArray;
+}
+
+size_t NMEAReassembly::messageBitLength() const {
+    return _messageBitLength;
+}
+
+size_t NMEAReassembly::messageByteLength() const {
+    return (_messageBitLength + 7) / 8;
+}
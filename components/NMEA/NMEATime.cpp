@@ -29,6 +29,8 @@
 #include "etl/string_stream.h"
 #include "etl/string_view.h"
 
+#include <inttypes.h>
+
 NMEATime::NMEATime()
     : hasValue(false) {
 }
@@ -116,7 +118,7 @@ void NMEATime::buildSecondsFactionString(char *string) const {
         string++;
 
         char fractionDigits[11];
-        sprintf(fractionDigits, "%lu", secondFraction);
+        sprintf(fractionDigits, "%" PRIu32, secondFraction);
 
         unsigned leadingZeros = secondPrecision - strlen(fractionDigits);
         while (leadingZeros--) {
@@ -15,49 +15,57 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-
 #ifndef NMEA_DECAPSULATOR_H
 #define NMEA_DECAPSULATOR_H
 
-#include "NMEATalker.h"
-#include "NMEAMsgType.h"
+#include "NMEAReassembly.h"
 
-#include "etl/array.h"
-#include "etl/bit_stream.h"
 #include "etl/string_view.h"
 
 #include <stdint.h>
 #include <stddef.h>
 
-constexpr size_t maxNMEAEncapsulatedMessageSize = 256;
+class NMEATalker;
+class NMEAMsgType;
+class NMEARadioChannelCode;
 
+// Puts encapsulated messages back together from their fragments. Several multi-fragment messages
+// can be in flight at once, as happens when a dual channel receiver interleaves the fragments of
+// messages heard on each channel. A reassembly that doesn't see its next fragment in time is given
+// up on, and when there are more messages in flight than slots, the oldest is evicted.
 class NMEADecapsulator {
     private:
-        bool decapsulationInProgress;
-        NMEATalker messageTalker;
-        NMEAMsgType messageMsgType;
-        uint8_t messageFragmentCount;
-        uint8_t lastFragmentIndex;
-        uint32_t messageID;
-        etl::array<uint8_t, maxNMEAEncapsulatedMessageSize> messageDataArray;
-        etl::bit_stream_writer messageBitStream;
-
-        bool fragmentIsNext(const NMEATalker &talker, const NMEAMsgType &msgType,
-                            uint8_t fragmentCount, uint8_t fragmentIndex,
-                            uint32_t messageIdOrZero);
-        bool addFragmentPayload(etl::string_view &payloadView, uint8_t fillBits);
-        uint8_t payloadCharValue(char payloadChar);
+        static constexpr size_t reassemblySlots = 4;
+        static constexpr uint32_t reassemblyTimeoutMs = 2000;
+
+        NMEAReassembly reassemblies[reassemblySlots];
+        // Single fragment messages, by far the most common, are assembled separately so that
+        // they never displace a multi-fragment message.
+        NMEAReassembly singleFragmentReassembly;
+        uint32_t nextStartSequence;
+        uint32_t _evictedMessages;
+        uint32_t _incompleteMessages;
+
+        void expireReassemblies();
+        NMEAReassembly *findReassembly(const NMEATalker &talker, const NMEAMsgType &msgType,
+                                       const NMEARadioChannelCode &radioChannelCode,
+                                       uint8_t fragmentCount, uint32_t messageIdOrZero);
+        NMEAReassembly &allocateReassembly();
+        void abandonReassembly(NMEAReassembly &reassembly);
+        NMEAReassembly *addToReassembly(NMEAReassembly &reassembly, uint8_t fragmentIndex,
+                                        const etl::string_view &payloadView, uint8_t fillBits);
 
     public:
         NMEADecapsulator();
-        void addFragment(const NMEATalker &talker, const NMEAMsgType &msgType,
-                         uint8_t fragmentCount, uint8_t fragmentIndex, uint32_t messageIdOrZero,
-                         etl::string_view &payloadView, uint8_t fillBits);
-        bool isComplete() const;
-        const etl::array<uint8_t, maxNMEAEncapsulatedMessageSize> &messageData() const;
-        size_t messageBitLength() const;
-        size_t messageByteLength() const;
-        void reset();
+        // Returns the message completed by the fragment, if any. It remains valid until the next
+        // fragment is added.
+        const NMEAReassembly *addFragment(const NMEATalker &talker, const NMEAMsgType &msgType,
+                                          const NMEARadioChannelCode &radioChannelCode,
+                                          uint8_t fragmentCount, uint8_t fragmentIndex,
+                                          uint32_t messageIdOrZero,
+                                          const etl::string_view &payloadView, uint8_t fillBits);
+        uint32_t evictedMessages() const;
+        uint32_t incompleteMessages() const;
 };
 
 #endif // NMEA_DECAPSULATOR_H
@@ -41,7 +41,7 @@ class NMEAHundredthsUInt8 : public LoggableItem {
     public:
         bool extract(NMEALineWalker &lineWalker, NMEATalker &talker, const char *msgType,
                      const char *fieldName);
-        constexpr operator HundredthsUInt8() const { return value; }
+        operator HundredthsUInt8() const { return value; }
         void publish(DataModelHundredthsUInt8Leaf &leaf) const;
         virtual void log(Logger &logger) const override;
 };
@@ -34,6 +34,7 @@
 #include "etl/vector.h"
 
 #include <stddef.h>
+#include <stdint.h>
 
 class NMEATalker;
 class NMEAMsgType;
@@ -48,10 +49,22 @@ class NMEAInterface : public NMEALineSource, public NMEALineHandler {
         NMEAParser parser;
         etl::vector<NMEAMessageHandler *, maxMessageHandlers> messageHandlers;
         StatCounter messagesCounter;
+        // One bit per NMEAMsgType::Value, set if any of the message handlers decodes the type
+        // fully, or takes it lazily.
+        uint32_t decodedMsgTypes;
+        uint32_t lazyMsgTypes;
 
+        DataModelNode encapsulatedNode;
+        DataModelUInt32Leaf evictedEncapsulatedLeaf;
+        DataModelUInt32Leaf incompleteEncapsulatedLeaf;
+
+        bool needsParsing(const NMEAMsgType &msgType);
         void handleLine(const NMEALine &inputLine, const NMEATalker &talker,
                         const NMEAMsgType &msgType);
 
+    protected:
+        virtual void exportStats(uint32_t msElapsed) override;
+
     public:
         NMEAInterface(DataModelNode &interfaceNode, const char *filteredTalkersList,
                       AISContacts &aisContacts, StatsManager &statsManager);
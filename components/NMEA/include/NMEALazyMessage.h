@@ -0,0 +1,83 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMEA_LAZY_MESSAGE_H
+#define NMEA_LAZY_MESSAGE_H
+
+#include "NMEALine.h"
+#include "NMEALineWalker.h"
+#include "NMEATalker.h"
+#include "NMEAMsgType.h"
+
+#include "etl/string_view.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+class NMEAParser;
+class NMEAMessage;
+
+// A line handed to message handlers that only need some of its fields, in place of a fully
+// decoded NMEAMessage. On the first field access the line is split into words once, recording
+// where each starts, and only the fields asked for are decoded, straight from the line. Field
+// indexes count the words after the message type, so a multi-word field such as a latitude and
+// its hemisphere takes two. A handler that does want everything can still get the parsed message,
+// which is decoded once however many handlers ask for it.
+//
+// Like NMEAMessages, lazy messages are only valid for the duration of the handler call.
+class NMEALazyMessage {
+    private:
+        NMEAParser &parser;
+        const NMEALine &nmeaLine;
+        NMEATalker talker;
+        NMEAMsgType msgType;
+        // Every field takes at least its separating comma, so a line can't have more than this.
+        uint8_t fieldOffsets[maxNMEALineLength];
+        uint8_t _fieldCount;
+        bool tokenized;
+        bool parsed;
+        NMEAMessage *parsedMessage;
+
+        void tokenize();
+        bool seekField(size_t fieldIndex, NMEALineWalker &walker);
+
+    public:
+        NMEALazyMessage(NMEAParser &parser, const NMEALine &nmeaLine, const NMEATalker &talker,
+                        const NMEAMsgType &msgType);
+        const NMEATalker &source() const;
+        NMEAMsgType::Value type() const;
+        size_t fieldCount();
+        bool getField(size_t fieldIndex, etl::string_view &word);
+        // Decodes the field using the field type's own extract(), given the arguments that follow
+        // the line walker and talker, as in
+        // decodeField(2, windSpeed, "MWV", "Wind Speed").
+        template <typename Field, typename... ExtractArgs>
+        bool decodeField(size_t fieldIndex, Field &field, ExtractArgs... extractArgs) {
+            NMEALineWalker walker(nmeaLine, true);
+            if (!seekField(fieldIndex, walker)) {
+                return false;
+            }
+
+            return field.extract(walker, talker, extractArgs...);
+        }
+        // Returns the fully decoded message, parsing it on the first call, or nullptr if the line
+        // didn't parse.
+        NMEAMessage *message();
+};
+
+#endif // NMEA_LAZY_MESSAGE_H
@@ -20,10 +20,24 @@
 #define NMEA_MESSAGE_HANDLER_H
 
 #include "NMEAMessage.h"
+#include "NMEAMsgType.h"
+
+class NMEALazyMessage;
 
 class NMEAMessageHandler {
     public:
+        // Asked for each message type when the handler is added to an interface. Lines of a type
+        // that no handler of the interface decodes, fully or lazily, are never parsed.
+        virtual bool decodesMsgType(NMEAMsgType::Value msgType) const = 0;
         virtual void processMessage(const NMEAMessage *message) = 0;
+        // Handlers that only need some fields of a message type can instead take it as an
+        // NMEALazyMessage, which decodes just the fields asked for. A type taken lazily isn't
+        // also passed to processMessage().
+        virtual bool decodesMsgTypeLazily(NMEAMsgType::Value msgType) const {
+            return false;
+        }
+        virtual void processLazyMessage(NMEALazyMessage &message) {
+        }
 };
 
 #endif
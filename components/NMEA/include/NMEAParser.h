@@ -30,6 +30,7 @@ class AISContacts;
 class NMEAMessage;
 class NMEALine;
 class NMEALineWalker;
+class NMEAReassembly;
 
 class NMEAParser {
     private:
@@ -42,12 +43,15 @@ class NMEAParser {
         NMEAMessage *parseEncapsulatedLine(const NMEATalker &talker, const NMEAMsgType &msgType,
                                            NMEALineWalker &walker);
         NMEAMessage *parseEncapsulatedMessage(const NMEATalker &talker,
-                                              const NMEAMsgType &msgType);
+                                              const NMEAMsgType &msgType,
+                                              const NMEAReassembly &reassembly);
 
     public:
         NMEAParser(AISContacts &aisContacts);
         NMEAMessage *parseLine(const NMEALine &nmeaLine, const NMEATalker &talker,
                                const NMEAMsgType &msgType);
+        uint32_t evictedEncapsulatedMessages() const;
+        uint32_t incompleteEncapsulatedMessages() const;
 };
 
 #endif // NMEA_PARSER_H
@@ -43,6 +43,7 @@ class NMEARadioChannelCode : public LoggableItem {
         bool extract(NMEALineWalker &lineWalker, const NMEATalker &talker,
                      const NMEAMsgType &msgType);
         void publish(DataModelStringLeaf &leaf) const;
+        bool operator == (const NMEARadioChannelCode &other) const;
         virtual void log(Logger &logger) const override;
 };
 
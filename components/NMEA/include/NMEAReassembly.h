@@ -0,0 +1,72 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NMEA_REASSEMBLY_H
+#define NMEA_REASSEMBLY_H
+
+#include "NMEATalker.h"
+#include "NMEAMsgType.h"
+#include "NMEARadioChannelCode.h"
+
+#include "PassiveTimer.h"
+
+#include "etl/array.h"
+#include "etl/string_view.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+constexpr size_t maxNMEAEncapsulatedMessageSize = 256;
+
+// One encapsulated message being put back together from its fragments. Fragments are matched to
+// it by talker, message type, radio channel, fragment count and sequential message id.
+class NMEAReassembly {
+    private:
+        bool inUse;
+        NMEATalker talker;
+        NMEAMsgType msgType;
+        NMEARadioChannelCode radioChannelCode;
+        uint8_t fragmentCount;
+        uint8_t lastFragmentIndex;
+        uint32_t messageID;
+        // Order in which the reassemblies were started, used to pick the oldest for eviction.
+        uint32_t startSequence;
+        PassiveTimer timeout;
+        etl::array<uint8_t, maxNMEAEncapsulatedMessageSize> messageDataArray;
+        size_t _messageBitLength;
+
+        void start(const NMEATalker &talker, const NMEAMsgType &msgType,
+                   const NMEARadioChannelCode &radioChannelCode, uint8_t fragmentCount,
+                   uint32_t messageIdOrZero, uint32_t startSequence);
+        bool matches(const NMEATalker &talker, const NMEAMsgType &msgType,
+                     const NMEARadioChannelCode &radioChannelCode, uint8_t fragmentCount,
+                     uint32_t messageIdOrZero) const;
+        bool addFragmentPayload(uint8_t fragmentIndex, const etl::string_view &payloadView,
+                                uint8_t fillBits);
+        bool appendBits(uint32_t bits, uint8_t bitCount);
+
+        friend class NMEADecapsulator;
+
+    public:
+        NMEAReassembly();
+        bool isComplete() const;
+        const etl::array<uint8_t, maxNMEAEncapsulatedMessageSize> &messageData() const;
+        size_t messageBitLength() const;
+        size_t messageByteLength() const;
+};
+
+#endif // NMEA_REASSEMBLY_H
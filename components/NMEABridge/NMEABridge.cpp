@@ -20,6 +20,7 @@
 #include "NMEAMsgType.h"
 #include "NMEAInterface.h"
 #include "NMEALine.h"
+#include "NMEALineSlice.h"
 #include "NMEALineWalker.h"
 #include "NMEALineHandler.h"
 #include "Interface.h"
@@ -102,15 +103,24 @@ void NMEABridge::buildBridgedMessageSet(const char *msgTypeList) {
 void NMEABridge::handleLine(const NMEALine &inputLine, const NMEATalker &talker,
                             const NMEAMsgType &msgType) {
     if (bridgedMsgTypes.contains(msgType)) {
-        // Attempt to queue the message, but don't block. If the Message Buffer is full then we're
-        // overrunning the output interface. Blocking here is just going to lead to input overruns.
-        size_t queuedLength = xMessageBufferSend(messagesBuffer, inputLine.data(),
-                                                 inputLine.length(), 0);
+        // Attempt to queue the message, but don't block. If the receive ring can't hold on to
+        // any more lines or the Message Buffer is full then we're overrunning the output
+        // interface. Blocking here is just going to lead to input overruns.
+        NMEALineSlice *slice = inputLine.retain();
+        if (slice == nullptr) {
+            droppedMessages++;
+            taskLogger() << logDebugNMEABridge << "Dropped NMEA " << msgType
+                         << " message due to full receive ring on bridge " << name << eol;
+            return;
+        }
+
+        size_t queuedLength = xMessageBufferSend(messagesBuffer, &slice, sizeof(slice), 0);
         if (queuedLength != 0) {
             bridgedMessages++;
             taskLogger() << logDebugNMEABridge << "Bridged NMEA " << msgType << " message to "
                          << dstInterface.name() << eol;
         } else {
+            slice->release();
             droppedMessages++;
             taskLogger() << logDebugNMEABridge << "Dropped NMEA " << msgType
                          << " message due to full bridge queue on bridge " << name << eol;
@@ -120,26 +130,21 @@ void NMEABridge::handleLine(const NMEALine &inputLine, const NMEATalker &talker,
 
 void NMEABridge::task() {
     while (true) {
-        char message[maxNMEALineLength];
-        size_t messageLength = xMessageBufferReceive(messagesBuffer, message, maxNMEALineLength,
+        NMEALineSlice *slice;
+        size_t messageLength = xMessageBufferReceive(messagesBuffer, &slice, sizeof(slice),
                                                      portMAX_DELAY);
-        if (messageLength > 0) {
-            // Internally NMEA 0183 messages don't include the terminating CR,LF, so we need to add
-            // it here before we output it.
-            message[messageLength] = '\r';
-            message[messageLength + 1] = '\n';
-            message[messageLength + 2] = 0;
-            size_t sent = dstInterface.sendBytes(message, messageLength + 2);
-            if (sent == messageLength + 2) {
-                // Remove the CR,LF for the debug message
-                message[messageLength] = '0';
+        if (messageLength == sizeof(slice)) {
+            // The slice includes the line's terminating CR,LF, so it can go out as is.
+            size_t sent = dstInterface.sendBytes(slice->data(), slice->length());
+            if (sent == slice->length()) {
                 logger << logDebugNMEABridge << "Wrote NMEA message to " << dstInterface.name()
-                       << ": " << message << eol;
+                       << ": " << NMEALine(slice->data(), slice->length()) << eol;
             } else {
                 outputErrors++;
                 logger << logWarnNMEABridge << "Error sending NMEA bridged message to "
                        << dstInterface.name() << eol;
             }
+            slice->release();
         }
     }
 }
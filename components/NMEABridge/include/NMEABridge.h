@@ -39,6 +39,7 @@
 #include <stdint.h>
 
 class NMEALine;
+class NMEALineSlice;
 class NMEAInterface;
 class Interface;
 class StatsManager;
@@ -52,7 +53,10 @@ class DataModel;
 class NMEABridge : public TaskObject, NMEALineHandler, StatsHolder {
     private:
         static constexpr size_t MAX_BRIDGE_MSG_TYPES = 10;
-        static constexpr size_t messageBufferLength = maxNMEALineLength * 5;
+        static constexpr size_t maxQueuedMessages = 8;
+        // Each message in a FreeRTOS message buffer is preceded by its length.
+        static constexpr size_t messageBufferLength =
+            maxQueuedMessages * (sizeof(size_t) + sizeof(NMEALineSlice *));
         static constexpr size_t stackSize = 4096;
 
         etl::set<NMEAMsgType, MAX_BRIDGE_MSG_TYPES> bridgedMsgTypes;
@@ -67,10 +71,11 @@ class NMEABridge : public TaskObject, NMEALineHandler, StatsHolder {
         // a typical UART TX buffer. Clearly the bridge configuration must make sense with the
         // resulting message stream being something that the output interface can handle.
         // (aka don't bridge AIS messages to 4800 baud).
-        // We use freeRTOS message buffers for this as it allows for variable sized discrete
-        // messages. We don't have to worry about its lack of mutual exclusion as we only have one
-        // writer, the input task for the interface the bridge is configured on, and one reader,
-        // the bridge task.
+        // Rather than copying the message, the input side retains the line's slice of its
+        // interface's receive ring and queues that, the bridge task sending straight from the
+        // ring and then releasing it. We use a freeRTOS message buffer for the queue, not having
+        // to worry about its lack of mutual exclusion as we only have one writer, the input task
+        // for the interface the bridge is configured on, and one reader, the bridge task.
         MessageBufferHandle_t messagesBuffer;
 
         StatCounter bridgedMessages;
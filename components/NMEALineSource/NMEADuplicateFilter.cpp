@@ -0,0 +1,75 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "NMEADuplicateFilter.h"
+
+#include "NMEALine.h"
+
+#include <freertos/FreeRTOS.h>
+#include "esp_timer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+NMEADuplicateFilter nmeaDuplicateFilter;
+
+NMEADuplicateFilter::NMEADuplicateFilter() : entries(), nextEntry(0) {
+    portMUX_INITIALIZE(&lock);
+}
+
+bool NMEADuplicateFilter::isDuplicate(const NMEALine &line, const void *source) {
+    if (windowMs == 0) {
+        return false;
+    }
+
+    const uint32_t hash = lineHash(line);
+    const size_t length = line.length();
+    const uint32_t nowMs = (uint32_t)(esp_timer_get_time() / 1000);
+
+    taskENTER_CRITICAL(&lock);
+    for (const Entry &entry : entries) {
+        if (entry.hash == hash && entry.length == length && entry.source != source &&
+            nowMs - entry.receivedMs < windowMs) {
+            taskEXIT_CRITICAL(&lock);
+            return true;
+        }
+    }
+
+    Entry &entry = entries[nextEntry];
+    entry.hash = hash;
+    entry.receivedMs = nowMs;
+    entry.source = source;
+    entry.length = length;
+    nextEntry = (nextEntry + 1) % cacheEntries;
+    taskEXIT_CRITICAL(&lock);
+
+    return false;
+}
+
+// 32 bit FNV-1a over the whole line, checksum included. The checksum alone is too weak to tell
+// lines apart, and the start of a line is much the same for all sentences of a type.
+uint32_t NMEADuplicateFilter::lineHash(const NMEALine &line) {
+    const uint8_t *data = (const uint8_t *)line.data();
+    const size_t length = line.length();
+
+    uint32_t hash = 2166136261u;
+    for (size_t pos = 0; pos < length; pos++) {
+        hash = (hash ^ data[pos]) * 16777619u;
+    }
+
+    return hash;
+}
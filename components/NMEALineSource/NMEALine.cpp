@@ -17,31 +17,34 @@
  */
 
 #include "NMEALine.h"
+#include "NMEALineRing.h"
+#include "NMEALineSlice.h"
 
 #include "CharacterTools.h"
+#include "NumberFormat.h"
 #include "Logger.h"
 
 #include "etl/string.h"
 #include "etl/string_view.h"
-#include "etl/to_string.h"
 
 #include <stddef.h>
 
-NMEALine::NMEALine() : line() {
+NMEALine::NMEALine() : line(), viewData(nullptr), viewLength(0), ring(nullptr) {
 }
 
-NMEALine::NMEALine(const etl::istring &string) : line(string) {
+NMEALine::NMEALine(const etl::istring &string)
+    : line(string), viewData(nullptr), viewLength(0), ring(nullptr) {
 }
 
-void NMEALine::reset() {
-    line.clear();
+NMEALine::NMEALine(const char *data, size_t length, NMEALineRing *ring)
+    : line(), viewData(data), viewLength(length), ring(ring) {
 }
 
-void NMEALine::append(const char *srcBuffer, size_t start, size_t end) {
-    line.append(srcBuffer + start, end - start);
-    if (line.is_truncated()) {
-        logger() << logWarnNMEALine << "NMEA line exceeded maximum length, truncated" << eol;
-    }
+void NMEALine::reset() {
+    line.clear();
+    viewData = nullptr;
+    viewLength = 0;
+    ring = nullptr;
 }
 
 void NMEALine::append(const etl::istring &string) {
@@ -65,24 +68,27 @@ void NMEALine::append(char character) {
     }
 }
 
-bool NMEALine::isEmpty() {
-    return line.empty();
+bool NMEALine::isEmpty() const {
+    return length() == 0;
 }
 
-bool NMEALine::sanityCheck() {
+// The line parity is the XOR of every character in the line, accumulated by the caller as it
+// framed the line, so that the line doesn't need to be walked a second time.
+bool NMEALine::sanityCheck(uint8_t lineParity) const {
     if (isEmpty()) {
         logger() << logWarnNMEALine << "Empty NMEA message" << eol;
         return false;
     }
 
-    char firstCharacter = line.front();
+    char firstCharacter = data()[0];
     if (firstCharacter != '$' && firstCharacter != '!') {
-        logger() << logWarnNMEALine << "NMEA message missing leading '$' or '!': " << line << eol;
+        logger() << logWarnNMEALine << "NMEA message missing leading '$' or '!': " << *this
+                 << eol;
         return false;
     }
 
-    if (!validateChecksum()) {
-        logger() << logWarnNMEALine << "NMEA line with bad checksum: " << line << eol;
+    if (!validateChecksum(lineParity)) {
+        logger() << logWarnNMEALine << "NMEA line with bad checksum: " << *this << eol;
         return false;
     }
 
@@ -100,31 +106,29 @@ void NMEALine::appendChecksum() {
     // Parity is calulated as being over all characters in the message between the opening '$'
     // (or '!') and the '*', non-inclusive.
     uint8_t checksum = 0;
-    for (int pos = 1; pos < line.length() - 1; pos++) {
+    for (size_t pos = 1; pos < line.length() - 1; pos++) {
         checksum ^= line[pos];
     }
 
-    etl::string<3> checksumString;
-    etl::format_spec checksumFormat;
-    checksumFormat.hex().upper_case(true).width(2).fill('0');
-    etl::to_string(checksum, checksumString, checksumFormat);
-
-    line.append(checksumString);
+    char checksumString[hexByteFormatLength];
+    formatHexByte(checksumString, checksum);
+    line.append(checksumString, hexByteFormatLength);
 }
 
-bool NMEALine::validateChecksum() {
-    size_t checksumPos = line.size() - 3;
-    if (line[checksumPos] != '*') {
+bool NMEALine::validateChecksum(uint8_t lineParity) const {
+    const char *lineData = data();
+    const size_t lineLength = length();
+    if (lineLength < 4) {
         return false;
     }
 
-    uint8_t checksum = 0;
-    for (size_t pos = 1; pos < checksumPos; pos++) {
-        checksum = checksum ^ line[pos];
+    const size_t checksumPos = lineLength - 3;
+    if (lineData[checksumPos] != '*') {
+        return false;
     }
 
-    const uint8_t firstChecksumChar = line[checksumPos + 1];
-    const uint8_t secondChecksumChar = line[checksumPos + 2];
+    const uint8_t firstChecksumChar = lineData[checksumPos + 1];
+    const uint8_t secondChecksumChar = lineData[checksumPos + 2];
     if (!isUpperCaseHexidecimalDigit(firstChecksumChar) ||
         !isUpperCaseHexidecimalDigit(secondChecksumChar)) {
         return false;
@@ -132,25 +136,49 @@ bool NMEALine::validateChecksum() {
     const uint8_t lineChecksum = hexidecimalValue(firstChecksumChar) * 16 +
                                  hexidecimalValue(secondChecksumChar);
 
+    // The checksum covers the characters between the opening '$' (or '!') and the '*', so take
+    // those characters and the checksum itself back out of the parity of the whole line.
+    const uint8_t checksum = lineParity ^ lineData[0] ^ '*' ^ firstChecksumChar ^
+                             secondChecksumChar;
+
     return lineChecksum == checksum;
 }
 
-const etl::istring &NMEALine::contents() const {
-    return line;
+etl::string_view NMEALine::contents() const {
+    return etl::string_view(data(), length());
 }
 
 const char *NMEALine::data() const {
-    return line.data();
+    if (viewData) {
+        return viewData;
+    } else {
+        return line.data();
+    }
 }
 
 size_t NMEALine::length() const {
-    return line.size();
+    if (viewData) {
+        return viewLength;
+    } else {
+        return line.size();
+    }
+}
+
+// Takes a reference to the line, CR/LF included, for a handler that needs it after its
+// handleLine() call returns. Returns nullptr if the line isn't in a receive ring or the ring has
+// no room to keep it.
+NMEALineSlice *NMEALine::retain() const {
+    if (ring == nullptr) {
+        return nullptr;
+    }
+
+    return ring->retainLine(viewData, viewLength);
 }
 
 Logger & operator << (Logger &logger, const NMEALine &nmeaLine) {
     // Depending upon where this is done, the line may or may not have a CRLF at the end. If it
     // does, avoid logging it.
-    etl::string_view lineView(nmeaLine.line);
+    etl::string_view lineView(nmeaLine.contents());
     if (lineView.back() == '\n') {
         lineView.remove_suffix(1);
         if (lineView.back() == '\r') {
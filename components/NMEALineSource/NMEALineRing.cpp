@@ -0,0 +1,186 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NMEALineRing.h"
+#include "NMEALineSlice.h"
+
+#include "etl/algorithm.h"
+
+#include <atomic>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+NMEALineRing::NMEALineRing()
+    : overrunReceive(false),
+      pendingStart(0),
+      pendingEnd(0),
+      oldestSlice(0),
+      sliceCount(0),
+      _usedSpace(0),
+      _peakUsedSpace(0),
+      _overruns(0),
+      _retainFailures(0) {
+}
+
+// Throws away any partial line, leaving retained slices be.
+void NMEALineRing::reset() {
+    pendingStart = pendingEnd;
+}
+
+void NMEALineRing::reclaimSlices() {
+    while (sliceCount && slices[oldestSlice].references.load(std::memory_order_acquire) == 0) {
+        oldestSlice = (oldestSlice + 1) % maxSlices;
+        sliceCount--;
+    }
+}
+
+// The oldest position in the ring that is still in use.
+size_t NMEALineRing::tail() const {
+    if (sliceCount) {
+        return slices[oldestSlice].position;
+    } else {
+        return pendingStart;
+    }
+}
+
+// Moves receiving to the start of the ring, copying the (at most a line or so of) pending
+// characters along so that the line stays contiguous. If retained slices are in the way the
+// pending characters are dropped instead, which is counted as an overrun.
+void NMEALineRing::moveToStart(bool &pendingDropped) {
+    size_t length = pendingLength();
+    const size_t nextLap = (pendingStart & ~ringMask) + ringSize;
+    const size_t newTail = sliceCount ? slices[oldestSlice].position : nextLap;
+
+    if (nextLap + length + minReceiveSpace - newTail > ringSize) {
+        _overruns++;
+        pendingDropped = true;
+        length = 0;
+    } else {
+        memmove(buffer, pending(), length);
+    }
+
+    pendingStart = nextLap;
+    pendingEnd = nextLap + length;
+}
+
+// Returns where the next read should go, and in length how much may be read there. If room had
+// to be made by dropping the partial line, pendingDropped is set and the caller should resync.
+char *NMEALineRing::receiveSpace(size_t maxLength, size_t &length, bool &pendingDropped) {
+    pendingDropped = false;
+    reclaimSlices();
+
+    // Where the next read would go, measured from the start of the ring the pending characters
+    // begin in. It may be at the very end, but the pending characters are never split.
+    size_t offset = (pendingStart & ringMask) + pendingLength();
+    if (ringSize - offset < minReceiveSpace ||
+        (offset != 0 && sliceCount == 0 && pendingStart == pendingEnd)) {
+        // Either we're about to run out of room at the end of the ring, or nothing is in use,
+        // in which case starting over gives the most room for the next read.
+        moveToStart(pendingDropped);
+        offset = pendingLength();
+    }
+
+    const size_t inUse = pendingEnd - tail();
+    _usedSpace = inUse;
+    if (inUse > _peakUsedSpace) {
+        _peakUsedSpace = inUse;
+    }
+
+    if (inUse >= ringSize) {
+        // Retained slices have the whole ring tied up. The reader still needs somewhere to put
+        // what it reads, but it, and the line it's part of, are lost.
+        _overruns++;
+        pendingStart = pendingEnd;
+        pendingDropped = true;
+        overrunReceive = true;
+        length = etl::min(sizeof(overrunBuffer), maxLength);
+        return overrunBuffer;
+    }
+
+    length = etl::min(etl::min(ringSize - offset, ringSize - inUse), maxLength);
+    return buffer + offset;
+}
+
+void NMEALineRing::received(size_t length) {
+    if (overrunReceive) {
+        overrunReceive = false;
+    } else {
+        pendingEnd += length;
+    }
+}
+
+const char *NMEALineRing::pending() const {
+    return buffer + (pendingStart & ringMask);
+}
+
+size_t NMEALineRing::pendingLength() const {
+    return pendingEnd - pendingStart;
+}
+
+// Done with the first length characters of pending, they're either a framed line or junk.
+void NMEALineRing::consume(size_t length) {
+    pendingStart += length;
+}
+
+// Takes a reference on a line, which must be within the pending characters and followed by its
+// CR/LF, which are included in the slice. Handlers are called one after another for the same
+// line, so a second reference to a line will be to the newest slice.
+NMEALineSlice *NMEALineRing::retainLine(const char *line, size_t length) {
+    const size_t position = pendingStart + (line - pending());
+
+    if (sliceCount) {
+        NMEALineSlice &newestSlice = slices[(oldestSlice + sliceCount - 1) % maxSlices];
+        if (newestSlice.position == position) {
+            newestSlice.references.fetch_add(1, std::memory_order_relaxed);
+            return &newestSlice;
+        }
+    }
+
+    const size_t retainedStart = sliceCount ? slices[oldestSlice].position : position;
+    if (sliceCount == maxSlices || pendingEnd - retainedStart > maxRetainedSpace) {
+        _retainFailures++;
+        return nullptr;
+    }
+
+    NMEALineSlice &slice = slices[(oldestSlice + sliceCount) % maxSlices];
+    slice.position = position;
+    slice._data = line;
+    slice._length = length + 2;
+    slice.references.store(1, std::memory_order_relaxed);
+    sliceCount++;
+
+    return &slice;
+}
+
+uint32_t NMEALineRing::usedSpace() const {
+    return _usedSpace;
+}
+
+uint32_t NMEALineRing::peakUsedSpace() const {
+    return _peakUsedSpace;
+}
+
+uint32_t NMEALineRing::overruns() const {
+    return _overruns;
+}
+
+uint32_t NMEALineRing::retainFailures() const {
+    return _retainFailures;
+}
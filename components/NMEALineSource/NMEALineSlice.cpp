@@ -0,0 +1,41 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NMEALineSlice.h"
+
+#include <atomic>
+
+#include <stddef.h>
+#include <stdint.h>
+
+NMEALineSlice::NMEALineSlice() : position(0), _data(nullptr), _length(0), references(0) {
+}
+
+const char *NMEALineSlice::data() const {
+    return _data;
+}
+
+size_t NMEALineSlice::length() const {
+    return _length;
+}
+
+// The ring only looks for released slices from the receiving task, so all that's needed here is
+// to drop the count.
+void NMEALineSlice::release() {
+    references.fetch_sub(1, std::memory_order_release);
+}
@@ -18,10 +18,13 @@
 
 #include "NMEALineSource.h"
 #include "NMEALine.h"
+#include "NMEALineRing.h"
 #include "NMEALineHandler.h"
 #include "NMEALineWalker.h"
 #include "NMEATalker.h"
+#include "NMEATalkerSet.h"
 #include "NMEAMsgType.h"
+#include "NMEADuplicateFilter.h"
 
 #include "DataModelNode.h"
 #include "DataModelStringLeaf.h"
@@ -33,28 +36,42 @@
 #include "Error.h"
 
 #include "etl/vector.h"
-#include "etl/set.h"
 #include "etl/string.h"
 #include "etl/string_view.h"
 
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
 NMEALineSource::NMEALineSource(DataModelNode &interfaceNode, const char *filteredTalkersList,
                                StatsManager &statsManager)
-    : carriageReturnFound(false),
+    : ring(),
+      scannedLength(0),
+      scannedParity(0),
+      carriageReturnFound(false),
+      discardingLine(false),
+      reportedTalkers(0),
       messagesCounter(),
       talkerFilteredMessages(0),
       badTagMessages(0),
+      duplicateMessages(0),
       nmeaNode("nmea", &interfaceNode),
       _nmeaInputNode("input", &nmeaNode),
       messagesLeaf("messages", &_nmeaInputNode),
       messageRateLeaf("messageRate", &_nmeaInputNode),
       talkersLeaf("talkers", &_nmeaInputNode, talkersBuffer),
       talkerFilteredMessagesLeaf("talkerFilteredMsgs", &_nmeaInputNode),
-      badTagsMessagesLeaf("badTagMsgs", &_nmeaInputNode) {
+      badTagsMessagesLeaf("badTagMsgs", &_nmeaInputNode),
+      duplicateMessagesLeaf("duplicateMsgs", &_nmeaInputNode),
+      ringNode("ring", &_nmeaInputNode),
+      ringSizeLeaf("size", &ringNode),
+      ringUsedLeaf("used", &ringNode),
+      ringPeakUsedLeaf("peakUsed", &ringNode),
+      ringOverrunsLeaf("overruns", &ringNode),
+      ringRetainFailuresLeaf("retainFailures", &ringNode) {
     statsManager.addStatsHolder(*this);
     talkersLeaf = "";
+    ringSizeLeaf = NMEALineRing::ringSize;
 
     buildFilteredTalkersSet(filteredTalkersList);
 }
@@ -84,118 +101,160 @@ void NMEALineSource::buildFilteredTalkersSet(const char *filteredTalkersList) {
             if (filteredTalkers.contains(talker)) {
                 logger() << logWarnNMEALine << "Duplicate NMEA talker '" << talkerStrView
                         << "' in NMEA 0183 talker filter list: " << filteredTalkersList << eol;
-            } else {
-                filteredTalkers.insert(talker);
+            } else if (!filteredTalkers.insert(talker)) {
+                logger() << logWarnNMEALine << "Ignoring bad NMEA talker code '" << talkerStrView
+                         << "' in NMEA 0183 talker filter list: " << filteredTalkersList << eol;
             }
         }
     }
 }
 
 void NMEALineSource::sourceReset() {
+    ring.reset();
+    scannedLength = 0;
+    scannedParity = 0;
     carriageReturnFound = false;
-    inputLine.reset();
+    discardingLine = false;
 }
 
-bool NMEALineSource::scanForCarriageReturn(size_t &carriageReturnPos, const char *buffer,
-                                           size_t &bufferPos, size_t &remaining) {
-    size_t scanRemaining;
-    size_t scanPos;
+// Looks for the carriage return ending a line, a 32-bit word at a time where possible, folding
+// each character before it into the line's parity as it goes. Returns the position of the
+// carriage return, or end if there isn't one.
+size_t NMEALineSource::scanToCarriageReturn(const char *buffer, size_t pos, size_t end,
+                                            uint8_t &parity) {
+    static constexpr uint32_t lowBits = 0x01010101;
+    static constexpr uint32_t highBits = 0x80808080;
+    static constexpr uint32_t carriageReturns = lowBits * '\r';
+
+    // Byte at a time up to a word boundary, the ESP32 can't do unaligned word loads...
+    while (pos < end && ((uintptr_t)(buffer + pos) & (sizeof(uint32_t) - 1)) != 0) {
+        if (buffer[pos] == '\r') {
+            return pos;
+        }
+        parity ^= buffer[pos++];
+    }
 
-    for (scanPos = bufferPos, scanRemaining = remaining;
-        scanRemaining;
-        scanPos++, scanRemaining--) {
-        if (buffer[scanPos] == '\r') {
-            carriageReturnPos = scanPos;
-            return true;
+    // ...then a word at a time until a word holds a carriage return. XORing a word with all
+    // carriage returns zeroes any byte that is one, which the classic SWAR zero byte test finds.
+    uint32_t wordParity = 0;
+    while (end - pos >= sizeof(uint32_t)) {
+        uint32_t word;
+        memcpy(&word, __builtin_assume_aligned(buffer + pos, sizeof(uint32_t)), sizeof(word));
+        const uint32_t carriageReturnsZeroed = word ^ carriageReturns;
+        if (((carriageReturnsZeroed - lowBits) & ~carriageReturnsZeroed & highBits) != 0) {
+            break;
+        }
+        wordParity ^= word;
+        pos += sizeof(uint32_t);
+    }
+    wordParity ^= wordParity >> 16;
+    wordParity ^= wordParity >> 8;
+    parity ^= (uint8_t)wordParity;
+
+    // ...and byte at a time to find the carriage return within its word, or through the tail.
+    while (pos < end) {
+        if (buffer[pos] == '\r') {
+            return pos;
         }
+        parity ^= buffer[pos++];
     }
 
-    return false;
+    return end;
 }
 
-bool NMEALineSource::processBufferToEndOfLine(const char *buffer, size_t &bufferPos,
-                                              size_t &remaining) {
-    // Since NMEA 0183 has CR/LF terminated lines, if the last thing we looked at was a carriage
-    // return, we should be looking at a line feed.
-    if (carriageReturnFound) {
-        if (isLineFeed(buffer[bufferPos])) {
-            // Skip past the line feed and return saying the line is ready for processing.
-            bufferPos++;
-            remaining--;
-            carriageReturnFound = false;
-            return true;
-        } else {
-            // We had a carriage return without the associated line feed. Toss out any characters
-            // that we had accumulated in the line and move on, processing the buffer.
-            logger() << logWarnNMEALine << "NMEA line with CR, but no LF. Ignoring." << eol;
-            inputLine.reset();
-            carriageReturnFound = false;
-        }
+// Returns where in the receive ring the interface should read to, and how much it may read.
+char *NMEALineSource::receiveBuffer(size_t &length) {
+    bool pendingDropped;
+    char *buffer = ring.receiveSpace(maxReceiveLength, length, pendingDropped);
+    if (pendingDropped) {
+        logger() << logWarnNMEALine << "NMEA receive ring overrun, partial line dropped" << eol;
+        scannedLength = 0;
+        scannedParity = 0;
+        carriageReturnFound = false;
+        discardingLine = true;
     }
 
-    size_t carriageReturnPos;
-    if (scanForCarriageReturn(carriageReturnPos, buffer, bufferPos, remaining)) {
-        // We have a CR, move the characters up to that point into the line.
-        inputLine.append(buffer, bufferPos, carriageReturnPos);
-        remaining -= carriageReturnPos - bufferPos + 1;
-        bufferPos = carriageReturnPos + 1;
-
-        // If we have at least one more character in the buffer make sure it's an LF
-        if (remaining) {
-            if (isLineFeed(buffer[bufferPos])) {
-                // The line was correctly terminated and should be ready to go.
-                remaining--;
-                bufferPos++;
-                return true;
+    return buffer;
+}
+
+// Frames the lines in what was just read to the space given by receiveBuffer(). Lines are
+// handled where they sit in the ring, with the ring keeping a partial line contiguous until the
+// rest of it arrives.
+void NMEALineSource::processReceived(size_t length) {
+    ring.received(length);
+
+    const char *pending = ring.pending();
+    size_t pendingLength = ring.pendingLength();
+    size_t pos = scannedLength;
+    uint8_t parity = scannedParity;
+
+    while (pos < pendingLength) {
+        if (carriageReturnFound) {
+            // Since NMEA 0183 has CR/LF terminated lines, the carriage return should be followed
+            // by a line feed.
+            carriageReturnFound = false;
+            size_t lineEnd;
+            if (isLineFeed(pending[pos])) {
+                lineTerminated(pending, pos - 1, parity);
+                lineEnd = pos + 1;
             } else {
-                // We had a carriage return without the associated line feed. Toss out any
-                // characters that we had accumulated in the line. If we still have characters in
-                // the buffer, recursively process those.
+                // A carriage return without the associated line feed. Toss out the line and carry
+                // on with what follows the carriage return.
                 logger() << logWarnNMEALine << "NMEA line with CR, but no LF. Ignoring." << eol;
-                inputLine.reset();
-                remaining--;
-                bufferPos++;
-                if (remaining) {
-                    return processBufferToEndOfLine(buffer, bufferPos, remaining);
-                } else {
-                    bufferPos = 0;
-                    return false;
-                }
+                discardingLine = false;
+                lineEnd = pos;
             }
-        } else {
-            // The buffer ended on a carriage return, we'll pick up looking for the line feed after
-            // the next read.
+            ring.consume(lineEnd);
+            pending += lineEnd;
+            pendingLength -= lineEnd;
+            pos = 0;
+            parity = 0;
+            continue;
+        }
+
+        pos = scanToCarriageReturn(pending, pos, pendingLength, parity);
+        if (pos < pendingLength) {
             carriageReturnFound = true;
-            return false;
+            pos++;
         }
-    } else {
-        // No carriage return so far, stash what we have so far in the line.
-        inputLine.append(buffer, bufferPos, bufferPos + remaining);
-        bufferPos = 0;
-        remaining = 0;
-        return false;
     }
-}
-
-void NMEALineSource::processBuffer(const char *buffer, size_t length) {
-    size_t bufferPos = 0;
-    size_t remaining = length;
 
-    while (remaining) {
-        if (processBufferToEndOfLine(buffer, bufferPos, remaining)) {
-            lineCompleted();
-            inputLine.reset();
+    if (!carriageReturnFound && pos > 0 && (discardingLine || pos > maxNMEALineLength)) {
+        // No point in holding on to a line that's too long to use. Drop what we have of it, and
+        // the rest as it arrives.
+        if (!discardingLine) {
+            logger() << logWarnNMEALine << "NMEA line exceeded maximum length of "
+                     << maxNMEALineLength << " characters. Ignoring." << eol;
+            discardingLine = true;
         }
+        ring.consume(pos);
+        pos = 0;
+        parity = 0;
     }
+
+    scannedLength = pos;
+    scannedParity = parity;
 }
 
-void NMEALineSource::lineCompleted() {
-    if (inputLine.isEmpty()) {
+void NMEALineSource::lineTerminated(const char *start, size_t length, uint8_t parity) {
+    if (discardingLine) {
+        discardingLine = false;
+    } else if (length > maxNMEALineLength) {
+        logger() << logWarnNMEALine << "NMEA line of " << length
+                 << " characters exceeded maximum length. Ignoring." << eol;
+    } else {
+        lineCompleted(start, length, parity);
+    }
+}
+
+void NMEALineSource::lineCompleted(const char *start, size_t length, uint8_t parity) {
+    if (length == 0) {
         // For now we just ignore empty input lines. Count?
         return;
     }
 
-    if (!inputLine.sanityCheck()) {
+    NMEALine inputLine(start, length, &ring);
+    if (!inputLine.sanityCheck(parity)) {
         // Errors are logged by the sanity check.
         return;
     }
@@ -204,20 +263,21 @@ void NMEALineSource::lineCompleted() {
 
     NMEATalker talker;
     NMEAMsgType msgType;
-    if (parseTag(talker, msgType)) {
+    if (parseTag(inputLine, talker, msgType)) {
         if (!talkers.contains(talker)) {
             newTalkerSeen(talker);
         }
 
         if (filteredTalkers.contains(talker)) {
-            messageFilteredByTalker(talker);
+            messageFilteredByTalker(inputLine, talker);
         } else {
-            handleLine(talker, msgType);
+            handleLine(inputLine, talker, msgType);
         }
     }
 }
 
-bool NMEALineSource::parseTag(NMEATalker &talker, NMEAMsgType &msgType) {
+bool NMEALineSource::parseTag(const NMEALine &inputLine, NMEATalker &talker,
+                              NMEAMsgType &msgType) {
     NMEALineWalker walker(inputLine, true);
 
     etl::string_view tagView;
@@ -229,7 +289,7 @@ bool NMEALineSource::parseTag(NMEATalker &talker, NMEAMsgType &msgType) {
 
     // Deal with the proprietary messages which have a four character tag instead of the usual five
     if (tagView.size() == 4 && tagView[0] == 'P') {
-        talker = NMEATalker("PD");
+        talker = NMEATalker('P', 'D');
         msgType = NMEAMsgType(NMEAMsgType::PROPRIETARY);
         return true;
     }
@@ -240,14 +300,11 @@ bool NMEALineSource::parseTag(NMEATalker &talker, NMEAMsgType &msgType) {
         return false;
     }
 
-    etl::string<2> talkerCode(tagView.begin(), 2);
-    talker = NMEATalker(talkerCode);
-
-    etl::string<3> msgTypeStr(tagView.begin() + 2, 3);
-    msgType = NMEAMsgType(msgTypeStr);
+    talker = NMEATalker(tagView[0], tagView[1]);
+    msgType = NMEAMsgType(tagView[2], tagView[3], tagView[4]);
     if (msgType == NMEAMsgType::UNKNOWN) {
-        logger() << logWarnNMEALine << "NMEA message with unknown type (" << msgTypeStr << ")"
-                 << " from " << talker << ". Ignored." << eol;
+        logger() << logWarnNMEALine << "NMEA message with unknown type (" << tagView.substr(2)
+                 << ")" << " from " << talker << ". Ignored." << eol;
         return false;
     }
 
@@ -255,10 +312,15 @@ bool NMEALineSource::parseTag(NMEATalker &talker, NMEAMsgType &msgType) {
 }
 
 void NMEALineSource::newTalkerSeen(const NMEATalker &talker) {
-    if (!talkers.full()) {
+    // Talkers that can't be kept in the set are seen anew with every message, don't spam the log.
+    if (!talkers.insert(talker)) {
+        return;
+    }
+
+    if (reportedTalkers < maxTalkers) {
         logger() << logNotifyNMEA << "New NMEA talker '" << talker << "'" << eol;
 
-        talkers.insert(talker);
+        reportedTalkers++;
 
         etl::string<4> newText;
         if (!talkersLeaf.isEmptyStr()) {
@@ -272,14 +334,39 @@ void NMEALineSource::newTalkerSeen(const NMEATalker &talker) {
     }
 }
 
-void NMEALineSource::messageFilteredByTalker(const NMEATalker &talker) {
+void NMEALineSource::messageFilteredByTalker(const NMEALine &inputLine,
+                                             const NMEATalker &talker) {
     talkerFilteredMessages++;
 
     logger() << logDebugNMEA << "Filtering NMEA msg from talker '" << talker << "': " << inputLine
              << eol;
 }
 
-void NMEALineSource::handleLine(const NMEATalker &talker, const NMEAMsgType &msgType) {
+bool NMEALineSource::mayBeDuplicate(const NMEALine &inputLine, const NMEAMsgType &msgType) {
+    switch (msgType) {
+        case NMEAMsgType::VDM:
+        case NMEAMsgType::VDO:
+            // Each interface puts its own encapsulated messages back together, so dropping one
+            // fragment of a multi-fragment message because another interface also received it
+            // would leave both interfaces with incomplete messages. The fragment count directly
+            // follows the tag, as in "!AIVDM,2,1,...".
+            return inputLine.length() > 8 && inputLine.data()[7] == '1' &&
+                   inputLine.data()[8] == ',';
+
+        default:
+            return true;
+    }
+}
+
+void NMEALineSource::handleLine(const NMEALine &inputLine, const NMEATalker &talker,
+                                const NMEAMsgType &msgType) {
+    // Checked here, ahead of all of the line handlers, so that a line received on another
+    // interface is dropped whatever would have been done with it.
+    if (mayBeDuplicate(inputLine, msgType) && nmeaDuplicateFilter.isDuplicate(inputLine, this)) {
+        duplicateMessages++;
+        return;
+    }
+
     logger() << logDebugNMEALine << "Handling NMEA formatted line: " << inputLine << eol;
     for (NMEALineHandler *lineHandler : lineHandlers) {
         lineHandler->handleLine(inputLine, talker, msgType);
@@ -304,4 +391,9 @@ void NMEALineSource::exportStats(uint32_t msElapsed) {
     messagesCounter.update(messagesLeaf, messageRateLeaf, msElapsed);
     talkerFilteredMessagesLeaf = talkerFilteredMessages;
     badTagsMessagesLeaf = badTagMessages;
+    duplicateMessagesLeaf = duplicateMessages;
+    ringUsedLeaf = ring.usedSpace();
+    ringPeakUsedLeaf = ring.peakUsedSpace();
+    ringOverrunsLeaf = ring.overruns();
+    ringRetainFailuresLeaf = ring.retainFailures();
 }
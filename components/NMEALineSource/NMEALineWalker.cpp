@@ -75,6 +75,10 @@ void NMEALineWalker::skipChar() {
     remaining.remove_prefix(1);
 }
 
+void NMEALineWalker::skipChars(size_t count) {
+    remaining.remove_prefix(count);
+}
+
 void NMEALineWalker::skipWord() {
     size_t commaPos = remaining.find(',');
     if (commaPos == remaining.npos) {
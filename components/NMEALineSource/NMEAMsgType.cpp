@@ -24,12 +24,110 @@
 #include "etl/string.h"
 #include "etl/string_view.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
+// Message type codes are packed into an integer, first character in the high byte, and looked
+// up with a perfect hash: a multiplicative hash whose multiplier is searched for at compile time
+// so that no two of the codes in the table below land in the same slot. A lookup is then a
+// multiply, a shift and a check that the slot holds the code looked up.
+static constexpr uint32_t msgTypeCode(char firstCharacter, char secondCharacter,
+                                      char thirdCharacter) {
+    return ((uint32_t)(uint8_t)firstCharacter << 16) | ((uint32_t)(uint8_t)secondCharacter << 8) |
+           (uint32_t)(uint8_t)thirdCharacter;
+}
+
+typedef struct {
+    uint32_t code;
+    NMEAMsgType::Value value;
+} MsgTypeTableEntry;
+
+static constexpr MsgTypeTableEntry msgTypeTable[] = {
+    { msgTypeCode('A', 'L', 'K'), NMEAMsgType::ALK },
+    { msgTypeCode('D', 'B', 'K'), NMEAMsgType::DBK },
+    { msgTypeCode('D', 'B', 'S'), NMEAMsgType::DBS },
+    { msgTypeCode('D', 'B', 'T'), NMEAMsgType::DBT },
+    { msgTypeCode('D', 'P', 'T'), NMEAMsgType::DPT },
+    { msgTypeCode('G', 'G', 'A'), NMEAMsgType::GGA },
+    { msgTypeCode('G', 'L', 'L'), NMEAMsgType::GLL },
+    { msgTypeCode('G', 'N', 'S'), NMEAMsgType::GNS },
+    { msgTypeCode('G', 'S', 'A'), NMEAMsgType::GSA },
+    { msgTypeCode('G', 'S', 'T'), NMEAMsgType::GST },
+    { msgTypeCode('G', 'S', 'V'), NMEAMsgType::GSV },
+    { msgTypeCode('H', 'D', 'G'), NMEAMsgType::HDG },
+    { msgTypeCode('H', 'D', 'M'), NMEAMsgType::HDM },
+    { msgTypeCode('M', 'T', 'W'), NMEAMsgType::MTW },
+    { msgTypeCode('M', 'W', 'V'), NMEAMsgType::MWV },
+    { msgTypeCode('R', 'M', 'C'), NMEAMsgType::RMC },
+    { msgTypeCode('R', 'S', 'A'), NMEAMsgType::RSA },
+    { msgTypeCode('T', 'X', 'T'), NMEAMsgType::TXT },
+    { msgTypeCode('V', 'D', 'M'), NMEAMsgType::VDM },
+    { msgTypeCode('V', 'D', 'O'), NMEAMsgType::VDO },
+    { msgTypeCode('V', 'H', 'W'), NMEAMsgType::VHW },
+    { msgTypeCode('V', 'T', 'G'), NMEAMsgType::VTG }
+};
+
+static constexpr unsigned msgTypeHashBits = 6;
+static constexpr size_t msgTypeHashSlots = 1 << msgTypeHashBits;
+
+static constexpr size_t msgTypeHashSlot(uint32_t code, uint32_t multiplier) {
+    return (uint32_t)(code * multiplier) >> (32 - msgTypeHashBits);
+}
+
+static constexpr bool msgTypeHashIsPerfect(uint32_t multiplier) {
+    bool slotUsed[msgTypeHashSlots] = {};
+    for (const MsgTypeTableEntry &entry : msgTypeTable) {
+        const size_t slot = msgTypeHashSlot(entry.code, multiplier);
+        if (slotUsed[slot]) {
+            return false;
+        }
+        slotUsed[slot] = true;
+    }
+
+    return true;
+}
+
+static constexpr uint32_t findMsgTypeHashMultiplier() {
+    // Start from the golden ratio, as Knuth suggests, and try odd multipliers from there.
+    uint32_t multiplier = 0x9e3779b1;
+    while (!msgTypeHashIsPerfect(multiplier)) {
+        multiplier += 2;
+    }
+
+    return multiplier;
+}
+
+static constexpr uint32_t msgTypeHashMultiplier = findMsgTypeHashMultiplier();
+
+typedef struct {
+    MsgTypeTableEntry slots[msgTypeHashSlots];
+} MsgTypeHashTable;
+
+// Unused slots have a code of zero, which no three character type can have.
+static constexpr MsgTypeHashTable buildMsgTypeHashTable() {
+    MsgTypeHashTable hashTable = {};
+    for (MsgTypeTableEntry &slot : hashTable.slots) {
+        slot = { 0, NMEAMsgType::UNKNOWN };
+    }
+    for (const MsgTypeTableEntry &entry : msgTypeTable) {
+        hashTable.slots[msgTypeHashSlot(entry.code, msgTypeHashMultiplier)] = entry;
+    }
+
+    return hashTable;
+}
+
+static constexpr MsgTypeHashTable msgTypeHashTable = buildMsgTypeHashTable();
+
 NMEAMsgType::NMEAMsgType() : value(UNKNOWN) {
 }
 
 NMEAMsgType::NMEAMsgType(Value value) : value(value) {
 }
 
+NMEAMsgType::NMEAMsgType(char firstCharacter, char secondCharacter, char thirdCharacter) {
+    parse(firstCharacter, secondCharacter, thirdCharacter);
+}
+
 NMEAMsgType::NMEAMsgType(const etl::istring &msgTypeStr) {
     parse(msgTypeStr);
 }
@@ -38,57 +136,29 @@ NMEAMsgType::NMEAMsgType(const etl::string_view &msgTypeStrView) {
     parse(msgTypeStrView);
 }
 
+void NMEAMsgType::parse(char firstCharacter, char secondCharacter, char thirdCharacter) {
+    const uint32_t code = msgTypeCode(firstCharacter, secondCharacter, thirdCharacter);
+    const MsgTypeTableEntry &slot =
+        msgTypeHashTable.slots[msgTypeHashSlot(code, msgTypeHashMultiplier)];
+    if (slot.code == code) {
+        value = slot.value;
+    } else {
+        value = UNKNOWN;
+    }
+}
+
 void NMEAMsgType::parse(const etl::istring &msgTypeStr) {
     etl::string_view msgTypeStrView(msgTypeStr);
     parse(msgTypeStrView);
 }
 
 void NMEAMsgType::parse(const etl::string_view &msgTypeStrView) {
-    if (msgTypeStrView == "DBK") {
-        value = DBK;
-    } else if (msgTypeStrView == "DBS") {
-        value = DBS;
-    } else if (msgTypeStrView == "DBT") {
-        value = DBT;
-    } else if (msgTypeStrView == "DPT") {
-        value = DPT;
-    } else if (msgTypeStrView == "GGA") {
-        value = GGA;
-    } else if (msgTypeStrView == "GLL") {
-        value = GLL;
-    } else if (msgTypeStrView == "GNS") {
-        value = GNS;
-    } else if (msgTypeStrView == "GSA") {
-        value = GSA;
-    } else if (msgTypeStrView == "GST") {
-        value = GST;
-    } else if (msgTypeStrView == "GSV") {
-        value = GSV;
-    } else if (msgTypeStrView == "HDG") {
-        value = HDG;
-    } else if (msgTypeStrView == "HDM") {
-        value = HDM;
-    } else if (msgTypeStrView == "MTW") {
-        value = MTW;
-    } else if (msgTypeStrView == "MWV") {
-        value = MWV;
-    } else if (msgTypeStrView == "RMC") {
-        value = RMC;
-    } else if (msgTypeStrView == "RSA") {
-        value = RSA;
-    } else if (msgTypeStrView == "TXT") {
-        value = TXT;
-    } else if (msgTypeStrView == "VDM") {
-        value = VDM;
-    } else if (msgTypeStrView == "VDO") {
-        value = VDO;
-    } else if (msgTypeStrView == "VHW") {
-        value = VHW;
-    } else if (msgTypeStrView == "VTG") {
-        value = VTG;
-    } else {
+    if (msgTypeStrView.size() != 3) {
         value = UNKNOWN;
+        return;
     }
+
+    parse(msgTypeStrView[0], msgTypeStrView[1], msgTypeStrView[2]);
 }
 
 const char *NMEAMsgType::name() const {
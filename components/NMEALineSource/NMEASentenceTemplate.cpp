@@ -0,0 +1,119 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "NMEASentenceTemplate.h"
+#include "NMEALine.h"
+
+#include "NumberFormat.h"
+
+#include "Error.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+NMEASentenceTemplate::NMEASentenceTemplate(const char *talkerCode, const char *format)
+    : slotCount(0) {
+    if (strlen(talkerCode) != 2) {
+        fatalError("Bad NMEA sentence template talker code");
+    }
+
+    size_t length = 0;
+    text[length++] = '$';
+    text[length++] = talkerCode[0];
+    text[length++] = talkerCode[1];
+
+    // The longest sentence the template can produce, including the checksum, must fit an NMEA
+    // line.
+    size_t maxSentenceLength = length + 3;
+    size_t fixedTextStart = 0;
+    for (const char *formatPos = format; *formatPos; formatPos++) {
+        if (*formatPos != '%') {
+            if (length == maxNMEALineLength) {
+                fatalError("NMEA sentence template too long");
+            }
+            text[length++] = *formatPos;
+            maxSentenceLength++;
+            continue;
+        }
+
+        SlotType slotType;
+        switch (*++formatPos) {
+            case 'u':
+                slotType = UNSIGNED_SLOT;
+                break;
+
+            case 'i':
+                slotType = SIGNED_SLOT;
+                break;
+
+            case 't':
+                slotType = TENTHS_SLOT;
+                break;
+
+            case 'c':
+                slotType = CHARACTER_SLOT;
+                break;
+
+            default:
+                fatalError("Bad NMEA sentence template slot type");
+        }
+        if (slotCount == maxSlots) {
+            fatalError("Too many slots in NMEA sentence template");
+        }
+
+        addFixedText(slotCount, fixedTextStart, length);
+        slotTypes[slotCount++] = slotType;
+        maxSentenceLength += maxSlotLength(slotType);
+        fixedTextStart = length;
+    }
+    addFixedText(slotCount, fixedTextStart, length);
+
+    if (maxSentenceLength > maxNMEALineLength) {
+        fatalError("NMEA sentence template too long");
+    }
+}
+
+void NMEASentenceTemplate::addFixedText(size_t slot, size_t start, size_t end) {
+    FixedText &fixedText = fixedTexts[slot];
+    fixedText.offset = start;
+    fixedText.length = end - start;
+
+    // The checksum covers everything after the leading '$'.
+    uint8_t parity = 0;
+    for (size_t pos = start == 0 ? 1 : start; pos < end; pos++) {
+        parity ^= text[pos];
+    }
+    fixedText.parity = parity;
+}
+
+size_t NMEASentenceTemplate::maxSlotLength(SlotType slotType) {
+    switch (slotType) {
+        case UNSIGNED_SLOT:
+            return 5;
+
+        case SIGNED_SLOT:
+            return 6;
+
+        case TENTHS_SLOT:
+            return 7;
+
+        case CHARACTER_SLOT:
+        default:
+            return 1;
+    }
+}
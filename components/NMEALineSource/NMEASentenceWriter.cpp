@@ -0,0 +1,104 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "NMEASentenceWriter.h"
+#include "NMEASentenceTemplate.h"
+#include "NMEALine.h"
+
+#include "TenthsUInt16.h"
+
+#include "NumberFormat.h"
+
+#include "Error.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+NMEASentenceWriter::NMEASentenceWriter(const NMEASentenceTemplate &sentenceTemplate)
+    : sentenceTemplate(sentenceTemplate), length(0), parity(0), slot(0) {
+    appendFixedText(0);
+}
+
+void NMEASentenceWriter::writeUnsigned(uint16_t value) {
+    char *slotText = startSlot(NMEASentenceTemplate::UNSIGNED_SLOT);
+    finishSlot(formatUInt32(slotText, value));
+}
+
+void NMEASentenceWriter::writeSigned(int16_t value) {
+    char *slotText = startSlot(NMEASentenceTemplate::SIGNED_SLOT);
+    finishSlot(formatInt32(slotText, value));
+}
+
+void NMEASentenceWriter::writeTenths(const TenthsUInt16 &value) {
+    char *slotText = startSlot(NMEASentenceTemplate::TENTHS_SLOT);
+    finishSlot(formatFixedPoint(slotText, (uint32_t)value.wholeNumber(), value.tenths(), 1));
+}
+
+void NMEASentenceWriter::writeCharacter(char character) {
+    char *slotText = startSlot(NMEASentenceTemplate::CHARACTER_SLOT);
+    *slotText = character;
+    finishSlot(1);
+}
+
+void NMEASentenceWriter::writeEmpty() {
+    if (slot == sentenceTemplate.slotCount) {
+        fatalError("Too many slots written to NMEA sentence");
+    }
+    finishSlot(0);
+}
+
+NMEALine NMEASentenceWriter::line() {
+    if (slot != sentenceTemplate.slotCount) {
+        fatalError("NMEA sentence missing slots");
+    }
+
+    // The template guarantees room for the checksum.
+    sentence[length++] = '*';
+    length += formatHexByte(sentence + length, parity);
+
+    return NMEALine(sentence, length);
+}
+
+char *NMEASentenceWriter::startSlot(NMEASentenceTemplate::SlotType slotType) {
+    if (slot == sentenceTemplate.slotCount) {
+        fatalError("Too many slots written to NMEA sentence");
+    }
+    if (sentenceTemplate.slotTypes[slot] != slotType) {
+        fatalError("Wrong type of value written to NMEA sentence slot");
+    }
+
+    return sentence + length;
+}
+
+void NMEASentenceWriter::finishSlot(size_t slotLength) {
+    for (size_t pos = length; pos < length + slotLength; pos++) {
+        parity ^= sentence[pos];
+    }
+    length += slotLength;
+    slot++;
+
+    appendFixedText(slot);
+}
+
+void NMEASentenceWriter::appendFixedText(size_t fixedTextIndex) {
+    const NMEASentenceTemplate::FixedText &fixedText =
+        sentenceTemplate.fixedTexts[fixedTextIndex];
+    memcpy(sentence + length, sentenceTemplate.text + fixedText.offset, fixedText.length);
+    length += fixedText.length;
+    parity ^= fixedText.parity;
+}
@@ -146,7 +146,11 @@ static const TalkerTableEntry talkerTable[] = {
     { "", nullptr }
 };
 
-NMEATalker::NMEATalker() : talkerCode("??") {
+NMEATalker::NMEATalker() : NMEATalker('?', '?') {
+}
+
+NMEATalker::NMEATalker(char firstCharacter, char secondCharacter)
+    : talkerCode(((uint8_t)firstCharacter << 8) | (uint8_t)secondCharacter) {
 }
 
 NMEATalker::NMEATalker(const etl::istring &talkerCode) {
@@ -154,7 +158,7 @@ NMEATalker::NMEATalker(const etl::istring &talkerCode) {
         fatalError("Bad parsing of the NMEA Talker Code");
     }
 
-    this->talkerCode = talkerCode;
+    *this = NMEATalker(talkerCode[0], talkerCode[1]);
 }
 
 NMEATalker::NMEATalker(const etl::string_view &talkerCodeStrView) {
@@ -162,19 +166,34 @@ NMEATalker::NMEATalker(const etl::string_view &talkerCodeStrView) {
         fatalError("Bad parsing of the NMEA Talker Code");
     }
 
-    this->talkerCode.assign(talkerCodeStrView.begin(), talkerCodeStrView.end());
+    *this = NMEATalker(talkerCodeStrView[0], talkerCodeStrView[1]);
+}
+
+uint16_t NMEATalker::code() const {
+    return talkerCode;
+}
+
+char NMEATalker::firstCharacter() const {
+    return (char)(talkerCode >> 8);
+}
+
+char NMEATalker::secondCharacter() const {
+    return (char)(talkerCode & 0xff);
 }
 
 const char *NMEATalker::name() const {
+    const char first = firstCharacter();
+    const char second = secondCharacter();
+
     unsigned tableEntryIndex;
     for (tableEntryIndex = 0; talkerTable[tableEntryIndex].code[0] != 0; tableEntryIndex++) {
         const TalkerTableEntry &tableEntry = talkerTable[tableEntryIndex];
-        if (tableEntry.code[0] == talkerCode[0] && tableEntry.code[1] == talkerCode[1]) {
+        if (tableEntry.code[0] == first && tableEntry.code[1] == second) {
             return tableEntry.description;
         }
     }
 
-    if (talkerCode[0] == 'P') {
+    if (first == 'P') {
         return "Proprietary";
     }
 
@@ -0,0 +1,82 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NMEATalkerSet.h"
+#include "NMEATalker.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+NMEATalkerSet::NMEATalkerSet() : members{}, memberCount(0) {
+}
+
+bool NMEATalkerSet::characterIndex(char character, size_t &index) {
+    if (character >= 'A' && character <= 'Z') {
+        index = character - 'A';
+        return true;
+    }
+    if (character >= '0' && character <= '9') {
+        index = 26 + character - '0';
+        return true;
+    }
+
+    return false;
+}
+
+bool NMEATalkerSet::talkerIndex(const NMEATalker &talker, size_t &index) {
+    size_t firstIndex;
+    size_t secondIndex;
+    if (!characterIndex(talker.firstCharacter(), firstIndex) ||
+        !characterIndex(talker.secondCharacter(), secondIndex)) {
+        return false;
+    }
+
+    index = firstIndex * codeCharacters + secondIndex;
+    return true;
+}
+
+// Returns false if the talker can't be a member of the set, true if it is now one, whether or
+// not it already was.
+bool NMEATalkerSet::insert(const NMEATalker &talker) {
+    size_t index;
+    if (!talkerIndex(talker, index)) {
+        return false;
+    }
+
+    const uint32_t bit = 1U << (index % bitsPerWord);
+    uint32_t &word = members[index / bitsPerWord];
+    if ((word & bit) == 0) {
+        word |= bit;
+        memberCount++;
+    }
+
+    return true;
+}
+
+bool NMEATalkerSet::contains(const NMEATalker &talker) const {
+    size_t index;
+    if (!talkerIndex(talker, index)) {
+        return false;
+    }
+
+    return (members[index / bitsPerWord] & (1U << (index % bitsPerWord))) != 0;
+}
+
+size_t NMEATalkerSet::size() const {
+    return memberCount;
+}
@@ -0,0 +1,60 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NMEA_DUPLICATE_FILTER_H
+#define NMEA_DUPLICATE_FILTER_H
+
+#include <freertos/FreeRTOS.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+class NMEALine;
+
+// Recognizes lines that have already been received, within a short window, on another NMEA
+// interface, as happens on boats with redundant AIS receivers or GPS feeds. Lines are remembered
+// by a hash of their contents, along with their length and the interface that received them, in
+// a small cache shared by all of the interfaces. Repeats of a line on the interface that first
+// received it aren't duplicates, they're that interface's next line.
+class NMEADuplicateFilter {
+    private:
+        static constexpr size_t cacheEntries = 32;
+        static constexpr uint32_t windowMs = CONFIG_LUNAMON_NMEA_DUPLICATE_WINDOW_MS;
+
+        struct Entry {
+            uint32_t hash;
+            uint32_t receivedMs;
+            const void *source;
+            size_t length;
+        };
+
+        Entry entries[cacheEntries];
+        size_t nextEntry;
+        portMUX_TYPE lock;
+
+        static uint32_t lineHash(const NMEALine &line);
+
+    public:
+        NMEADuplicateFilter();
+        // Returns true if the line was received from another source within the window. Otherwise
+        // the line is remembered as having been received from the given source.
+        bool isDuplicate(const NMEALine &line, const void *source);
+};
+
+extern NMEADuplicateFilter nmeaDuplicateFilter;
+
+#endif // NMEA_DUPLICATE_FILTER_H
@@ -25,30 +25,39 @@
 #include <stddef.h>
 
 class Logger;
+class NMEALineRing;
+class NMEALineSlice;
 
 const size_t maxNMEALineLength = 82;
 
 class NMEALine {
     private:
         etl::string<maxNMEALineLength> line;
+        // Lines handed to NMEALineHandlers by an NMEALineSource are views into the source's
+        // receive ring instead of copies. They are only valid for the duration of the
+        // handleLine() call, unless retained, and can't be appended to.
+        const char *viewData;
+        size_t viewLength;
+        NMEALineRing *ring;
 
-        bool validateChecksum();
+        bool validateChecksum(uint8_t lineParity) const;
 
     public:
         NMEALine();
         NMEALine(const etl::istring &string);
+        NMEALine(const char *data, size_t length, NMEALineRing *ring = nullptr);
         void reset();
-        void append(const char *srcBuffer, size_t start, size_t end);
         void append(const etl::istring &string);
         void append(const char *string);
         void append(char character);
-        bool isEmpty();
-        bool sanityCheck();
+        bool isEmpty() const;
+        bool sanityCheck(uint8_t lineParity) const;
         void appendWord(const etl::istring &string);
         void appendChecksum();
-        const etl::istring &contents() const;
+        etl::string_view contents() const;
         const char *data() const;
         size_t length() const;
+        NMEALineSlice *retain() const;
 
     friend Logger & operator << (Logger &logger, const NMEALine &nmeaLine);
 };
@@ -0,0 +1,94 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMEA_LINE_RING_H
+#define NMEA_LINE_RING_H
+
+#include "NMEALine.h"
+#include "NMEALineSlice.h"
+
+#include "sdkconfig.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The receive buffer of an NMEALineSource. Interfaces read straight into the ring, lines are
+// framed where they land, and a handler that needs a line after its handleLine() call returns
+// takes a reference counted slice of the ring instead of a copy. Received lines are always
+// contiguous in the ring, so the characters following a line are its CR/LF.
+//
+// Space is reclaimed oldest first, so a retained slice holds up everything received after it.
+// Should receiving catch up with a slice still in use, reads are thrown away and counted as
+// overruns until it's released.
+//
+// Positions are counted in characters received, modulo the ring size, which must be a power of
+// two for this to survive the counts wrapping. The ring is only written and framed from the
+// receiving task, slices may be released from any task.
+class NMEALineRing {
+    public:
+        static constexpr size_t ringSize = CONFIG_LUNAMON_NMEA_RECEIVE_RING_SIZE;
+
+    private:
+        static constexpr size_t ringMask = ringSize - 1;
+        static constexpr size_t maxSlices = 8;
+        // When there's less than this left at the end of the ring, receiving moves to its start,
+        // taking the line in progress with it.
+        static constexpr size_t minReceiveSpace = maxNMEALineLength;
+        // Slices are refused once the ring has this much in use, leaving the rest for lines
+        // received while the consumers catch up.
+        static constexpr size_t maxRetainedSpace = ringSize / 4;
+
+        static_assert((ringSize & ringMask) == 0, "NMEALineRing size must be a power of two");
+
+        char buffer[ringSize];
+        // Where reads go to be thrown away when the ring is full.
+        char overrunBuffer[minReceiveSpace];
+        bool overrunReceive;
+        // Received characters that haven't been made into lines yet run from pendingStart to
+        // pendingEnd.
+        size_t pendingStart;
+        size_t pendingEnd;
+        // Slices held by consumers, oldest first.
+        NMEALineSlice slices[maxSlices];
+        size_t oldestSlice;
+        size_t sliceCount;
+        uint32_t _usedSpace;
+        uint32_t _peakUsedSpace;
+        uint32_t _overruns;
+        uint32_t _retainFailures;
+
+        void reclaimSlices();
+        size_t tail() const;
+        void moveToStart(bool &pendingDropped);
+
+    public:
+        NMEALineRing();
+        void reset();
+        char *receiveSpace(size_t maxLength, size_t &length, bool &pendingDropped);
+        void received(size_t length);
+        const char *pending() const;
+        size_t pendingLength() const;
+        void consume(size_t length);
+        NMEALineSlice *retainLine(const char *line, size_t length);
+        uint32_t usedSpace() const;
+        uint32_t peakUsedSpace() const;
+        uint32_t overruns() const;
+        uint32_t retainFailures() const;
+};
+
+#endif // NMEA_LINE_RING_H
@@ -0,0 +1,50 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMEA_LINE_SLICE_H
+#define NMEA_LINE_SLICE_H
+
+#include <atomic>
+
+#include <stddef.h>
+#include <stdint.h>
+
+class NMEALineRing;
+
+// A reference counted slice of an NMEALineRing holding one received line, including its CR/LF
+// terminator. A slice is taken with NMEALine::retain() by a consumer that needs the line after
+// its handleLine() call returns, and must be released once the consumer is done with it, which
+// may be done from any task. The ring won't reuse the space until then.
+class NMEALineSlice {
+    private:
+        // Where the slice is in the ring's stream of received characters.
+        size_t position;
+        const char *_data;
+        size_t _length;
+        std::atomic<uint32_t> references;
+
+        friend class NMEALineRing;
+
+    public:
+        NMEALineSlice();
+        const char *data() const;
+        size_t length() const;
+        void release();
+};
+
+#endif // NMEA_LINE_SLICE_H
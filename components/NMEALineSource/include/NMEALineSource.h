@@ -20,8 +20,10 @@
 #define NMEA_LINE_SOURCE_H
 
 #include "NMEALine.h"
+#include "NMEALineRing.h"
 #include "NMEALineHandler.h"
 #include "NMEATalker.h"
+#include "NMEATalkerSet.h"
 
 #include "DataModelNode.h"
 #include "DataModelStringLeaf.h"
@@ -31,7 +33,6 @@
 #include "StatCounter.h"
 
 #include "etl/vector.h"
-#include "etl/set.h"
 
 #include <stddef.h>
 #include <stdint.h>
@@ -45,14 +46,24 @@ class NMEALineSource : StatsHolder {
         static const size_t maxTalkers = 10;
 
         etl::vector<NMEALineHandler *, MAX_LINE_HANDLERS> lineHandlers;
-        NMEALine inputLine;
+        // Lines are handed to the handlers straight out of the receive ring. How far into the
+        // pending characters of a partial line we've scanned is kept between reads, along with
+        // their parity and whether the scan stopped on the carriage return.
+        NMEALineRing ring;
+        size_t scannedLength;
+        uint8_t scannedParity;
         bool carriageReturnFound;
-        etl::set<NMEATalker, maxTalkers> talkers;
-        etl::set<NMEATalker, maxTalkers> filteredTalkers;
+        // Set when a line has been found to be too long, or was lost to a ring overrun, and
+        // the rest of it is to be dropped as it arrives.
+        bool discardingLine;
+        NMEATalkerSet talkers;
+        size_t reportedTalkers;
+        NMEATalkerSet filteredTalkers;
         StatCounter messagesCounter;
         uint32_t talkerFilteredMessages;
         etl::string<maxTalkers * 3> talkersBuffer;
         uint32_t badTagMessages;
+        uint32_t duplicateMessages;
 
         DataModelNode nmeaNode;
         DataModelNode _nmeaInputNode;
@@ -61,21 +72,33 @@ class NMEALineSource : StatsHolder {
         DataModelStringLeaf talkersLeaf;
         DataModelUInt32Leaf talkerFilteredMessagesLeaf;
         DataModelUInt32Leaf badTagsMessagesLeaf;
+        DataModelUInt32Leaf duplicateMessagesLeaf;
+        DataModelNode ringNode;
+        DataModelUInt32Leaf ringSizeLeaf;
+        DataModelUInt32Leaf ringUsedLeaf;
+        DataModelUInt32Leaf ringPeakUsedLeaf;
+        DataModelUInt32Leaf ringOverrunsLeaf;
+        DataModelUInt32Leaf ringRetainFailuresLeaf;
 
         void buildFilteredTalkersSet(const char *filteredTalkersList);
-        bool scanForCarriageReturn(size_t &carriageReturnPos, const char *buffer,
-                                   size_t &bufferPos, size_t &remaining);
-        bool processBufferToEndOfLine(const char *buffer, size_t &bufferPos, size_t &remaining);
-        void lineCompleted();
-        bool parseTag(NMEATalker &talker, NMEAMsgType &msgType);
+        static size_t scanToCarriageReturn(const char *buffer, size_t pos, size_t end,
+                                           uint8_t &parity);
+        void lineTerminated(const char *start, size_t length, uint8_t parity);
+        void lineCompleted(const char *start, size_t length, uint8_t parity);
+        bool parseTag(const NMEALine &inputLine, NMEATalker &talker, NMEAMsgType &msgType);
         void newTalkerSeen(const NMEATalker &talker);
-        void messageFilteredByTalker(const NMEATalker &talker);
-        void handleLine(const NMEATalker &talker, const NMEAMsgType &msgType);
-        virtual void exportStats(uint32_t msElapsed) override;
+        void messageFilteredByTalker(const NMEALine &inputLine, const NMEATalker &talker);
+        bool mayBeDuplicate(const NMEALine &inputLine, const NMEAMsgType &msgType);
+        void handleLine(const NMEALine &inputLine, const NMEATalker &talker,
+                        const NMEAMsgType &msgType);
 
     protected:
-        void processBuffer(const char *buffer, size_t length);
+        static constexpr size_t maxReceiveLength = maxNMEALineLength * 3;
+
+        char *receiveBuffer(size_t &length);
+        void processReceived(size_t length);
         DataModelNode &nmeaInputNode();
+        virtual void exportStats(uint32_t msElapsed) override;
 
     public:
         NMEALineSource(DataModelNode &interfaceNode, const char *filteredTalkersList,
@@ -21,6 +21,8 @@
 
 #include "etl/string_view.h"
 
+#include <stddef.h>
+
 class NMEALine;
 
 class NMEALineWalker {
@@ -38,6 +40,7 @@ class NMEALineWalker {
         bool getChar(char &character);
         bool getWord(etl::string_view &word);
         void skipChar();
+        void skipChars(size_t count);
         void skipWord();
         bool atEndOfLine() const;
 };
@@ -61,8 +61,10 @@ class NMEAMsgType {
     public:
         NMEAMsgType();
         NMEAMsgType(Value value);
+        NMEAMsgType(char firstCharacter, char secondCharacter, char thirdCharacter);
         NMEAMsgType(const etl::istring &msgTypeStr);
         NMEAMsgType(const etl::string_view &msgTypeStrView);
+        void parse(char firstCharacter, char secondCharacter, char thirdCharacter);
         void parse(const etl::istring &msgTypeStr);
         void parse(const etl::string_view &msgTypeStrView);
         constexpr operator Value() const { return value; }
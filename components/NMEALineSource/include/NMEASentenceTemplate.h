@@ -0,0 +1,71 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NMEA_SENTENCE_TEMPLATE_H
+#define NMEA_SENTENCE_TEMPLATE_H
+
+#include "NMEALine.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+// The shape of a sentence that is generated over and over with new values, described once as the
+// fixed text of the sentence with typed slots for the values. In the format, which follows the
+// talker code, a slot is written as a '%' followed by its type:
+//
+//   %u  unsigned whole number up to 65535
+//   %i  signed whole number from -32768 to 32767
+//   %t  unsigned number with tenths, as in a TenthsUInt16
+//   %c  single character
+//
+// so that a DBT sentence would be "DBT,%t,f,,M,,F". The fixed text, and its contribution to the
+// checksum, is worked out when the template is built, leaving only the values for an
+// NMEASentenceWriter to format.
+class NMEASentenceTemplate {
+    public:
+        enum SlotType : uint8_t {
+            UNSIGNED_SLOT,
+            SIGNED_SLOT,
+            TENTHS_SLOT,
+            CHARACTER_SLOT
+        };
+
+    private:
+        static constexpr size_t maxSlots = 8;
+
+        // The fixed text runs between the slots, so there is one more of them than of slots.
+        struct FixedText {
+            uint8_t offset;
+            uint8_t length;
+            uint8_t parity;
+        };
+
+        char text[maxNMEALineLength];
+        FixedText fixedTexts[maxSlots + 1];
+        SlotType slotTypes[maxSlots];
+        size_t slotCount;
+
+        void addFixedText(size_t slot, size_t start, size_t end);
+        static size_t maxSlotLength(SlotType slotType);
+
+        friend class NMEASentenceWriter;
+
+    public:
+        NMEASentenceTemplate(const char *talkerCode, const char *format);
+};
+
+#endif // NMEA_SENTENCE_TEMPLATE_H
@@ -0,0 +1,58 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NMEA_SENTENCE_WRITER_H
+#define NMEA_SENTENCE_WRITER_H
+
+#include "NMEASentenceTemplate.h"
+#include "NMEALine.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+class TenthsUInt16;
+
+// Generates a sentence from an NMEASentenceTemplate. Slots are filled in order, each value being
+// formatted straight into the sentence, followed by the template's fixed text up to the next slot.
+// The checksum is kept up to date as the sentence is written, so finishing the sentence is just
+// a matter of appending it.
+class NMEASentenceWriter {
+    private:
+        const NMEASentenceTemplate &sentenceTemplate;
+        char sentence[maxNMEALineLength];
+        size_t length;
+        uint8_t parity;
+        size_t slot;
+
+        char *startSlot(NMEASentenceTemplate::SlotType slotType);
+        void finishSlot(size_t slotLength);
+        void appendFixedText(size_t fixedTextIndex);
+
+    public:
+        NMEASentenceWriter(const NMEASentenceTemplate &sentenceTemplate);
+        void writeUnsigned(uint16_t value);
+        void writeSigned(int16_t value);
+        void writeTenths(const TenthsUInt16 &value);
+        void writeCharacter(char character);
+        // Leaves the slot, of whatever type, as an empty field.
+        void writeEmpty();
+        // The completed sentence, with its checksum, which remains valid for the life of the
+        // writer. All of the slots must have been written.
+        NMEALine line();
+};
+
+#endif // NMEA_SENTENCE_WRITER_H
@@ -26,14 +26,22 @@
 #include "etl/string_view.h"
 #include "etl/compare.h"
 
+#include <stdint.h>
+
+// Talker codes are kept packed into an integer, first character in the high byte, so that
+// comparisons and set lookups don't have to deal with strings.
 class NMEATalker : public etl::compare<NMEATalker>, public LoggableItem {
     private:
-        etl::string<2> talkerCode;
+        uint16_t talkerCode;
 
     public:
         NMEATalker();
+        NMEATalker(char firstCharacter, char secondCharacter);
         NMEATalker(const etl::istring &talkerCode);
         NMEATalker(const etl::string_view &talkerCodeStrView);
+        uint16_t code() const;
+        char firstCharacter() const;
+        char secondCharacter() const;
         const char *name() const;
         bool operator == (const NMEATalker &other) const;
         virtual void log(Logger &logger) const override;
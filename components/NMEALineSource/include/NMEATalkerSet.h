@@ -0,0 +1,49 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMEA_TALKER_SET_H
+#define NMEA_TALKER_SET_H
+
+#include "NMEATalker.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// A set of talkers kept as a bitmap indexed by talker code, so that checking a talker against it
+// on every message is a couple of table lookups. Talker codes are made of upper case letters and
+// digits, talkers with other characters in their codes can't be members.
+class NMEATalkerSet {
+    private:
+        static constexpr size_t codeCharacters = 26 + 10;
+        static constexpr size_t maxTalkers = codeCharacters * codeCharacters;
+        static constexpr size_t bitsPerWord = 32;
+
+        uint32_t members[(maxTalkers + bitsPerWord - 1) / bitsPerWord];
+        size_t memberCount;
+
+        static bool characterIndex(char character, size_t &index);
+        static bool talkerIndex(const NMEATalker &talker, size_t &index);
+
+    public:
+        NMEATalkerSet();
+        bool insert(const NMEATalker &talker);
+        bool contains(const NMEATalker &talker) const;
+        size_t size() const;
+};
+
+#endif // NMEA_TALKER_SET_H
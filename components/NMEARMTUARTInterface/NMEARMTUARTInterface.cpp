@@ -48,9 +48,11 @@ void NMEARMTUARTInterface::task() {
         // Currently we read by polling to see if there are characters in the UART's RX buffer,
         // reading them if there are, sleeping if there are not. A better implementation would be
         // to use an interrupt to wake the task...
-        size_t bytesRead = readToBuffer(buffer, rxBufferSize);
+        size_t length;
+        char *buffer = receiveBuffer(length);
+        size_t bytesRead = readToBuffer(buffer, length);
         if (bytesRead) {
-            processBuffer(buffer, bytesRead);
+            processReceived(bytesRead);
         } else {
             vTaskDelay(pdMS_TO_TICKS(noDataDelayMs));
         }
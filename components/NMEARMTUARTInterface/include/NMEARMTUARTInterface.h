@@ -39,7 +39,6 @@ class NMEARMTUARTInterface : public RMTUARTInterface, public NMEAInterface {
         static constexpr size_t rxBufferSize = maxNMEALineLength * 3;
         static constexpr uint32_t noDataDelayMs = 20;
 
-        char buffer[rxBufferSize];
 
         virtual void task() override;
 
@@ -26,15 +26,25 @@
 #include "etl/string.h"
 #include "etl/to_string.h"
 
+#include "esp_timer.h"
+
 #include <arpa/inet.h>
 #include <lwip/sockets.h>
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 NMEAClient::NMEAClient(int socket, struct sockaddr_in &sourceAddr)
     : socket(socket),
-      sourceAddr(sourceAddr) {
+      sourceAddr(sourceAddr),
+      head(0),
+      tail(0),
+      claimed(0),
+      behind(false),
+      behindSinceMs(0),
+      _droppedLines(0),
+      _sentBytes(0) {
     // We want client sockets to be non-blocking so that we don't lose input messages because of a
     // slow client or one that is going away.
     int nonblocking = 1;
@@ -42,32 +52,117 @@ NMEAClient::NMEAClient(int socket, struct sockaddr_in &sourceAddr)
     setSocketKeepalive();
 }
 
-bool NMEAClient::sendLine(const NMEALine &inputLine, bool &dropped) {
-    ssize_t result = send(socket, inputLine.data(), inputLine.length(), 0);
+bool NMEAClient::queueLine(const NMEALine &inputLine, bool &wasEmpty) {
+    const size_t lineLength = inputLine.length();
+    const size_t queuedLength = lineLength + 2;
+    wasEmpty = head == tail;
+
+    if (queuedBytes() + queuedLength > bufferSize) {
+        fellBehind();
+        if (slowClientPolicy != NMEA_CLIENT_DROP_OLDEST || !dropOldestLines(queuedLength)) {
+            _droppedLines++;
+            return false;
+        }
+    }
+
+    append(inputLine.data(), lineLength);
+    append("\r\n", 2);
+
+    return true;
+}
+
+// Makes room for a new line by dropping whole lines from the front of the buffer. Nothing can be
+// dropped while the writer is sending from the front, so the new line is dropped instead.
+bool NMEAClient::dropOldestLines(size_t length) {
+    if (length > bufferSize || claimed != 0) {
+        return false;
+    }
+
+    while (queuedBytes() + length > bufferSize) {
+        // Lines are dropped through their LF. A partially sent line at the front goes with them,
+        // leaving the client with a garbled line, but that beats holding up the newer ones.
+        while (tail != head && buffer[tail++ & bufferMask] != '\n') {
+        }
+        _droppedLines++;
+    }
+
+    return true;
+}
+
+void NMEAClient::append(const char *data, size_t length) {
+    const size_t offset = head & bufferMask;
+    const size_t firstLength = length < bufferSize - offset ? length : bufferSize - offset;
+    memcpy(buffer + offset, data, firstLength);
+    memcpy(buffer, data + firstLength, length - firstLength);
+    head += length;
+}
+
+void NMEAClient::fellBehind() {
+    if (!behind) {
+        behind = true;
+        behindSinceMs = millis();
+    }
+}
+
+size_t NMEAClient::claimQueued(const char *&data) {
+    if (head == tail) {
+        behind = false;
+        return 0;
+    }
+
+    // Queued lines that wrap around the end of the buffer take two claims.
+    const size_t offset = tail & bufferMask;
+    const size_t queued = head - tail;
+    claimed = queued < bufferSize - offset ? queued : bufferSize - offset;
+    data = buffer + offset;
+
+    return claimed;
+}
+
+ssize_t NMEAClient::sendClaimed(const char *data, size_t length) {
+    ssize_t result = send(socket, data, length, 0);
     if (result < 0) {
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            // The socket buffer is full so the client isn't going to get this message. It's still
-            // open though so we don't disconnect.
-            logger() << logDebugNMEAServer << "Send to NMEA Server client " << *this
-                     << " failed due to full buffer (" << strerror(errno) << ")" << eol;
-            dropped = true;
-            return true;
-        } else {
-            logger() << logWarnNMEAServer << "Send to NMEA Server client " << sourceAddr
-                     << " failed: " << strerror(errno) << "(" << errno << ")" << eol;
-            dropped = true;
-            return false;
+            // The socket buffer is full. What's left stays queued for the next time round.
+            return 0;
         }
-    } else if ((size_t)result != inputLine.length()) {
-        // Is this a thing?
-        logger() << logWarnNMEAServer << "Partial NMEA message sent to client " << sourceAddr
-                 << eol;
-        dropped = false;
-        return true;
-    } else {
-        dropped = false;
-        return true;
+
+        logger() << logWarnNMEAServer << "Send to NMEA Server client " << sourceAddr
+                 << " failed: " << strerror(errno) << "(" << errno << ")" << eol;
     }
+
+    return result;
+}
+
+void NMEAClient::releaseClaimed(size_t sentLength) {
+    tail += sentLength;
+    _sentBytes += sentLength;
+    claimed = 0;
+}
+
+bool NMEAClient::hasQueued() const {
+    return head != tail;
+}
+
+bool NMEAClient::tooFarBehind() const {
+    return slowClientPolicy == NMEA_CLIENT_DISCONNECT && behind &&
+           millis() - behindSinceMs >= slowClientDisconnectMs;
+}
+
+size_t NMEAClient::queuedBytes() const {
+    return head - tail;
+}
+
+uint32_t NMEAClient::droppedLines() const {
+    return _droppedLines;
+}
+
+uint32_t NMEAClient::sentBytes() const {
+    return _sentBytes;
+}
+
+uint32_t NMEAClient::millis() {
+    return (uint32_t)(esp_timer_get_time() / 1000);
 }
 
 void NMEAClient::setSocketKeepalive() {
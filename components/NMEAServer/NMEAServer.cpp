@@ -18,6 +18,7 @@
 
 #include "NMEAServer.h"
 #include "NMEAClient.h"
+#include "NMEAServerWriter.h"
 
 #include "NMEALine.h"
 
@@ -48,6 +49,7 @@ NMEAServer::NMEAServer(uint16_t knownPort, WiFiManager &wifiManager, StatsManage
     : TaskObject("NMEA Server", LOGGER_LEVEL_DEBUG, stackSize),
       WiFiManagerClient(wifiManager),
       knownPort(knownPort),
+      writer(*this),
       connects(0),
       disconnects(0),
       connectFailures(0),
@@ -68,6 +70,30 @@ NMEAServer::NMEAServer(uint16_t knownPort, WiFiManager &wifiManager, StatsManage
       client5NameLeaf("5", &clientsNode, client5NameBuffer),
       clientNameLeaves { &client1NameLeaf, &client2NameLeaf, &client3NameLeaf, &client4NameLeaf,
                          &client5NameLeaf },
+      clientLagNode("lag", &clientsNode),
+      client1LagLeaf("1", &clientLagNode),
+      client2LagLeaf("2", &clientLagNode),
+      client3LagLeaf("3", &clientLagNode),
+      client4LagLeaf("4", &clientLagNode),
+      client5LagLeaf("5", &clientLagNode),
+      clientLagLeaves { &client1LagLeaf, &client2LagLeaf, &client3LagLeaf, &client4LagLeaf,
+                        &client5LagLeaf },
+      clientDroppedNode("dropped", &clientsNode),
+      client1DroppedLeaf("1", &clientDroppedNode),
+      client2DroppedLeaf("2", &clientDroppedNode),
+      client3DroppedLeaf("3", &clientDroppedNode),
+      client4DroppedLeaf("4", &clientDroppedNode),
+      client5DroppedLeaf("5", &clientDroppedNode),
+      clientDroppedLeaves { &client1DroppedLeaf, &client2DroppedLeaf, &client3DroppedLeaf,
+                            &client4DroppedLeaf, &client5DroppedLeaf },
+      clientBytesNode("bytes", &clientsNode),
+      client1BytesLeaf("1", &clientBytesNode),
+      client2BytesLeaf("2", &clientBytesNode),
+      client3BytesLeaf("3", &clientBytesNode),
+      client4BytesLeaf("4", &clientBytesNode),
+      client5BytesLeaf("5", &clientBytesNode),
+      clientBytesLeaves { &client1BytesLeaf, &client2BytesLeaf, &client3BytesLeaf,
+                          &client4BytesLeaf, &client5BytesLeaf },
       messagesNode("messages", &nmeaServerNode),
       sentMessagesLeaf("sent", &messagesNode),
       sendMessageRateLeaf("sendRate", &messagesNode),
@@ -89,6 +115,7 @@ void NMEAServer::task() {
     }
 
     createServerSocket();
+    writer.start();
     logger << logNotifyNMEAServer << "NEMA Server listening for connections on port " << knownPort
            << eol;
 
@@ -175,34 +202,108 @@ void NMEAServer::newClient(int clientSocket, struct sockaddr_in &sourceAddr,
     connects++;
 }
 
-// Called on the thread for the particular interface...
+// Called on the thread for the particular interface. The line is only queued for each client,
+// the sending being left to the writer task.
 void NMEAServer::handleLine(const NMEALine &inputLine, const NMEATalker &talker,
                             const NMEAMsgType &msgType) {
+    bool wakeWriter = false;
+
     takeClientLock();
 
-    etl::ivector<NMEAClient *>::iterator clientIterator;
-    for (clientIterator = clients.begin(); clientIterator != clients.end(); ) {
-        NMEAClient *client = *clientIterator;
-        bool dropped;
-        if (!client->sendLine(inputLine, dropped)) {
+    for (NMEAClient *client : clients) {
+        const uint32_t droppedBefore = client->droppedLines();
+        bool wasEmpty;
+        if (client->queueLine(inputLine, wasEmpty) && wasEmpty) {
+            wakeWriter = true;
+        }
+        droppedMessages += client->droppedLines() - droppedBefore;
+    }
+
+    if (wakeWriter) {
+        writer.notifyLinesQueued();
+    }
+
+    releaseClientLock();
+}
+
+// Called on the writer task. Returns true if lines were left queued for any of the clients.
+// Clients are only removed by the writer task, so those in the snapshot taken under the client
+// lock stay valid while it sends to them without the lock.
+bool NMEAServer::sendToClients() {
+    bool linesLeft = false;
+
+    takeClientLock();
+    etl::vector<NMEAClient *, CONFIG_LUNAMON_NMEA_SERVER_MAX_CLIENTS> sendingClients(clients);
+    releaseClientLock();
+
+    for (NMEAClient *client : sendingClients) {
+        if (!sendToClient(*client)) {
             // Send failed, shut it down...
-            // Consider the implications to logging while holding this lock. It's not great, but
-            // the information is pretty useful.
-            logger << logNotifyNMEAServer << "NMEA Server client " << *client << " closed." << eol;
-            clientIterator = clients.erase(clientIterator);
-            client->~NMEAClient();
-            clientPool.release(client);
-            disconnects++;
-        } else {
-            if (dropped) {
-                droppedMessages++;
-            } else {
+            taskLogger() << logNotifyNMEAServer << "NMEA Server client " << *client << " closed."
+                         << eol;
+            removeClient(client);
+            continue;
+        }
+
+        takeClientLock();
+        const bool tooFarBehind = client->tooFarBehind();
+        if (!tooFarBehind && client->hasQueued()) {
+            linesLeft = true;
+        }
+        releaseClientLock();
+
+        if (tooFarBehind) {
+            taskLogger() << logWarnNMEAServer << "NMEA Server client " << *client
+                         << " fell too far behind. Disconnecting." << eol;
+            removeClient(client);
+        }
+    }
+
+    return linesLeft;
+}
+
+// Sends as much of what's queued for the client as its socket will take. The client lock is only
+// held to claim the queued bytes and to release them once sent, not for the send itself. Returns
+// false if the socket failed.
+bool NMEAServer::sendToClient(NMEAClient &client) {
+    while (true) {
+        const char *data;
+        takeClientLock();
+        const size_t claimedLength = client.claimQueued(data);
+        releaseClientLock();
+        if (claimedLength == 0) {
+            return true;
+        }
+
+        const ssize_t result = client.sendClaimed(data, claimedLength);
+        const size_t sentLength = result > 0 ? result : 0;
+
+        // Lines only count as sent once their LF has gone.
+        for (size_t position = 0; position < sentLength; position++) {
+            if (data[position] == '\n') {
                 sentMessages++;
             }
-            clientIterator++;
+        }
+
+        takeClientLock();
+        client.releaseClaimed(sentLength);
+        releaseClientLock();
+
+        if (result < 0) {
+            return false;
+        }
+        if (sentLength < claimedLength) {
+            return true;
         }
     }
+}
 
+void NMEAServer::removeClient(NMEAClient *client) {
+    takeClientLock();
+    clients.erase(etl::find(clients.begin(), clients.end(), client));
+    client->~NMEAClient();
+    clientPool.release(client);
+    disconnects++;
     releaseClientLock();
 }
 
@@ -231,17 +332,20 @@ void NMEAServer::exportStats(uint32_t msElapsed) {
     sentMessages.update(sentMessagesLeaf, sendMessageRateLeaf, msElapsed);
     droppedMessagesLeaf = droppedMessages;
 
-    updateClientNames();
+    updateClients();
 }
 
-void NMEAServer::updateClientNames() {
+void NMEAServer::updateClients() {
     takeClientLock();
 
     int pos = 0;
     for (NMEAClient *client : clients) {
         if (pos < 5) {
-            // For now we just have a fixed number of name slots in the data model.
+            // For now we just have a fixed number of client slots in the data model.
             client->setNameLeaf(clientNameLeaves[pos]);
+            *clientLagLeaves[pos] = client->queuedBytes();
+            *clientDroppedLeaves[pos] = client->droppedLines();
+            *clientBytesLeaves[pos] = client->sentBytes();
             pos++;
         } else {
             break;
@@ -252,5 +356,8 @@ void NMEAServer::updateClientNames() {
 
     for ( ; pos < 5; pos++) {
         *clientNameLeaves[pos] = "";
+        *clientLagLeaves[pos] = 0;
+        *clientDroppedLeaves[pos] = 0;
+        *clientBytesLeaves[pos] = 0;
     }
 }
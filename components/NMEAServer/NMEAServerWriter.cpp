@@ -0,0 +1,61 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NMEAServerWriter.h"
+#include "NMEAServer.h"
+
+#include "TaskObject.h"
+
+#include "Logger.h"
+#include "Error.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <stdint.h>
+
+NMEAServerWriter::NMEAServerWriter(NMEAServer &server)
+    : TaskObject("NMEA Server Writer", LOGGER_LEVEL_DEBUG, stackSize),
+      server(server) {
+}
+
+void NMEAServerWriter::task() {
+    TickType_t wait = portMAX_DELAY;
+
+    while (true) {
+        uint32_t notifications = 0;
+        (void)xTaskNotifyWaitIndexed(notifyIndex, 0, UINT32_MAX, &notifications, wait);
+
+        // Whether woken for new lines or on the retry timer, everything queued for every client
+        // goes out in as few sends as the sockets allow.
+        if (server.sendToClients()) {
+            wait = retryDelay;
+        } else {
+            wait = portMAX_DELAY;
+        }
+    }
+}
+
+// Called on the thread for the interface the line came in on, with the server's client lock held.
+void NMEAServerWriter::notifyLinesQueued() {
+    if (xTaskNotifyIndexed(taskHandle(), notifyIndex, notifyLinesQueuedMask, eSetBits) != pdPASS) {
+        taskLogger() << logErrorNMEAServer << "Failed to send lines queued notification to NMEA "
+                     << "Server writer" << eol;
+        errorExit();
+    }
+}
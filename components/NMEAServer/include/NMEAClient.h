@@ -21,20 +21,74 @@
 
 #include <lwip/sockets.h>
 
+#include <stddef.h>
+#include <stdint.h>
+
 class NMEALine;
 class Logger;
 class DataModelStringLeaf;
 
+enum NMEAClientSlowClientPolicy : uint8_t {
+    NMEA_CLIENT_DROP_OLDEST = 0,
+    NMEA_CLIENT_DROP_NEWEST = 1,
+    NMEA_CLIENT_DISCONNECT = 2
+};
+
+// A connected NMEA Server client. Lines for the client are queued, CRLF terminated, in its own
+// send buffer by whatever task they arrive on, and sent from there in batches by the server's
+// writer task. Other than sendClaimed(), all of a client's methods are called with the server's
+// client lock held. The writer claims the queued bytes under the lock and sends them without it,
+// so that a slow socket doesn't hold up the tasks queueing lines.
 class NMEAClient {
     private:
+        static constexpr size_t bufferSize = CONFIG_LUNAMON_NMEA_SERVER_CLIENT_BUFFER_SIZE;
+        static constexpr size_t bufferMask = bufferSize - 1;
+        static_assert((bufferSize & bufferMask) == 0,
+                      "NMEA Server client buffer size must be a power of two");
+        static constexpr NMEAClientSlowClientPolicy slowClientPolicy =
+            (NMEAClientSlowClientPolicy)CONFIG_LUNAMON_NMEA_SERVER_SLOW_CLIENT_POLICY;
+        static constexpr uint32_t slowClientDisconnectMs =
+            CONFIG_LUNAMON_NMEA_SERVER_SLOW_CLIENT_DISCONNECT_SECONDS * 1000;
+
         int socket;
         struct sockaddr_in sourceAddr;
+        char buffer[bufferSize];
+        // Free running positions of the next byte to be queued and the next to be sent.
+        uint32_t head;
+        uint32_t tail;
+        // Bytes from the tail claimed by the writer and being sent. They stay in the buffer, and
+        // can't be dropped to make room, until the writer releases them.
+        size_t claimed;
+        // Set while lines are being dropped for lack of room, and cleared once the buffer has
+        // been emptied.
+        bool behind;
+        uint32_t behindSinceMs;
+        uint32_t _droppedLines;
+        uint32_t _sentBytes;
 
         void setSocketKeepalive();
+        bool dropOldestLines(size_t length);
+        void append(const char *data, size_t length);
+        void fellBehind();
+        static uint32_t millis();
 
     public:
         NMEAClient(int socket, struct sockaddr_in &sourceAddr);
-        bool sendLine(const NMEALine &inputLine, bool &dropped);
+        // Returns false if the line had to be dropped. Sets wasEmpty if the buffer had nothing
+        // queued before the line, and so the server needs to be woken to send it.
+        bool queueLine(const NMEALine &inputLine, bool &wasEmpty);
+        // Claims the next contiguous run of queued bytes for sending, returning its length, or 0
+        // if there's nothing queued.
+        size_t claimQueued(const char *&data);
+        // Called without the client lock. Returns the number of bytes the socket took, 0 if it
+        // had no room, or -1 if it failed.
+        ssize_t sendClaimed(const char *data, size_t length);
+        void releaseClaimed(size_t sentLength);
+        bool hasQueued() const;
+        bool tooFarBehind() const;
+        size_t queuedBytes() const;
+        uint32_t droppedLines() const;
+        uint32_t sentBytes() const;
         void setNameLeaf(DataModelStringLeaf *nameLeaf);
         ~NMEAClient();
 
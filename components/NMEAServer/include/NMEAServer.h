@@ -24,6 +24,7 @@
 #include "WiFiManagerClient.h"
 #include "StatsHolder.h"
 #include "NMEAClient.h"
+#include "NMEAServerWriter.h"
 
 #include "StatCounter.h"
 #include "DataModelNode.h"
@@ -56,6 +57,7 @@ class NMEAServer : public NMEALineHandler, public TaskObject, WiFiManagerClient,
         static constexpr size_t maxClientNameLength = 22;
 
         uint16_t knownPort;
+        NMEAServerWriter writer;
         int serverSocket;
         SemaphoreHandle_t clientLock;
         etl::pool<NMEAClient, CONFIG_LUNAMON_NMEA_SERVER_MAX_CLIENTS> clientPool;
@@ -65,6 +67,7 @@ class NMEAServer : public NMEALineHandler, public TaskObject, WiFiManagerClient,
         uint32_t disconnects;
         uint32_t connectFailures;
         uint8_t maxClients;
+        // Counted by the writer task as lines are sent, rather than queued.
         StatCounter sentMessages;
         uint32_t droppedMessages;
         DataModelNode nmeaServerNode;
@@ -87,6 +90,28 @@ class NMEAServer : public NMEALineHandler, public TaskObject, WiFiManagerClient,
         etl::string<maxClientNameLength> client5NameBuffer;
         DataModelStringLeaf client5NameLeaf;
         DataModelStringLeaf *clientNameLeaves[5];
+        // Bytes queued but not yet sent, lines dropped and bytes sent, for each client.
+        DataModelNode clientLagNode;
+        DataModelUInt32Leaf client1LagLeaf;
+        DataModelUInt32Leaf client2LagLeaf;
+        DataModelUInt32Leaf client3LagLeaf;
+        DataModelUInt32Leaf client4LagLeaf;
+        DataModelUInt32Leaf client5LagLeaf;
+        DataModelUInt32Leaf *clientLagLeaves[5];
+        DataModelNode clientDroppedNode;
+        DataModelUInt32Leaf client1DroppedLeaf;
+        DataModelUInt32Leaf client2DroppedLeaf;
+        DataModelUInt32Leaf client3DroppedLeaf;
+        DataModelUInt32Leaf client4DroppedLeaf;
+        DataModelUInt32Leaf client5DroppedLeaf;
+        DataModelUInt32Leaf *clientDroppedLeaves[5];
+        DataModelNode clientBytesNode;
+        DataModelUInt32Leaf client1BytesLeaf;
+        DataModelUInt32Leaf client2BytesLeaf;
+        DataModelUInt32Leaf client3BytesLeaf;
+        DataModelUInt32Leaf client4BytesLeaf;
+        DataModelUInt32Leaf client5BytesLeaf;
+        DataModelUInt32Leaf *clientBytesLeaves[5];
         DataModelNode messagesNode;
         DataModelUInt32Leaf sentMessagesLeaf;
         DataModelUInt32Leaf sendMessageRateLeaf;
@@ -96,17 +121,20 @@ class NMEAServer : public NMEALineHandler, public TaskObject, WiFiManagerClient,
         void createServerSocket();
         void newClient(int clientSocket, struct sockaddr_in &sourceAddr,
                        socklen_t sourceAddrLength);
+        bool sendToClient(NMEAClient &client);
+        void removeClient(NMEAClient *client);
         void closeClientSocket(int clientSocket);
         void takeClientLock();
         void releaseClientLock();
         virtual void exportStats(uint32_t msElapsed) override;
-        void updateClientNames();
+        void updateClients();
 
     public:
         NMEAServer(uint16_t knownPort, WiFiManager &wifiManager, StatsManager &statsManager,
                    DataModel &dataModel);
         virtual void handleLine(const NMEALine &inputLine, const NMEATalker &talker,
                                 const NMEAMsgType &msgType) override;
+        bool sendToClients();
 };
 
 #endif // NMEA_SERVER_H
@@ -0,0 +1,50 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NMEA_SERVER_WRITER_H
+#define NMEA_SERVER_WRITER_H
+
+#include "TaskObject.h"
+
+#include <freertos/FreeRTOS.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+class NMEAServer;
+
+// Sends the lines queued for the NMEA Server's clients, so that the tasks of the interfaces the
+// lines come in on never touch a client socket.
+class NMEAServerWriter : public TaskObject {
+    private:
+        static constexpr size_t stackSize = 3 * 1024;
+        static constexpr UBaseType_t notifyIndex = 1;
+        static constexpr uint32_t notifyLinesQueuedMask = 0x00000001;
+        // How long to wait before trying again on clients whose sockets were full.
+        static constexpr TickType_t retryDelay = pdMS_TO_TICKS(20);
+
+        NMEAServer &server;
+
+        virtual void task() override;
+
+    public:
+        NMEAServerWriter(NMEAServer &server);
+        void notifyLinesQueued();
+};
+
+#endif // NMEA_SERVER_WRITER_H
@@ -38,7 +38,6 @@ class NMEASoftUARTInterface : public SoftUARTInterface, public NMEAInterface {
         static constexpr size_t rxBufferSize = maxNMEALineLength * 3;
         static constexpr uint32_t noDataDelayMs = 20;
 
-        char buffer[rxBufferSize];
 
         void task();
 
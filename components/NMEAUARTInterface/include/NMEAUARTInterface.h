@@ -39,9 +39,7 @@ class NMEAUARTInterface : public UARTInterface, public NMEAInterface {
         static constexpr size_t stackSize = 3 * 1024;
         static constexpr size_t rxBufferSize = maxNMEALineLength * 3;
         static constexpr size_t txBufferSize = maxNMEALineLength * 3;
-        static constexpr uint32_t noDataDelayMs = 20;
 
-        char buffer[rxBufferSize];
 
         virtual void task() override;
 
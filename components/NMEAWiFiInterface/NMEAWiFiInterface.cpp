@@ -57,12 +57,13 @@ void NMEAWiFiInterface::processStream() {
     sourceReset();
 
     while (true) {
-        char buffer[maxNMEALineLength];
-        size_t bytesRead = readToBuffer(buffer, maxNMEALineLength);
+        size_t length;
+        char *buffer = receiveBuffer(length);
+        size_t bytesRead = readToBuffer(buffer, length);
         if (bytesRead == 0) {
             // Connection was closed
             return;
         }
-        processBuffer(buffer, bytesRead);
+        processReceived(bytesRead);
     }
 }
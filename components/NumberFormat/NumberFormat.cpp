@@ -0,0 +1,133 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "NumberFormat.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Digits are produced two at a time, from the least significant end, out of a table of all of
+// the pairs from "00" to "99".
+static const char digitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const char hexDigits[17] = "0123456789ABCDEF";
+
+static size_t decimalDigits(uint32_t value) {
+    size_t digits = 1;
+    while (true) {
+        if (value < 10) {
+            return digits;
+        }
+        if (value < 100) {
+            return digits + 1;
+        }
+        if (value < 1000) {
+            return digits + 2;
+        }
+        if (value < 10000) {
+            return digits + 3;
+        }
+        value /= 10000;
+        digits += 4;
+    }
+}
+
+// Writes exactly length digits of value, zero padding on the left, with the digits ending just
+// before end.
+static void formatDigitsBackwards(char *end, uint32_t value, size_t length) {
+    char *pos = end;
+    while (length >= 2) {
+        const uint32_t pair = (value % 100) * 2;
+        value /= 100;
+        pos -= 2;
+        pos[0] = digitPairs[pair];
+        pos[1] = digitPairs[pair + 1];
+        length -= 2;
+    }
+    if (length) {
+        *--pos = '0' + value % 10;
+    }
+}
+
+size_t formatUInt32(char *buffer, uint32_t value) {
+    const size_t length = decimalDigits(value);
+    formatDigitsBackwards(buffer + length, value, length);
+    return length;
+}
+
+size_t formatInt32(char *buffer, int32_t value) {
+    if (value < 0) {
+        buffer[0] = '-';
+        // Negated as unsigned so that INT32_MIN is handled.
+        return 1 + formatUInt32(buffer + 1, 0u - (uint32_t)value);
+    }
+
+    return formatUInt32(buffer, value);
+}
+
+static size_t formatFraction(char *buffer, uint32_t fraction, uint8_t decimals) {
+    if (decimals == 0) {
+        return 0;
+    }
+    if (decimals > maxFixedPointDecimals) {
+        decimals = maxFixedPointDecimals;
+    }
+
+    buffer[0] = '.';
+    formatDigitsBackwards(buffer + 1 + decimals, fraction, decimals);
+    return 1 + decimals;
+}
+
+size_t formatFixedPoint(char *buffer, uint32_t wholeNumber, uint32_t fraction, uint8_t decimals) {
+    const size_t wholeLength = formatUInt32(buffer, wholeNumber);
+    return wholeLength + formatFraction(buffer + wholeLength, fraction, decimals);
+}
+
+size_t formatFixedPoint(char *buffer, int32_t integer, uint32_t fraction, uint8_t decimals) {
+    const size_t integerLength = formatInt32(buffer, integer);
+    return integerLength + formatFraction(buffer + integerLength, fraction, decimals);
+}
+
+size_t formatHexByte(char *buffer, uint8_t value) {
+    buffer[0] = hexDigits[value >> 4];
+    buffer[1] = hexDigits[value & 0x0f];
+    return hexByteFormatLength;
+}
+
+size_t formatNMEACoordinate(char *buffer, uint8_t degrees, uint8_t degreeDigits,
+                            uint32_t tenThousandthsOfMinutes) {
+    const uint32_t wholeMinutes = tenThousandthsOfMinutes / 10000;
+    const uint32_t minuteFraction = tenThousandthsOfMinutes % 10000;
+
+    formatDigitsBackwards(buffer + degreeDigits, degrees, degreeDigits);
+    char *minutes = buffer + degreeDigits;
+    formatDigitsBackwards(minutes + 2, wholeMinutes, 2);
+    minutes[2] = '.';
+    formatDigitsBackwards(minutes + 7, minuteFraction, 4);
+
+    return degreeDigits + 7;
+}
@@ -0,0 +1,51 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NUMBER_FORMAT_H
+#define NUMBER_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Number formatting for the paths that run on every data model leaf update and every generated
+// NMEA sentence. Each function writes into a caller supplied buffer, which must be at least the
+// given maximum length, doesn't NUL terminate, and returns the number of characters written.
+
+constexpr size_t maxUInt32FormatLength = 10;
+constexpr size_t maxInt32FormatLength = 11;
+constexpr size_t maxFixedPointDecimals = 9;
+constexpr size_t maxFixedPointFormatLength = maxInt32FormatLength + 1 + maxFixedPointDecimals;
+constexpr size_t hexByteFormatLength = 2;
+constexpr size_t maxNMEACoordinateFormatLength = 10;
+
+extern size_t formatUInt32(char *buffer, uint32_t value);
+extern size_t formatInt32(char *buffer, int32_t value);
+// Writes "whole.fraction" with the fraction zero padded to the given number of decimals, as in
+// formatFixedPoint(buffer, 12, 5, 2) giving "12.05". The fraction must be less than
+// 10^decimals.
+extern size_t formatFixedPoint(char *buffer, uint32_t wholeNumber, uint32_t fraction,
+                               uint8_t decimals);
+extern size_t formatFixedPoint(char *buffer, int32_t integer, uint32_t fraction,
+                               uint8_t decimals);
+// Two upper case hex digits, as used for NMEA checksums.
+extern size_t formatHexByte(char *buffer, uint8_t value);
+// An NMEA 0183 latitude or longitude in the zero padded ddmm.mmmm (or dddmm.mmmm for longitudes,
+// with three degree digits) form. Minutes are given in ten thousandths.
+extern size_t formatNMEACoordinate(char *buffer, uint8_t degrees, uint8_t degreeDigits,
+                                   uint32_t tenThousandthsOfMinutes);
+
+#endif // NUMBER_FORMAT_H
@@ -38,9 +38,9 @@
 #include <stdint.h>
 
 STALKInterface::STALKInterface(Interface &interface, InstrumentData &instrumentData,
-                               StatsManager &statsManager)
+                               StatsManager &statsManager, DataModel &dataModel)
     : NMEALineSource(interface.interfaceNode(), "", statsManager),
-      SeaTalkInterface(interface, instrumentData, statsManager),
+      SeaTalkInterface(interface, instrumentData, statsManager, dataModel),
       interface(interface),
       messagesCounter(),
       illformedMessages(0),
@@ -160,7 +160,7 @@ void STALKInterface::sendCommand(const SeaTalkLine &seaTalkLine) {
     // Todo add an c++ iterator to seaTalkLine
     etl::format_spec byteFormat;
     byteFormat.hex().upper_case(true).width(2).fill('0');
-    for (int pos = 0; pos < seaTalkLine.length(); pos++) {
+    for (size_t pos = 0; pos < seaTalkLine.length(); pos++) {
         uint8_t datagramByte = seaTalkLine[pos];
         etl::string<4> datagramByteString;
         etl::to_string(datagramByte, datagramByteString, byteFormat);
@@ -172,8 +172,8 @@ void STALKInterface::sendCommand(const SeaTalkLine &seaTalkLine) {
 
     taskLogger() << logDebugSTALK << "Sending STALK command: " << nmeaLine << eol;
 
-    size_t bytesWritten = interface.send(nmeaLine.contents());
-    if (bytesWritten != nmeaLine.contents().length()) {
+    size_t bytesWritten = interface.sendBytes(nmeaLine.data(), nmeaLine.length());
+    if (bytesWritten != nmeaLine.length()) {
         taskLogger() << logWarnSTALK << "Write failure sended SeaTalk command to interface "
                      << interface.name() << eol;
     }
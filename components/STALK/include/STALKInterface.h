@@ -33,6 +33,7 @@ class NMEALineWalker;
 class Interface;
 class InstrumentData;
 class StatsManager;
+class DataModel;
 
 class STALKInterface : public NMEALineSource, NMEALineHandler, public SeaTalkInterface {
     private:
@@ -56,7 +57,7 @@ class STALKInterface : public NMEALineSource, NMEALineHandler, public SeaTalkInt
 
     public:
         STALKInterface(Interface &interface, InstrumentData &instrumentData,
-                       StatsManager &statsManager);
+                       StatsManager &statsManager, DataModel &dataModel);
         bool lastMessageIllformed() const;
 };
 
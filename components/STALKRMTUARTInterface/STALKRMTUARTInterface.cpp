@@ -35,7 +35,7 @@ STALKRMTUARTInterface::STALKRMTUARTInterface(const char *name, const char *label
     : RMTUARTInterface(name, label, INTERFACE_STALK, RX_AND_TX, baudRate, DATA_WIDTH_8_BITS,
                        PARITY_NONE, STOP_BITS_1, rxPin, txPin, rxBufferSize, statsManager,
                        dataModel, stackSize),
-      STALKInterface(*this, instrumentData, statsManager),
+      STALKInterface(*this, instrumentData, statsManager, dataModel),
       firstDigitalYachtsWorkaroundSent(false) {
     digitalYachtsWorkaroundTimer.setSeconds(digitalYachtsStartTimeSec);
 }
@@ -51,9 +51,11 @@ void STALKRMTUARTInterface::task() {
         // Currently we read by polling to see if there are characters in the UART's RC buffer,
         // reading them if there are, sleeping if there are not. A better implementation would be
         // to use an interrupt to wake the task...
-        size_t bytesRead = readToBuffer(buffer, rxBufferSize);
+        size_t length;
+        char *buffer = receiveBuffer(length);
+        size_t bytesRead = readToBuffer(buffer, length);
         if (bytesRead) {
-            NMEALineSource::processBuffer(buffer, bytesRead);
+            processReceived(bytesRead);
 
             // To get around bugs in Digitial Yachts' ST-NMEA (ISO) converters which prevented some
             // units from having configuration messages stored in NVRAM, we can reconfigure them on
@@ -43,7 +43,6 @@ class STALKRMTUARTInterface : public RMTUARTInterface, public STALKInterface {
         static constexpr uint32_t digitalYachtsStartTimeSec = 5;
         static constexpr uint32_t digitalYachtsResendTimeSec = 30;
 
-        char buffer[rxBufferSize];
         PassiveTimer digitalYachtsWorkaroundTimer;
         bool firstDigitalYachtsWorkaroundSent;
 
@@ -34,7 +34,7 @@ STALKUARTInterface::STALKUARTInterface(const char *name, const char *label, uart
                                        DataModel &dataModel)
     : UARTInterface(name, label, INTERFACE_STALK, uartNumber, rxPin, txPin, baudRate, rxBufferSize,
                     txBufferSize, statsManager, dataModel, stackSize),
-      STALKInterface(*this, instrumentData, statsManager),
+      STALKInterface(*this, instrumentData, statsManager, dataModel),
       firstDigitalYachtsWorkaroundSent(false) {
     digitalYachtsWorkaroundTimer.setSeconds(digitalYachtsStartTimeSec);
 }
@@ -47,21 +47,18 @@ void STALKUARTInterface::task() {
     logger << logDebugSTALKUART << "Starting receive on UART " << uartNumber() << "..." << eol;
 
     while (true) {
-        // Currently we read by polling to see if there are characters in the UART's RC buffer,
-        // reading them if there are, sleeping if there are not. A better implementation would be
-        // to use an interrupt to wake the task...
-        size_t bytesRead = readToBuffer(buffer, rxBufferSize);
+        size_t length;
+        char *buffer = receiveBuffer(length);
+        size_t bytesRead = receive(buffer, length, pdMS_TO_TICKS(maxReceiveWaitMs));
         if (bytesRead) {
-            NMEALineSource::processBuffer(buffer, bytesRead);
+            processReceived(bytesRead);
+        }
 
-            // To get around bugs in Digitial Yachts' ST-NMEA (ISO) converters which prevented some
-            // units from having configuration messages stored in NVRAM, we can reconfigure them on
-            // the fly.
-            if (CONFIG_LUNAMON_DIGITAL_YACHTS_STALK_WORKAROUND_ENABLED) {
-                workAroundDigitalYachtsBugs();
-            }
-        } else {
-            vTaskDelay(pdMS_TO_TICKS(noDataDelayMs));
+        // To get around bugs in Digitial Yachts' ST-NMEA (ISO) converters which prevented some
+        // units from having configuration messages stored in NVRAM, we can reconfigure them on
+        // the fly.
+        if (CONFIG_LUNAMON_DIGITAL_YACHTS_STALK_WORKAROUND_ENABLED) {
+            workAroundDigitalYachtsBugs();
         }
     }
 }
@@ -40,12 +40,13 @@ class STALKUARTInterface : public UARTInterface, public STALKInterface {
     private:
         static constexpr size_t stackSize = (1024 * 8);
         static constexpr size_t rxBufferSize = maxNMEALineLength * 3;
+        // Bounds how long we wait for data so the Digital Yachts workaround still gets checked
+        // when the converter has gone quiet.
+        static constexpr uint32_t maxReceiveWaitMs = 1000;
         static constexpr size_t txBufferSize = maxNMEALineLength * 2;
-        static constexpr uint32_t noDataDelayMs = 20;
         static constexpr uint32_t digitalYachtsStartTimeSec = 5;
         static constexpr uint32_t digitalYachtsResendTimeSec = 30;
 
-        char buffer[rxBufferSize];
         PassiveTimer digitalYachtsWorkaroundTimer;
         bool firstDigitalYachtsWorkaroundSent;
 
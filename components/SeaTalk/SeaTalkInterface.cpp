@@ -19,10 +19,13 @@
 #include "SeaTalkInterface.h"
 #include "SeaTalkParser.h"
 #include "SeaTalkWriteTester.h"
+#include "SeaTalkLampIntensity.h"
 #include "Interface.h"
 
+#include "DataModel.h"
 #include "DataModelNode.h"
 #include "DataModelUInt32Leaf.h"
+#include "DataModelWritableLeaf.h"
 #include "StatsManager.h"
 #include "StatCounter.h"
 
@@ -30,7 +33,7 @@
 #include "Error.h"
 
 SeaTalkInterface::SeaTalkInterface(Interface &interface, InstrumentData &instrumentData,
-                                   StatsManager &statsManager)
+                                   StatsManager &statsManager, DataModel &dataModel)
     : interface(interface),
       writeTester(nullptr),
       inputDatagramCounter(),
@@ -46,7 +49,10 @@ SeaTalkInterface::SeaTalkInterface(Interface &interface, InstrumentData &instrum
       outputNode("output", &seaTalkNode),
       outputDatagramsLeaf("datagrams", &outputNode),
       outputDatagramsRateLeaf("datagramRate", &outputNode),
-      outputErrorsLeaf("errors", &outputNode) {
+      outputErrorsLeaf("errors", &outputNode),
+      commandInterfaceNode(interface.name(), &dataModel.commandNode()),
+      commandNode("seaTalk", &commandInterfaceNode),
+      lampIntensityLeaf("lampIntensity", &commandNode, lampIntensityBuffer, *this) {
     statsManager.addStatsHolder(*this);
 
     if ((parser = new SeaTalkParser(inputNode, instrumentData, statsManager)) == nullptr) {
@@ -74,7 +80,7 @@ void SeaTalkInterface::start() {
 }
 
 void SeaTalkInterface::processBuffer(uint16_t *buffer, size_t length) {
-    for (int pos = 0; pos < length; pos++) {
+    for (size_t pos = 0; pos < length; pos++) {
         uint16_t nextChar = buffer[pos];
         if (nextChar & 0x100) {
             if (!inputLine.isEmpty()) {
@@ -113,6 +119,24 @@ void SeaTalkInterface::sendCommand(const SeaTalkLine &seaTalkLine) {
     }
 }
 
+// Called on the task of the MQTT client that wrote the leaf, not the interface task.
+bool SeaTalkInterface::leafWritten(DataModelWritableLeaf &leaf, const char *value) {
+    if (&leaf != &lampIntensityLeaf) {
+        return false;
+    }
+
+    SeaTalkLampIntensity lampIntensity(SeaTalkLampIntensity::L0);
+    if (!lampIntensity.setFromName(value)) {
+        taskLogger() << logWarnSeaTalk << "Illegal lamp intensity '" << value
+                     << "' for SeaTalk interface " << interface.name() << eol;
+        return false;
+    }
+
+    setLampIntensity(lampIntensity);
+
+    return true;
+}
+
 // For STALK interfaces this is called by STALKInterface::exportStats()
 void SeaTalkInterface::exportStats(uint32_t msElapsed) {
     inputDatagramCounter.update(inputDatagramsLeaf, inputDatagramsRateLeaf, msElapsed);
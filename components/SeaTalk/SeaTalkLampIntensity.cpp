@@ -21,6 +21,7 @@
 #include "Logger.h"
 
 #include <stdint.h>
+#include <string.h>
 
 SeaTalkLampIntensity::SeaTalkLampIntensity(uint8_t value) {
     this->value = (Value)value;
@@ -45,6 +46,20 @@ const char *SeaTalkLampIntensity::name() const {
     }
 }
 
+// Accepts the names given by name(), returning false for anything else.
+bool SeaTalkLampIntensity::setFromName(const char *name) {
+    SeaTalkLampIntensity candidate(L0);
+    do {
+        if (strcmp(name, candidate.name()) == 0) {
+            value = candidate.value;
+            return true;
+        }
+        candidate.cycle();
+    } while (candidate.value != L0);
+
+    return false;
+}
+
 bool SeaTalkLampIntensity::intensityValid() const {
     switch (value) {
         case L0:
@@ -26,8 +26,11 @@
 
 #include "DataModelNode.h"
 #include "DataModelUInt32Leaf.h"
+#include "DataModelWritableLeaf.h"
 #include "StatCounter.h"
 
+#include "etl/string.h"
+
 #include <stddef.h>
 #include <stdint.h>
 
@@ -36,10 +39,13 @@ class SeaTalkWriteTester;
 class Interface;
 class InstrumentData;
 class StatsManager;
+class DataModel;
 class SeaTalkNMEABridge;
 
-class SeaTalkInterface : public SeaTalkMaster, StatsHolder {
+class SeaTalkInterface : public SeaTalkMaster, StatsHolder, DataModelWriteHandler {
     private:
+        static constexpr size_t maxLampIntensityLength = 2;
+
         Interface &interface;
         SeaTalkLine inputLine;
         SeaTalkParser *parser;
@@ -58,15 +64,21 @@ class SeaTalkInterface : public SeaTalkMaster, StatsHolder {
         DataModelUInt32Leaf outputDatagramsLeaf;
         DataModelUInt32Leaf outputDatagramsRateLeaf;
         DataModelUInt32Leaf outputErrorsLeaf;
+        // Commands clients can give, under command/<interface>/seaTalk
+        DataModelNode commandInterfaceNode;
+        DataModelNode commandNode;
+        etl::string<maxLampIntensityLength> lampIntensityBuffer;
+        DataModelWritableLeaf lampIntensityLeaf;
 
         virtual void sendCommand(const SeaTalkLine &seaTalkLine);
+        virtual bool leafWritten(DataModelWritableLeaf &leaf, const char *value) override;
 
     protected:
         virtual void exportStats(uint32_t msElapsed) override;
 
     public:
         SeaTalkInterface(Interface &interface, InstrumentData &instrumentData,
-                         StatsManager &statsManager);
+                         StatsManager &statsManager, DataModel &dataModel);
         void addBridge(SeaTalkNMEABridge *bridge);
         void start();
         void processBuffer(uint16_t *buffer, size_t length);
@@ -43,6 +43,7 @@ class SeaTalkLampIntensity {
         constexpr operator Value() const { return value; }
         constexpr operator uint8_t() const { return (uint8_t)value; }
         const char *name() const;
+        bool setFromName(const char *name);
         explicit operator bool() const = delete;
         void cycle();
 
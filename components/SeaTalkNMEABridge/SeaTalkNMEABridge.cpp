@@ -22,6 +22,8 @@
 #include "NMEALineHandler.h"
 #include "NMEATalker.h"
 #include "NMEAMsgType.h"
+#include "NMEASentenceTemplate.h"
+#include "NMEASentenceWriter.h"
 
 #include "StatCounter.h"
 #include "StatsManager.h"
@@ -36,11 +38,22 @@
 #include "Error.h"
 
 #include "etl/string.h"
-#include "etl/string_stream.h"
 
 #include <stdint.h>
 #include <string.h>
 
+// Checked ahead of the sentence templates being built from it, so that a bad code is reported as a
+// configuration problem.
+static const char *checkedTalkerCode(const char *talkerCode) {
+    if (strlen(talkerCode) != 2) {
+        logger() << logWarnSeaTalkNMEABridge << "Bad SeaTalk NMEA Bridge Talker Code '"
+                 << talkerCode << "'" << eol;
+        errorExit();
+    }
+
+    return talkerCode;
+}
+
 SeaTalkNMEABridge::SeaTalkNMEABridge(const char *name, const char *label, const char *talkerCode,
                                      NMEALineHandler &destination, StatsManager &statsManager,
                                      DataModel &dataModel)
@@ -50,68 +63,58 @@ SeaTalkNMEABridge::SeaTalkNMEABridge(const char *name, const char *label, const
       bridgeNode(name, &dataModel.sysNode()),
       labelLeaf("label", &bridgeNode, labelBuffer),
       bridgedMessagesLeaf("bridged", &bridgeNode),
-      bridgedMessageRateLeaf("bridgedRate", &bridgeNode) {
+      bridgedMessageRateLeaf("bridgedRate", &bridgeNode),
+      dbtTemplate(checkedTalkerCode(talkerCode), "DBT,%t,f,,M,,F"),
+      hdmTemplate(talkerCode, "HDM,%u,M"),
+      mwvTemplate(talkerCode, "MWV,%t,R,%t,N,%c"),
+      rsaTemplate(talkerCode, "RSA,%i,%c,%i,%c"),
+      vhwTemplate(talkerCode, "VHW,%u,%c,%u,%c,%t,%c,%t,%c") {
     statsManager.addStatsHolder(*this);
 
-    if (strlen(talkerCode) != 2) {
-        logger() << logWarnSeaTalkNMEABridge << "Bad SeaTalk NMEA Bridge Talker Code '"
-                 << talkerCode << "'" << eol;
-        errorExit();
-    }
-
     labelLeaf = label;
 }
 
 void SeaTalkNMEABridge::bridgeDBTMessage(const TenthsUInt16 &depthFeet) {
-    etl::string<10> depthFeetStr;
-    depthFeet.toString(depthFeetStr);
-
-    etl::string<maxNMEALineLength> message;
-    etl::string_stream messageStream(message);
-    messageStream << "$" << talkerCode << "DBT" << "," << depthFeetStr << ",f,,M,,F";
+    NMEASentenceWriter writer(dbtTemplate);
+    writer.writeTenths(depthFeet);
 
-    bridgeMessage(NMEAMsgType(NMEAMsgType::DBT), message);
+    bridgeMessage(NMEAMsgType(NMEAMsgType::DBT), writer.line());
 }
 
 void SeaTalkNMEABridge::bridgeHDMMessage(uint16_t heading) {
-    etl::string<maxNMEALineLength> message;
-    etl::string_stream messageStream(message);
-    messageStream << "$" << talkerCode << "HDM" << "," << etl::setprecision(1) << heading << ",M";
+    NMEASentenceWriter writer(hdmTemplate);
+    writer.writeUnsigned(heading);
 
-    bridgeMessage(NMEAMsgType(NMEAMsgType::HDM), message);
+    bridgeMessage(NMEAMsgType(NMEAMsgType::HDM), writer.line());
 }
 
 void SeaTalkNMEABridge::bridgeMWVMessage(const TenthsUInt16 &windAngle, bool windAngleValid,
                                          const TenthsUInt16 &windSpeedKN, bool windSpeedValid) {
-    etl::string<10> windAngleStr;
-    windAngle.toString(windAngleStr);
-    etl::string<10> windSpeedKNStr;
-    windSpeedKN.toString(windSpeedKNStr);
-
-    etl::string<maxNMEALineLength> message;
-    etl::string_stream messageStream(message);
-    messageStream << "$" << talkerCode << "MWV" << ",";
+    NMEASentenceWriter writer(mwvTemplate);
     if (windAngleValid) {
-        messageStream << windAngleStr;
+        writer.writeTenths(windAngle);
+    } else {
+        writer.writeEmpty();
     }
-    messageStream << ",R,";
     if (windSpeedValid) {
-        messageStream << windSpeedKNStr;
+        writer.writeTenths(windSpeedKN);
+    } else {
+        writer.writeEmpty();
     }
-    messageStream << ",N," << validityCode(windAngleValid | windSpeedValid);
+    writer.writeCharacter(validityCode(windAngleValid | windSpeedValid));
 
-    bridgeMessage(NMEAMsgType(NMEAMsgType::MWV), message);
+    bridgeMessage(NMEAMsgType(NMEAMsgType::MWV), writer.line());
 }
 
 void SeaTalkNMEABridge::bridgeRSAMessage(int8_t stbdRudderPos, bool stbdRudderPosValid,
                                          int8_t portRudderPos, bool portRudderPosValid) {
-    etl::string<maxNMEALineLength> message;
-    etl::string_stream messageStream(message);
-    messageStream << "$" << talkerCode << "RSA" << "," << etl::setprecision(1)
-                  << stbdRudderPos << "," << validityCode(stbdRudderPosValid) << ","
-                  << portRudderPos << "," << validityCode(portRudderPosValid);
+    NMEASentenceWriter writer(rsaTemplate);
+    writer.writeSigned(stbdRudderPos);
+    writer.writeCharacter(validityCode(stbdRudderPosValid));
+    writer.writeSigned(portRudderPos);
+    writer.writeCharacter(validityCode(portRudderPosValid));
 
-    bridgeMessage(NMEAMsgType(NMEAMsgType::RSA), message);
+    bridgeMessage(NMEAMsgType(NMEAMsgType::RSA), writer.line());
 }
 
 void SeaTalkNMEABridge::bridgeVHWMessage(uint16_t headingTrue, bool headingTrueValid,
@@ -119,40 +122,40 @@ void SeaTalkNMEABridge::bridgeVHWMessage(uint16_t headingTrue, bool headingTrueV
                                          const TenthsUInt16 &waterSpeedKN, bool waterSpeedKNValid,
                                          const TenthsUInt16 &waterSpeedKMPH,
                                          bool waterSpeedKMPHValid) {
-    etl::string<maxNMEALineLength> message;
-    etl::string_stream messageStream(message);
-    messageStream << "$" << talkerCode << "VHW" << ",";
+    NMEASentenceWriter writer(vhwTemplate);
     if (headingTrueValid) {
-        messageStream << etl::setprecision(1) << headingTrue << ",T,";
+        writer.writeUnsigned(headingTrue);
+        writer.writeCharacter('T');
     } else {
-        messageStream << ",,";
+        writer.writeEmpty();
+        writer.writeEmpty();
     }
     if (headingMagneticValid) {
-        messageStream << etl::setprecision(1) << headingMagnetic << ",M,";
+        writer.writeUnsigned(headingMagnetic);
+        writer.writeCharacter('M');
     } else {
-        messageStream << ",,";
+        writer.writeEmpty();
+        writer.writeEmpty();
     }
     if (waterSpeedKNValid) {
-        etl::string<10> waterSpeedKNStr;
-        waterSpeedKN.toString(waterSpeedKNStr);
-        messageStream << waterSpeedKNStr << ",N,";
+        writer.writeTenths(waterSpeedKN);
+        writer.writeCharacter('N');
     } else {
-        messageStream << ",,";
+        writer.writeEmpty();
+        writer.writeEmpty();
     }
     if (waterSpeedKMPHValid) {
-        etl::string<10> waterSpeedKMPHStr;
-        waterSpeedKMPH.toString(waterSpeedKMPHStr);
-        messageStream << waterSpeedKMPHStr << ",K";
+        writer.writeTenths(waterSpeedKMPH);
+        writer.writeCharacter('K');
     } else {
-        messageStream << ",";
+        writer.writeEmpty();
+        writer.writeEmpty();
     }
-    bridgeMessage(NMEAMsgType(NMEAMsgType::VHW), message);
-}
 
-void SeaTalkNMEABridge::bridgeMessage(const NMEAMsgType &msgType, const etl::istring &message) {
-    NMEALine nmeaLine(message);
-    nmeaLine.appendChecksum();
+    bridgeMessage(NMEAMsgType(NMEAMsgType::VHW), writer.line());
+}
 
+void SeaTalkNMEABridge::bridgeMessage(const NMEAMsgType &msgType, const NMEALine &nmeaLine) {
     logger() << logDebugSeaTalkNMEABridge << "Bridging from SeaTalk: " << nmeaLine << eol;
 
     NMEATalker talker(talkerCode);
@@ -160,11 +163,11 @@ void SeaTalkNMEABridge::bridgeMessage(const NMEAMsgType &msgType, const etl::ist
     bridgedMessages++;
 }
 
-const char *SeaTalkNMEABridge::validityCode(bool valid) {
+char SeaTalkNMEABridge::validityCode(bool valid) {
     if (valid) {
-        return "A";
+        return 'A';
     } else {
-        return "V";  // How V became meaning invalid I'll never know...
+        return 'V';  // How V became meaning invalid I'll never know...
     }
 }
 
@@ -19,6 +19,8 @@
 #ifndef SEA_TALK_NMEA_BRIDGE_H
 #define SEA_TALK_NMEA_BRIDGE_H
 
+#include "NMEASentenceTemplate.h"
+
 #include "StatsHolder.h"
 #include "StatCounter.h"
 
@@ -31,6 +33,7 @@
 #include <stdint.h>
 
 class NMEALineHandler;
+class NMEALine;
 class NMEAMsgType;
 class StatsManager;
 class DataModel;
@@ -48,10 +51,15 @@ class SeaTalkNMEABridge : StatsHolder {
         DataModelStringLeaf labelLeaf;
         DataModelUInt32Leaf bridgedMessagesLeaf;
         DataModelUInt32Leaf bridgedMessageRateLeaf;
+        NMEASentenceTemplate dbtTemplate;
+        NMEASentenceTemplate hdmTemplate;
+        NMEASentenceTemplate mwvTemplate;
+        NMEASentenceTemplate rsaTemplate;
+        NMEASentenceTemplate vhwTemplate;
 
-        void bridgeMessage(const NMEAMsgType &msgType, const etl::istring &message);
+        void bridgeMessage(const NMEAMsgType &msgType, const NMEALine &nmeaLine);
         virtual void exportStats(uint32_t msElapsed) override;
-        const char *validityCode(bool valid);
+        char validityCode(bool valid);
 
     public:
         SeaTalkNMEABridge(const char *name, const char *label, const char *talkerCode,
@@ -33,7 +33,7 @@ SeaTalkRMTUARTInterface::SeaTalkRMTUARTInterface(const char *name, const char *l
     : RMTUARTInterface(name, label, INTERFACE_SEA_TALK, RX_AND_TX, SEA_TALK_BAUD_RATE,
                        SEA_TALK_DATA_WIDTH, SEA_TALK_PARITY, SEA_TALK_STOP_BITS, rxGPIO, txGPIO,
                        rxBufferSize * 2, statsManager, dataModel, stackSize),
-      SeaTalkInterface(*this, instrumentData, statsManager) {
+      SeaTalkInterface(*this, instrumentData, statsManager, dataModel) {
 }
 
 void SeaTalkRMTUARTInterface::task() {
@@ -28,10 +28,16 @@
 
 #include "etl/algorithm.h"
 
+#include "DataModelNode.h"
+#include "DataModelUInt32Leaf.h"
+
 #include "driver/gpio.h"
 #include "driver/uart.h"
 #include "esp_err.h"
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
 #include <stddef.h>
 #include <string.h>
 
@@ -43,7 +49,15 @@ UARTInterface::UARTInterface(const char *name, const char *label, enum Interface
       _uartNumber(uartNumber),
       rxPin(rxPin),
       txPin(txPin),
-      baudRate(baudRate) {
+      baudRate(baudRate),
+      eventQueue(nullptr),
+      fifoOverflows(0),
+      bufferFulls(0),
+      receiveErrors(0),
+      uartNode("uart", &interfaceNode()),
+      fifoOverflowsLeaf("fifoOverflows", &uartNode),
+      bufferFullsLeaf("bufferFulls", &uartNode),
+      receiveErrorsLeaf("receiveErrors", &uartNode) {
     // On the ESP32-S3, and possibly other versions, the ring buffers used have to be sized in a
     // multiple of four bytes. Addjust the buffer sizes accordingly.
     this->rxBufferSize = (rxBufferSize + 3) & 0xfffffffc;
@@ -56,7 +70,8 @@ void UARTInterface::startUART() {
            << " tx buffer size " << txBufferSize << eol;
 
     esp_err_t error;
-    error = uart_driver_install(_uartNumber, rxBufferSize, txBufferSize, 0, nullptr, 0);
+    error = uart_driver_install(_uartNumber, rxBufferSize, txBufferSize, eventQueueSize,
+                                &eventQueue, 0);
     if (error != ESP_OK) {
         logger << logErrorUART << "Failed to install UART " << _uartNumber << "  driver: "
                
@@ -103,6 +118,13 @@ void UARTInterface::startUART() {
                << ESPError(error) << eol;
         errorExit();
     }
+
+    error = uart_set_rx_full_threshold(_uartNumber, rxFullThreshold);
+    if (error != ESP_OK) {
+        logger << logErrorUART << "Failed to set UART " << _uartNumber << " RX full threshold: "
+               << ESPError(error) << eol;
+        errorExit();
+    }
 }
 
 uart_port_t UARTInterface::uartNumber() const {
@@ -132,6 +154,68 @@ size_t UARTInterface::readToBuffer(void *buffer, size_t rxBufferSize) {
     }
 }
 
+// Blocks until there's received data, returning as much of it as fits in the buffer, or 0 if
+// maxWait passes without any event from the driver. The driver
+// posts a data event when the RX FIFO reaches its full threshold or when the line has been idle
+// for the RX timeout, so the end of a sentence wakes us within a couple of character times.
+// Anything already buffered is returned first, as a read that didn't take everything won't be
+// followed by another event until more characters arrive.
+size_t UARTInterface::receive(void *buffer, size_t rxBufferSize, TickType_t maxWait) {
+    while (true) {
+        size_t bytesRead = readToBuffer(buffer, rxBufferSize);
+        if (bytesRead) {
+            return bytesRead;
+        }
+
+        uart_event_t event;
+        if (xQueueReceive(eventQueue, &event, maxWait) != pdTRUE) {
+            return 0;
+        }
+
+        switch (event.type) {
+            case UART_DATA:
+                break;
+
+            case UART_FIFO_OVF:
+                fifoOverflows++;
+                logger << logWarnUART << "UART " << _uartNumber << " RX FIFO overflow" << eol;
+                discardInput();
+                break;
+
+            case UART_BUFFER_FULL:
+                bufferFulls++;
+                logger << logWarnUART << "UART " << _uartNumber << " RX buffer full" << eol;
+                discardInput();
+                break;
+
+            case UART_BREAK:
+            case UART_PARITY_ERR:
+            case UART_FRAME_ERR:
+                receiveErrors++;
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+// After an overflow the buffered data is missing characters and the queued events describe data
+// that is no longer there, so both are thrown away and the line source resyncs on the next
+// sentence start.
+void UARTInterface::discardInput() {
+    uart_flush_input(_uartNumber);
+    xQueueReset(eventQueue);
+}
+
+void UARTInterface::exportStats(uint32_t msElapsed) {
+    Interface::exportStats(msElapsed);
+
+    fifoOverflowsLeaf = fifoOverflows;
+    bufferFullsLeaf = bufferFulls;
+    receiveErrorsLeaf = receiveErrors;
+}
+
 size_t UARTInterface::sendBytes(const void *bytes, size_t length) {
     logger << logDebugUART << "Writing " << length << " bytes to UART " << _uartNumber << eol;
 
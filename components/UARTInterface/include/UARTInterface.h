@@ -21,10 +21,17 @@
 
 #include "Interface.h"
 
+#include "DataModelNode.h"
+#include "DataModelUInt32Leaf.h"
+
 #include "driver/gpio.h"
 #include "driver/uart.h"
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
 #include <stddef.h>
+#include <stdint.h>
 
 class StatsManager;
 class DataModelNode;
@@ -32,6 +39,10 @@ class DataModelNode;
 class UARTInterface : public Interface {
     private:
         static constexpr uint8_t rxTimeoutInChars = 2;
+        // Half of the hardware FIFO, leaving room for characters that arrive while the driver's
+        // interrupt handler is getting to it at higher baud rates.
+        static constexpr int rxFullThreshold = 64;
+        static constexpr int eventQueueSize = 20;
 
         uart_port_t _uartNumber;
         int rxPin;
@@ -39,6 +50,19 @@ class UARTInterface : public Interface {
         int baudRate;
         size_t rxBufferSize;
         size_t txBufferSize;
+        QueueHandle_t eventQueue;
+        uint32_t fifoOverflows;
+        uint32_t bufferFulls;
+        uint32_t receiveErrors;
+        DataModelNode uartNode;
+        DataModelUInt32Leaf fifoOverflowsLeaf;
+        DataModelUInt32Leaf bufferFullsLeaf;
+        DataModelUInt32Leaf receiveErrorsLeaf;
+
+        void discardInput();
+
+    protected:
+        virtual void exportStats(uint32_t msElapsed) override;
 
     public:
         UARTInterface(const char *name, const char *label, enum InterfaceProtocol protocol,
@@ -48,6 +72,7 @@ class UARTInterface : public Interface {
         void startUART();
         uart_port_t uartNumber() const;
         size_t readToBuffer(void *buffer, size_t rxBufferSize);
+        size_t receive(void *buffer, size_t rxBufferSize, TickType_t maxWait = portMAX_DELAY);
         virtual size_t sendBytes(const void *bytes, size_t length) override;
 };
 
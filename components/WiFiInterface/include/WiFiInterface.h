@@ -24,7 +24,7 @@
 #include "WiFiManagerClient.h"
 #include "DataModelBoolLeaf.h"
 
-#include <sys/socket.h>
+#include <lwip/sockets.h>
 #include <stddef.h>
 #include <stdint.h>
 
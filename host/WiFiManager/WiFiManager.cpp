@@ -0,0 +1,34 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WiFiManager.h"
+
+#include "Error.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+WiFiManager::WiFiManager() {
+    if ((eventGroup = xEventGroupCreate()) == nullptr) {
+        fatalError("Failed to create WiFi event group");
+    }
+}
+
+void WiFiManager::start() {
+    xEventGroupSetBits(eventGroup, WIFI_CONNECTED_EVENT);
+}
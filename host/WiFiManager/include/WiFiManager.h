@@ -0,0 +1,40 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WIFI_MANAGER_H
+#define WIFI_MANAGER_H
+
+// Host build replacement for the WiFiManager component. The host's network is assumed to be up,
+// so start() just reports the connection to the WiFiManagerClients.
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+#define WIFI_CONNECTED_EVENT            0b00000001
+#define WIFI_DISCONNECTED_EVENT         0b00000010
+#define WIFI_CONNECTION_FAILED_EVENT    0b00000100
+
+class WiFiManager {
+    public:
+        EventGroupHandle_t eventGroup;
+
+        WiFiManager();
+        void start();
+};
+
+#endif // WIFI_MANAGER_H
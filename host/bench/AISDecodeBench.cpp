@@ -0,0 +1,129 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Measures how many AIS sentences per second NMEAParser gets through: reassembling the
+// encapsulated fragments, de-armoring their six bit payloads and decoding the messages. The
+// sentences are framed once up front, so this doesn't include the line source's framing cost,
+// which nmea-framing-bench measures.
+//
+//   build-host/ais-decode-bench [seconds per run]
+
+#include "BenchTools.h"
+
+#include "NMEAParser.h"
+#include "NMEALineSource.h"
+#include "NMEALineHandler.h"
+#include "NMEALine.h"
+#include "NMEATalker.h"
+#include "NMEAMsgType.h"
+#include "NMEAMessage.h"
+
+#include "AISContacts.h"
+
+#include "StatsManager.h"
+#include "DataModel.h"
+#include "DataModelNode.h"
+#include "Logger.h"
+
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static constexpr unsigned defaultRunSeconds = 5;
+// 38400 baud, eight data bits with a start and a stop bit.
+static constexpr double streamBytesPerSecond = 38400 / 10.0;
+
+struct FramedSentence {
+    std::string line;
+    NMEATalker talker;
+    NMEAMsgType msgType;
+};
+
+// Frames the sample stream once, keeping copies of the lines and their tags.
+class SentenceCollector : public NMEALineSource, public NMEALineHandler {
+    public:
+        std::vector<FramedSentence> sentences;
+
+        SentenceCollector(DataModelNode &interfaceNode, StatsManager &statsManager)
+            : NMEALineSource(interfaceNode, "", statsManager) {
+            addLineHandler(*this);
+        }
+
+        virtual void handleLine(const NMEALine &inputLine, const NMEATalker &talker,
+                                const NMEAMsgType &msgType) override {
+            sentences.push_back({ std::string(inputLine.data(), inputLine.length()), talker,
+                                  msgType });
+        }
+
+        void feed(const std::string &stream) {
+            size_t pos = 0;
+            while (pos < stream.size()) {
+                size_t length;
+                char *buffer = receiveBuffer(length);
+                length = std::min(length, stream.size() - pos);
+                memcpy(buffer, stream.data() + pos, length);
+                processReceived(length);
+                pos += length;
+            }
+        }
+};
+
+int main(int argc, char **argv) {
+    const unsigned runSeconds = benchRunSeconds(argc, argv, defaultRunSeconds);
+
+    Logger logger(LOGGER_LEVEL_ERROR);
+    logger.initForTask();
+
+    StatsManager statsManager;
+    DataModel dataModel(statsManager);
+    DataModelNode interfaceNode("bench", &dataModel.rootNode());
+    SentenceCollector collector(interfaceNode, statsManager);
+    AISContacts aisContacts;
+    NMEAParser parser(aisContacts);
+
+    const std::string stream = loadBenchData("AISSample.nmea");
+    collector.feed(stream);
+    const std::vector<FramedSentence> &sentences = collector.sentences;
+
+    uint64_t messages = 0;
+    auto parseStream = [&]() {
+        for (const FramedSentence &sentence : sentences) {
+            const NMEALine line(sentence.line.data(), sentence.line.size());
+            if (parser.parseLine(line, sentence.talker, sentence.msgType) != nullptr) {
+                messages++;
+            }
+        }
+    };
+
+    parseStream();
+    const uint64_t messagesPerStream = messages;
+    printf("%zu sentences, %llu messages per pass of the stream\n", sentences.size(),
+           (unsigned long long)messagesPerStream);
+
+    const double passesPerSecond = benchRate(runSeconds, 1, parseStream);
+    const double sentencesPerSecond = passesPerSecond * sentences.size();
+    const double streamSentencesPerSecond = sentences.size() * streamBytesPerSecond / stream.size();
+    printf("%10.0f sentences/s %10.0f messages/s, %6.0f times a 38400 baud stream's %.0f/s\n",
+           sentencesPerSecond, passesPerSecond * messagesPerStream,
+           sentencesPerSecond / streamSentencesPerSecond, streamSentencesPerSecond);
+
+    return 0;
+}
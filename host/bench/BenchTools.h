@@ -0,0 +1,79 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_TOOLS_H
+#define BENCH_TOOLS_H
+
+// Helpers shared by the host benchmarks.
+
+#include <chrono>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Reads one of the inputs in bench/data, exiting if it can't.
+static inline std::string loadBenchData(const char *fileName) {
+    const std::string path = std::string(LUNAMON_BENCH_DATA_DIR) + "/" + fileName;
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        perror(path.c_str());
+        exit(1);
+    }
+
+    std::string contents;
+    char buffer[4096];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        contents.append(buffer, length);
+    }
+    fclose(file);
+
+    return contents;
+}
+
+// The optional [seconds per run] argument all of the benchmarks take.
+static inline unsigned benchRunSeconds(int argc, char **argv, unsigned defaultSeconds) {
+    const unsigned runSeconds = argc > 1 ? (unsigned)atoi(argv[1]) : defaultSeconds;
+    if (argc > 2 || runSeconds == 0) {
+        fprintf(stderr, "usage: %s [seconds per run]\n", argv[0]);
+        exit(1);
+    }
+
+    return runSeconds;
+}
+
+// Calls work() repeatedly for at least the given time, returning the calls made per second.
+// work() is called in batches so that reading the clock doesn't dominate short operations.
+template <typename Work>
+static inline double benchRate(double runSeconds, unsigned batch, Work work) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + std::chrono::duration<double>(runSeconds);
+    uint64_t calls = 0;
+    do {
+        for (unsigned call = 0; call < batch; call++) {
+            work();
+        }
+        calls += batch;
+    } while (std::chrono::steady_clock::now() < end);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return calls / elapsed.count();
+}
+
+#endif // BENCH_TOOLS_H
@@ -0,0 +1,119 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Reports the DRAM that data model leaves spend on their subscriptions, before and after they
+// moved from a fixed array inside every leaf to records taken from a shared pool. The sizes of
+// DataModelLeaf and of the pool are those of the classes as built, with the Kconfig defaults of
+// five MQTT clients and 320 pooled subscriptions for each. A leaf's subscription storage, the
+// head of its list and the lock guarding it, is what DataModelLeaf adds to DataModelElement. The
+// earlier layout no longer exists, so it is reconstructed from the current leaf by swapping the
+// list head for an etl::vector of five subscriber/cookie pairs.
+//
+// Host pointers and locks aren't those of the ESP32, where pointers are 4 bytes and a
+// portMUX_TYPE is 8, so the same comparison is also worked out from the ESP32 field sizes.
+//
+//   build-host/leaf-memory-bench
+
+#include "StatsManager.h"
+#include "DataModel.h"
+#include "DataModelElement.h"
+#include "DataModelLeaf.h"
+#include "DataModelNode.h"
+#include "DataModelUInt32Leaf.h"
+#include "Logger.h"
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdint.h>
+
+// The host data model, as reported under $SYS/dataModel/leaves, a firmware build with its extra
+// interfaces, and a large one.
+static constexpr unsigned leafCounts[] = { 166, 260, 500 };
+static constexpr unsigned measuredLeafCount = 500;
+static constexpr size_t previousMaxSubscribers = 5;
+
+// etl::vector's buffer pointer, size and capacity ahead of its fixed array.
+template <typename Pointer>
+struct PreviousSubscriptions {
+    struct Subscription {
+        Pointer subscriber;
+        uint32_t cookie;
+    };
+    Pointer buffer;
+    Pointer size;
+    Pointer capacity;
+    Subscription subscriptions[previousMaxSubscribers];
+};
+
+// The ESP32 field sizes of a leaf's list head and lock, and of a pooled record: next and
+// subscriber pointers and a cookie.
+static constexpr size_t esp32PointerSize = 4;
+static constexpr size_t esp32PortMuxSize = 8;
+static constexpr size_t esp32PooledSubscriptionSize = 2 * esp32PointerSize + sizeof(uint32_t);
+
+static void printTotals(const char *layout, size_t previousPerLeaf, size_t currentPerLeaf,
+                        size_t poolBytes) {
+    printf("%s: %zu bytes per leaf before, %zu after, plus a %zu byte pool\n", layout,
+           previousPerLeaf, currentPerLeaf, poolBytes);
+    for (unsigned leafCount : leafCounts) {
+        const size_t before = leafCount * previousPerLeaf;
+        const size_t after = leafCount * currentPerLeaf + poolBytes;
+        printf("  %3u leaves: %6zu bytes before, %6zu after, %6ld saved\n", leafCount, before,
+               after, (long)before - (long)after);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    Logger logger(LOGGER_LEVEL_ERROR);
+    logger.initForTask();
+
+    StatsManager statsManager;
+    DataModel dataModel(statsManager);
+    DataModelNode benchNode("bench", &dataModel.rootNode());
+
+    static char leafNames[measuredLeafCount][8];
+    const size_t heapBefore = mallinfo2().uordblks;
+    for (unsigned leaf = 0; leaf < measuredLeafCount; leaf++) {
+        snprintf(leafNames[leaf], sizeof(leafNames[leaf]), "leaf%u", leaf);
+        new DataModelUInt32Leaf(leafNames[leaf], &benchNode);
+    }
+    const size_t heapAfter = mallinfo2().uordblks;
+
+    const size_t subscriptionStorage = sizeof(DataModelLeaf) - sizeof(DataModelElement);
+    printf("sizeof DataModelElement %zu, DataModelLeaf %zu, DataModelUInt32Leaf %zu\n",
+           sizeof(DataModelElement), sizeof(DataModelLeaf), sizeof(DataModelUInt32Leaf));
+    printf("Heap per DataModelUInt32Leaf created: %zu bytes\n",
+           (heapAfter - heapBefore) / measuredLeafCount);
+    printf("Subscription storage per leaf: %zu bytes (list head %zu, lock %zu)\n",
+           subscriptionStorage, sizeof(void *), sizeof(portMUX_TYPE));
+    printf("Subscription pool: %zu records, %zu bytes\n", DataModelLeaf::subscriptionPoolSize(),
+           DataModelLeaf::subscriptionPoolBytes());
+
+    printTotals("Host", subscriptionStorage - sizeof(void *) +
+                            sizeof(PreviousSubscriptions<uintptr_t>),
+                subscriptionStorage, DataModelLeaf::subscriptionPoolBytes());
+    printTotals("ESP32", esp32PortMuxSize + sizeof(PreviousSubscriptions<uint32_t>),
+                esp32PortMuxSize + esp32PointerSize,
+                DataModelLeaf::subscriptionPoolSize() * esp32PooledSubscriptionSize);
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Measures what a data model leaf update costs the updating task with 0, 1 and 5 subscribers
+// that only count what they are sent. Leaves format their value only when there are
+// subscribers, once per update however many there are, so the 0 subscriber case should be close
+// to just storing the value. The "formatting always" row formats the value on every update as
+// well, which is what updates cost before.
+//
+//   build-host/leaf-update-bench [seconds per run]
+
+#include "BenchTools.h"
+
+#include "StatsManager.h"
+#include "DataModel.h"
+#include "DataModelNode.h"
+#include "DataModelSubscriber.h"
+#include "DataModelLeaf.h"
+#include "DataModelUInt32Leaf.h"
+#include "DataModelTenthsUInt16Leaf.h"
+#include "TenthsUInt16.h"
+#include "NumberFormat.h"
+#include "Logger.h"
+
+#include "etl/string.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+static constexpr unsigned defaultRunSeconds = 2;
+static constexpr unsigned subscriberCounts[] = { 0, 1, 5 };
+static constexpr unsigned maxBenchSubscribers = 5;
+static constexpr unsigned updateBatch = 1024;
+
+class CountingSubscriber : public DataModelSubscriber {
+    private:
+        etl::string<16> _name;
+
+    public:
+        uint64_t publishes;
+
+        CountingSubscriber() : _name("counter"), publishes(0) {
+        }
+
+        virtual void publish(DataModelLeaf &leaf, const char *value, bool retainedValue,
+                             uint32_t cookie) override {
+            publishes++;
+        }
+
+        virtual void publishTopic(const char *topic, const char *value, uint32_t cookie) override {
+        }
+
+        virtual const etl::istring &name() const override {
+            return _name;
+        }
+};
+
+// Keeps the "formatting always" conversions from being optimized away.
+static volatile size_t lengthSink;
+
+static void subscribeAll(DataModel &dataModel, CountingSubscriber *subscribers,
+                         unsigned subscriberCount) {
+    for (unsigned subscriber = 0; subscriber < maxBenchSubscribers; subscriber++) {
+        dataModel.unsubscribeAll(subscribers[subscriber]);
+    }
+    for (unsigned subscriber = 0; subscriber < subscriberCount; subscriber++) {
+        if (!dataModel.subscribe("bench/#", subscribers[subscriber], 0)) {
+            fprintf(stderr, "subscribe failed\n");
+            exit(1);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    const unsigned runSeconds = benchRunSeconds(argc, argv, defaultRunSeconds);
+
+    Logger logger(LOGGER_LEVEL_ERROR);
+    logger.initForTask();
+
+    StatsManager statsManager;
+    DataModel dataModel(statsManager);
+    DataModelNode benchNode("bench", &dataModel.rootNode());
+    DataModelUInt32Leaf uint32Leaf("uint32", &benchNode);
+    DataModelTenthsUInt16Leaf tenthsLeaf("tenths", &benchNode);
+    CountingSubscriber subscribers[maxBenchSubscribers];
+
+    // Leaves only publish when their value changes, so every update stores a new one.
+    uint32_t value = 0;
+    auto updateUInt32 = [&]() {
+        uint32Leaf = value++;
+    };
+    auto updateTenths = [&]() {
+        tenthsLeaf = TenthsUInt16((uint16_t)(value / 10), (uint8_t)(value % 10));
+        value++;
+    };
+
+    printf("%-17s %13s %13s\n", "updates/s", "uint32 leaf", "tenths leaf");
+    for (unsigned subscriberCount : subscriberCounts) {
+        subscribeAll(dataModel, subscribers, subscriberCount);
+        const double uint32Rate = benchRate(runSeconds, updateBatch, updateUInt32);
+        const double tenthsRate = benchRate(runSeconds, updateBatch, updateTenths);
+        char label[32];
+        snprintf(label, sizeof(label), "%u subscriber%s", subscriberCount,
+                 subscriberCount == 1 ? "" : "s");
+        printf("%-17s %13.0f %13.0f\n", label, uint32Rate, tenthsRate);
+    }
+
+    subscribeAll(dataModel, subscribers, 0);
+    const double uint32Rate = benchRate(runSeconds, updateBatch, [&]() {
+        char buffer[maxUInt32FormatLength];
+        lengthSink = formatUInt32(buffer, value);
+        updateUInt32();
+    });
+    const double tenthsRate = benchRate(runSeconds, updateBatch, [&]() {
+        etl::string<maxFixedPointFormatLength> valueStr;
+        TenthsUInt16((uint16_t)(value / 10), (uint8_t)(value % 10)).toString(valueStr);
+        lengthSink = valueStr.size();
+        updateTenths();
+    });
+    printf("%-17s %13.0f %13.0f\n", "formatting always", uint32Rate, tenthsRate);
+
+    return 0;
+}
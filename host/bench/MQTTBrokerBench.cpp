@@ -0,0 +1,273 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Measures the MQTT broker's memory per client slot and the PUBLISH messages per second it
+// delivers to 1, 5 and 20 clients subscribed to a set of data model leaves that are updated as
+// fast as one task can. The engine and number of client slots are those the host build was
+// configured with, for example:
+//
+//   cmake -S host -B build-host -DLUNAMON_HOST_MQTT_MAX_CLIENTS=20
+//         -DLUNAMON_HOST_MQTT_BROKER_ENGINE=1
+//   build-host/mqtt-broker-bench [seconds per run]
+//
+// Memory is the heap allocated by the broker's constructor, less the broker object itself, plus
+// the target sized stacks of the tasks it created. The heap figure comes from a 64 bit host and
+// is only indicative of the target's.
+
+#include "HostShim.h"
+
+#include "StatsManager.h"
+#include "DataModel.h"
+#include "DataModelNode.h"
+#include "DataModelUInt32Leaf.h"
+#include "WiFiManager.h"
+#include "MQTTBroker.h"
+#include "Logger.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <malloc.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+static constexpr uint16_t brokerPort = 1883;
+static constexpr unsigned benchLeafCount = 16;
+static constexpr unsigned clientCounts[] = { 1, 5, 20 };
+static constexpr unsigned defaultRunSeconds = 5;
+
+static bool sendAll(int clientSocket, const uint8_t *data, size_t length) {
+    while (length) {
+        const ssize_t sent = send(clientSocket, data, length, 0);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        length -= sent;
+    }
+
+    return true;
+}
+
+// Returns the length of the complete packet at the start of data, or 0 if there isn't one yet.
+static size_t packetLength(const uint8_t *data, size_t length) {
+    size_t remainingLength = 0;
+    uint32_t multiplier = 1;
+    for (size_t pos = 1; pos < length && pos <= 4; pos++) {
+        remainingLength += (data[pos] & 0x7f) * multiplier;
+        multiplier *= 128;
+        if ((data[pos] & 0x80) == 0) {
+            const size_t total = pos + 1 + remainingLength;
+            return total <= length ? total : 0;
+        }
+    }
+
+    return 0;
+}
+
+static int connectClient(unsigned clientNumber) {
+    int clientSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (clientSocket < 0) {
+        perror("socket");
+        exit(1);
+    }
+
+    struct sockaddr_in brokerAddr;
+    memset(&brokerAddr, 0, sizeof(brokerAddr));
+    brokerAddr.sin_family = AF_INET;
+    brokerAddr.sin_port = htons(brokerPort);
+    brokerAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    // The broker may still be coming up.
+    while (connect(clientSocket, (struct sockaddr *)&brokerAddr, sizeof(brokerAddr)) != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    char clientID[16];
+    const size_t clientIDLength = snprintf(clientID, sizeof(clientID), "bench%u", clientNumber);
+
+    // CONNECT, MQTT 3.1.1, clean session, no keep alive.
+    uint8_t connect[64] = { 0x10, 0, 0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, 0x02, 0x00, 0x00 };
+    size_t connectLength = 12;
+    connect[connectLength++] = 0;
+    connect[connectLength++] = clientIDLength;
+    memcpy(connect + connectLength, clientID, clientIDLength);
+    connectLength += clientIDLength;
+    connect[1] = connectLength - 2;
+
+    // SUBSCRIBE to everything the producer updates.
+    static const char topicFilter[] = "bench/#";
+    uint8_t subscribe[32] = { 0x82, 0, 0x00, 0x01, 0x00, sizeof(topicFilter) - 1 };
+    size_t subscribeLength = 6;
+    memcpy(subscribe + subscribeLength, topicFilter, sizeof(topicFilter) - 1);
+    subscribeLength += sizeof(topicFilter) - 1;
+    subscribe[subscribeLength++] = 0;
+    subscribe[1] = subscribeLength - 2;
+
+    if (!sendAll(clientSocket, connect, connectLength) ||
+        !sendAll(clientSocket, subscribe, subscribeLength)) {
+        fprintf(stderr, "Client %u failed to connect to the broker\n", clientNumber);
+        exit(1);
+    }
+
+    return clientSocket;
+}
+
+// Counts the PUBLISH packets received until told to stop.
+static void runClient(int clientSocket, std::atomic<bool> &running,
+                      std::atomic<uint64_t> &publishesReceived) {
+    struct timeval timeout = { 0, 100 * 1000 };
+    setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    static constexpr size_t bufferSize = 64 * 1024;
+    std::vector<uint8_t> buffer(bufferSize);
+    size_t buffered = 0;
+    uint64_t publishes = 0;
+
+    while (running) {
+        const ssize_t received = recv(clientSocket, buffer.data() + buffered,
+                                      bufferSize - buffered, 0);
+        if (received <= 0) {
+            continue;
+        }
+        buffered += received;
+
+        size_t pos = 0;
+        size_t length;
+        while ((length = packetLength(buffer.data() + pos, buffered - pos)) != 0) {
+            if ((buffer[pos] >> 4) == 3) {
+                publishes++;
+            }
+            pos += length;
+        }
+        buffered -= pos;
+        memmove(buffer.data(), buffer.data() + pos, buffered);
+    }
+
+    static const uint8_t disconnect[] = { 0xe0, 0x00 };
+    sendAll(clientSocket, disconnect, sizeof(disconnect));
+    close(clientSocket);
+
+    publishesReceived += publishes;
+}
+
+static void runBench(unsigned clientCount, unsigned runSeconds,
+                     DataModelUInt32Leaf **leaves) {
+    std::atomic<bool> running(true);
+    std::atomic<uint64_t> publishesReceived(0);
+    std::vector<std::thread> clients;
+
+    for (unsigned clientNumber = 0; clientNumber < clientCount; clientNumber++) {
+        int clientSocket = connectClient(clientNumber);
+        clients.emplace_back(runClient, clientSocket, std::ref(running),
+                             std::ref(publishesReceived));
+    }
+
+    // Let the subscriptions settle before counting.
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    publishesReceived = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + std::chrono::seconds(runSeconds);
+    uint64_t updates = 0;
+    uint32_t value = 0;
+    while (std::chrono::steady_clock::now() < end) {
+        for (unsigned leaf = 0; leaf < benchLeafCount; leaf++) {
+            *leaves[leaf] = value;
+        }
+        value++;
+        updates += benchLeafCount;
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    running = false;
+    for (std::thread &client : clients) {
+        client.join();
+    }
+
+    printf("%3u clients: %10.0f updates/s %10.0f messages/s delivered\n", clientCount,
+           updates / elapsed.count(), publishesReceived / elapsed.count());
+
+    // Give the broker time to return the sessions to its free list.
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+}
+
+int main(int argc, char **argv) {
+    const unsigned runSeconds = argc > 1 ? (unsigned)atoi(argv[1]) : defaultRunSeconds;
+    if (argc > 2 || runSeconds == 0) {
+        fprintf(stderr, "usage: %s [seconds per run]\n", argv[0]);
+        return 1;
+    }
+
+    Logger logger(LOGGER_LEVEL_ERROR);
+    logger.initForTask();
+
+    StatsManager statsManager;
+    DataModel dataModel(statsManager);
+    WiFiManager wifiManager;
+
+    DataModelNode benchNode("bench", &dataModel.rootNode());
+    char leafNames[benchLeafCount][8];
+    DataModelUInt32Leaf *leaves[benchLeafCount];
+    for (unsigned leaf = 0; leaf < benchLeafCount; leaf++) {
+        snprintf(leafNames[leaf], sizeof(leafNames[leaf]), "leaf%u", leaf);
+        leaves[leaf] = new DataModelUInt32Leaf(leafNames[leaf], &benchNode);
+    }
+
+    const size_t heapBefore = mallinfo2().uordblks;
+    const uint32_t stacksBefore = HostShim::createdTaskStackBytes();
+    MQTTBroker *broker = new MQTTBroker(wifiManager, dataModel, statsManager);
+    const size_t heapAfter = mallinfo2().uordblks;
+    const uint32_t stacksAfter = HostShim::createdTaskStackBytes();
+
+    const size_t heapPerClient = (heapAfter - heapBefore - sizeof(MQTTBroker)) / maxMQTTConnections;
+    const size_t stackPerClient = (stacksAfter - stacksBefore) / maxMQTTConnections;
+    printf("%s engine, %u client slots\n",
+           mqttBrokerEngine == MQTT_BROKER_EVENT_LOOP ? "Event loop" : "Threaded",
+           (unsigned)maxMQTTConnections);
+    printf("Memory per client slot: %zu bytes heap + %zu bytes task stacks = %zu bytes\n",
+           heapPerClient, stackPerClient, heapPerClient + stackPerClient);
+
+    statsManager.start();
+    dataModel.start();
+    wifiManager.start();
+    broker->start();
+
+    for (unsigned clientCount : clientCounts) {
+        if (clientCount > maxMQTTConnections) {
+            printf("%3u clients: skipped, the broker has %u client slots\n", clientCount,
+                   (unsigned)maxMQTTConnections);
+            continue;
+        }
+        runBench(clientCount, runSeconds, leaves);
+    }
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Measures how fast NMEALineSource frames lines, the bytes per second it gets through feeding a
+// 38400 baud AIS receiver stream to it in UART sized reads. The lines are handed to a
+// line handler that only counts them, so this is the cost of framing, checksumming and tag
+// parsing alone.
+//
+//   build-host/nmea-framing-bench [seconds per run]
+//
+// bench/data/AISSample.nmea is a synthesized capture of a few seconds of a busy receiver's output:
+// class A and B position reports, base station reports and two fragment static and voyage data
+// messages, on both AIS channels, with valid payloads and checksums.
+
+#include "BenchTools.h"
+
+#include "NMEALineSource.h"
+#include "NMEALineHandler.h"
+#include "NMEALine.h"
+#include "NMEATalker.h"
+#include "NMEAMsgType.h"
+
+#include "StatsManager.h"
+#include "DataModel.h"
+#include "DataModelNode.h"
+#include "Logger.h"
+
+#include <string>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static constexpr unsigned defaultRunSeconds = 5;
+static constexpr size_t readSizes[] = { 16, 120, 512 };
+// 38400 baud, eight data bits with a start and a stop bit.
+static constexpr double streamBytesPerSecond = 38400 / 10.0;
+
+class BenchLineSource : public NMEALineSource, public NMEALineHandler {
+    public:
+        uint64_t lines;
+
+        BenchLineSource(DataModelNode &interfaceNode, StatsManager &statsManager)
+            : NMEALineSource(interfaceNode, "", statsManager), lines(0) {
+            addLineHandler(*this);
+        }
+
+        virtual void handleLine(const NMEALine &inputLine, const NMEATalker &talker,
+                                const NMEAMsgType &msgType) override {
+            lines++;
+        }
+
+        // Feeds the whole stream through, readSize bytes at a time.
+        void feed(const std::string &stream, size_t readSize) {
+            size_t pos = 0;
+            while (pos < stream.size()) {
+                size_t length;
+                char *buffer = receiveBuffer(length);
+                length = std::min(length, std::min(readSize, stream.size() - pos));
+                memcpy(buffer, stream.data() + pos, length);
+                processReceived(length);
+                pos += length;
+            }
+        }
+};
+
+int main(int argc, char **argv) {
+    const unsigned runSeconds = benchRunSeconds(argc, argv, defaultRunSeconds);
+
+    Logger logger(LOGGER_LEVEL_ERROR);
+    logger.initForTask();
+
+    StatsManager statsManager;
+    DataModel dataModel(statsManager);
+    DataModelNode interfaceNode("bench", &dataModel.rootNode());
+    BenchLineSource lineSource(interfaceNode, statsManager);
+
+    const std::string stream = loadBenchData("AISSample.nmea");
+    lineSource.feed(stream, readSizes[0]);
+    const uint64_t linesPerStream = lineSource.lines;
+    printf("%zu bytes, %llu lines per pass of the stream\n", stream.size(),
+           (unsigned long long)linesPerStream);
+
+    for (size_t readSize : readSizes) {
+        const double passesPerSecond = benchRate(runSeconds, 1, [&]() {
+            lineSource.feed(stream, readSize);
+        });
+        const double bytesPerSecond = passesPerSecond * stream.size();
+        printf("%4zu byte reads: %8.1f MB/s %10.0f lines/s, %6.0f times a 38400 baud stream\n",
+               readSize, bytesPerSecond / 1e6, passesPerSecond * linesPerStream,
+               bytesPerSecond / streamBytesPerSecond);
+    }
+
+    return 0;
+}
@@ -0,0 +1,189 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compares eager and lazy decoding of one sentence of each of the 17 unencapsulated NMEA 0183
+// message types the parser supports, in nanoseconds per sentence. Eager is NMEAParser decoding
+// every field into a message, as the data model bridge gets them. Lazy is an NMEALazyMessage
+// splitting the line into fields and decoding the one field a handler interested in just that
+// would read, and then the same lazy message asked for the whole decoded message.
+//
+//   build-host/nmea-parse-bench [seconds per run]
+
+#include "BenchTools.h"
+
+#include "NMEAParser.h"
+#include "NMEALazyMessage.h"
+#include "NMEAMessage.h"
+#include "NMEALine.h"
+#include "NMEATalker.h"
+#include "NMEAMsgType.h"
+#include "NMEAUInt8.h"
+#include "NMEATenthsInt16.h"
+#include "NMEATenthsUInt16.h"
+#include "NMEAHundredthsUInt8.h"
+#include "NMEALatitude.h"
+
+#include "AISContacts.h"
+
+#include "Logger.h"
+
+#include "etl/string_view.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+static constexpr unsigned defaultRunSeconds = 1;
+static constexpr unsigned parseBatch = 1024;
+
+struct BenchSentence {
+    // Without the checksum, which is added.
+    const char *sentence;
+    // Decodes the field a handler wanting only one would read.
+    bool (*decodeOneField)(NMEALazyMessage &message);
+};
+
+static const BenchSentence benchSentences[] = {
+    { "$SDDBK,12.3,f,3.7,M,2.0,F", [](NMEALazyMessage &message) {
+        NMEATenthsInt16 depthMeters;
+        return message.decodeField(2, depthMeters, "DBK", "Depth Meters", true);
+    } },
+    { "$SDDBS,12.3,f,3.7,M,2.0,F", [](NMEALazyMessage &message) {
+        NMEATenthsUInt16 depthMeters;
+        return message.decodeField(2, depthMeters, "DBS", "Depth Meters", true);
+    } },
+    { "$SDDBT,12.3,f,3.7,M,2.0,F", [](NMEALazyMessage &message) {
+        NMEATenthsUInt16 depthMeters;
+        return message.decodeField(2, depthMeters, "DBT", "Depth Meters", true);
+    } },
+    { "$SDDPT,3.7,0.5,100", [](NMEALazyMessage &message) {
+        NMEATenthsUInt16 depth;
+        return message.decodeField(0, depth, "DPT", "Depth");
+    } },
+    { "$GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,",
+      [](NMEALazyMessage &message) {
+        NMEALatitude latitude;
+        return message.decodeField(1, latitude, "GGA", true);
+    } },
+    { "$GPGLL,4916.45,N,12311.12,W,225444,A,A", [](NMEALazyMessage &message) {
+        NMEALatitude latitude;
+        return message.decodeField(0, latitude, "GLL", true);
+    } },
+    { "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1", [](NMEALazyMessage &message) {
+        NMEAHundredthsUInt8 hdop;
+        return message.decodeField(15, hdop, "GSA", "HDOP");
+    } },
+    { "$GPGST,172814.0,0.6,2.3,2.0,273.6,2.3,2.0,3.1", [](NMEALazyMessage &message) {
+        NMEATenthsUInt16 rms;
+        return message.decodeField(1, rms, "GST", "Standard Deviation of Range Inputs RMS");
+    } },
+    { "$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00",
+      [](NMEALazyMessage &message) {
+        NMEAUInt8 numberSatellites;
+        return message.decodeField(2, numberSatellites, "GSV", "Number Satellites");
+    } },
+    { "$HCHDG,101.1,2.0,E,7.1,W", [](NMEALazyMessage &message) {
+        NMEATenthsUInt16 heading;
+        return message.decodeField(0, heading, "HDG", "Magnetic Sensor Heading");
+    } },
+    { "$YXMTW,17.5,C", [](NMEALazyMessage &message) {
+        NMEATenthsInt16 waterTemperature;
+        return message.decodeField(0, waterTemperature, "MTW", "Water Temperature");
+    } },
+    { "$WIMWV,214.8,R,10.1,N,A", [](NMEALazyMessage &message) {
+        NMEATenthsUInt16 windSpeed;
+        return message.decodeField(2, windSpeed, "MWV", "Wind Speed");
+    } },
+    { "$GPRMC,123519.00,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W,A",
+      [](NMEALazyMessage &message) {
+        NMEALatitude latitude;
+        return message.decodeField(2, latitude, "RMC", true);
+    } },
+    { "$AGRSA,10.5,A,,V", [](NMEALazyMessage &message) {
+        NMEATenthsInt16 rudderAngle;
+        return message.decodeField(0, rudderAngle, "RSA", "Starboard Rudder Sensor Angle");
+    } },
+    { "$GPTXT,01,01,02,ANTENNA OK", [](NMEALazyMessage &message) {
+        etl::string_view text;
+        return message.getField(3, text);
+    } },
+    { "$VWVHW,245.1,T,245.1,M,5.5,N,10.2,K", [](NMEALazyMessage &message) {
+        NMEATenthsInt16 waterSpeedKnots;
+        return message.decodeField(4, waterSpeedKnots, "VHW", "Water Speed Knots");
+    } },
+    { "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A", [](NMEALazyMessage &message) {
+        NMEATenthsUInt16 speedOverGround;
+        return message.decodeField(4, speedOverGround, "VTG", "Speed Over Ground");
+    } }
+};
+
+static double nanosecondsPer(double callsPerSecond) {
+    return 1e9 / callsPerSecond;
+}
+
+int main(int argc, char **argv) {
+    const unsigned runSeconds = benchRunSeconds(argc, argv, defaultRunSeconds);
+
+    Logger logger(LOGGER_LEVEL_ERROR);
+    logger.initForTask();
+
+    AISContacts aisContacts;
+    NMEAParser parser(aisContacts);
+
+    printf("%-11s %7s %17s %21s\n", "ns/sentence", "eager", "lazy, one field",
+           "lazy, whole message");
+    double eagerTotal = 0;
+    double oneFieldTotal = 0;
+    double wholeMessageTotal = 0;
+    for (const BenchSentence &benchSentence : benchSentences) {
+        NMEALine line;
+        line.append(benchSentence.sentence);
+        line.appendChecksum();
+        const char *sentence = benchSentence.sentence;
+        const NMEATalker talker(sentence[1], sentence[2]);
+        const NMEAMsgType msgType(sentence[3], sentence[4], sentence[5]);
+
+        NMEALazyMessage checkMessage(parser, line, talker, msgType);
+        if (!benchSentence.decodeOneField(checkMessage) || checkMessage.message() == nullptr) {
+            fprintf(stderr, "Bench sentence '%s' didn't decode\n", sentence);
+            return 1;
+        }
+
+        const double eager = nanosecondsPer(benchRate(runSeconds, parseBatch, [&]() {
+            parser.parseLine(line, talker, msgType);
+        }));
+        const double oneField = nanosecondsPer(benchRate(runSeconds, parseBatch, [&]() {
+            NMEALazyMessage message(parser, line, talker, msgType);
+            benchSentence.decodeOneField(message);
+        }));
+        const double wholeMessage = nanosecondsPer(benchRate(runSeconds, parseBatch, [&]() {
+            NMEALazyMessage message(parser, line, talker, msgType);
+            message.message();
+        }));
+        printf("%-11s %7.1f %17.1f %21.1f\n", msgType.name(), eager, oneField, wholeMessage);
+
+        eagerTotal += eager;
+        oneFieldTotal += oneField;
+        wholeMessageTotal += wholeMessage;
+    }
+    const size_t sentenceCount = sizeof(benchSentences) / sizeof(benchSentences[0]);
+    printf("%-11s %7.1f %17.1f %21.1f\n", "mean", eagerTotal / sentenceCount,
+           oneFieldTotal / sentenceCount, wholeMessageTotal / sentenceCount);
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compares NumberFormat with the etl and snprintf conversions it replaced, in conversions per
+// second, for the number forms used on the data model and NMEA output paths: decimal integers,
+// fixed point with two decimals and the hex checksum byte. Each conversion appends to an
+// etl::string, as the callers do.
+//
+//   build-host/number-format-bench [seconds per run]
+
+#include "BenchTools.h"
+
+#include "NumberFormat.h"
+
+#include "etl/string.h"
+#include "etl/string_stream.h"
+#include "etl/to_string.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+static constexpr unsigned defaultRunSeconds = 2;
+static constexpr size_t valueCount = 1024;
+
+static uint32_t unsignedValues[valueCount];
+static int32_t signedValues[valueCount];
+static uint32_t hundredths[valueCount];
+
+// Keeps the conversions from being optimized away.
+static volatile size_t lengthSink;
+
+static void makeValues() {
+    // A fixed LCG so that every run converts the same values. The shifts spread the values over
+    // all digit counts instead of mostly ten digit ones.
+    uint32_t state = 12345;
+    for (size_t pos = 0; pos < valueCount; pos++) {
+        state = state * 1664525 + 1013904223;
+        unsignedValues[pos] = state >> (state % 29);
+        signedValues[pos] = (int32_t)(state >> (state % 29 + 1)) * (pos % 2 ? -1 : 1);
+        hundredths[pos] = state % 100;
+    }
+}
+
+template <typename Convert>
+static void runCase(const char *name, unsigned runSeconds, Convert convert) {
+    etl::string<32> string;
+    const double passesPerSecond = benchRate(runSeconds, 1, [&]() {
+        size_t length = 0;
+        for (size_t pos = 0; pos < valueCount; pos++) {
+            string.clear();
+            convert(pos, string);
+            length += string.size();
+        }
+        lengthSink = length;
+    });
+    printf("  %-24s %12.0f conversions/s\n", name, passesPerSecond * valueCount);
+}
+
+int main(int argc, char **argv) {
+    const unsigned runSeconds = benchRunSeconds(argc, argv, defaultRunSeconds);
+    makeValues();
+
+    printf("uint32_t:\n");
+    runCase("formatUInt32", runSeconds, [](size_t pos, etl::istring &string) {
+        char buffer[maxUInt32FormatLength];
+        string.append(buffer, formatUInt32(buffer, unsignedValues[pos]));
+    });
+    runCase("etl::to_string", runSeconds, [](size_t pos, etl::istring &string) {
+        etl::to_string(unsignedValues[pos], string);
+    });
+    runCase("snprintf", runSeconds, [](size_t pos, etl::istring &string) {
+        char buffer[maxUInt32FormatLength + 1];
+        string.append(buffer, snprintf(buffer, sizeof(buffer), "%lu",
+                                       (unsigned long)unsignedValues[pos]));
+    });
+
+    printf("int32_t:\n");
+    runCase("formatInt32", runSeconds, [](size_t pos, etl::istring &string) {
+        char buffer[maxInt32FormatLength];
+        string.append(buffer, formatInt32(buffer, signedValues[pos]));
+    });
+    runCase("etl::to_string", runSeconds, [](size_t pos, etl::istring &string) {
+        etl::to_string(signedValues[pos], string);
+    });
+    runCase("snprintf", runSeconds, [](size_t pos, etl::istring &string) {
+        char buffer[maxInt32FormatLength + 1];
+        string.append(buffer, snprintf(buffer, sizeof(buffer), "%ld",
+                                       (long)signedValues[pos]));
+    });
+
+    printf("fixed point, two decimals:\n");
+    runCase("formatFixedPoint", runSeconds, [](size_t pos, etl::istring &string) {
+        char buffer[maxFixedPointFormatLength];
+        string.append(buffer, formatFixedPoint(buffer, unsignedValues[pos] >> 16,
+                                               hundredths[pos], 2));
+    });
+    runCase("etl::string_stream", runSeconds, [](size_t pos, etl::istring &string) {
+        etl::string_stream stringStream(string);
+        stringStream << (unsignedValues[pos] >> 16) << "." << etl::setfill('0') << etl::setw(2)
+                     << hundredths[pos];
+    });
+    runCase("snprintf", runSeconds, [](size_t pos, etl::istring &string) {
+        char buffer[maxFixedPointFormatLength + 1];
+        string.append(buffer, snprintf(buffer, sizeof(buffer), "%lu.%02lu",
+                                       (unsigned long)(unsignedValues[pos] >> 16),
+                                       (unsigned long)hundredths[pos]));
+    });
+
+    printf("hex checksum byte:\n");
+    runCase("formatHexByte", runSeconds, [](size_t pos, etl::istring &string) {
+        char buffer[hexByteFormatLength];
+        string.append(buffer, formatHexByte(buffer, (uint8_t)unsignedValues[pos]));
+    });
+    runCase("etl::to_string", runSeconds, [](size_t pos, etl::istring &string) {
+        etl::format_spec checksumFormat;
+        checksumFormat.hex().upper_case(true).width(2).fill('0');
+        etl::to_string((uint8_t)unsignedValues[pos], string, checksumFormat);
+    });
+    runCase("snprintf", runSeconds, [](size_t pos, etl::istring &string) {
+        char buffer[hexByteFormatLength + 1];
+        string.append(buffer, snprintf(buffer, sizeof(buffer), "%02X",
+                                       (unsigned)(uint8_t)unsignedValues[pos]));
+    });
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Measures how long subscribing takes against a data model of 500 leaves, 50 nodes of 10 leaves
+// each, for 100 literal topic filters, 50 filters ending in a '+' level, a filter with a '+'
+// level in the middle and a '#' filter. Subscribing resolves a filter's leading literal levels
+// through the subscription index's element table, a lookup per level, and then has the tree
+// enumerate the children beneath any wildcard level, so a '+' level's cost depends on the
+// elements beneath it and '#' visits every leaf. Each subscription is removed again after it is
+// made, so the times include the unsubscribe.
+//
+//   build-host/subscribe-bench [seconds per run]
+
+#include "BenchTools.h"
+
+#include "StatsManager.h"
+#include "DataModel.h"
+#include "DataModelNode.h"
+#include "DataModelSubscriber.h"
+#include "DataModelLeaf.h"
+#include "DataModelUInt32Leaf.h"
+#include "Logger.h"
+
+#include "etl/string.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdint.h>
+
+static constexpr unsigned defaultRunSeconds = 2;
+static constexpr unsigned nodeCount = 50;
+static constexpr unsigned leavesPerNode = 10;
+static constexpr unsigned literalFilterCount = 100;
+// Filters are subscribed and unsubscribed a batch at a time, so that the subscription index fits
+// in its default size.
+static constexpr size_t filterBatchSize = 50;
+
+class CountingSubscriber : public DataModelSubscriber {
+    private:
+        etl::string<16> _name;
+
+    public:
+        uint64_t publishes;
+
+        CountingSubscriber() : _name("counter"), publishes(0) {
+        }
+
+        virtual void publish(DataModelLeaf &leaf, const char *value, bool retainedValue,
+                             uint32_t cookie) override {
+            publishes++;
+        }
+
+        virtual void publishTopic(const char *topic, const char *value, uint32_t cookie) override {
+        }
+
+        virtual const etl::istring &name() const override {
+            return _name;
+        }
+};
+
+static void runCase(const char *name, unsigned runSeconds, DataModel &dataModel,
+                    CountingSubscriber &subscriber, const std::vector<std::string> &filters) {
+    const double roundsPerSecond = benchRate(runSeconds, 1, [&]() {
+        for (size_t batchStart = 0; batchStart < filters.size(); batchStart += filterBatchSize) {
+            const size_t batchEnd = std::min(batchStart + filterBatchSize, filters.size());
+            for (size_t filter = batchStart; filter < batchEnd; filter++) {
+                if (!dataModel.subscribe(filters[filter].c_str(), subscriber, 0)) {
+                    fprintf(stderr, "subscribe to '%s' failed\n", filters[filter].c_str());
+                    exit(1);
+                }
+            }
+            for (size_t filter = batchStart; filter < batchEnd; filter++) {
+                dataModel.unsubscribe(filters[filter].c_str(), subscriber);
+            }
+        }
+    });
+    printf("%-20s %3zu filter%s %8.2f us per filter\n", name, filters.size(),
+           filters.size() == 1 ? " " : "s", 1e6 / (roundsPerSecond * filters.size()));
+}
+
+int main(int argc, char **argv) {
+    const unsigned runSeconds = benchRunSeconds(argc, argv, defaultRunSeconds);
+
+    Logger logger(LOGGER_LEVEL_ERROR);
+    logger.initForTask();
+
+    StatsManager statsManager;
+    DataModel dataModel(statsManager);
+    DataModelNode benchNode("bench", &dataModel.rootNode());
+
+    // Element names aren't copied, so they have to outlive the elements.
+    static char nodeNames[nodeCount][8];
+    static char leafNames[leavesPerNode][8];
+    for (unsigned leaf = 0; leaf < leavesPerNode; leaf++) {
+        snprintf(leafNames[leaf], sizeof(leafNames[leaf]), "leaf%u", leaf);
+    }
+    for (unsigned node = 0; node < nodeCount; node++) {
+        snprintf(nodeNames[node], sizeof(nodeNames[node]), "node%02u", node);
+        DataModelNode *dataModelNode = new DataModelNode(nodeNames[node], &benchNode);
+        for (unsigned leaf = 0; leaf < leavesPerNode; leaf++) {
+            new DataModelUInt32Leaf(leafNames[leaf], dataModelNode);
+        }
+    }
+
+    CountingSubscriber subscriber;
+    std::vector<std::string> filters;
+
+    // Every fifth leaf, spread across all of the nodes.
+    for (unsigned filter = 0; filter < literalFilterCount; filter++) {
+        const unsigned leafNumber = filter * 5;
+        filters.push_back(std::string("bench/") + nodeNames[leafNumber / leavesPerNode] + "/" +
+                          leafNames[leafNumber % leavesPerNode]);
+    }
+    runCase("bench/nodeNN/leafN", runSeconds, dataModel, subscriber, filters);
+
+    filters.clear();
+    for (unsigned node = 0; node < nodeCount; node++) {
+        filters.push_back(std::string("bench/") + nodeNames[node] + "/+");
+    }
+    runCase("bench/nodeNN/+", runSeconds, dataModel, subscriber, filters);
+
+    runCase("bench/+/leaf3", runSeconds, dataModel, subscriber, { "bench/+/leaf3" });
+    runCase("#", runSeconds, dataModel, subscriber, { "#" });
+
+    return 0;
+}
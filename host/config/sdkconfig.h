@@ -0,0 +1,107 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+// Host build stand in for the sdkconfig.h that ESP-IDF generates from menuconfig. Values are the
+// Kconfig defaults (main/Config) plus sdkconfig.defaults, and need to follow them when options
+// are added or their defaults change. Only options referenced by the host build appear here.
+
+#define CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES 2
+#define CONFIG_ESP_MAIN_TASK_STACK_SIZE 32768
+
+// The broker's client count and engine can be overridden from the host CMake configuration, so
+// that the broker benchmark can be built for each.
+#ifndef CONFIG_LUNAMON_MAX_MQTT_CLIENTS
+#define CONFIG_LUNAMON_MAX_MQTT_CLIENTS 5
+#endif
+#ifndef CONFIG_LUNAMON_MQTT_BROKER_ENGINE
+#define CONFIG_LUNAMON_MQTT_BROKER_THREADED 1
+#define CONFIG_LUNAMON_MQTT_BROKER_ENGINE 0
+#endif
+#define CONFIG_LUNAMON_MQTT_TCP_KEEPALIVE_IDLE 5
+#define CONFIG_LUNAMON_MQTT_TCP_KEEPALIVE_INTERVAL 5
+#define CONFIG_LUNAMON_MQTT_TCP_KEEPALIVE_COUNT 3
+#define CONFIG_LUNAMON_MQTT_RECEIVE_BUFFER_SIZE 8192
+#define CONFIG_LUNAMON_MQTT_RECEIVE_RING_SIZE 2048
+#define CONFIG_LUNAMON_MQTT_OUTGOING_BUFFER_SIZE 2048
+#define CONFIG_LUNAMON_MQTT_FLUSH_THRESHOLD 1024
+#define CONFIG_LUNAMON_MQTT_FLUSH_DELAY_MS 20
+#define CONFIG_LUNAMON_MQTT_PUBLISH_QUEUE_DEPTH_16 1
+#define CONFIG_LUNAMON_MQTT_PUBLISH_QUEUE_DEPTH 16
+#define CONFIG_LUNAMON_MQTT_PUBLISH_QUEUE_DROP_OLDEST 1
+#define CONFIG_LUNAMON_MQTT_PUBLISH_QUEUE_OVERFLOW_POLICY 0
+#define CONFIG_LUNAMON_MQTT_PUBLISH_QUEUE_BLOCK_TIMEOUT_MS 100
+#define CONFIG_LUNAMON_MQTT_RELAY_QUEUE_DEPTH 4
+#define CONFIG_LUNAMON_MQTT_QOS1_WINDOW 8
+#define CONFIG_LUNAMON_MQTT_QOS1_RETRANSMIT_MS 10000
+#define CONFIG_LUNAMON_DATA_MODEL_TOPIC_ARENA_SIZE 8192
+#define CONFIG_LUNAMON_DATA_MODEL_FILTER_INDEX_FILTERS 64
+#define CONFIG_LUNAMON_DATA_MODEL_FILTER_INDEX_NODES 128
+#define CONFIG_LUNAMON_DATA_MODEL_FILTER_INDEX_LEVEL_LENGTH 31
+#define CONFIG_LUNAMON_DATA_MODEL_SUBSCRIPTIONS_PER_CLIENT 320
+// The broker benchmark subscribes every client to the same leaves.
+#define CONFIG_LUNAMON_DATA_MODEL_MAX_LEAF_SUBSCRIBERS 32
+
+#define CONFIG_LUNAMON_NMEA_SERVER_MAX_CLIENTS 5
+#define CONFIG_LUNAMON_NMEA_SERVER_TCP_KEEPALIVE_IDLE 5
+#define CONFIG_LUNAMON_NMEA_SERVER_TCP_KEEPALIVE_INTERVAL 5
+#define CONFIG_LUNAMON_NMEA_SERVER_TCP_KEEPALIVE_COUNT 3
+#define CONFIG_LUNAMON_NMEA_SERVER_CLIENT_BUFFER_SIZE 4096
+#define CONFIG_LUNAMON_NMEA_SERVER_SLOW_CLIENT_POLICY 0
+#define CONFIG_LUNAMON_NMEA_SERVER_SLOW_CLIENT_DISCONNECT_SECONDS 10
+
+#define CONFIG_LUNAMON_NMEA_RECEIVE_RING_SIZE 2048
+#define CONFIG_LUNAMON_NMEA_DUPLICATE_WINDOW_MS 1000
+#define CONFIG_LUNAMON_SEA_TALK_WRITE_TEST_ENABLED 0
+
+#define CONFIG_LUNAMON_DEBUG_MEMORY_USAGE_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_MAIN_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_DATA_MODEL_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_MQTT_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_NMEA_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_DATA_MODEL_BRIDGE_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_NMEA_WIFI_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_NMEA_UART_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_NMEA_SOFT_UART_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_NMEA_RMT_UART_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_STALK_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_STALK_UART_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_STALK_RMT_UART_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_SEA_TALK_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_SEA_TALK_RMT_UART_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_NMEA_SERVER_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_NMEA_BRIDGE_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_NMEA_LINE_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_SEA_TALK_NMEA_BRIDGE_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_UART_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_SOFT_UART_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_AIS_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_RMT_UART_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_WIFI_INTERFACE_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_WIFI_MANAGER_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_STATS_MANAGER_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_ENVIRONMENTAL_MON_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_TASK_OBJECT_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_BUZZER_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_I2C_MASTER_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_BME280_DRIVER_ENABLED 0
+#define CONFIG_LUNAMON_DEBUG_MODULE_ENS160_DRIVER_ENABLED 0
+
+#endif // SDKCONFIG_H
@@ -0,0 +1,89 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LunaMonHost.h"
+
+#include "StatsManager.h"
+#include "DataModel.h"
+#include "AISContacts.h"
+#include "WiFiManager.h"
+#include "MQTTBroker.h"
+#include "InstrumentData.h"
+#include "DataModelBridge.h"
+#include "NMEAWiFiInterface.h"
+#include "NMEAServer.h"
+#include "LogManager.h"
+#include "Logger.h"
+#include "Error.h"
+
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <stdint.h>
+
+LunaMonHost::LunaMonHost(const char *nmeaSourceAddr, uint16_t nmeaSourcePort,
+                         uint16_t nmeaServerPort)
+    : dataModel(statsManager),
+      mqttBroker(wifiManager, dataModel, statsManager),
+      instrumentData(dataModel, statsManager),
+      dataModelBridge(instrumentData),
+      logManager(dataModel),
+      logger(LOGGER_LEVEL_DEBUG),
+      nmeaServer(nullptr),
+      uptimeLeaf("uptime", &dataModel.brokerNode()) {
+    logger.initForTask();
+
+    if (nmeaServerPort) {
+        nmeaServer = new NMEAServer(nmeaServerPort, wifiManager, statsManager, dataModel);
+        if (nmeaServer == nullptr) {
+            fatalError("Failed to allocate NMEA 0183 Server");
+        }
+    }
+
+    nmeaInterface = new NMEAWiFiInterface("host", "Host NMEA Source", nmeaSourceAddr,
+                                          nmeaSourcePort, "", wifiManager, statsManager,
+                                          aisContacts, dataModel);
+    if (nmeaInterface == nullptr) {
+        fatalError("Failed to allocate host NMEA interface");
+    }
+    nmeaInterface->addMessageHandler(dataModelBridge);
+    if (nmeaServer) {
+        nmeaInterface->addLineHandler(*nmeaServer);
+    }
+}
+
+void LunaMonHost::run() {
+    statsManager.start();
+    dataModel.start();
+    aisContacts.start();
+    wifiManager.start();
+    mqttBroker.start();
+
+    if (nmeaServer) {
+        nmeaServer->start();
+    }
+
+    nmeaInterface->start();
+
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(10000));
+        uptimeLeaf = (uint32_t)(esp_timer_get_time() / 1000000);
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LUNA_MON_HOST_H
+#define LUNA_MON_HOST_H
+
+#include "StatsManager.h"
+#include "DataModel.h"
+#include "DataModelUInt32Leaf.h"
+#include "AISContacts.h"
+#include "WiFiManager.h"
+#include "MQTTBroker.h"
+#include "InstrumentData.h"
+#include "DataModelBridge.h"
+#include "LogManager.h"
+#include "Logger.h"
+
+#include <stdint.h>
+
+class NMEAWiFiInterface;
+class NMEAServer;
+
+// The hardware independent part of LunaMon, run as a Linux process. NMEA 0183 comes in over TCP
+// the same way as the WiFi source does on the target and is published through the MQTT broker
+// and, optionally, an NMEA server.
+class LunaMonHost {
+    private:
+        StatsManager statsManager;
+        DataModel dataModel;
+        AISContacts aisContacts;
+        WiFiManager wifiManager;
+        MQTTBroker mqttBroker;
+        InstrumentData instrumentData;
+        DataModelBridge dataModelBridge;
+        LogManager logManager;
+        Logger logger;
+        NMEAServer *nmeaServer;
+        NMEAWiFiInterface *nmeaInterface;
+        DataModelUInt32Leaf uptimeLeaf;
+
+    public:
+        LunaMonHost(const char *nmeaSourceAddr, uint16_t nmeaSourcePort, uint16_t nmeaServerPort);
+        void run();
+};
+
+#endif // LUNA_MON_HOST_H
@@ -0,0 +1,58 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LunaMonHost.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+static constexpr const char *defaultNMEASourceAddr = "127.0.0.1";
+static constexpr uint16_t defaultNMEASourcePort = 10110;
+
+static void usage(const char *programName) {
+    fprintf(stderr, "usage: %s [NMEA source IPv4 address [NMEA source port [NMEA server port]]]\n",
+            programName);
+    exit(1);
+}
+
+static uint16_t parsePort(const char *programName, const char *portStr) {
+    char *end;
+    unsigned long port = strtoul(portStr, &end, 10);
+    if (*portStr == 0 || *end != 0 || port > UINT16_MAX) {
+        usage(programName);
+    }
+
+    return (uint16_t)port;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 4) {
+        usage(argv[0]);
+    }
+
+    const char *nmeaSourceAddr = argc > 1 ? argv[1] : defaultNMEASourceAddr;
+    uint16_t nmeaSourcePort = argc > 2 ? parsePort(argv[0], argv[2]) : defaultNMEASourcePort;
+    uint16_t nmeaServerPort = argc > 3 ? parsePort(argv[0], argv[3]) : 0;
+
+    LunaMonHost lunaMonHost(nmeaSourceAddr, nmeaSourcePort, nmeaServerPort);
+
+    lunaMonHost.run();
+
+    return 0;
+}
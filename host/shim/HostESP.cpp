@@ -0,0 +1,76 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HostShim.h"
+
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_err.h"
+
+#include <chrono>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+int64_t HostShim::microseconds() {
+    static const std::chrono::steady_clock::time_point startTime =
+        std::chrono::steady_clock::now();
+
+    const std::chrono::steady_clock::duration elapsed =
+        std::chrono::steady_clock::now() - startTime;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+int64_t esp_timer_get_time(void) {
+    return HostShim::microseconds();
+}
+
+uint32_t esp_log_timestamp(void) {
+    return (uint32_t)(HostShim::microseconds() / 1000);
+}
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK:
+            return "ESP_OK";
+        case ESP_FAIL:
+            return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:
+            return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:
+            return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:
+            return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:
+            return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:
+            return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED:
+            return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:
+            return "ESP_ERR_TIMEOUT";
+        default:
+            return "UNKNOWN ERROR";
+    }
+}
+
+const char *esp_err_to_name_r(esp_err_t code, char *buf, size_t buflen) {
+    snprintf(buf, buflen, "%s (0x%x)", esp_err_to_name(code), (unsigned)code);
+    return buf;
+}
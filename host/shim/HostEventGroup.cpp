@@ -0,0 +1,87 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HostShim.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+#include <condition_variable>
+#include <mutex>
+
+struct EventGroupDef_t {
+    std::mutex mutex;
+    std::condition_variable changed;
+    EventBits_t bits;
+
+    EventGroupDef_t() : bits(0) {
+    }
+};
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    return new EventGroupDef_t;
+}
+
+void vEventGroupDelete(EventGroupHandle_t eventGroup) {
+    delete eventGroup;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t eventGroup, EventBits_t bitsToSet) {
+    std::unique_lock<std::mutex> lock(eventGroup->mutex);
+
+    eventGroup->bits |= bitsToSet;
+    eventGroup->changed.notify_all();
+
+    return eventGroup->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t eventGroup, EventBits_t bitsToClear) {
+    std::unique_lock<std::mutex> lock(eventGroup->mutex);
+
+    const EventBits_t oldBits = eventGroup->bits;
+    eventGroup->bits &= ~bitsToClear;
+
+    return oldBits;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t eventGroup) {
+    std::unique_lock<std::mutex> lock(eventGroup->mutex);
+
+    return eventGroup->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t eventGroup, EventBits_t bitsToWaitFor,
+                                BaseType_t clearOnExit, BaseType_t waitForAllBits,
+                                TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock(eventGroup->mutex);
+
+    auto satisfied = [eventGroup, bitsToWaitFor, waitForAllBits] {
+        const EventBits_t setBits = eventGroup->bits & bitsToWaitFor;
+        return waitForAllBits ? setBits == bitsToWaitFor : setBits != 0;
+    };
+
+    const bool waitSatisfied =
+        HostShim::waitTicks(lock, eventGroup->changed, ticksToWait, satisfied);
+
+    const EventBits_t bits = eventGroup->bits;
+    if (waitSatisfied && clearOnExit) {
+        eventGroup->bits &= ~bitsToWaitFor;
+    }
+
+    return bits;
+}
@@ -0,0 +1,126 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HostShim.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/message_buffer.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+struct StreamBufferDef_t {
+    static constexpr size_t lengthBytes = sizeof(size_t);
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    const size_t capacity;
+    size_t used;
+    std::deque<std::vector<uint8_t>> messages;
+
+    StreamBufferDef_t(size_t capacity) : capacity(capacity), used(0) {
+    }
+
+    size_t spaceAvailable() const {
+        return capacity - used;
+    }
+};
+
+MessageBufferHandle_t xMessageBufferCreate(size_t bufferSizeBytes) {
+    return new StreamBufferDef_t(bufferSizeBytes);
+}
+
+void vMessageBufferDelete(MessageBufferHandle_t messageBuffer) {
+    delete messageBuffer;
+}
+
+size_t xMessageBufferSend(MessageBufferHandle_t messageBuffer, const void *data,
+                          size_t dataLengthBytes, TickType_t ticksToWait) {
+    const size_t bytesNeeded = dataLengthBytes + StreamBufferDef_t::lengthBytes;
+    if (bytesNeeded > messageBuffer->capacity) {
+        return 0;
+    }
+
+    std::unique_lock<std::mutex> lock(messageBuffer->mutex);
+
+    if (!HostShim::waitTicks(lock, messageBuffer->changed, ticksToWait,
+                             [messageBuffer, bytesNeeded] {
+                                 return messageBuffer->spaceAvailable() >= bytesNeeded;
+                             })) {
+        return 0;
+    }
+
+    const uint8_t *bytes = (const uint8_t *)data;
+    messageBuffer->messages.emplace_back(bytes, bytes + dataLengthBytes);
+    messageBuffer->used += bytesNeeded;
+    messageBuffer->changed.notify_all();
+
+    return dataLengthBytes;
+}
+
+// As with FreeRTOS, a message too large for the receiver's buffer is left in the message buffer.
+size_t xMessageBufferReceive(MessageBufferHandle_t messageBuffer, void *rxData,
+                             size_t bufferLengthBytes, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock(messageBuffer->mutex);
+
+    if (!HostShim::waitTicks(lock, messageBuffer->changed, ticksToWait,
+                             [messageBuffer] { return !messageBuffer->messages.empty(); })) {
+        return 0;
+    }
+
+    const std::vector<uint8_t> &message = messageBuffer->messages.front();
+    const size_t messageLength = message.size();
+    if (messageLength > bufferLengthBytes) {
+        return 0;
+    }
+
+    memcpy(rxData, message.data(), messageLength);
+    messageBuffer->messages.pop_front();
+    messageBuffer->used -= messageLength + StreamBufferDef_t::lengthBytes;
+    messageBuffer->changed.notify_all();
+
+    return messageLength;
+}
+
+BaseType_t xMessageBufferReset(MessageBufferHandle_t messageBuffer) {
+    std::unique_lock<std::mutex> lock(messageBuffer->mutex);
+
+    messageBuffer->messages.clear();
+    messageBuffer->used = 0;
+    messageBuffer->changed.notify_all();
+
+    return pdPASS;
+}
+
+size_t xMessageBufferSpacesAvailable(MessageBufferHandle_t messageBuffer) {
+    std::unique_lock<std::mutex> lock(messageBuffer->mutex);
+
+    return messageBuffer->spaceAvailable();
+}
+
+BaseType_t xMessageBufferIsEmpty(MessageBufferHandle_t messageBuffer) {
+    std::unique_lock<std::mutex> lock(messageBuffer->mutex);
+
+    return messageBuffer->messages.empty() ? pdTRUE : pdFALSE;
+}
@@ -0,0 +1,57 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_SHIM_H
+#define HOST_SHIM_H
+
+// Internals shared between the host FreeRTOS and ESP-IDF stand ins.
+
+#include "freertos/FreeRTOS.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include <stdint.h>
+
+namespace HostShim {
+
+// Microseconds since the process started.
+int64_t microseconds();
+
+// The total stack asked for by every xTaskCreate so far, which is what the tasks would take on
+// the target.
+uint32_t createdTaskStackBytes();
+
+// Wait on a condition variable for up to a FreeRTOS tick count, with portMAX_DELAY meaning
+// forever. Returns the final value of the predicate.
+template <typename Predicate>
+bool waitTicks(std::unique_lock<std::mutex> &lock, std::condition_variable &condition,
+               TickType_t ticksToWait, Predicate predicate) {
+    if (ticksToWait == portMAX_DELAY) {
+        condition.wait(lock, predicate);
+        return true;
+    }
+
+    const std::chrono::milliseconds timeout((uint64_t)ticksToWait * portTICK_PERIOD_MS);
+    return condition.wait_for(lock, timeout, predicate);
+}
+
+} // namespace HostShim
+
+#endif // HOST_SHIM_H
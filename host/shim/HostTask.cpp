@@ -0,0 +1,258 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HostShim.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+#include <pthread.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+struct tskTaskControlBlock {
+    TaskFunction_t taskCode;
+    void *parameters;
+    std::string name;
+    uint32_t stackDepth;
+    UBaseType_t priority;
+    pthread_t thread;
+
+    std::mutex notifyMutex;
+    std::condition_variable notifyCondition;
+    uint32_t notifyValues[configTASK_NOTIFICATION_ARRAY_ENTRIES];
+    bool notifyPending[configTASK_NOTIFICATION_ARRAY_ENTRIES];
+
+    tskTaskControlBlock(TaskFunction_t taskCode, void *parameters, const char *name,
+                        uint32_t stackDepth, UBaseType_t priority)
+        : taskCode(taskCode),
+          parameters(parameters),
+          name(name),
+          stackDepth(stackDepth),
+          priority(priority),
+          thread(pthread_self()),
+          notifyValues(),
+          notifyPending() {
+    }
+};
+
+// Task control blocks are never freed. A handle may be held by other tasks after its task has
+// deleted itself and FreeRTOS applications don't create tasks dynamically enough for it to matter.
+static thread_local TaskHandle_t currentTask = nullptr;
+
+static std::atomic<uint32_t> createdStackBytes(0);
+
+uint32_t HostShim::createdTaskStackBytes() {
+    return createdStackBytes;
+}
+
+static TaskHandle_t taskOrCurrent(TaskHandle_t task) {
+    return task ? task : xTaskGetCurrentTaskHandle();
+}
+
+static void checkNotifyIndex(UBaseType_t index) {
+    if (index >= configTASK_NOTIFICATION_ARRAY_ENTRIES) {
+        fprintf(stderr, "Task notification index %u out of range\n", index);
+        abort();
+    }
+}
+
+static void *taskThread(void *taskPtr) {
+    TaskHandle_t task = (TaskHandle_t)taskPtr;
+
+    currentTask = task;
+    task->taskCode(task->parameters);
+
+    return nullptr;
+}
+
+// ESP-IDF sized stacks are far too small for 64 bit host code, so the stack depth is not used
+// to size the thread and threads get the default pthread stack.
+BaseType_t xTaskCreate(TaskFunction_t taskCode, const char *name, uint32_t stackDepth,
+                       void *parameters, UBaseType_t priority, TaskHandle_t *createdTask) {
+    TaskHandle_t task = new tskTaskControlBlock(taskCode, parameters, name, stackDepth, priority);
+
+    // Set before the thread starts, the task is allowed to look at its own handle right away.
+    if (createdTask) {
+        *createdTask = task;
+    }
+
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+    int result = pthread_create(&task->thread, &attributes, taskThread, task);
+    pthread_attr_destroy(&attributes);
+
+    if (result != 0) {
+        if (createdTask) {
+            *createdTask = nullptr;
+        }
+        delete task;
+        return pdFAIL;
+    }
+
+    createdStackBytes += stackDepth;
+
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task != nullptr && task != currentTask) {
+        fprintf(stderr, "Deleting another task (%s) is not supported on host\n",
+                task->name.c_str());
+        abort();
+    }
+
+    pthread_exit(nullptr);
+}
+
+void vTaskDelay(TickType_t ticksToDelay) {
+    const uint64_t delayMs = (uint64_t)ticksToDelay * portTICK_PERIOD_MS;
+    struct timespec delay;
+    delay.tv_sec = delayMs / 1000;
+    delay.tv_nsec = (delayMs % 1000) * 1000000;
+
+    while (nanosleep(&delay, &delay) != 0) {
+    }
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(HostShim::microseconds() / (1000 * portTICK_PERIOD_MS));
+}
+
+// Threads not started through xTaskCreate, such as the one running main(), are adopted as tasks
+// the first time they need a handle.
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    if (currentTask == nullptr) {
+        currentTask = new tskTaskControlBlock(nullptr, nullptr, "main", 0, tskIDLE_PRIORITY + 1);
+    }
+
+    return currentTask;
+}
+
+const char *pcTaskGetName(TaskHandle_t task) {
+    return taskOrCurrent(task)->name.c_str();
+}
+
+uint32_t uxTaskGetStackHighWaterMark2(TaskHandle_t task) {
+    return taskOrCurrent(task)->stackDepth;
+}
+
+BaseType_t xTaskGenericNotify(TaskHandle_t task, UBaseType_t indexToNotify, uint32_t value,
+                              eNotifyAction action, uint32_t *previousNotificationValue) {
+    checkNotifyIndex(indexToNotify);
+
+    std::unique_lock<std::mutex> lock(task->notifyMutex);
+
+    uint32_t &notifyValue = task->notifyValues[indexToNotify];
+    if (previousNotificationValue) {
+        *previousNotificationValue = notifyValue;
+    }
+
+    switch (action) {
+        case eNoAction:
+            break;
+        case eSetBits:
+            notifyValue |= value;
+            break;
+        case eIncrement:
+            notifyValue++;
+            break;
+        case eSetValueWithOverwrite:
+            notifyValue = value;
+            break;
+        case eSetValueWithoutOverwrite:
+            if (task->notifyPending[indexToNotify]) {
+                return pdFAIL;
+            }
+            notifyValue = value;
+            break;
+    }
+
+    task->notifyPending[indexToNotify] = true;
+    task->notifyCondition.notify_all();
+
+    return pdPASS;
+}
+
+BaseType_t xTaskGenericNotifyWait(UBaseType_t indexToWaitOn, uint32_t bitsToClearOnEntry,
+                                  uint32_t bitsToClearOnExit, uint32_t *notificationValue,
+                                  TickType_t ticksToWait) {
+    checkNotifyIndex(indexToWaitOn);
+
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->notifyMutex);
+
+    uint32_t &notifyValue = task->notifyValues[indexToWaitOn];
+    bool &notifyPending = task->notifyPending[indexToWaitOn];
+    if (!notifyPending) {
+        notifyValue &= ~bitsToClearOnEntry;
+    }
+
+    bool notified = HostShim::waitTicks(lock, task->notifyCondition, ticksToWait,
+                                        [&notifyPending] { return notifyPending; });
+
+    if (notificationValue) {
+        *notificationValue = notifyValue;
+    }
+    if (!notified) {
+        return pdFALSE;
+    }
+
+    notifyValue &= ~bitsToClearOnExit;
+    notifyPending = false;
+
+    return pdTRUE;
+}
+
+uint32_t ulTaskGenericNotifyValueClear(TaskHandle_t task, UBaseType_t indexToClear,
+                                       uint32_t bitsToClear) {
+    checkNotifyIndex(indexToClear);
+
+    task = taskOrCurrent(task);
+    std::unique_lock<std::mutex> lock(task->notifyMutex);
+
+    uint32_t &notifyValue = task->notifyValues[indexToClear];
+    const uint32_t oldNotifyValue = notifyValue;
+    notifyValue &= ~bitsToClear;
+
+    return oldNotifyValue;
+}
+
+void portMUX_INITIALIZE(portMUX_TYPE *mux) {
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mux->mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+}
+
+void vPortEnterCritical(portMUX_TYPE *mux) {
+    pthread_mutex_lock(&mux->mutex);
+}
+
+void vPortExitCritical(portMUX_TYPE *mux) {
+    pthread_mutex_unlock(&mux->mutex);
+}
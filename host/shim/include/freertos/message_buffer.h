@@ -0,0 +1,48 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_FREERTOS_MESSAGE_BUFFER_H
+#define HOST_FREERTOS_MESSAGE_BUFFER_H
+
+#include "freertos/FreeRTOS.h"
+
+#include <stddef.h>
+
+typedef struct StreamBufferDef_t *MessageBufferHandle_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// As with FreeRTOS, each message costs its length plus a size_t length word of the buffer's
+// capacity.
+MessageBufferHandle_t xMessageBufferCreate(size_t bufferSizeBytes);
+void vMessageBufferDelete(MessageBufferHandle_t messageBuffer);
+size_t xMessageBufferSend(MessageBufferHandle_t messageBuffer, const void *data,
+                          size_t dataLengthBytes, TickType_t ticksToWait);
+size_t xMessageBufferReceive(MessageBufferHandle_t messageBuffer, void *rxData,
+                             size_t bufferLengthBytes, TickType_t ticksToWait);
+BaseType_t xMessageBufferReset(MessageBufferHandle_t messageBuffer);
+size_t xMessageBufferSpacesAvailable(MessageBufferHandle_t messageBuffer);
+BaseType_t xMessageBufferIsEmpty(MessageBufferHandle_t messageBuffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_FREERTOS_MESSAGE_BUFFER_H
@@ -0,0 +1,88 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+#include <stdint.h>
+
+typedef struct tskTaskControlBlock *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum {
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite
+} eNotifyAction;
+
+#define tskIDLE_PRIORITY        ((UBaseType_t)0U)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Priorities are recorded but not applied, host threads all run at the default policy. The
+// stack depth is in bytes, as it is with ESP-IDF, and is used as the pthread's stack size.
+BaseType_t xTaskCreate(TaskFunction_t taskCode, const char *name, uint32_t stackDepth,
+                       void *parameters, UBaseType_t priority, TaskHandle_t *createdTask);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticksToDelay);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+const char *pcTaskGetName(TaskHandle_t task);
+// There is no high water mark to be had from a pthread, so this reports the full stack as free.
+uint32_t uxTaskGetStackHighWaterMark2(TaskHandle_t task);
+
+BaseType_t xTaskGenericNotify(TaskHandle_t task, UBaseType_t indexToNotify, uint32_t value,
+                              eNotifyAction action, uint32_t *previousNotificationValue);
+BaseType_t xTaskGenericNotifyWait(UBaseType_t indexToWaitOn, uint32_t bitsToClearOnEntry,
+                                  uint32_t bitsToClearOnExit, uint32_t *notificationValue,
+                                  TickType_t ticksToWait);
+uint32_t ulTaskGenericNotifyValueClear(TaskHandle_t task, UBaseType_t indexToClear,
+                                       uint32_t bitsToClear);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define taskYIELD()                     sched_yield()
+
+#define xTaskNotifyIndexed(task, index, value, action) \
+    xTaskGenericNotify((task), (index), (value), (action), NULL)
+#define xTaskNotify(task, value, action) \
+    xTaskGenericNotify((task), 0, (value), (action), NULL)
+#define xTaskNotifyGiveIndexed(task, index) \
+    xTaskGenericNotify((task), (index), 0, eIncrement, NULL)
+#define xTaskNotifyGive(task) \
+    xTaskGenericNotify((task), 0, 0, eIncrement, NULL)
+#define xTaskNotifyWaitIndexed(index, clearOnEntry, clearOnExit, value, ticks) \
+    xTaskGenericNotifyWait((index), (clearOnEntry), (clearOnExit), (value), (ticks))
+#define xTaskNotifyWait(clearOnEntry, clearOnExit, value, ticks) \
+    xTaskGenericNotifyWait(0, (clearOnEntry), (clearOnExit), (value), (ticks))
+#define ulTaskNotifyValueClearIndexed(task, index, bitsToClear) \
+    ulTaskGenericNotifyValueClear((task), (index), (bitsToClear))
+#define ulTaskNotifyValueClear(task, bitsToClear) \
+    ulTaskGenericNotifyValueClear((task), 0, (bitsToClear))
+
+#include <sched.h>
+
+#endif // HOST_FREERTOS_TASK_H
@@ -0,0 +1,41 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_LWIP_SOCKETS_H
+#define HOST_LWIP_SOCKETS_H
+
+// The BSD socket API that lwIP mirrors, plus the lwIP only reentrant inet_ntoa and ioctl name.
+
+#include <sys/types.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+
+static inline char *inet_ntoa_r(in_addr_t addr, char *buf, int buflen) {
+    struct in_addr inAddr;
+    inAddr.s_addr = addr;
+    return (char *)inet_ntop(AF_INET, &inAddr, buf, (socklen_t)buflen);
+}
+
+#define lwip_ioctl ioctl
+
+#endif // HOST_LWIP_SOCKETS_H
@@ -0,0 +1,162 @@
+/*
+ * This file is part of LunaMon (https://github.com/LisaRowell/LunaMonESP)
+ * Copyright (C) 2024 Lisa Rowell
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the packets built by MQTTPacketBuilder byte for byte against the encodings given in the
+// MQTT 3.1.1 specification, including remaining lengths that take more than one byte. Run from
+// ctest, exiting non-zero if any packet differs.
+
+#include "MQTTPacketBuilder.h"
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static unsigned failures = 0;
+
+static void expectPacket(const char *name, const MQTTPacketBuilder &builder,
+                         const std::vector<uint8_t> &expected) {
+    if (builder.size() == expected.size() &&
+        memcmp(builder.data(), expected.data(), expected.size()) == 0) {
+        printf("PASS %s\n", name);
+        return;
+    }
+
+    failures++;
+    printf("FAIL %s\n  expected (%zu):", name, expected.size());
+    for (size_t pos = 0; pos < expected.size() && pos < 32; pos++) {
+        printf(" %02x", expected[pos]);
+    }
+    printf("\n  built    (%zu):", builder.size());
+    for (size_t pos = 0; pos < builder.size() && pos < 32; pos++) {
+        printf(" %02x", builder.data()[pos]);
+    }
+    printf("\n");
+}
+
+static void expectTrue(const char *name, bool condition) {
+    if (condition) {
+        printf("PASS %s\n", name);
+    } else {
+        failures++;
+        printf("FAIL %s\n", name);
+    }
+}
+
+// A PUBLISH with a one character topic and a value of the given length, which has a remaining
+// length of the value length plus three.
+static std::vector<uint8_t> publishWithValueLength(size_t valueLength,
+                                                   std::initializer_list<uint8_t> lengthBytes,
+                                                   std::vector<char> &value) {
+    value.assign(valueLength, 'v');
+    value.push_back(0);
+
+    std::vector<uint8_t> packet = { 0x30 };
+    packet.insert(packet.end(), lengthBytes);
+    packet.insert(packet.end(), { 0x00, 0x01, 't' });
+    packet.insert(packet.end(), valueLength, 'v');
+
+    return packet;
+}
+
+static void testRemainingLength(const char *name, size_t valueLength,
+                                std::initializer_list<uint8_t> lengthBytes) {
+    static uint8_t buffer[20000];
+    MQTTPacketBuilder builder(buffer, sizeof(buffer));
+    std::vector<char> value;
+    const std::vector<uint8_t> expected = publishWithValueLength(valueLength, lengthBytes, value);
+
+    if (!builder.buildPublish("t", value.data(), false, 0, false, 0)) {
+        expectTrue(name, false);
+        return;
+    }
+    expectPacket(name, builder, expected);
+}
+
+int main() {
+    uint8_t buffer[256];
+    MQTTPacketBuilder builder(buffer, sizeof(buffer));
+
+    // 3.2 CONNACK: fixed header, remaining length 2, acknowledge flags, return code.
+    builder.buildConnectAck(true, 0);
+    expectPacket("CONNACK session present, accepted", builder, { 0x20, 0x02, 0x01, 0x00 });
+    builder.reset();
+    builder.buildConnectAck(false, 5);
+    expectPacket("CONNACK not authorized", builder, { 0x20, 0x02, 0x00, 0x05 });
+    builder.reset();
+
+    // 3.3 PUBLISH: QoS 0 carries no packet identifier.
+    builder.buildPublish("a/b", "12", false, 0, false, 0);
+    expectPacket("PUBLISH QoS 0", builder,
+                 { 0x30, 0x07, 0x00, 0x03, 'a', '/', 'b', '1', '2' });
+    builder.reset();
+
+    // DUP, QoS 1 and RETAIN flags in the fixed header, then the packet identifier after the topic.
+    builder.buildPublish("t", "v", true, 1, true, 0x1234);
+    expectPacket("PUBLISH QoS 1 dup retain", builder,
+                 { 0x3b, 0x06, 0x00, 0x01, 't', 0x12, 0x34, 'v' });
+    builder.reset();
+
+    // 2.2.3 Remaining Length: seven bits per byte, continuation in the top bit.
+    testRemainingLength("PUBLISH remaining length 127", 124, { 0x7f });
+    testRemainingLength("PUBLISH remaining length 128", 125, { 0x80, 0x01 });
+    testRemainingLength("PUBLISH remaining length 203", 200, { 0xcb, 0x01 });
+    testRemainingLength("PUBLISH remaining length 16383", 16380, { 0xff, 0x7f });
+    testRemainingLength("PUBLISH remaining length 16384", 16381, { 0x80, 0x80, 0x01 });
+
+    // 3.4 PUBACK
+    builder.buildPublishAck(7);
+    expectPacket("PUBACK", builder, { 0x40, 0x02, 0x00, 0x07 });
+    builder.reset();
+
+    // 3.9 SUBACK: packet identifier then a return code per topic filter.
+    const uint8_t results[] = { 0x00, 0x01, 0x80 };
+    builder.buildSubscribeAck(0x0102, sizeof(results), results);
+    expectPacket("SUBACK", builder, { 0x90, 0x05, 0x01, 0x02, 0x00, 0x01, 0x80 });
+    builder.reset();
+
+    // 3.11 UNSUBACK
+    builder.buildUnsubscribeAck(0x0a0b);
+    expectPacket("UNSUBACK", builder, { 0xb0, 0x02, 0x0a, 0x0b });
+    builder.reset();
+
+    // 3.13 PINGRESP
+    builder.buildPingResponse();
+    expectPacket("PINGRESP", builder, { 0xd0, 0x00 });
+    builder.reset();
+
+    // Packets are appended, and one that doesn't fit leaves the buffer as it was.
+    builder.buildPingResponse();
+    builder.buildUnsubscribeAck(1);
+    expectPacket("PINGRESP then UNSUBACK", builder, { 0xd0, 0x00, 0xb0, 0x02, 0x00, 0x01 });
+    builder.reset();
+
+    uint8_t smallBuffer[5];
+    MQTTPacketBuilder smallBuilder(smallBuffer, sizeof(smallBuffer));
+    smallBuilder.buildPingResponse();
+    expectTrue("UNSUBACK too big refused", !smallBuilder.buildUnsubscribeAck(1));
+    expectPacket("Refused build leaves buffer", smallBuilder, { 0xd0, 0x00 });
+
+    if (failures) {
+        printf("%u failures\n", failures);
+        return 1;
+    }
+
+    return 0;
+}